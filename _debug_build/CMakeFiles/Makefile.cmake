@@ -0,0 +1,147 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/cmake/FindOsmium.cmake"
+  "/root/repo/doc/CMakeLists.txt"
+  "/root/repo/examples/CMakeLists.txt"
+  "/root/repo/test/CMakeLists.txt"
+  "/usr/lib/x86_64-linux-gnu/cmake/Boost-1.74.0/BoostConfig.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/Boost-1.74.0/BoostConfigVersion.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/BoostDetectToolset-1.74.0.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/boost_headers-1.74.0/boost_headers-config-version.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/boost_headers-1.74.0/boost_headers-config.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/boost_program_options-1.74.0/boost_program_options-config-version.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/boost_program_options-1.74.0/boost_program_options-config.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/boost_program_options-1.74.0/libboost_program_options-variant-shared.cmake"
+  "/usr/lib/x86_64-linux-gnu/cmake/boost_program_options-1.74.0/libboost_program_options-variant-static.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakePushCheckState.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CPack.cmake"
+  "/usr/share/cmake-3.25/Modules/CPackComponent.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckSymbolExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindBZip2.cmake"
+  "/usr/share/cmake-3.25/Modules/FindBoost.cmake"
+  "/usr/share/cmake-3.25/Modules/FindDoxygen.cmake"
+  "/usr/share/cmake-3.25/Modules/FindEXPAT.cmake"
+  "/usr/share/cmake-3.25/Modules/FindGDAL.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPkgConfig.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/FindZLIB.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/SelectLibraryConfigurations.cmake"
+  "/usr/share/cmake-3.25/Templates/CPackConfig.cmake.in"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CPackConfig.cmake"
+  "CPackSourceConfig.cmake"
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "test/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "examples/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "doc/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "test/CMakeFiles/testlib.dir/DependInfo.cmake"
+  "test/CMakeFiles/area_test_area_id.dir/DependInfo.cmake"
+  "test/CMakeFiles/area_test_node_ref_segment.dir/DependInfo.cmake"
+  "test/CMakeFiles/basic_test_box.dir/DependInfo.cmake"
+  "test/CMakeFiles/basic_test_changeset.dir/DependInfo.cmake"
+  "test/CMakeFiles/basic_test_entity_bits.dir/DependInfo.cmake"
+  "test/CMakeFiles/basic_test_location.dir/DependInfo.cmake"
+  "test/CMakeFiles/basic_test_node.dir/DependInfo.cmake"
+  "test/CMakeFiles/basic_test_node_ref.dir/DependInfo.cmake"
+  "test/CMakeFiles/basic_test_object_comparisons.dir/DependInfo.cmake"
+  "test/CMakeFiles/basic_test_relation.dir/DependInfo.cmake"
+  "test/CMakeFiles/basic_test_timestamp.dir/DependInfo.cmake"
+  "test/CMakeFiles/basic_test_way.dir/DependInfo.cmake"
+  "test/CMakeFiles/buffer_test_buffer_node.dir/DependInfo.cmake"
+  "test/CMakeFiles/buffer_test_buffer_pool.dir/DependInfo.cmake"
+  "test/CMakeFiles/buffer_test_buffer_purge.dir/DependInfo.cmake"
+  "test/CMakeFiles/buffer_test_buffer_raw_data.dir/DependInfo.cmake"
+  "test/CMakeFiles/geom_test_geojson.dir/DependInfo.cmake"
+  "test/CMakeFiles/geom_test_mercator.dir/DependInfo.cmake"
+  "test/CMakeFiles/geom_test_wkb.dir/DependInfo.cmake"
+  "test/CMakeFiles/geom_test_wkt.dir/DependInfo.cmake"
+  "test/CMakeFiles/index_test_id_to_location.dir/DependInfo.cmake"
+  "test/CMakeFiles/index_test_typed_mmap.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_apply_parallel.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_bzip2.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_file_formats.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_merge_reader.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_reader.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_reader_bbox.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_reader_read_meta.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_reader_opl.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_reader_osmbuf.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_reader_xml_builtin.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_reader_xml_parallel.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_pipeline.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_pbf_blob_index.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_pbf_compression.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_protobuf_reader.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_protobuf_writer.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_reader_pbf.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_reader_pbf_sorted.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_writer_pbf.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_output_iterator.dir/DependInfo.cmake"
+  "test/CMakeFiles/io_test_write_thread.dir/DependInfo.cmake"
+  "test/CMakeFiles/tags_test_filter.dir/DependInfo.cmake"
+  "test/CMakeFiles/tags_test_operators.dir/DependInfo.cmake"
+  "test/CMakeFiles/tags_test_tag_list.dir/DependInfo.cmake"
+  "test/CMakeFiles/thread_test_byte_budget.dir/DependInfo.cmake"
+  "test/CMakeFiles/thread_test_pool.dir/DependInfo.cmake"
+  "test/CMakeFiles/thread_test_queue.dir/DependInfo.cmake"
+  "test/CMakeFiles/thread_test_spsc_queue.dir/DependInfo.cmake"
+  "test/CMakeFiles/util_test_cast_with_assert.dir/DependInfo.cmake"
+  "test/CMakeFiles/util_test_double.dir/DependInfo.cmake"
+  "test/CMakeFiles/util_test_options.dir/DependInfo.cmake"
+  "test/CMakeFiles/util_test_string.dir/DependInfo.cmake"
+  "examples/CMakeFiles/osmium_convert.dir/DependInfo.cmake"
+  "examples/CMakeFiles/osmium_count.dir/DependInfo.cmake"
+  "examples/CMakeFiles/osmium_create_node_cache.dir/DependInfo.cmake"
+  "examples/CMakeFiles/osmium_debug.dir/DependInfo.cmake"
+  "examples/CMakeFiles/osmium_index.dir/DependInfo.cmake"
+  "examples/CMakeFiles/osmium_read.dir/DependInfo.cmake"
+  "examples/CMakeFiles/osmium_serdump.dir/DependInfo.cmake"
+  "examples/CMakeFiles/osmium_use_node_cache.dir/DependInfo.cmake"
+  )
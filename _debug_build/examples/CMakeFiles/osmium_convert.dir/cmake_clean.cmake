@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/osmium_convert.dir/osmium_convert.cpp.o"
+  "CMakeFiles/osmium_convert.dir/osmium_convert.cpp.o.d"
+  "osmium_convert"
+  "osmium_convert.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/osmium_convert.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
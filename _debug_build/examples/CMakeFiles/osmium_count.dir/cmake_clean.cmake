@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/osmium_count.dir/osmium_count.cpp.o"
+  "CMakeFiles/osmium_count.dir/osmium_count.cpp.o.d"
+  "osmium_count"
+  "osmium_count.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/osmium_count.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
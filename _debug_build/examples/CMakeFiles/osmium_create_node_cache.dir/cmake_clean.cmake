@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/osmium_create_node_cache.dir/osmium_create_node_cache.cpp.o"
+  "CMakeFiles/osmium_create_node_cache.dir/osmium_create_node_cache.cpp.o.d"
+  "osmium_create_node_cache"
+  "osmium_create_node_cache.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/osmium_create_node_cache.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/osmium_debug.dir/osmium_debug.cpp.o"
+  "CMakeFiles/osmium_debug.dir/osmium_debug.cpp.o.d"
+  "osmium_debug"
+  "osmium_debug.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/osmium_debug.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
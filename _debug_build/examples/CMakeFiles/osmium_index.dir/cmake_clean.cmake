@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/osmium_index.dir/osmium_index.cpp.o"
+  "CMakeFiles/osmium_index.dir/osmium_index.cpp.o.d"
+  "osmium_index"
+  "osmium_index.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/osmium_index.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
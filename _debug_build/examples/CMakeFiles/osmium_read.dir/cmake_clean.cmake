@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/osmium_read.dir/osmium_read.cpp.o"
+  "CMakeFiles/osmium_read.dir/osmium_read.cpp.o.d"
+  "osmium_read"
+  "osmium_read.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/osmium_read.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/osmium_serdump.dir/osmium_serdump.cpp.o"
+  "CMakeFiles/osmium_serdump.dir/osmium_serdump.cpp.o.d"
+  "osmium_serdump"
+  "osmium_serdump.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/osmium_serdump.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
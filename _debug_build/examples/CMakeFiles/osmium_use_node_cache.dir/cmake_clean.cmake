@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/osmium_use_node_cache.dir/osmium_use_node_cache.cpp.o"
+  "CMakeFiles/osmium_use_node_cache.dir/osmium_use_node_cache.cpp.o.d"
+  "osmium_use_node_cache"
+  "osmium_use_node_cache.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/osmium_use_node_cache.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
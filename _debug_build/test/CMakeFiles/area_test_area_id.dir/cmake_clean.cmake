@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/area_test_area_id.dir/t/area/test_area_id.cpp.o"
+  "CMakeFiles/area_test_area_id.dir/t/area/test_area_id.cpp.o.d"
+  "area_test_area_id"
+  "area_test_area_id.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/area_test_area_id.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
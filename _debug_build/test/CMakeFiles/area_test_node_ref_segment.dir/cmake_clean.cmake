@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/area_test_node_ref_segment.dir/t/area/test_node_ref_segment.cpp.o"
+  "CMakeFiles/area_test_node_ref_segment.dir/t/area/test_node_ref_segment.cpp.o.d"
+  "area_test_node_ref_segment"
+  "area_test_node_ref_segment.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/area_test_node_ref_segment.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
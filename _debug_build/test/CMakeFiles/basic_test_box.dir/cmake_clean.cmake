@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/basic_test_box.dir/t/basic/test_box.cpp.o"
+  "CMakeFiles/basic_test_box.dir/t/basic/test_box.cpp.o.d"
+  "basic_test_box"
+  "basic_test_box.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/basic_test_box.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/basic_test_changeset.dir/t/basic/test_changeset.cpp.o"
+  "CMakeFiles/basic_test_changeset.dir/t/basic/test_changeset.cpp.o.d"
+  "basic_test_changeset"
+  "basic_test_changeset.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/basic_test_changeset.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
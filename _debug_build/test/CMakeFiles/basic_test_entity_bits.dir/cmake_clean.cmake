@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/basic_test_entity_bits.dir/t/basic/test_entity_bits.cpp.o"
+  "CMakeFiles/basic_test_entity_bits.dir/t/basic/test_entity_bits.cpp.o.d"
+  "basic_test_entity_bits"
+  "basic_test_entity_bits.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/basic_test_entity_bits.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
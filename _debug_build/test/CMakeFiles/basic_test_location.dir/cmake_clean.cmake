@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/basic_test_location.dir/t/basic/test_location.cpp.o"
+  "CMakeFiles/basic_test_location.dir/t/basic/test_location.cpp.o.d"
+  "basic_test_location"
+  "basic_test_location.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/basic_test_location.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
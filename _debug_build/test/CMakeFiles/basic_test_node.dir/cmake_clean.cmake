@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/basic_test_node.dir/t/basic/test_node.cpp.o"
+  "CMakeFiles/basic_test_node.dir/t/basic/test_node.cpp.o.d"
+  "basic_test_node"
+  "basic_test_node.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/basic_test_node.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
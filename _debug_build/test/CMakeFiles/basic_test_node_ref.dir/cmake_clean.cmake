@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/basic_test_node_ref.dir/t/basic/test_node_ref.cpp.o"
+  "CMakeFiles/basic_test_node_ref.dir/t/basic/test_node_ref.cpp.o.d"
+  "basic_test_node_ref"
+  "basic_test_node_ref.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/basic_test_node_ref.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
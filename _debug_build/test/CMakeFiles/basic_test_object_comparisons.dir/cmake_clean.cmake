@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/basic_test_object_comparisons.dir/t/basic/test_object_comparisons.cpp.o"
+  "CMakeFiles/basic_test_object_comparisons.dir/t/basic/test_object_comparisons.cpp.o.d"
+  "basic_test_object_comparisons"
+  "basic_test_object_comparisons.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/basic_test_object_comparisons.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/basic_test_relation.dir/t/basic/test_relation.cpp.o"
+  "CMakeFiles/basic_test_relation.dir/t/basic/test_relation.cpp.o.d"
+  "basic_test_relation"
+  "basic_test_relation.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/basic_test_relation.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/basic_test_timestamp.dir/t/basic/test_timestamp.cpp.o"
+  "CMakeFiles/basic_test_timestamp.dir/t/basic/test_timestamp.cpp.o.d"
+  "basic_test_timestamp"
+  "basic_test_timestamp.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/basic_test_timestamp.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/basic_test_way.dir/t/basic/test_way.cpp.o"
+  "CMakeFiles/basic_test_way.dir/t/basic/test_way.cpp.o.d"
+  "basic_test_way"
+  "basic_test_way.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/basic_test_way.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/buffer_test_buffer_node.dir/t/buffer/test_buffer_node.cpp.o"
+  "CMakeFiles/buffer_test_buffer_node.dir/t/buffer/test_buffer_node.cpp.o.d"
+  "buffer_test_buffer_node"
+  "buffer_test_buffer_node.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/buffer_test_buffer_node.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
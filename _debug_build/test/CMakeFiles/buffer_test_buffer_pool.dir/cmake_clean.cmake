@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/buffer_test_buffer_pool.dir/t/buffer/test_buffer_pool.cpp.o"
+  "CMakeFiles/buffer_test_buffer_pool.dir/t/buffer/test_buffer_pool.cpp.o.d"
+  "buffer_test_buffer_pool"
+  "buffer_test_buffer_pool.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/buffer_test_buffer_pool.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/buffer_test_buffer_purge.dir/t/buffer/test_buffer_purge.cpp.o"
+  "CMakeFiles/buffer_test_buffer_purge.dir/t/buffer/test_buffer_purge.cpp.o.d"
+  "buffer_test_buffer_purge"
+  "buffer_test_buffer_purge.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/buffer_test_buffer_purge.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
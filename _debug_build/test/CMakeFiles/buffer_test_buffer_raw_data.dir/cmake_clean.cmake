@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/buffer_test_buffer_raw_data.dir/t/buffer/test_buffer_raw_data.cpp.o"
+  "CMakeFiles/buffer_test_buffer_raw_data.dir/t/buffer/test_buffer_raw_data.cpp.o.d"
+  "buffer_test_buffer_raw_data"
+  "buffer_test_buffer_raw_data.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/buffer_test_buffer_raw_data.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/geom_test_geojson.dir/t/geom/test_geojson.cpp.o"
+  "CMakeFiles/geom_test_geojson.dir/t/geom/test_geojson.cpp.o.d"
+  "geom_test_geojson"
+  "geom_test_geojson.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/geom_test_geojson.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
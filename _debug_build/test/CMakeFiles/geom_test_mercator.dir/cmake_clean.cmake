@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/geom_test_mercator.dir/t/geom/test_mercator.cpp.o"
+  "CMakeFiles/geom_test_mercator.dir/t/geom/test_mercator.cpp.o.d"
+  "geom_test_mercator"
+  "geom_test_mercator.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/geom_test_mercator.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
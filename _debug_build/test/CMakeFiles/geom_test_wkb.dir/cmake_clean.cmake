@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/geom_test_wkb.dir/t/geom/test_wkb.cpp.o"
+  "CMakeFiles/geom_test_wkb.dir/t/geom/test_wkb.cpp.o.d"
+  "geom_test_wkb"
+  "geom_test_wkb.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/geom_test_wkb.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/geom_test_wkt.dir/t/geom/test_wkt.cpp.o"
+  "CMakeFiles/geom_test_wkt.dir/t/geom/test_wkt.cpp.o.d"
+  "geom_test_wkt"
+  "geom_test_wkt.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/geom_test_wkt.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/index_test_id_to_location.dir/t/index/test_id_to_location.cpp.o"
+  "CMakeFiles/index_test_id_to_location.dir/t/index/test_id_to_location.cpp.o.d"
+  "index_test_id_to_location"
+  "index_test_id_to_location.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/index_test_id_to_location.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
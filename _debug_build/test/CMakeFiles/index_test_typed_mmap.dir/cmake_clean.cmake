@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/index_test_typed_mmap.dir/t/index/test_typed_mmap.cpp.o"
+  "CMakeFiles/index_test_typed_mmap.dir/t/index/test_typed_mmap.cpp.o.d"
+  "index_test_typed_mmap"
+  "index_test_typed_mmap.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/index_test_typed_mmap.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
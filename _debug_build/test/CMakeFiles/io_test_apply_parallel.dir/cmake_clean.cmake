@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_apply_parallel.dir/t/io/test_apply_parallel.cpp.o"
+  "CMakeFiles/io_test_apply_parallel.dir/t/io/test_apply_parallel.cpp.o.d"
+  "io_test_apply_parallel"
+  "io_test_apply_parallel.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_apply_parallel.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_bzip2.dir/t/io/test_bzip2.cpp.o"
+  "CMakeFiles/io_test_bzip2.dir/t/io/test_bzip2.cpp.o.d"
+  "io_test_bzip2"
+  "io_test_bzip2.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_bzip2.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
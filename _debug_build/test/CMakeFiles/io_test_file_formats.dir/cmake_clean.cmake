@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_file_formats.dir/t/io/test_file_formats.cpp.o"
+  "CMakeFiles/io_test_file_formats.dir/t/io/test_file_formats.cpp.o.d"
+  "io_test_file_formats"
+  "io_test_file_formats.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_file_formats.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_merge_reader.dir/t/io/test_merge_reader.cpp.o"
+  "CMakeFiles/io_test_merge_reader.dir/t/io/test_merge_reader.cpp.o.d"
+  "io_test_merge_reader"
+  "io_test_merge_reader.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_merge_reader.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_output_iterator.dir/t/io/test_output_iterator.cpp.o"
+  "CMakeFiles/io_test_output_iterator.dir/t/io/test_output_iterator.cpp.o.d"
+  "io_test_output_iterator"
+  "io_test_output_iterator.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_output_iterator.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
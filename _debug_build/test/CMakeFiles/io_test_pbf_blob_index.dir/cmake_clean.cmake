@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_pbf_blob_index.dir/t/io/test_pbf_blob_index.cpp.o"
+  "CMakeFiles/io_test_pbf_blob_index.dir/t/io/test_pbf_blob_index.cpp.o.d"
+  "io_test_pbf_blob_index"
+  "io_test_pbf_blob_index.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_pbf_blob_index.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
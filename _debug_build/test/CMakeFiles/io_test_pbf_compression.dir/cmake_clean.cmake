@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_pbf_compression.dir/t/io/test_pbf_compression.cpp.o"
+  "CMakeFiles/io_test_pbf_compression.dir/t/io/test_pbf_compression.cpp.o.d"
+  "io_test_pbf_compression"
+  "io_test_pbf_compression.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_pbf_compression.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
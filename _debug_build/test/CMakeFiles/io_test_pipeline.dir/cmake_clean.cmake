@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_pipeline.dir/t/io/test_pipeline.cpp.o"
+  "CMakeFiles/io_test_pipeline.dir/t/io/test_pipeline.cpp.o.d"
+  "io_test_pipeline"
+  "io_test_pipeline.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_pipeline.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_protobuf_writer.dir/t/io/test_protobuf_writer.cpp.o"
+  "CMakeFiles/io_test_protobuf_writer.dir/t/io/test_protobuf_writer.cpp.o.d"
+  "io_test_protobuf_writer"
+  "io_test_protobuf_writer.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_protobuf_writer.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
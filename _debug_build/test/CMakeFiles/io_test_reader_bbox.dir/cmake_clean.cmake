@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_reader_bbox.dir/t/io/test_reader_bbox.cpp.o"
+  "CMakeFiles/io_test_reader_bbox.dir/t/io/test_reader_bbox.cpp.o.d"
+  "io_test_reader_bbox"
+  "io_test_reader_bbox.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_reader_bbox.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
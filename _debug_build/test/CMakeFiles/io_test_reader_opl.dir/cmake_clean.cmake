@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_reader_opl.dir/t/io/test_reader_opl.cpp.o"
+  "CMakeFiles/io_test_reader_opl.dir/t/io/test_reader_opl.cpp.o.d"
+  "io_test_reader_opl"
+  "io_test_reader_opl.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_reader_opl.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
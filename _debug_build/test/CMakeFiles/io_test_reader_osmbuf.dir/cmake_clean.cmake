@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_reader_osmbuf.dir/t/io/test_reader_osmbuf.cpp.o"
+  "CMakeFiles/io_test_reader_osmbuf.dir/t/io/test_reader_osmbuf.cpp.o.d"
+  "io_test_reader_osmbuf"
+  "io_test_reader_osmbuf.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_reader_osmbuf.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
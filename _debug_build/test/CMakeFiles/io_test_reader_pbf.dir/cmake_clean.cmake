@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_reader_pbf.dir/t/io/test_reader_pbf.cpp.o"
+  "CMakeFiles/io_test_reader_pbf.dir/t/io/test_reader_pbf.cpp.o.d"
+  "io_test_reader_pbf"
+  "io_test_reader_pbf.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_reader_pbf.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
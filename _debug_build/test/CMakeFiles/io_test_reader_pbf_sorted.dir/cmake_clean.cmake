@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_reader_pbf_sorted.dir/t/io/test_reader_pbf_sorted.cpp.o"
+  "CMakeFiles/io_test_reader_pbf_sorted.dir/t/io/test_reader_pbf_sorted.cpp.o.d"
+  "io_test_reader_pbf_sorted"
+  "io_test_reader_pbf_sorted.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_reader_pbf_sorted.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_reader_read_meta.dir/t/io/test_reader_read_meta.cpp.o"
+  "CMakeFiles/io_test_reader_read_meta.dir/t/io/test_reader_read_meta.cpp.o.d"
+  "io_test_reader_read_meta"
+  "io_test_reader_read_meta.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_reader_read_meta.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
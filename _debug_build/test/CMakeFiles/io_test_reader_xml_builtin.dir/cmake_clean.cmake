@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_reader_xml_builtin.dir/t/io/test_reader_xml_builtin.cpp.o"
+  "CMakeFiles/io_test_reader_xml_builtin.dir/t/io/test_reader_xml_builtin.cpp.o.d"
+  "io_test_reader_xml_builtin"
+  "io_test_reader_xml_builtin.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_reader_xml_builtin.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_write_thread.dir/t/io/test_write_thread.cpp.o"
+  "CMakeFiles/io_test_write_thread.dir/t/io/test_write_thread.cpp.o.d"
+  "io_test_write_thread"
+  "io_test_write_thread.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_write_thread.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
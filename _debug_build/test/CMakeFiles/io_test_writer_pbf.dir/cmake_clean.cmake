@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_test_writer_pbf.dir/t/io/test_writer_pbf.cpp.o"
+  "CMakeFiles/io_test_writer_pbf.dir/t/io/test_writer_pbf.cpp.o.d"
+  "io_test_writer_pbf"
+  "io_test_writer_pbf.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_test_writer_pbf.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/tags_test_filter.dir/t/tags/test_filter.cpp.o"
+  "CMakeFiles/tags_test_filter.dir/t/tags/test_filter.cpp.o.d"
+  "tags_test_filter"
+  "tags_test_filter.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tags_test_filter.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
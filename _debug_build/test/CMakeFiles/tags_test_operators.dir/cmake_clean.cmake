@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/tags_test_operators.dir/t/tags/test_operators.cpp.o"
+  "CMakeFiles/tags_test_operators.dir/t/tags/test_operators.cpp.o.d"
+  "tags_test_operators"
+  "tags_test_operators.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tags_test_operators.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
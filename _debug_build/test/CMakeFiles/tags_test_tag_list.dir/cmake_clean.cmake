@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/tags_test_tag_list.dir/t/tags/test_tag_list.cpp.o"
+  "CMakeFiles/tags_test_tag_list.dir/t/tags/test_tag_list.cpp.o.d"
+  "tags_test_tag_list"
+  "tags_test_tag_list.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tags_test_tag_list.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
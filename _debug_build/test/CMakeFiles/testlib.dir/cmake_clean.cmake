@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/testlib.dir/test_main.cpp.o"
+  "CMakeFiles/testlib.dir/test_main.cpp.o.d"
+  "libtestlib.a"
+  "libtestlib.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testlib.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/thread_test_byte_budget.dir/t/thread/test_byte_budget.cpp.o"
+  "CMakeFiles/thread_test_byte_budget.dir/t/thread/test_byte_budget.cpp.o.d"
+  "thread_test_byte_budget"
+  "thread_test_byte_budget.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/thread_test_byte_budget.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
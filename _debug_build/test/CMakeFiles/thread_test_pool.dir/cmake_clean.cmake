@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/thread_test_pool.dir/t/thread/test_pool.cpp.o"
+  "CMakeFiles/thread_test_pool.dir/t/thread/test_pool.cpp.o.d"
+  "thread_test_pool"
+  "thread_test_pool.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/thread_test_pool.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/thread_test_spsc_queue.dir/t/thread/test_spsc_queue.cpp.o"
+  "CMakeFiles/thread_test_spsc_queue.dir/t/thread/test_spsc_queue.cpp.o.d"
+  "thread_test_spsc_queue"
+  "thread_test_spsc_queue.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/thread_test_spsc_queue.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/util_test_cast_with_assert.dir/t/util/test_cast_with_assert.cpp.o"
+  "CMakeFiles/util_test_cast_with_assert.dir/t/util/test_cast_with_assert.cpp.o.d"
+  "util_test_cast_with_assert"
+  "util_test_cast_with_assert.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/util_test_cast_with_assert.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
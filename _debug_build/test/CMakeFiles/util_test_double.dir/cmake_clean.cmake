@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/util_test_double.dir/t/util/test_double.cpp.o"
+  "CMakeFiles/util_test_double.dir/t/util/test_double.cpp.o.d"
+  "util_test_double"
+  "util_test_double.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/util_test_double.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
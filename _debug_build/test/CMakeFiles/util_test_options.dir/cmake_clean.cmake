@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/util_test_options.dir/t/util/test_options.cpp.o"
+  "CMakeFiles/util_test_options.dir/t/util/test_options.cpp.o.d"
+  "util_test_options"
+  "util_test_options.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/util_test_options.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
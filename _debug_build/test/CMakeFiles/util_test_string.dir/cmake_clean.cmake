@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/util_test_string.dir/t/util/test_string.cpp.o"
+  "CMakeFiles/util_test_string.dir/t/util/test_string.cpp.o.d"
+  "util_test_string"
+  "util_test_string.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/util_test_string.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,114 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/test
+# Build directory: /root/repo/_debug_build/test
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(area_test_area_id "/root/repo/_debug_build/test/area_test_area_id")
+set_tests_properties(area_test_area_id PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;area" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;65;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(area_test_node_ref_segment "/root/repo/_debug_build/test/area_test_node_ref_segment")
+set_tests_properties(area_test_node_ref_segment PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;area" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;66;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(basic_test_box "/root/repo/_debug_build/test/basic_test_box")
+set_tests_properties(basic_test_box PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;basic" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;68;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(basic_test_changeset "/root/repo/_debug_build/test/basic_test_changeset")
+set_tests_properties(basic_test_changeset PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;basic" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;69;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(basic_test_entity_bits "/root/repo/_debug_build/test/basic_test_entity_bits")
+set_tests_properties(basic_test_entity_bits PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;basic" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;70;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(basic_test_location "/root/repo/_debug_build/test/basic_test_location")
+set_tests_properties(basic_test_location PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;basic" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;71;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(basic_test_node "/root/repo/_debug_build/test/basic_test_node")
+set_tests_properties(basic_test_node PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;basic" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;72;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(basic_test_node_ref "/root/repo/_debug_build/test/basic_test_node_ref")
+set_tests_properties(basic_test_node_ref PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;basic" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;73;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(basic_test_object_comparisons "/root/repo/_debug_build/test/basic_test_object_comparisons")
+set_tests_properties(basic_test_object_comparisons PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;basic" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;74;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(basic_test_relation "/root/repo/_debug_build/test/basic_test_relation")
+set_tests_properties(basic_test_relation PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;basic" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;75;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(basic_test_timestamp "/root/repo/_debug_build/test/basic_test_timestamp")
+set_tests_properties(basic_test_timestamp PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;basic" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;76;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(basic_test_way "/root/repo/_debug_build/test/basic_test_way")
+set_tests_properties(basic_test_way PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;basic" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;77;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(buffer_test_buffer_node "/root/repo/_debug_build/test/buffer_test_buffer_node")
+set_tests_properties(buffer_test_buffer_node PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;buffer" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;79;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(buffer_test_buffer_pool "/root/repo/_debug_build/test/buffer_test_buffer_pool")
+set_tests_properties(buffer_test_buffer_pool PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;buffer" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;80;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(buffer_test_buffer_purge "/root/repo/_debug_build/test/buffer_test_buffer_purge")
+set_tests_properties(buffer_test_buffer_purge PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;buffer" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;81;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(buffer_test_buffer_raw_data "/root/repo/_debug_build/test/buffer_test_buffer_raw_data")
+set_tests_properties(buffer_test_buffer_raw_data PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;buffer" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;82;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(geom_test_geojson "/root/repo/_debug_build/test/geom_test_geojson")
+set_tests_properties(geom_test_geojson PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;geom" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;93;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(geom_test_mercator "/root/repo/_debug_build/test/geom_test_mercator")
+set_tests_properties(geom_test_mercator PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;geom" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;96;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(geom_test_wkb "/root/repo/_debug_build/test/geom_test_wkb")
+set_tests_properties(geom_test_wkb PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;geom" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;99;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(geom_test_wkt "/root/repo/_debug_build/test/geom_test_wkt")
+set_tests_properties(geom_test_wkt PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;geom" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;100;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(index_test_id_to_location "/root/repo/_debug_build/test/index_test_id_to_location")
+set_tests_properties(index_test_id_to_location PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;index" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;102;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(index_test_typed_mmap "/root/repo/_debug_build/test/index_test_typed_mmap")
+set_tests_properties(index_test_typed_mmap PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;index" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;103;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_apply_parallel "/root/repo/_debug_build/test/io_test_apply_parallel")
+set_tests_properties(io_test_apply_parallel PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;105;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_bzip2 "/root/repo/_debug_build/test/io_test_bzip2")
+set_tests_properties(io_test_bzip2 PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;106;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_file_formats "/root/repo/_debug_build/test/io_test_file_formats")
+set_tests_properties(io_test_file_formats PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;107;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_merge_reader "/root/repo/_debug_build/test/io_test_merge_reader")
+set_tests_properties(io_test_merge_reader PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;108;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_reader "/root/repo/_debug_build/test/io_test_reader")
+set_tests_properties(io_test_reader PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;109;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_reader_bbox "/root/repo/_debug_build/test/io_test_reader_bbox")
+set_tests_properties(io_test_reader_bbox PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;110;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_reader_read_meta "/root/repo/_debug_build/test/io_test_reader_read_meta")
+set_tests_properties(io_test_reader_read_meta PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;111;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_reader_opl "/root/repo/_debug_build/test/io_test_reader_opl")
+set_tests_properties(io_test_reader_opl PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;112;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_reader_osmbuf "/root/repo/_debug_build/test/io_test_reader_osmbuf")
+set_tests_properties(io_test_reader_osmbuf PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;113;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_reader_xml_builtin "/root/repo/_debug_build/test/io_test_reader_xml_builtin")
+set_tests_properties(io_test_reader_xml_builtin PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;114;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_reader_xml_parallel "/root/repo/_debug_build/test/io_test_reader_xml_parallel")
+set_tests_properties(io_test_reader_xml_parallel PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;115;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_pipeline "/root/repo/_debug_build/test/io_test_pipeline")
+set_tests_properties(io_test_pipeline PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;116;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_pbf_blob_index "/root/repo/_debug_build/test/io_test_pbf_blob_index")
+set_tests_properties(io_test_pbf_blob_index PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;117;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_pbf_compression "/root/repo/_debug_build/test/io_test_pbf_compression")
+set_tests_properties(io_test_pbf_compression PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;118;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_protobuf_reader "/root/repo/_debug_build/test/io_test_protobuf_reader")
+set_tests_properties(io_test_protobuf_reader PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;119;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_protobuf_writer "/root/repo/_debug_build/test/io_test_protobuf_writer")
+set_tests_properties(io_test_protobuf_writer PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;120;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_reader_pbf "/root/repo/_debug_build/test/io_test_reader_pbf")
+set_tests_properties(io_test_reader_pbf PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;121;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_reader_pbf_sorted "/root/repo/_debug_build/test/io_test_reader_pbf_sorted")
+set_tests_properties(io_test_reader_pbf_sorted PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;122;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_writer_pbf "/root/repo/_debug_build/test/io_test_writer_pbf")
+set_tests_properties(io_test_writer_pbf PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;123;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_output_iterator "/root/repo/_debug_build/test/io_test_output_iterator")
+set_tests_properties(io_test_output_iterator PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;124;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(io_test_write_thread "/root/repo/_debug_build/test/io_test_write_thread")
+set_tests_properties(io_test_write_thread PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;io" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;125;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(tags_test_filter "/root/repo/_debug_build/test/tags_test_filter")
+set_tests_properties(tags_test_filter PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;tags" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;127;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(tags_test_operators "/root/repo/_debug_build/test/tags_test_operators")
+set_tests_properties(tags_test_operators PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;tags" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;128;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(tags_test_tag_list "/root/repo/_debug_build/test/tags_test_tag_list")
+set_tests_properties(tags_test_tag_list PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;tags" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;129;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(thread_test_byte_budget "/root/repo/_debug_build/test/thread_test_byte_budget")
+set_tests_properties(thread_test_byte_budget PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;thread" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;131;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(thread_test_pool "/root/repo/_debug_build/test/thread_test_pool")
+set_tests_properties(thread_test_pool PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;thread" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;132;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(thread_test_queue "/root/repo/_debug_build/test/thread_test_queue")
+set_tests_properties(thread_test_queue PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;thread" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;133;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(thread_test_spsc_queue "/root/repo/_debug_build/test/thread_test_spsc_queue")
+set_tests_properties(thread_test_spsc_queue PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;thread" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;134;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(util_test_cast_with_assert "/root/repo/_debug_build/test/util_test_cast_with_assert")
+set_tests_properties(util_test_cast_with_assert PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;util" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;136;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(util_test_double "/root/repo/_debug_build/test/util_test_double")
+set_tests_properties(util_test_double PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;util" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;137;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(util_test_options "/root/repo/_debug_build/test/util_test_options")
+set_tests_properties(util_test_options PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;util" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;138;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(util_test_string "/root/repo/_debug_build/test/util_test_string")
+set_tests_properties(util_test_string PROPERTIES  ENVIRONMENT "OSMIUM_TEST_DATA_DIR=/root/repo/test" LABELS "unit;fast;util" WORKING_DIRECTORY "/root/repo/_debug_build/test" _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;44;add_test;/root/repo/test/CMakeLists.txt;139;add_unit_test;/root/repo/test/CMakeLists.txt;0;")
@@ -35,7 +35,5 @@ int main(int argc, char* argv[]) {
 
     osmium::apply(reader, location_handler);
     reader.close();
-
-    google::protobuf::ShutdownProtobufLibrary();
 }
 
@@ -46,6 +46,9 @@
 #    OSMIUM_INCLUDE_DIRS  - Where to find include files.
 #    OSMIUM_XML_LIBRARIES - Libraries needed for XML I/O.
 #    OSMIUM_PBF_LIBRARIES - Libraries needed for PBF I/O.
+#    OSMIUM_PBF_COMPRESSION_LIBRARIES - Optional libraries for zstd and
+#                           lz4 compressed PBF blobs (part of
+#                           OSMIUM_PBF_LIBRARIES if found).
 #    OSMIUM_IO_LIBRARIES  - Libraries needed for XML or PBF I/O.
 #    OSMIUM_LIBRARIES     - All libraries Osmium uses somewhere.
 #
@@ -110,15 +113,11 @@ endif()
 #----------------------------------------------------------------------
 # Component 'pbf'
 if(Osmium_USE_PBF)
-    find_package(OSMPBF)
-    find_package(Protobuf)
     find_package(ZLIB)
     find_package(Threads)
 
-    if(OSMPBF_FOUND AND PROTOBUF_FOUND AND ZLIB_FOUND AND Threads_FOUND)
+    if(ZLIB_FOUND AND Threads_FOUND)
         list(APPEND OSMIUM_PBF_LIBRARIES
-            ${OSMPBF_LIBRARIES}
-            ${PROTOBUF_LITE_LIBRARY}
             ${ZLIB_LIBRARIES}
             ${CMAKE_THREAD_LIBS_INIT}
         )
@@ -126,10 +125,29 @@ if(Osmium_USE_PBF)
             list(APPEND OSMIUM_PBF_LIBRARIES ws2_32)
         endif()
         list(APPEND OSMIUM_INCLUDE_DIRS
-            ${OSMPBF_INCLUDE_DIRS}
-            ${PROTOBUF_INCLUDE_DIR}
             ${ZLIB_INCLUDE_DIR}
         )
+
+        # Optional support for zstd and lz4 compressed blobs
+        find_path(ZSTD_INCLUDE_DIR zstd.h)
+        find_library(ZSTD_LIBRARY NAMES zstd)
+        if(ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+            set(ZSTD_FOUND 1)
+            add_definitions(-DOSMIUM_WITH_ZSTD=${ZSTD_FOUND})
+            list(APPEND OSMIUM_PBF_COMPRESSION_LIBRARIES ${ZSTD_LIBRARY})
+            list(APPEND OSMIUM_INCLUDE_DIRS ${ZSTD_INCLUDE_DIR})
+        endif()
+
+        find_path(LZ4_INCLUDE_DIR lz4.h)
+        find_library(LZ4_LIBRARY NAMES lz4)
+        if(LZ4_INCLUDE_DIR AND LZ4_LIBRARY)
+            set(LZ4_FOUND 1)
+            add_definitions(-DOSMIUM_WITH_LZ4=${LZ4_FOUND})
+            list(APPEND OSMIUM_PBF_COMPRESSION_LIBRARIES ${LZ4_LIBRARY})
+            list(APPEND OSMIUM_INCLUDE_DIRS ${LZ4_INCLUDE_DIR})
+        endif()
+
+        list(APPEND OSMIUM_PBF_LIBRARIES ${OSMIUM_PBF_COMPRESSION_LIBRARIES})
     else()
         set(_missing_libraries 1)
         message(WARNING "Osmium: Can not find some libraries for PBF input/output, please install them or configure the paths.")
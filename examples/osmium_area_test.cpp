@@ -132,7 +132,5 @@ int main(int argc, char* argv[]) {
         }
         std::cerr << "\n";
     }
-
-    google::protobuf::ShutdownProtobufLibrary();
 }
 
@@ -46,7 +46,5 @@ int main(int argc, char* argv[]) {
     }
 
     reader.close();
-
-    google::protobuf::ShutdownProtobufLibrary();
 }
 
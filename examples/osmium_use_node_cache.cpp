@@ -64,8 +64,6 @@ int main(int argc, char* argv[]) {
     osmium::apply(reader, location_handler, handler);
     reader.close();
 
-    google::protobuf::ShutdownProtobufLibrary();
-
     return 0;
 }
 
@@ -0,0 +1,175 @@
+#ifndef OSMIUM_APPLY_PARALLEL_HPP
+#define OSMIUM_APPLY_PARALLEL_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <utility>
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/visitor.hpp>
+
+namespace osmium {
+
+    namespace detail {
+
+        /**
+         * Pool task applying the handlers to all objects in a buffer. The
+         * buffer is handed back as the result of the task.
+         */
+        template <class TApply>
+        struct apply_buffer_task {
+
+            osmium::memory::Buffer buffer;
+            const TApply* apply_handlers;
+
+            osmium::memory::Buffer operator()() {
+                (*apply_handlers)(buffer);
+                return std::move(buffer);
+            }
+
+        }; // struct apply_buffer_task
+
+        template <class TSource, class TCallback, class ...THandlers>
+        inline void apply_parallel_impl(osmium::thread::Pool& pool, TSource& source, TCallback& in_order, THandlers&... handlers) {
+            const size_t max_in_flight = 2 * static_cast<size_t>(pool.num_threads());
+
+            const auto apply_handlers = [&handlers...](osmium::memory::Buffer& buffer) {
+                for (auto& item : buffer) {
+                    apply_item_recurse(item, handlers...);
+                }
+            };
+            typedef apply_buffer_task<decltype(apply_handlers)> task_type;
+
+            std::deque<std::future<osmium::memory::Buffer>> results;
+
+            auto finish_oldest = [&] {
+                osmium::memory::Buffer buffer = results.front().get();
+                results.pop_front();
+                in_order(buffer);
+                source.recycle(std::move(buffer));
+            };
+
+            try {
+                while (osmium::memory::Buffer buffer = source.read()) {
+                    if (results.size() >= max_in_flight) {
+                        finish_oldest();
+                    }
+                    results.push_back(pool.submit(task_type{std::move(buffer), &apply_handlers}));
+                }
+                while (!results.empty()) {
+                    finish_oldest();
+                }
+            } catch (...) {
+                // The tasks still running reference the handlers, so we
+                // have to wait for them before leaving.
+                for (auto& result : results) {
+                    if (result.valid()) {
+                        result.wait();
+                    }
+                }
+                throw;
+            }
+
+            flush_recurse(handlers...);
+        }
+
+        struct no_callback {
+
+            void operator()(const osmium::memory::Buffer&) const noexcept {
+            }
+
+        }; // struct no_callback
+
+    } // namespace detail
+
+    /**
+     * Like osmium::apply(), but the handlers are called from the threads
+     * of the osmium::thread::Pool. Each buffer read from the source is
+     * handed to a pool thread which calls the handlers for all objects
+     * in it. Several buffers are processed at the same time, so the
+     * handlers must be thread-safe. Their flush() functions are called
+     * once at the end from the calling thread.
+     *
+     * The source is usually an osmium::io::Reader, it needs read() and
+     * recycle() functions.
+     *
+     * If a handler throws an exception, it is re-thrown here after all
+     * buffers already handed to the pool are done.
+     *
+     * The buffers are processed in the osmium::thread::Pool::instance().
+     * Use the overload taking a pool to run them somewhere else.
+     */
+    template <class TSource, class ...THandlers>
+    inline void apply_parallel(TSource& source, THandlers&... handlers) {
+        detail::no_callback callback;
+        detail::apply_parallel_impl(osmium::thread::Pool::instance(), source, callback, handlers...);
+    }
+
+    /**
+     * Like apply_parallel() above, but the buffers are processed in the
+     * given pool.
+     */
+    template <class TSource, class ...THandlers>
+    inline void apply_parallel(TSource& source, osmium::thread::Pool& pool, THandlers&... handlers) {
+        detail::no_callback callback;
+        detail::apply_parallel_impl(pool, source, callback, handlers...);
+    }
+
+    /**
+     * Like apply_parallel(), but after the handlers are done with a
+     * buffer, the in_order function is called with it from the calling
+     * thread. This happens in the order the buffers were read, so
+     * in_order can be used for all the work that needs the objects in
+     * sequence or that is not thread-safe.
+     */
+    template <class TSource, class TCallback, class ...THandlers>
+    inline void apply_parallel_ordered(TSource& source, TCallback&& in_order, THandlers&... handlers) {
+        detail::apply_parallel_impl(osmium::thread::Pool::instance(), source, in_order, handlers...);
+    }
+
+    /**
+     * Like apply_parallel_ordered() above, but the buffers are processed
+     * in the given pool.
+     */
+    template <class TSource, class TCallback, class ...THandlers>
+    inline void apply_parallel_ordered(TSource& source, osmium::thread::Pool& pool, TCallback&& in_order, THandlers&... handlers) {
+        detail::apply_parallel_impl(pool, source, in_order, handlers...);
+    }
+
+} // namespace osmium
+
+#endif // OSMIUM_APPLY_PARALLEL_HPP
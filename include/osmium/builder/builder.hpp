@@ -154,6 +154,20 @@ namespace osmium {
                 return length;
             }
 
+            /**
+             * Append data to buffer and add a \0 byte after it.
+             *
+             * @param data Pointer to data. Does not need to be \0-terminated.
+             * @param length Length of data in bytes without \0 byte.
+             * @returns Number of bytes appended (length + 1).
+             */
+            osmium::memory::item_size_type append_with_zero(const char* data, const osmium::memory::item_size_type length) {
+                unsigned char* target = m_buffer.reserve_space(length + 1);
+                std::copy_n(reinterpret_cast<const unsigned char*>(data), length, target);
+                target[length] = '\0';
+                return length + 1;
+            }
+
             /**
              * Append \0-terminated string to buffer.
              */
@@ -197,6 +211,19 @@ namespace osmium {
                 add_padding(true);
             }
 
+            /**
+             * Add user name to buffer. Unlike with add_user() the user name
+             * does not need to be \0-terminated, the \0 byte is added.
+             *
+             * @param user Pointer to user name.
+             * @param length Length of user name without \0 byte.
+             */
+            void set_user(const char* user, const size_t length) {
+                object().set_user_size(static_cast_with_assert<string_size_type>(length + 1));
+                add_size(append_with_zero(user, static_cast_with_assert<string_size_type>(length)));
+                add_padding(true);
+            }
+
             /**
              * Add user name to buffer.
              *
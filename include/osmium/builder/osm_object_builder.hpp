@@ -90,6 +90,20 @@ namespace osmium {
                          append(value.data(), static_cast_with_assert<string_size_type>(value.size() + 1)));
             }
 
+            /**
+             * Add tag to buffer. Key and value do not need to be
+             * \0-terminated.
+             *
+             * @param key Pointer to tag key.
+             * @param key_length Length of key without \0 byte.
+             * @param value Pointer to tag value.
+             * @param value_length Length of value without \0 byte.
+             */
+            void add_tag(const char* key, const size_t key_length, const char* value, const size_t value_length) {
+                add_size(append_with_zero(key,   static_cast_with_assert<string_size_type>(key_length)) +
+                         append_with_zero(value, static_cast_with_assert<string_size_type>(value_length)));
+            }
+
         }; // class TagListBuilder
 
         template <class T>
@@ -188,6 +202,30 @@ namespace osmium {
                 }
             }
 
+            /**
+             * Add a member to the relation.
+             *
+             * @param type The type (node, way, or relation).
+             * @param ref The ID of the member.
+             * @param role Pointer to the role of the member. Does not need
+             *             to be \0-terminated.
+             * @param role_length Length of role without \0 byte.
+             * @param full_member Optional pointer to the member object. If it
+             *                    is available a copy will be added to the
+             *                    relation.
+             */
+            void add_member(osmium::item_type type, object_id_type ref, const char* role, const size_t role_length, const osmium::OSMObject* full_member = nullptr) {
+                osmium::RelationMember* member = reserve_space_for<osmium::RelationMember>();
+                new (member) osmium::RelationMember(ref, type, full_member != nullptr);
+                add_size(sizeof(RelationMember));
+                member->set_role_size(static_cast_with_assert<string_size_type>(role_length + 1));
+                add_size(append_with_zero(role, static_cast_with_assert<string_size_type>(role_length)));
+                add_padding(true);
+                if (full_member) {
+                    add_item(full_member);
+                }
+            }
+
             /**
              * Add a member to the relation.
              *
@@ -39,13 +39,14 @@ DEALINGS IN THE SOFTWARE.
  * Include this file if you want to write all kinds of OSM files.
  *
  * @attention If you include this file, you'll need to link with
- *            `libprotobuf-lite`, `libosmpbf`, `ws2_32` (Windows only),
- *            `libz`, `libbz2`, and enable multithreading.
+ *            `ws2_32` (Windows only), `libz`, `libbz2`, and enable
+ *            multithreading.
  */
 
 #include <osmium/io/any_compression.hpp> // IWYU pragma: export
 
 #include <osmium/io/opl_output.hpp> // IWYU pragma: export
+#include <osmium/io/osmbuf_output.hpp> // IWYU pragma: export
 #include <osmium/io/pbf_output.hpp> // IWYU pragma: export
 #include <osmium/io/xml_output.hpp> // IWYU pragma: export
 
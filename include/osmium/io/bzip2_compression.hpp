@@ -42,11 +42,18 @@ DEALINGS IN THE SOFTWARE.
  * @attention If you include this file, you'll need to link with `libbz2`.
  */
 
+#include <algorithm>
 #include <cerrno>
 #include <cstddef>
 #include <cstdio>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <system_error>
+#include <utility>
 
 #include <bzlib.h>
 
@@ -56,6 +63,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/io/compression.hpp>
 #include <osmium/io/file_compression.hpp>
+#include <osmium/thread/pool.hpp>
 #include <osmium/util/cast.hpp>
 #include <osmium/util/compatibility.hpp>
 
@@ -95,6 +103,109 @@ namespace osmium {
                 throw osmium::bzip2_error(error, errnum);
             }
 
+            /**
+             * Find the start of a bzip2 stream in the data. A stream starts
+             * with the magic "BZh", the block size ('1' to '9'), and the
+             * magic number of the first block. This can also match by
+             * chance inside compressed data, so the result is only a
+             * candidate.
+             *
+             * @param data Data to search in.
+             * @param offset Offset in data where the search starts.
+             * @returns Offset of the stream start or std::string::npos if
+             *          none was found.
+             */
+            inline size_t bzip2_find_stream_start(const std::string& data, size_t offset) {
+                static const char block_magic[] = "\x31\x41\x59\x26\x53\x59";
+                constexpr const size_t magic_size = 10;
+
+                while (true) {
+                    const size_t pos = data.find("BZh", offset);
+                    if (pos == std::string::npos || pos + magic_size > data.size()) {
+                        return std::string::npos;
+                    }
+                    if (data[pos + 3] >= '1' && data[pos + 3] <= '9' && !std::memcmp(data.data() + pos + 4, block_magic, 6)) {
+                        return pos;
+                    }
+                    offset = pos + 1;
+                }
+            }
+
+            /**
+             * The result of uncompressing bzip2 streams.
+             */
+            struct bzip2_stream_result {
+
+                std::string data {};
+
+                /// Did the data end with the end of a stream?
+                bool complete = false;
+
+            }; // struct bzip2_stream_result
+
+            /**
+             * Uncompress one or more concatenated bzip2 streams. (There can
+             * be more than one, because bzip2_find_stream_start() doesn't
+             * find streams without any blocks.) If the input ends before the
+             * last stream does, the result is marked as not complete.
+             *
+             * @param input Compressed data starting with a bzip2 stream.
+             * @throws osmium::bzip2_error If the data is not valid.
+             */
+            inline bzip2_stream_result bzip2_uncompress_streams(const std::string& input) {
+                bzip2_stream_result result;
+
+                bz_stream bzstream;
+                std::memset(&bzstream, 0, sizeof(bzstream));
+
+                bzstream.next_in = const_cast<char*>(input.data());
+                bzstream.avail_in = osmium::static_cast_with_assert<unsigned int>(input.size());
+
+                // bzip2 usually compresses OSM data to less than a fifth
+                result.data.resize(std::max(input.size() * 5, size_t(1024)));
+                size_t written = 0;
+                bool in_stream = false;
+                while (true) {
+                    if (!in_stream) {
+                        const int error = ::BZ2_bzDecompressInit(&bzstream, 0, 0);
+                        if (error != BZ_OK) {
+                            throw osmium::bzip2_error("bzip2 error: decompression init failed", error);
+                        }
+                        in_stream = true;
+                    }
+                    if (written == result.data.size()) {
+                        result.data.resize(result.data.size() * 2);
+                    }
+                    bzstream.next_out = &result.data[written];
+                    bzstream.avail_out = osmium::static_cast_with_assert<unsigned int>(result.data.size() - written);
+                    const int error = ::BZ2_bzDecompress(&bzstream);
+                    written = result.data.size() - bzstream.avail_out;
+                    if (error == BZ_STREAM_END) {
+                        ::BZ2_bzDecompressEnd(&bzstream);
+                        in_stream = false;
+                        if (bzstream.avail_in == 0) {
+                            result.complete = true;
+                            break;
+                        }
+                        continue;
+                    }
+                    if (error != BZ_OK) {
+                        ::BZ2_bzDecompressEnd(&bzstream);
+                        throw osmium::bzip2_error("bzip2 error: decompress failed", error);
+                    }
+                    if (bzstream.avail_in == 0 && bzstream.avail_out > 0) {
+                        break;
+                    }
+                }
+
+                if (in_stream) {
+                    ::BZ2_bzDecompressEnd(&bzstream);
+                }
+
+                result.data.resize(written);
+                return result;
+            }
+
         } // namespace detail
 
         class Bzip2Compressor : public Compressor {
@@ -272,12 +383,267 @@ namespace osmium {
 
         }; // class Bzip2BufferDecompressor
 
+        /**
+         * Decompressor for bzip2 data that uncompresses several bzip2
+         * streams in parallel using the osmium::thread::Pool.
+         *
+         * Large bzip2 files such as the planet and history dumps consist
+         * of many concatenated bzip2 streams. This decompressor finds the
+         * stream boundaries in the compressed data, uncompresses the
+         * streams in the pool threads and returns the results in order.
+         *
+         * Files written by the bzip2 program only contain a single stream.
+         * If no second stream is found in the first max_stream_size bytes,
+         * the data is uncompressed in the calling thread instead, just
+         * like the Bzip2Decompressor does it.
+         */
+        class Bzip2ParallelDecompressor : public Decompressor {
+
+            struct stream_chunk {
+                std::shared_ptr<std::string> input;
+                std::future<detail::bzip2_stream_result> result;
+            }; // struct stream_chunk
+
+            int m_fd;
+            const char* m_buffer;
+            size_t m_buffer_size;
+
+            // compressed data read, but not yet handed out
+            std::string m_input;
+            size_t m_search_offset;
+            bool m_input_done;
+
+            bool m_started;
+            bool m_parallel;
+
+            // parallel mode
+            osmium::thread::Pool* m_pool;
+            std::deque<stream_chunk> m_chunks;
+            size_t m_max_chunks;
+
+            // serial mode
+            bz_stream m_bzstream;
+            bool m_in_stream;
+
+            /**
+             * Append the next block of compressed data to m_input.
+             *
+             * @returns false if there is no more data.
+             */
+            bool read_more() {
+                if (m_input_done) {
+                    return false;
+                }
+
+                if (m_fd < 0) {
+                    const size_t size = std::min(m_buffer_size, static_cast<size_t>(osmium::io::Decompressor::input_buffer_size));
+                    m_input.append(m_buffer, size);
+                    m_buffer += size;
+                    m_buffer_size -= size;
+                    m_input_done = (size == 0);
+                    return !m_input_done;
+                }
+
+                const size_t old_size = m_input.size();
+                m_input.resize(old_size + osmium::io::Decompressor::input_buffer_size);
+                auto nread = ::read(m_fd, &m_input[old_size], osmium::io::Decompressor::input_buffer_size);
+                if (nread < 0) {
+                    m_input.resize(old_size);
+                    throw std::system_error(errno, std::system_category(), "Read failed");
+                }
+                m_input.resize(old_size + static_cast<size_t>(nread));
+                m_input_done = (nread == 0);
+                return !m_input_done;
+            }
+
+            /**
+             * Decide whether the data can be uncompressed in parallel by
+             * looking for the start of a second stream.
+             */
+            void start() {
+                m_started = true;
+                if (!m_pool) {
+                    m_pool = &osmium::thread::Pool::instance();
+                }
+                m_max_chunks = 2 * static_cast<size_t>(m_pool->num_threads());
+                while (m_input.size() < max_stream_size && read_more()) {
+                }
+                m_parallel = m_input_done || detail::bzip2_find_stream_start(m_input, 1) != std::string::npos;
+                if (!m_parallel) {
+                    m_bzstream.next_in = const_cast<char*>(m_input.data());
+                    m_bzstream.avail_in = osmium::static_cast_with_assert<unsigned int>(m_input.size());
+                }
+            }
+
+            /**
+             * Cut the next stream from the input and hand it to the pool
+             * for uncompressing.
+             *
+             * @returns false if there is no more input.
+             */
+            bool submit_next_stream() {
+                std::shared_ptr<std::string> input;
+                while (!input) {
+                    const size_t pos = detail::bzip2_find_stream_start(m_input, m_search_offset);
+                    if (pos != std::string::npos) {
+                        input = std::make_shared<std::string>(m_input, 0, pos);
+                        m_input.erase(0, pos);
+                        m_search_offset = 1;
+                    } else {
+                        // the magic could be cut off at the end of the data
+                        m_search_offset = std::max(m_input.size(), size_t(10)) - 9;
+                        if (!read_more()) {
+                            if (m_input.empty()) {
+                                return false;
+                            }
+                            input = std::make_shared<std::string>(std::move(m_input));
+                            m_input.clear();
+                        }
+                    }
+                }
+
+                m_chunks.push_back(stream_chunk{input, m_pool->submit([input]() {
+                    return detail::bzip2_uncompress_streams(*input);
+                })});
+
+                return true;
+            }
+
+            std::string read_parallel() {
+                while (m_chunks.size() < m_max_chunks && submit_next_stream()) {
+                }
+
+                while (!m_chunks.empty()) {
+                    stream_chunk chunk = std::move(m_chunks.front());
+                    m_chunks.pop_front();
+                    detail::bzip2_stream_result result = chunk.result.get();
+
+                    // If the stream didn't end where the next one was
+                    // supposed to start, the data at that place only looked
+                    // like the start of a stream by chance. Join the chunks
+                    // and try again.
+                    while (!result.complete) {
+                        if (m_chunks.empty() && !submit_next_stream()) {
+                            throw osmium::bzip2_error("bzip2 error: unexpected end of data", BZ_UNEXPECTED_EOF);
+                        }
+                        stream_chunk next = std::move(m_chunks.front());
+                        m_chunks.pop_front();
+                        chunk.input->append(*next.input);
+                        result = detail::bzip2_uncompress_streams(*chunk.input);
+                    }
+
+                    submit_next_stream();
+
+                    if (!result.data.empty()) {
+                        return std::move(result.data);
+                    }
+                }
+
+                return std::string();
+            }
+
+            std::string read_serial() {
+                std::string output(osmium::io::Decompressor::input_buffer_size, '\0');
+                m_bzstream.next_out = const_cast<char*>(output.data());
+                m_bzstream.avail_out = osmium::io::Decompressor::input_buffer_size;
+
+                while (m_bzstream.avail_out > 0) {
+                    if (m_bzstream.avail_in == 0) {
+                        m_input.clear();
+                        if (!read_more()) {
+                            if (m_in_stream) {
+                                throw osmium::bzip2_error("bzip2 error: unexpected end of data", BZ_UNEXPECTED_EOF);
+                            }
+                            break;
+                        }
+                        m_bzstream.next_in = const_cast<char*>(m_input.data());
+                        m_bzstream.avail_in = osmium::static_cast_with_assert<unsigned int>(m_input.size());
+                    }
+                    if (!m_in_stream) {
+                        const int error = ::BZ2_bzDecompressInit(&m_bzstream, 0, 0);
+                        if (error != BZ_OK) {
+                            throw osmium::bzip2_error("bzip2 error: decompression init failed", error);
+                        }
+                        m_in_stream = true;
+                    }
+                    const int error = ::BZ2_bzDecompress(&m_bzstream);
+                    if (error == BZ_STREAM_END) {
+                        ::BZ2_bzDecompressEnd(&m_bzstream);
+                        m_in_stream = false;
+                    } else if (error != BZ_OK) {
+                        throw osmium::bzip2_error("bzip2 error: decompress failed", error);
+                    }
+                }
+
+                output.resize(osmium::io::Decompressor::input_buffer_size - m_bzstream.avail_out);
+                return output;
+            }
+
+        public:
+
+            /**
+             * If no new stream starts in this many bytes, the data is not
+             * uncompressed in parallel.
+             */
+            static constexpr size_t max_stream_size = 16 * 1024 * 1024;
+
+            explicit Bzip2ParallelDecompressor(int fd) :
+                Decompressor(),
+                m_fd(fd),
+                m_buffer(nullptr),
+                m_buffer_size(0),
+                m_input(),
+                m_search_offset(1),
+                m_input_done(false),
+                m_started(false),
+                m_parallel(false),
+                m_pool(nullptr),
+                m_chunks(),
+                m_max_chunks(0),
+                m_bzstream(),
+                m_in_stream(false) {
+            }
+
+            Bzip2ParallelDecompressor(const char* buffer, size_t size) :
+                Bzip2ParallelDecompressor(-1) {
+                m_buffer = buffer;
+                m_buffer_size = size;
+            }
+
+            ~Bzip2ParallelDecompressor() override final {
+                close();
+            }
+
+            std::string read() override final {
+                if (!m_started) {
+                    start();
+                }
+                return m_parallel ? read_parallel() : read_serial();
+            }
+
+            void set_pool(osmium::thread::Pool& pool) override final {
+                m_pool = &pool;
+            }
+
+            void close() override final {
+                if (m_in_stream) {
+                    ::BZ2_bzDecompressEnd(&m_bzstream);
+                    m_in_stream = false;
+                }
+                if (m_fd >= 0) {
+                    ::close(m_fd);
+                    m_fd = -1;
+                }
+            }
+
+        }; // class Bzip2ParallelDecompressor
+
         namespace {
 
             const bool registered_bzip2_compression = osmium::io::CompressionFactory::instance().register_compression(osmium::io::file_compression::bzip2,
                 [](int fd) { return new osmium::io::Bzip2Compressor(fd); },
-                [](int fd) { return new osmium::io::Bzip2Decompressor(fd); },
-                [](const char* buffer, size_t size) { return new osmium::io::Bzip2BufferDecompressor(buffer, size); }
+                [](int fd) { return new osmium::io::Bzip2ParallelDecompressor(fd); },
+                [](const char* buffer, size_t size) { return new osmium::io::Bzip2ParallelDecompressor(buffer, size); }
             );
 
         } // anonymous namespace
@@ -54,6 +54,10 @@ DEALINGS IN THE SOFTWARE.
 
 namespace osmium {
 
+    namespace thread {
+        class Pool;
+    }
+
     namespace io {
 
         class Compressor {
@@ -93,6 +97,13 @@ namespace osmium {
             virtual void close() {
             }
 
+            /**
+             * Set the thread pool used by decompressors working in
+             * parallel. Must be called before the first read().
+             */
+            virtual void set_pool(osmium::thread::Pool&) {
+            }
+
         }; // class Decompressor
 
         /**
@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <cstddef>
 #include <functional>
 #include <map>
 #include <memory>
@@ -44,18 +45,114 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/memory/buffer_pool.hpp>
+#include <osmium/osm/box.hpp>
 #include <osmium/osm/entity_bits.hpp>
+#include <osmium/thread/byte_budget.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/spsc_queue.hpp>
 
 namespace osmium {
 
-    namespace thread {
-        template <typename T> class Queue;
-    } // namespace thread
-
     namespace io {
 
+        /**
+         * Reader option: Should metadata of OSM objects (version, timestamp,
+         * changeset, uid, and user name) be read? If this is set to no,
+         * all objects will have empty metadata and an empty user name,
+         * which makes parsing faster.
+         */
+        enum class read_meta {
+            no  = 0,
+            yes = 1
+        }; // enum class read_meta
+
+        /**
+         * Reader option: Should buffers keep the raw data they were decoded
+         * from? Currently only the PBF input format supports this. Every
+         * buffer then carries the original (compressed) blob it was decoded
+         * from and the PBF output format writes that blob out unchanged if
+         * the Writer was created with osmium::io::copy_raw_data::yes and
+         * nothing was added to or removed from the buffer. This makes copying, concatenating,
+         * or splitting PBF files much faster, but the raw data is kept in
+         * memory as long as the buffer exists.
+         *
+         * The raw data is only kept if the buffers contain everything that
+         * is in the blobs, ie if all entity types are read with metadata
+         * and no bounding box is set.
+         */
+        enum class keep_raw_data {
+            no  = 0,
+            yes = 1
+        }; // enum class keep_raw_data
+
         namespace detail {
 
+            /**
+             * Queue for the raw (uncompressed) input data between the
+             * ReadThread and the input format. There is always exactly one
+             * thread on each side.
+             */
+            typedef osmium::thread::SPSCQueue<std::string> input_queue_type;
+
+            /**
+             * Options set on the Reader that are handed down to the input
+             * format and its parsers.
+             */
+            struct reader_options {
+
+                /// Which OSM entities should be read?
+                osmium::osm_entity_bits::type read_which_entities = osmium::osm_entity_bits::all;
+
+                /**
+                 * Only nodes with a location inside this box are read. If
+                 * the box is not defined (the default), all nodes are read.
+                 */
+                osmium::Box bbox {};
+
+                /// Should metadata of OSM objects be read?
+                osmium::io::read_meta read_metadata = osmium::io::read_meta::yes;
+
+                /// Should buffers keep the raw data they were decoded from?
+                osmium::io::keep_raw_data keep_raw = osmium::io::keep_raw_data::no;
+
+                /**
+                 * Maximum number of bytes of raw and decoded data in flight
+                 * between the threads of the Reader. A quarter of this is
+                 * used for raw input data, the rest for decoded data. 0
+                 * means unlimited.
+                 */
+                size_t memory_budget = 0;
+
+                /// Thread pool for the parsers, nullptr means the default pool.
+                osmium::thread::Pool* pool = nullptr;
+
+                osmium::thread::Pool& thread_pool() const {
+                    return pool ? *pool : osmium::thread::Pool::instance();
+                }
+
+                /**
+                 * Are the buffers supposed to keep their raw data and does
+                 * the data in them match the raw data exactly, ie nothing
+                 * was filtered out while decoding it?
+                 */
+                bool keeps_raw_data() const noexcept {
+                    return keep_raw == osmium::io::keep_raw_data::yes &&
+                           (read_which_entities & osmium::osm_entity_bits::nwr) == osmium::osm_entity_bits::nwr &&
+                           !bbox &&
+                           read_metadata == osmium::io::read_meta::yes;
+                }
+
+                size_t raw_data_budget() const noexcept {
+                    return memory_budget / 4;
+                }
+
+                size_t decoded_data_budget() const noexcept {
+                    return memory_budget - raw_data_budget();
+                }
+
+            }; // struct reader_options
+
             /**
              * Virtual base class for all classes reading OSM files in different
              * formats.
@@ -68,12 +165,26 @@ namespace osmium {
             protected:
 
                 osmium::io::File m_file;
-                osmium::osm_entity_bits::type m_read_which_entities;
+                osmium::io::detail::reader_options m_options;
                 osmium::io::Header m_header;
 
-                explicit InputFormat(const osmium::io::File& file, osmium::osm_entity_bits::type read_which_entities) :
+                /// Budget for decoded data not yet returned from read().
+                osmium::thread::ByteBudget m_budget;
+
+                /**
+                 * Buffers given back by the user through recycle(). The
+                 * parsers take their buffers from here. This is a shared_ptr
+                 * because parser threads might still use it after this
+                 * object is gone.
+                 */
+                std::shared_ptr<osmium::memory::BufferPool> m_buffer_pool;
+
+                explicit InputFormat(const osmium::io::File& file, const osmium::io::detail::reader_options& options) :
                     m_file(file),
-                    m_read_which_entities(read_which_entities) {
+                    m_options(options),
+                    m_header(),
+                    m_budget(options.decoded_data_budget()),
+                    m_buffer_pool(std::make_shared<osmium::memory::BufferPool>()) {
                     m_header.set_has_multiple_object_versions(m_file.has_multiple_object_versions());
                 }
 
@@ -97,6 +208,18 @@ namespace osmium {
                     return m_header;
                 }
 
+                osmium::thread::budget_stats budget_stats() const {
+                    return m_budget.stats();
+                }
+
+                /**
+                 * Give a buffer returned from read() back so that its memory
+                 * can be reused.
+                 */
+                void recycle(osmium::memory::Buffer&& buffer) {
+                    m_buffer_pool->return_buffer(std::move(buffer));
+                }
+
             }; // class InputFormat
 
             /**
@@ -110,16 +233,21 @@ namespace osmium {
 
             public:
 
-                typedef std::function<osmium::io::detail::InputFormat*(const osmium::io::File&, osmium::osm_entity_bits::type read_which_entities, osmium::thread::Queue<std::string>&)> create_input_type;
+                typedef std::function<osmium::io::detail::InputFormat*(const osmium::io::File&, const osmium::io::detail::reader_options& options, osmium::io::detail::input_queue_type&)> create_input_type;
+
+                typedef std::function<osmium::io::detail::InputFormat*(const osmium::io::File&, const osmium::io::detail::reader_options& options, const char* data, size_t size)> create_memory_input_type;
 
             private:
 
                 typedef std::map<osmium::io::file_format, create_input_type> map_type;
+                typedef std::map<osmium::io::file_format, create_memory_input_type> memory_map_type;
 
                 map_type m_callbacks;
+                memory_map_type m_memory_callbacks;
 
                 InputFormatFactory() :
-                    m_callbacks() {
+                    m_callbacks(),
+                    m_memory_callbacks() {
                 }
 
             public:
@@ -136,12 +264,44 @@ namespace osmium {
                     return true;
                 }
 
-                std::unique_ptr<osmium::io::detail::InputFormat> create_input(const osmium::io::File& file, osmium::osm_entity_bits::type read_which_entities, osmium::thread::Queue<std::string>& input_queue) {
+                /**
+                 * Register a function creating an input format that parses
+                 * directly from a block of memory containing the complete
+                 * (uncompressed) file. This is optional, formats registered
+                 * this way also need to be registered with
+                 * register_input_format().
+                 */
+                bool register_memory_input_format(osmium::io::file_format format, create_memory_input_type create_function) {
+                    if (! m_memory_callbacks.insert(memory_map_type::value_type(format, create_function)).second) {
+                        return false;
+                    }
+                    return true;
+                }
+
+                /**
+                 * Can the given format be read directly from memory?
+                 */
+                bool supports_memory_input(osmium::io::file_format format) const {
+                    return m_memory_callbacks.count(format) > 0;
+                }
+
+                std::unique_ptr<osmium::io::detail::InputFormat> create_input(const osmium::io::File& file, const osmium::io::detail::reader_options& options, const char* data, size_t size) {
+                    file.check();
+
+                    auto it = m_memory_callbacks.find(file.format());
+                    if (it != m_memory_callbacks.end()) {
+                        return std::unique_ptr<osmium::io::detail::InputFormat>((it->second)(file, options, data, size));
+                    }
+
+                    throw std::runtime_error(std::string("Reading input format '") + as_string(file.format()) + "' from memory not supported.");
+                }
+
+                std::unique_ptr<osmium::io::detail::InputFormat> create_input(const osmium::io::File& file, const osmium::io::detail::reader_options& options, osmium::io::detail::input_queue_type& input_queue) {
                     file.check();
 
                     auto it = m_callbacks.find(file.format());
                     if (it != m_callbacks.end()) {
-                        return std::unique_ptr<osmium::io::detail::InputFormat>((it->second)(file, read_which_entities, input_queue));
+                        return std::unique_ptr<osmium::io::detail::InputFormat>((it->second)(file, options, input_queue));
                     }
 
                     throw std::runtime_error(std::string("Support for input format '") + as_string(file.format()) + "' not compiled into this binary.");
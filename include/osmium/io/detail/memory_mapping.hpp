@@ -0,0 +1,223 @@
+#ifndef OSMIUM_IO_DETAIL_MEMORY_MAPPING_HPP
+#define OSMIUM_IO_DETAIL_MEMORY_MAPPING_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifndef _WIN32
+# include <sys/mman.h>
+#else
+# include <mmap_for_windows.hpp>
+#endif
+
+#ifndef _MSC_VER
+# include <unistd.h>
+#else
+# include <io.h>
+#endif
+
+#include <osmium/io/detail/read_write.hpp>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * A private memory mapping of a complete file. The Reader
+             * uses this to hand the contents of uncompressed local files
+             * directly to input formats that can parse from memory instead
+             * of copying everything through the input queue.
+             *
+             * The memory is read-only unless a writable (copy-on-write)
+             * mapping is asked for. Input formats that hand out buffers
+             * pointing into the memory need that. Because the mapping is
+             * private changes are never written back to the file.
+             *
+             * Objects of this class can be moved, but not copied. The
+             * mapping is removed when the object is destructed.
+             */
+            class MemoryMapping {
+
+                size_t m_size;
+                char* m_data;
+
+                void unmap() noexcept {
+                    if (m_data) {
+                        ::munmap(m_data, m_size);
+                        m_data = nullptr;
+                        m_size = 0;
+                    }
+                }
+
+            public:
+
+                /**
+                 * Create an empty (invalid) mapping.
+                 */
+                MemoryMapping() noexcept :
+                    m_size(0),
+                    m_data(nullptr) {
+                }
+
+                /**
+                 * Map the first size bytes of the file with the given file
+                 * descriptor into memory. The file descriptor can be closed
+                 * after the mapping was created.
+                 *
+                 * @param fd File descriptor of the file to be mapped.
+                 * @param size Number of bytes to map. Must not be 0.
+                 * @param writable Map the memory writable (copy-on-write).
+                 *                 Not supported on Windows.
+                 * @throws std::system_error If mmap(2) failed.
+                 */
+                MemoryMapping(int fd, size_t size, bool writable = false) :
+                    m_size(size),
+                    m_data(nullptr) {
+                    void* addr = ::mmap(nullptr, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_PRIVATE, fd, 0);
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+                    if (addr == MAP_FAILED) {
+                        throw std::system_error(errno, std::system_category(), "mmap failed");
+                    }
+#pragma GCC diagnostic pop
+                    m_data = static_cast<char*>(addr);
+                }
+
+                MemoryMapping(const MemoryMapping&) = delete;
+                MemoryMapping& operator=(const MemoryMapping&) = delete;
+
+                MemoryMapping(MemoryMapping&& other) noexcept :
+                    m_size(other.m_size),
+                    m_data(other.m_data) {
+                    other.m_size = 0;
+                    other.m_data = nullptr;
+                }
+
+                MemoryMapping& operator=(MemoryMapping&& other) noexcept {
+                    unmap();
+                    std::swap(m_size, other.m_size);
+                    std::swap(m_data, other.m_data);
+                    return *this;
+                }
+
+                ~MemoryMapping() {
+                    unmap();
+                }
+
+                /**
+                 * Pointer to the beginning of the mapped data or nullptr
+                 * if nothing is mapped.
+                 */
+                const char* data() const noexcept {
+                    return m_data;
+                }
+
+                /**
+                 * Number of bytes mapped.
+                 */
+                size_t size() const noexcept {
+                    return m_size;
+                }
+
+                /**
+                 * In a bool context a mapping is true if there is some
+                 * memory mapped.
+                 */
+                explicit operator bool() const noexcept {
+                    return m_data != nullptr;
+                }
+
+            }; // class MemoryMapping
+
+            /**
+             * Map the named file into memory if it is a non-empty regular
+             * file. For everything else (stdin, pipes, devices, empty files)
+             * an invalid mapping is returned and the caller has to fall back
+             * to reading through a file descriptor.
+             *
+             * Writable mappings are not available on Windows, because
+             * the mmap emulation there can't do private writable mappings
+             * of read-only files. An invalid mapping is returned instead.
+             *
+             * @param filename Name of the file.
+             * @param writable Map the file writable (copy-on-write).
+             * @returns Mapping of the whole file or invalid mapping.
+             * @throws std::system_error If the file can not be opened or mapped.
+             */
+            inline MemoryMapping map_regular_file(const std::string& filename, bool writable = false) {
+                if (filename.empty()) {
+                    return MemoryMapping();
+                }
+
+#ifdef _WIN32
+                if (writable) {
+                    return MemoryMapping();
+                }
+#endif
+
+                // Check the file type before opening it, opening a named
+                // pipe here would disturb the fallback path.
+                struct stat s;
+                if (::stat(filename.c_str(), &s) < 0 || !S_ISREG(s.st_mode) || s.st_size <= 0) {
+                    return MemoryMapping();
+                }
+
+                const int fd = osmium::io::detail::open_for_reading(filename);
+
+                try {
+                    MemoryMapping mapping(fd, static_cast<size_t>(s.st_size), writable);
+                    ::close(fd);
+                    return mapping;
+                } catch (...) {
+                    ::close(fd);
+                    throw;
+                }
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_MEMORY_MAPPING_HPP
@@ -0,0 +1,843 @@
+#ifndef OSMIUM_IO_DETAIL_OPL_INPUT_FORMAT_HPP
+#define OSMIUM_IO_DETAIL_OPL_INPUT_FORMAT_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <boost/version.hpp>
+
+#ifdef __clang__
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wmissing-noreturn"
+# pragma clang diagnostic ignored "-Wsign-conversion"
+#endif
+
+#if BOOST_VERSION >= 104800
+# include <boost/regex/pending/unicode_iterator.hpp>
+#else
+# include <boost_unicode_iterator.hpp>
+#endif
+
+#ifdef __clang__
+# pragma clang diagnostic pop
+#endif
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/io/detail/input_format.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/file_format.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/buffer_pool.hpp>
+#include <osmium/osm.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/timestamp.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/thread/byte_budget.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/queue.hpp>
+#include <osmium/thread/util.hpp>
+
+namespace osmium {
+
+    /**
+     * Exception thrown when there was a problem with parsing the OPL format
+     * of a file.
+     */
+    struct opl_error : public io_error {
+
+        /// Offset of the start of the line with the error in the file.
+        uint64_t offset;
+
+        opl_error(const std::string& what, uint64_t line_offset) :
+            io_error(std::string("OPL error in line starting at byte ") + std::to_string(line_offset) + ": " + what),
+            offset(line_offset) {
+        }
+
+    }; // struct opl_error
+
+    namespace io {
+
+        class File;
+
+        namespace detail {
+
+            /**
+             * Parses a chunk of OPL data containing complete lines into a
+             * buffer. This is run in the thread pool.
+             *
+             * The data is either stored in the parser or it points into
+             * the input memory.
+             */
+            class OPLParser {
+
+                struct field {
+                    const char* begin = nullptr;
+                    const char* end = nullptr;
+
+                    explicit operator bool() const noexcept {
+                        return begin != nullptr;
+                    }
+
+                    bool empty() const noexcept {
+                        return begin == end;
+                    }
+                }; // struct field
+
+                /// The fields of one line, indexed by their key characters.
+                struct line_fields {
+                    field version;     // v
+                    field visible;     // d
+                    field changeset;   // c
+                    field timestamp;   // t
+                    field uid;         // i
+                    field user;        // u
+                    field tags;        // T
+                    field x;           // x
+                    field y;           // y
+                    field nodes;       // N
+                    field members;     // M
+                    field num_changes; // k
+                    field created_at;  // s
+                    field closed_at;   // e
+                    field max_x;       // X
+                    field max_y;       // Y
+                }; // struct line_fields
+
+                static constexpr size_t initial_buffer_size = 2 * 1024 * 1024;
+
+                std::string m_input;
+                const char* m_data;
+                size_t m_size;
+                uint64_t m_offset;
+                osmium::io::detail::reader_options m_options;
+                std::shared_ptr<osmium::memory::BufferPool> m_buffer_pool;
+                osmium::thread::ByteBudget* m_budget;
+                size_t m_acquired;
+
+                // offset of the line currently parsed in the file
+                uint64_t m_line_offset;
+
+                // space for decoding strings
+                std::string m_key;
+                std::string m_value;
+
+                [[noreturn]] void error(const std::string& message) const {
+                    throw osmium::opl_error(message, m_line_offset);
+                }
+
+                int64_t parse_integer(const char* begin, const char* end, const char* what) const {
+                    const char* str = begin;
+                    bool negative = false;
+                    if (str != end && *str == '-') {
+                        negative = true;
+                        ++str;
+                    }
+                    if (str == end || end - str > 18) {
+                        error(std::string("invalid ") + what);
+                    }
+                    int64_t result = 0;
+                    for (; str != end; ++str) {
+                        if (*str < '0' || *str > '9') {
+                            error(std::string("invalid ") + what);
+                        }
+                        result = result * 10 + (*str - '0');
+                    }
+                    return negative ? -result : result;
+                }
+
+                int64_t parse_integer(const field& f, const char* what) const {
+                    return parse_integer(f.begin, f.end, what);
+                }
+
+                osmium::Timestamp parse_timestamp(const field& f) const {
+                    if (f.empty()) {
+                        return osmium::Timestamp();
+                    }
+                    time_t timestamp;
+                    if (!osmium::detail::parse_iso_timestamp(f.begin, static_cast<size_t>(f.end - f.begin), timestamp)) {
+                        error("invalid timestamp");
+                    }
+                    return osmium::Timestamp(timestamp);
+                }
+
+                osmium::Location parse_location(const field& x, const field& y) const {
+                    osmium::Location location;
+                    int32_t value;
+                    if (x && !x.empty()) {
+                        if (!osmium::detail::string_to_location_coordinate(x.begin, x.end, value)) {
+                            error("invalid coordinate");
+                        }
+                        location.set_x(value);
+                    }
+                    if (y && !y.empty()) {
+                        if (!osmium::detail::string_to_location_coordinate(y.begin, y.end, value)) {
+                            error("invalid coordinate");
+                        }
+                        location.set_y(value);
+                    }
+                    return location;
+                }
+
+                /**
+                 * Decode a string with %-escaped characters.
+                 *
+                 * @returns Pointer to the decoded string, either pointing
+                 *          into the input data or into the scratch string.
+                 */
+                const char* decode_string(const char* begin, const char* end, std::string& scratch, size_t& length) const {
+                    const char* percent = static_cast<const char*>(std::memchr(begin, '%', static_cast<size_t>(end - begin)));
+                    if (!percent) {
+                        length = static_cast<size_t>(end - begin);
+                        return begin;
+                    }
+
+                    scratch.assign(begin, percent);
+                    boost::utf8_output_iterator<std::back_insert_iterator<std::string>> oit(std::back_inserter(scratch));
+                    while (percent != end) {
+                        if (*percent != '%') {
+                            scratch += *percent++;
+                            continue;
+                        }
+                        const char* hex_end = static_cast<const char*>(std::memchr(percent + 1, '%', static_cast<size_t>(end - percent - 1)));
+                        if (!hex_end || hex_end == percent + 1 || hex_end - percent > 7) {
+                            error("invalid escape sequence");
+                        }
+                        uint32_t c = 0;
+                        for (const char* h = percent + 1; h != hex_end; ++h) {
+                            if (*h >= '0' && *h <= '9') {
+                                c = c * 16 + static_cast<uint32_t>(*h - '0');
+                            } else if (*h >= 'a' && *h <= 'f') {
+                                c = c * 16 + static_cast<uint32_t>(*h - 'a' + 10);
+                            } else if (*h >= 'A' && *h <= 'F') {
+                                c = c * 16 + static_cast<uint32_t>(*h - 'A' + 10);
+                            } else {
+                                error("invalid escape sequence");
+                            }
+                        }
+                        if (c > 0x10ffff) {
+                            error("invalid escape sequence");
+                        }
+                        *oit = c;
+                        percent = hex_end + 1;
+                    }
+
+                    length = scratch.size();
+                    return scratch.data();
+                }
+
+                static const char* find(const char* begin, const char* end, char c) noexcept {
+                    const char* pos = static_cast<const char*>(std::memchr(begin, c, static_cast<size_t>(end - begin)));
+                    return pos ? pos : end;
+                }
+
+                void parse_tags(const field& f, osmium::builder::Builder* parent, osmium::memory::Buffer& buffer) {
+                    if (!f || f.empty()) {
+                        return;
+                    }
+                    osmium::builder::TagListBuilder builder(buffer, parent);
+                    const char* pos = f.begin;
+                    while (pos != f.end) {
+                        const char* tag_end = find(pos, f.end, ',');
+                        const char* equal = find(pos, tag_end, '=');
+                        if (equal == tag_end) {
+                            error("tag without '='");
+                        }
+                        size_t key_length;
+                        size_t value_length;
+                        const char* key = decode_string(pos, equal, m_key, key_length);
+                        const char* value = decode_string(equal + 1, tag_end, m_value, value_length);
+                        builder.add_tag(key, key_length, value, value_length);
+                        pos = tag_end == f.end ? tag_end : tag_end + 1;
+                    }
+                }
+
+                void parse_nodes(const field& f, osmium::builder::WayBuilder* parent, osmium::memory::Buffer& buffer) {
+                    if (!f || f.empty()) {
+                        return;
+                    }
+                    osmium::builder::WayNodeListBuilder builder(buffer, parent);
+                    const char* pos = f.begin;
+                    while (pos != f.end) {
+                        const char* ref_end = find(pos, f.end, ',');
+                        if (*pos != 'n') {
+                            error("invalid node reference");
+                        }
+                        builder.add_node_ref(parse_integer(pos + 1, ref_end, "node reference"));
+                        pos = ref_end == f.end ? ref_end : ref_end + 1;
+                    }
+                }
+
+                void parse_members(const field& f, osmium::builder::RelationBuilder* parent, osmium::memory::Buffer& buffer) {
+                    if (!f || f.empty()) {
+                        return;
+                    }
+                    osmium::builder::RelationMemberListBuilder builder(buffer, parent);
+                    const char* pos = f.begin;
+                    while (pos != f.end) {
+                        const char* member_end = find(pos, f.end, ',');
+                        const char* at = find(pos, member_end, '@');
+                        const osmium::item_type type = osmium::char_to_item_type(*pos);
+                        if (at == member_end || (type != osmium::item_type::node && type != osmium::item_type::way && type != osmium::item_type::relation)) {
+                            error("invalid relation member");
+                        }
+                        const osmium::object_id_type ref = parse_integer(pos + 1, at, "member reference");
+                        size_t role_length;
+                        const char* role = decode_string(at + 1, member_end, m_value, role_length);
+                        builder.add_member(type, ref, role, role_length);
+                        pos = member_end == f.end ? member_end : member_end + 1;
+                    }
+                }
+
+                template <class TBuilder>
+                void init_object(TBuilder& builder, osmium::object_id_type id, const line_fields& fields) {
+                    osmium::OSMObject& object = builder.object();
+                    object.set_id(id);
+
+                    if (fields.visible) {
+                        if (fields.visible.end - fields.visible.begin != 1 || (*fields.visible.begin != 'V' && *fields.visible.begin != 'D')) {
+                            error("invalid visible flag");
+                        }
+                        object.set_visible(*fields.visible.begin == 'V');
+                    }
+
+                    if (m_options.read_metadata == osmium::io::read_meta::no) {
+                        builder.set_user("", 0);
+                        return;
+                    }
+
+                    if (fields.version) {
+                        object.set_version(static_cast<osmium::object_version_type>(parse_integer(fields.version, "version")));
+                    }
+                    if (fields.changeset) {
+                        object.set_changeset(static_cast<osmium::changeset_id_type>(parse_integer(fields.changeset, "changeset")));
+                    }
+                    if (fields.timestamp) {
+                        object.set_timestamp(parse_timestamp(fields.timestamp));
+                    }
+                    if (fields.uid) {
+                        object.set_uid_from_signed(static_cast<osmium::signed_user_id_type>(parse_integer(fields.uid, "uid")));
+                    }
+
+                    size_t length = 0;
+                    const char* user = fields.user ? decode_string(fields.user.begin, fields.user.end, m_value, length) : "";
+                    builder.set_user(user, length);
+                }
+
+                void parse_changeset(osmium::object_id_type id, const line_fields& fields, osmium::memory::Buffer& buffer) {
+                    osmium::builder::ChangesetBuilder builder(buffer);
+                    osmium::Changeset& changeset = builder.object();
+                    changeset.set_id(static_cast<osmium::changeset_id_type>(id));
+                    if (fields.num_changes) {
+                        changeset.set_num_changes(static_cast<osmium::num_changes_type>(parse_integer(fields.num_changes, "number of changes")));
+                    }
+                    if (fields.created_at) {
+                        changeset.set_created_at(parse_timestamp(fields.created_at));
+                    }
+                    if (fields.closed_at) {
+                        changeset.set_closed_at(parse_timestamp(fields.closed_at));
+                    }
+                    if (fields.uid) {
+                        changeset.set_uid_from_signed(static_cast<osmium::signed_user_id_type>(parse_integer(fields.uid, "uid")));
+                    }
+                    changeset.bounds().extend(parse_location(fields.x, fields.y));
+                    changeset.bounds().extend(parse_location(fields.max_x, fields.max_y));
+
+                    size_t length = 0;
+                    const char* user = fields.user ? decode_string(fields.user.begin, fields.user.end, m_value, length) : "";
+                    builder.set_user(user, length);
+
+                    parse_tags(fields.tags, &builder, buffer);
+                }
+
+                void parse_line(const char* begin, const char* end, osmium::memory::Buffer& buffer) {
+                    if (begin != end && end[-1] == '\r') {
+                        --end;
+                    }
+                    if (begin == end || *begin == '#') {
+                        return;
+                    }
+
+                    osmium::item_type type;
+                    switch (*begin) {
+                        case 'n':
+                            type = osmium::item_type::node;
+                            break;
+                        case 'w':
+                            type = osmium::item_type::way;
+                            break;
+                        case 'r':
+                            type = osmium::item_type::relation;
+                            break;
+                        case 'c':
+                            type = osmium::item_type::changeset;
+                            break;
+                        default:
+                            error("unknown object type");
+                    }
+
+                    if (!(m_options.read_which_entities & osmium::osm_entity_bits::from_item_type(type))) {
+                        return;
+                    }
+
+                    const char* pos = find(begin, end, ' ');
+                    const osmium::object_id_type id = parse_integer(begin + 1, pos, "id");
+
+                    line_fields fields;
+                    while (pos != end) {
+                        if (*pos == ' ') {
+                            ++pos;
+                            continue;
+                        }
+                        const char* field_end = find(pos, end, ' ');
+                        field* f = nullptr;
+                        switch (*pos) {
+                            case 'v': f = &fields.version; break;
+                            case 'd': f = &fields.visible; break;
+                            case 'c': f = &fields.changeset; break;
+                            case 't': f = &fields.timestamp; break;
+                            case 'i': f = &fields.uid; break;
+                            case 'u': f = &fields.user; break;
+                            case 'T': f = &fields.tags; break;
+                            case 'x': f = &fields.x; break;
+                            case 'y': f = &fields.y; break;
+                            case 'N': f = &fields.nodes; break;
+                            case 'M': f = &fields.members; break;
+                            case 'k': f = &fields.num_changes; break;
+                            case 's': f = &fields.created_at; break;
+                            case 'e': f = &fields.closed_at; break;
+                            case 'X': f = &fields.max_x; break;
+                            case 'Y': f = &fields.max_y; break;
+                            default:
+                                error(std::string("unknown field '") + *pos + "'");
+                        }
+                        f->begin = pos + 1;
+                        f->end = field_end;
+                        pos = field_end;
+                    }
+
+                    switch (type) {
+                        case osmium::item_type::node: {
+                                const osmium::Location location = parse_location(fields.x, fields.y);
+                                if (m_options.bbox && (!location || !m_options.bbox.contains(location))) {
+                                    return;
+                                }
+                                osmium::builder::NodeBuilder builder(buffer);
+                                init_object(builder, id, fields);
+                                builder.object().set_location(location);
+                                parse_tags(fields.tags, &builder, buffer);
+                            }
+                            break;
+                        case osmium::item_type::way: {
+                                osmium::builder::WayBuilder builder(buffer);
+                                init_object(builder, id, fields);
+                                parse_tags(fields.tags, &builder, buffer);
+                                parse_nodes(fields.nodes, &builder, buffer);
+                            }
+                            break;
+                        case osmium::item_type::relation: {
+                                osmium::builder::RelationBuilder builder(buffer);
+                                init_object(builder, id, fields);
+                                parse_tags(fields.tags, &builder, buffer);
+                                parse_members(fields.members, &builder, buffer);
+                            }
+                            break;
+                        default:
+                            parse_changeset(id, fields, buffer);
+                            break;
+                    }
+                    buffer.commit();
+                }
+
+            public:
+
+                /**
+                 * Create parser for data stored in a string.
+                 *
+                 * @param data Complete lines of OPL data.
+                 * @param offset Offset of the data in the file.
+                 * @param options Options from the Reader.
+                 */
+                OPLParser(std::string&& data, uint64_t offset, const osmium::io::detail::reader_options& options) :
+                    m_input(std::move(data)),
+                    m_data(nullptr),
+                    m_size(m_input.size()),
+                    m_offset(offset),
+                    m_options(options),
+                    m_buffer_pool(),
+                    m_budget(nullptr),
+                    m_acquired(0),
+                    m_line_offset(offset),
+                    m_key(),
+                    m_value() {
+                }
+
+                /**
+                 * Create parser for data in memory.
+                 *
+                 * @param data Pointer to complete lines of OPL data. This
+                 *             memory must stay valid until the parser is
+                 *             done.
+                 * @param size Size of the data.
+                 * @param offset Offset of the data in the file.
+                 * @param options Options from the Reader.
+                 */
+                OPLParser(const char* data, size_t size, uint64_t offset, const osmium::io::detail::reader_options& options) :
+                    m_input(),
+                    m_data(data),
+                    m_size(size),
+                    m_offset(offset),
+                    m_options(options),
+                    m_buffer_pool(),
+                    m_budget(nullptr),
+                    m_acquired(0),
+                    m_line_offset(offset),
+                    m_key(),
+                    m_value() {
+                }
+
+                /**
+                 * Set the budget the estimated size of the result was
+                 * acquired from. Once the actual size is known, the budget
+                 * is corrected.
+                 */
+                void set_budget(osmium::thread::ByteBudget* budget, size_t acquired) noexcept {
+                    m_budget = budget;
+                    m_acquired = acquired;
+                }
+
+                /**
+                 * Set the pool the buffer for the result is taken from.
+                 */
+                void set_buffer_pool(const std::shared_ptr<osmium::memory::BufferPool>& buffer_pool) {
+                    m_buffer_pool = buffer_pool;
+                }
+
+                osmium::memory::Buffer operator()() {
+                    osmium::memory::Buffer buffer = m_buffer_pool ?
+                        m_buffer_pool->get_buffer(initial_buffer_size) :
+                        osmium::memory::Buffer(initial_buffer_size);
+
+                    const char* data = m_data ? m_data : m_input.data();
+                    const char* end = data + m_size;
+                    while (data != end) {
+                        m_line_offset = m_offset + static_cast<uint64_t>(data - (m_data ? m_data : m_input.data()));
+                        const char* line_end = find(data, end, '\n');
+                        parse_line(data, line_end, buffer);
+                        data = line_end == end ? end : line_end + 1;
+                    }
+
+                    if (m_budget) {
+                        if (buffer.committed() > m_acquired) {
+                            m_budget->force_acquire(buffer.committed() - m_acquired);
+                        } else {
+                            m_budget->release(m_acquired - buffer.committed());
+                        }
+                    }
+
+                    return buffer;
+                }
+
+            }; // class OPLParser
+
+            /**
+             * Class for reading OPL files.
+             *
+             * OPL is line oriented, so the input is cut into chunks of
+             * complete lines which are parsed in parallel by OPLParser in
+             * the thread pool. The results are put into the queue in the
+             * same order as the chunks so that the order of the objects is
+             * kept.
+             *
+             * The data can either come through an input queue (filled by
+             * the ReadThread) or it can be read directly from a block of
+             * memory containing the whole file (usually a memory mapped
+             * file).
+             */
+            class OPLInputFormat : public osmium::io::detail::InputFormat {
+
+                /// Chunks are cut at the first end of line after this many bytes.
+                static constexpr size_t chunk_size = 1024 * 1024;
+
+                static constexpr size_t max_queue_size = 20;
+
+                osmium::thread::Queue<std::future<osmium::memory::Buffer>> m_queue;
+                std::atomic<bool> m_done;
+                std::thread m_reader;
+                osmium::io::detail::input_queue_type* m_input_queue;
+                const char* m_data;
+                const char* m_end;
+
+                /**
+                 * Push a future onto the result queue that will deliver an
+                 * invalid buffer (signalling end of data) or the given
+                 * exception.
+                 */
+                void push_end_of_data(std::exception_ptr exception = nullptr) {
+                    std::promise<osmium::memory::Buffer> promise;
+                    m_queue.push(promise.get_future());
+                    if (exception) {
+                        promise.set_exception(exception);
+                    } else {
+                        promise.set_value(osmium::memory::Buffer());
+                    }
+                }
+
+                void submit_chunk(OPLParser&& parser, size_t size) {
+                    // The size of the decoded data is not known yet, use
+                    // the size of the OPL data as estimate. OPLParser
+                    // corrects this once it is done.
+                    m_budget.acquire(size);
+                    parser.set_budget(&m_budget, size);
+                    parser.set_buffer_pool(m_buffer_pool);
+                    m_queue.push(m_options.thread_pool().submit(std::move(parser)));
+                }
+
+                /**
+                 * Read data from the input queue and cut it into chunks.
+                 *
+                 * @returns false if reading was stopped early.
+                 */
+                bool read_from_input_queue() {
+                    std::string data;
+                    uint64_t offset = 0;
+                    while (!m_done) {
+                        std::string new_data;
+                        if (!m_input_queue->wait_and_pop(new_data)) {
+                            return false; // reading was cancelled
+                        }
+                        if (new_data.empty()) {
+                            if (!data.empty()) {
+                                const size_t size = data.size();
+                                submit_chunk(OPLParser{std::move(data), offset, m_options}, size);
+                            }
+                            return true;
+                        }
+
+                        if (data.empty()) {
+                            data = std::move(new_data);
+                        } else {
+                            data += new_data;
+                        }
+
+                        if (data.size() >= chunk_size) {
+                            const size_t pos = data.rfind('\n');
+                            if (pos != std::string::npos) {
+                                std::string rest { data.substr(pos + 1) };
+                                data.resize(pos + 1);
+                                const size_t size = data.size();
+                                submit_chunk(OPLParser{std::move(data), offset, m_options}, size);
+                                offset += size;
+                                data = std::move(rest);
+                            }
+                        }
+                    }
+                    return false;
+                }
+
+                /**
+                 * Cut the input memory into chunks.
+                 *
+                 * @returns false if reading was stopped early.
+                 */
+                bool read_from_memory() {
+                    const char* begin = m_data;
+                    while (m_data != m_end) {
+                        if (m_done) {
+                            return false;
+                        }
+                        const char* chunk_end = m_end;
+                        if (static_cast<size_t>(m_end - m_data) > chunk_size) {
+                            const char* eol = static_cast<const char*>(std::memchr(m_data + chunk_size, '\n', static_cast<size_t>(m_end - m_data) - chunk_size));
+                            if (eol) {
+                                chunk_end = eol + 1;
+                            }
+                        }
+                        const size_t size = static_cast<size_t>(chunk_end - m_data);
+                        submit_chunk(OPLParser{m_data, size, static_cast<uint64_t>(m_data - begin), m_options}, size);
+                        m_data = chunk_end;
+                    }
+                    return true;
+                }
+
+                void parse_opl_data() {
+                    osmium::thread::set_thread_name("_osmium_opl_in");
+                    try {
+                        if (!(m_input_queue ? read_from_input_queue() : read_from_memory())) {
+                            return;
+                        }
+                        push_end_of_data();
+                    } catch (...) {
+                        push_end_of_data(std::current_exception());
+                    }
+
+                    // The end marker must be in the queue before m_done is
+                    // set, otherwise read() might miss it.
+                    m_done = true;
+                }
+
+                void start_reader() {
+                    if (m_options.read_which_entities == osmium::osm_entity_bits::nothing) {
+                        m_done = true;
+                    } else {
+                        m_reader = std::thread(&OPLInputFormat::parse_opl_data, this);
+                    }
+                }
+
+                /**
+                 * Wait for all outstanding results and throw them away.
+                 * Parser tasks might still be running in the thread pool
+                 * and they might reference the input memory, so we have to
+                 * make sure they are all done before we go away.
+                 */
+                void drain_queue() {
+                    std::future<osmium::memory::Buffer> buffer_future;
+                    while (m_queue.try_pop(buffer_future)) {
+                        if (buffer_future.valid()) {
+                            buffer_future.wait();
+                        }
+                    }
+                }
+
+            public:
+
+                /**
+                 * Instantiate OPL Parser
+                 *
+                 * @param file osmium::io::File instance describing file to be read from.
+                 * @param options Options from the Reader (which entities to read etc.).
+                 * @param input_queue String queue where data is read from.
+                 */
+                OPLInputFormat(const osmium::io::File& file, const osmium::io::detail::reader_options& options, osmium::io::detail::input_queue_type& input_queue) :
+                    osmium::io::detail::InputFormat(file, options),
+                    m_queue(max_queue_size, "opl_parser_results"),
+                    m_done(false),
+                    m_input_queue(&input_queue),
+                    m_data(nullptr),
+                    m_end(nullptr) {
+                    start_reader();
+                }
+
+                /**
+                 * Instantiate OPL Parser reading from memory.
+                 *
+                 * @param file osmium::io::File instance describing file to be read from.
+                 * @param options Options from the Reader (which entities to read etc.).
+                 * @param data Pointer to the complete OPL file in memory. This
+                 *             memory must stay valid until this object is
+                 *             destructed.
+                 * @param size Size of the data.
+                 */
+                OPLInputFormat(const osmium::io::File& file, const osmium::io::detail::reader_options& options, const char* data, size_t size) :
+                    osmium::io::detail::InputFormat(file, options),
+                    m_queue(max_queue_size, "opl_parser_results"),
+                    m_done(false),
+                    m_input_queue(nullptr),
+                    m_data(data),
+                    m_end(data + size) {
+                    start_reader();
+                }
+
+                ~OPLInputFormat() {
+                    m_done = true;
+                    m_budget.shutdown(); // so the reader is not stuck waiting for the budget
+                    drain_queue(); // so the reader is not stuck on a full queue
+                    if (m_reader.joinable()) {
+                        m_reader.join();
+                    }
+                    drain_queue();
+                }
+
+                /**
+                 * Returns the next buffer with OSM data read from the OPL file.
+                 * Blocks if data is not available yet.
+                 * Returns an invalid buffer at end of input.
+                 */
+                osmium::memory::Buffer read() override {
+                    if (!m_done || !m_queue.empty()) {
+                        std::future<osmium::memory::Buffer> buffer_future;
+                        m_queue.wait_and_pop(buffer_future);
+                        try {
+                            osmium::memory::Buffer buffer = buffer_future.get();
+                            if (!buffer) {
+                                m_done = true;
+                            } else {
+                                m_budget.release(buffer.committed());
+                            }
+                            return buffer;
+                        } catch (...) {
+                            m_done = true;
+                            throw;
+                        }
+                    }
+
+                    return osmium::memory::Buffer();
+                }
+
+            }; // class OPLInputFormat
+
+            namespace {
+
+                const bool registered_opl_input = osmium::io::detail::InputFormatFactory::instance().register_input_format(osmium::io::file_format::opl,
+                    [](const osmium::io::File& file, const osmium::io::detail::reader_options& options, osmium::io::detail::input_queue_type& input_queue) {
+                        return new osmium::io::detail::OPLInputFormat(file, options, input_queue);
+                });
+
+                const bool registered_opl_memory_input = osmium::io::detail::InputFormatFactory::instance().register_memory_input_format(osmium::io::file_format::opl,
+                    [](const osmium::io::File& file, const osmium::io::detail::reader_options& options, const char* data, size_t size) {
+                        return new osmium::io::detail::OPLInputFormat(file, options, data, size);
+                });
+
+            } // anonymous namespace
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_OPL_INPUT_FORMAT_HPP
@@ -131,6 +131,8 @@ namespace osmium {
                         // Generally we don't want to let through any character
                         // that has special meaning in the OPL format such as
                         // space, comma, @, etc. and any non-printing characters.
+                        // All other characters are written as their hex code
+                        // point between two % characters.
                         if ((0x0021 <= c && c <= 0x0024) ||
                             (0x0026 <= c && c <= 0x002b) ||
                             (0x002d <= c && c <= 0x003c) ||
@@ -142,6 +144,7 @@ namespace osmium {
                         } else {
                             *m_out += '%';
                             output_formatted("%04x", c);
+                            *m_out += '%';
                         }
                     }
                 }
@@ -240,7 +243,7 @@ namespace osmium {
                         }
                         *m_out += item_type_to_char(member.type());
                         output_formatted("%" PRId64 "@", member.ref());
-                        *m_out += member.role();
+                        append_encoded_string(member.role());
                     }
                     *m_out += '\n';
                 }
@@ -279,12 +282,12 @@ namespace osmium {
 
             public:
 
-                OPLOutputFormat(const osmium::io::File& file, data_queue_type& output_queue) :
-                    OutputFormat(file, output_queue) {
+                OPLOutputFormat(const osmium::io::File& file, data_queue_type& output_queue, osmium::thread::Pool& pool) :
+                    OutputFormat(file, output_queue, pool) {
                 }
 
                 void write_buffer(osmium::memory::Buffer&& buffer) override final {
-                    m_output_queue.push(osmium::thread::Pool::instance().submit(OPLOutputBlock{std::move(buffer)}));
+                    m_output_queue.push(m_pool.submit(OPLOutputBlock{std::move(buffer)}));
                 }
 
                 void close() override final {
@@ -301,8 +304,8 @@ namespace osmium {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-variable"
                 const bool registered_opl_output = osmium::io::detail::OutputFormatFactory::instance().register_output_format(osmium::io::file_format::opl,
-                    [](const osmium::io::File& file, data_queue_type& output_queue) {
-                        return new osmium::io::detail::OPLOutputFormat(file, output_queue);
+                    [](const osmium::io::File& file, data_queue_type& output_queue, osmium::thread::Pool& pool) {
+                        return new osmium::io::detail::OPLOutputFormat(file, output_queue, pool);
                 });
 #pragma GCC diagnostic pop
 
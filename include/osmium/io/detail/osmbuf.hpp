@@ -0,0 +1,274 @@
+#ifndef OSMIUM_IO_DETAIL_OSMBUF_HPP
+#define OSMIUM_IO_DETAIL_OSMBUF_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <osmium/io/error.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/location.hpp>
+
+namespace osmium {
+
+    /**
+     * Exception thrown when there was a problem with reading a file in
+     * the native OSMBUF format.
+     */
+    struct osmbuf_error : public io_error {
+
+        osmbuf_error(const std::string& what) :
+            io_error(std::string("OSMBUF error: ") + what) {
+        }
+
+        osmbuf_error(const char* what) :
+            io_error(std::string("OSMBUF error: ") + what) {
+        }
+
+    }; // struct osmbuf_error
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * @brief The native OSMBUF file format
+             *
+             * OSMBUF files contain the contents of osmium::memory::Buffers
+             * exactly as they are in memory. Reading them needs no
+             * decoding: When the file is memory mapped, the buffers
+             * returned by the Reader point directly into the mapping.
+             *
+             * The format depends on the byte order and on the memory
+             * layout of the OSM objects in the build of libosmium that
+             * wrote it. It is meant for intermediate files, not for
+             * exchanging data. Readers check the byte order and the
+             * format version and reject everything they can't handle.
+             *
+             * Layout of a file (all values in native byte order, all
+             * parts are aligned to osmium::memory::align_bytes):
+             *
+             * * file_header
+             * * header data: osmbuf_header_box entries followed by the
+             *   header options as "key\0value\0" pairs, padded
+             * * for each buffer: block_header (type data) and the
+             *   committed bytes of the buffer
+             * * block_header (type directory) and one directory_entry
+             *   for each data block
+             * * file_trailer with the offset of the directory block
+             */
+            namespace osmbuf {
+
+                const char file_magic[8] = { 'O', 'S', 'M', 'B', 'U', 'F', '\0', '\0' };
+                const char trailer_magic[8] = { 'O', 'S', 'M', 'B', 'U', 'F', 'I', 'X' };
+
+                /**
+                 * Version of the memory layout of OSM objects. This must
+                 * be incremented whenever the layout of any item changes.
+                 */
+                const uint32_t format_version = 1;
+
+                const uint32_t byte_order_mark = 0x01020304;
+
+                enum class block_type : uint32_t {
+                    data      = 1,
+                    directory = 2
+                }; // enum class block_type
+
+                enum header_flags : uint32_t {
+                    multiple_object_versions = 1
+                }; // enum header_flags
+
+                struct file_header {
+                    char magic[8];
+                    uint32_t version;
+                    uint32_t byte_order;
+                    uint32_t align_bytes;
+                    uint32_t flags;
+                    uint32_t num_boxes;
+                    uint32_t num_options;
+                    uint64_t data_size;
+                }; // struct file_header
+
+                struct header_box {
+                    int32_t min_x;
+                    int32_t min_y;
+                    int32_t max_x;
+                    int32_t max_y;
+                }; // struct header_box
+
+                struct block_header {
+                    uint64_t size;
+                    block_type type;
+                    uint32_t entities;
+                }; // struct block_header
+
+                struct directory_entry {
+                    uint64_t offset;
+                    uint64_t size;
+                    uint32_t entities;
+                    uint32_t reserved;
+                }; // struct directory_entry
+
+                struct file_trailer {
+                    uint64_t directory_offset;
+                    char magic[8];
+                }; // struct file_trailer
+
+                static_assert(sizeof(file_header) % osmium::memory::align_bytes == 0, "osmbuf::file_header has wrong size");
+                static_assert(sizeof(header_box) == 16, "osmbuf::header_box has wrong size");
+                static_assert(sizeof(block_header) % osmium::memory::align_bytes == 0, "osmbuf::block_header has wrong size");
+                static_assert(sizeof(directory_entry) % osmium::memory::align_bytes == 0, "osmbuf::directory_entry has wrong size");
+                static_assert(sizeof(file_trailer) % osmium::memory::align_bytes == 0, "osmbuf::file_trailer has wrong size");
+
+                /**
+                 * Entity types of all OSM objects in the buffer.
+                 */
+                inline osmium::osm_entity_bits::type buffer_entities(const osmium::memory::Buffer& buffer) noexcept {
+                    osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::nothing;
+                    for (const auto& item : buffer) {
+                        entities |= osmium::osm_entity_bits::from_item_type(item.type());
+                    }
+                    return entities;
+                }
+
+                /**
+                 * Append the binary representation of an object to a string.
+                 */
+                template <typename T>
+                inline void append(std::string& out, const T& value) {
+                    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+                }
+
+                /**
+                 * Check the file header and return the size of the complete
+                 * header including the header data.
+                 *
+                 * @throws osmium::osmbuf_error If this is not an OSMBUF
+                 *         file this build can read.
+                 */
+                inline uint64_t check_file_header(const file_header& header) {
+                    if (std::memcmp(header.magic, file_magic, sizeof(file_magic)) != 0) {
+                        throw osmium::osmbuf_error("not an OSMBUF file");
+                    }
+                    if (header.byte_order != byte_order_mark) {
+                        throw osmium::osmbuf_error("file was written on a machine with a different byte order");
+                    }
+                    if (header.version != format_version || header.align_bytes != osmium::memory::align_bytes) {
+                        throw osmium::osmbuf_error("unsupported format version");
+                    }
+                    if (header.data_size % osmium::memory::align_bytes != 0 ||
+                        header.data_size < uint64_t(header.num_boxes) * sizeof(header_box)) {
+                        throw osmium::osmbuf_error("invalid header");
+                    }
+                    return sizeof(file_header) + header.data_size;
+                }
+
+                /**
+                 * Create file header and header data from the given header.
+                 */
+                inline std::string encode_header(const osmium::io::Header& header) {
+                    std::string options;
+                    for (const auto& option : header) {
+                        options.append(option.first);
+                        options += '\0';
+                        options.append(option.second);
+                        options += '\0';
+                    }
+                    options.append(osmium::memory::padded_length(options.size()) - options.size(), '\0');
+
+                    file_header fh;
+                    std::memcpy(fh.magic, file_magic, sizeof(file_magic));
+                    fh.version = format_version;
+                    fh.byte_order = byte_order_mark;
+                    fh.align_bytes = osmium::memory::align_bytes;
+                    fh.flags = header.has_multiple_object_versions() ? static_cast<uint32_t>(header_flags::multiple_object_versions) : 0;
+                    fh.num_boxes = static_cast<uint32_t>(header.boxes().size());
+                    fh.num_options = static_cast<uint32_t>(header.size());
+                    fh.data_size = header.boxes().size() * sizeof(header_box) + options.size();
+
+                    std::string out;
+                    append(out, fh);
+                    for (const auto& box : header.boxes()) {
+                        append(out, header_box{box.bottom_left().x(), box.bottom_left().y(), box.top_right().x(), box.top_right().y()});
+                    }
+                    out += options;
+                    return out;
+                }
+
+                /**
+                 * Decode the header data following the (already checked)
+                 * file header.
+                 *
+                 * @throws osmium::osmbuf_error If the header data is invalid.
+                 */
+                inline osmium::io::Header decode_header(const file_header& fh, const char* data) {
+                    osmium::io::Header header;
+                    header.set_has_multiple_object_versions((fh.flags & header_flags::multiple_object_versions) != 0);
+
+                    for (uint32_t i = 0; i < fh.num_boxes; ++i) {
+                        header_box hb;
+                        std::memcpy(&hb, data, sizeof(header_box));
+                        data += sizeof(header_box);
+                        header.add_box(osmium::Box(osmium::Location(hb.min_x, hb.min_y), osmium::Location(hb.max_x, hb.max_y)));
+                    }
+
+                    const char* end = data + (fh.data_size - fh.num_boxes * sizeof(header_box));
+                    for (uint32_t i = 0; i < fh.num_options; ++i) {
+                        const char* key_end = static_cast<const char*>(std::memchr(data, '\0', static_cast<size_t>(end - data)));
+                        const char* value_end = key_end ? static_cast<const char*>(std::memchr(key_end + 1, '\0', static_cast<size_t>(end - key_end - 1))) : nullptr;
+                        if (!value_end) {
+                            throw osmium::osmbuf_error("invalid header");
+                        }
+                        header.set(std::string(data, key_end), std::string(key_end + 1, value_end));
+                        data = value_end + 1;
+                    }
+
+                    return header;
+                }
+
+            } // namespace osmbuf
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_OSMBUF_HPP
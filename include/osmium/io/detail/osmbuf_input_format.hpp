@@ -0,0 +1,396 @@
+#ifndef OSMIUM_IO_DETAIL_OSMBUF_INPUT_FORMAT_HPP
+#define OSMIUM_IO_DETAIL_OSMBUF_INPUT_FORMAT_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <osmium/io/detail/input_format.hpp>
+#include <osmium/io/detail/osmbuf.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/file_format.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/thread/queue.hpp>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * Reads files in the native OSMBUF format.
+             *
+             * When reading from memory (usually a memory mapped file) the
+             * block directory at the end of the file is used to find the
+             * blocks and the buffers returned point directly into the
+             * memory. Nothing is parsed or copied. These buffers are only
+             * valid as long as the Reader exists. The Reader maps OSMBUF
+             * files writable but private (copy-on-write), so the objects
+             * can be changed, but changes are not written back to the file.
+             * On Windows OSMBUF files are not mapped but read through the
+             * input queue.
+             *
+             * When reading through the input queue (compressed files,
+             * pipes or with the file option "mmap=false") the blocks are
+             * read one after the other and copied into buffers.
+             *
+             * Objects are only copied into new buffers when some of them
+             * have to be filtered out because their entity type was not
+             * requested or because of the bounding box set on the Reader.
+             * The osmium::io::read_meta option is ignored, there is nothing
+             * to be saved by not reading metadata.
+             */
+            class OSMBUFInputFormat : public osmium::io::detail::InputFormat {
+
+                osmium::io::detail::input_queue_type* m_input_queue;
+                std::string m_input_buffer;
+
+                const char* m_begin;
+                const char* m_end;
+
+                // directory of data blocks when reading from memory
+                const osmbuf::directory_entry* m_directory;
+                const osmbuf::directory_entry* m_directory_end;
+
+                bool m_done;
+
+                /**
+                 * Read the given number of bytes from the input queue into
+                 * the input buffer.
+                 *
+                 * @returns false if there is no data left at all.
+                 * @throws osmium::osmbuf_error If the input ends after some,
+                 *         but not all of the bytes.
+                 */
+                bool fill_input_buffer(size_t size) {
+                    while (m_input_buffer.size() < size) {
+                        std::string new_data;
+                        m_input_queue->wait_and_pop(new_data);
+                        if (new_data.empty()) {
+                            if (m_input_buffer.empty()) {
+                                return false;
+                            }
+                            throw osmium::osmbuf_error("truncated data (EOF encountered)");
+                        }
+                        m_input_buffer += new_data;
+                    }
+                    return true;
+                }
+
+                template <typename T>
+                T read_from_input_queue() {
+                    if (!fill_input_buffer(sizeof(T))) {
+                        throw osmium::osmbuf_error("truncated data (EOF encountered)");
+                    }
+                    T value;
+                    std::memcpy(&value, m_input_buffer.data(), sizeof(T));
+                    m_input_buffer.erase(0, sizeof(T));
+                    return value;
+                }
+
+                bool is_wanted(const osmium::OSMEntity& entity) const {
+                    if (!(m_options.read_which_entities & osmium::osm_entity_bits::from_item_type(entity.type()))) {
+                        return false;
+                    }
+                    if (m_options.bbox && entity.type() == osmium::item_type::node) {
+                        const osmium::Location location = static_cast<const osmium::Node&>(entity).location();
+                        return location && m_options.bbox.contains(location);
+                    }
+                    return true;
+                }
+
+                /**
+                 * Do the objects in a block with the given entity types
+                 * have to be filtered?
+                 */
+                bool needs_filtering(uint32_t entities) const noexcept {
+                    const auto types = static_cast<osmium::osm_entity_bits::type>(entities);
+                    return (types & ~m_options.read_which_entities) ||
+                           (m_options.bbox && (types & osmium::osm_entity_bits::node));
+                }
+
+                /**
+                 * Copy all objects we are interested in from the input
+                 * buffer into a new buffer.
+                 */
+                osmium::memory::Buffer filter(const osmium::memory::Buffer& input) {
+                    osmium::memory::Buffer buffer = m_buffer_pool->get_buffer(input.committed());
+                    for (const auto& entity : input) {
+                        if (is_wanted(entity)) {
+                            buffer.add_item(entity);
+                            buffer.commit();
+                        }
+                    }
+                    return buffer;
+                }
+
+                /**
+                 * Check the trailer and the directory at the end of the
+                 * file and set up m_directory.
+                 */
+                void read_directory(uint64_t header_size) {
+                    const uint64_t file_size = static_cast<uint64_t>(m_end - m_begin);
+                    if (file_size < header_size + sizeof(osmbuf::block_header) + sizeof(osmbuf::file_trailer)) {
+                        throw osmium::osmbuf_error("missing block directory (file truncated?)");
+                    }
+
+                    osmbuf::file_trailer trailer;
+                    std::memcpy(&trailer, m_end - sizeof(osmbuf::file_trailer), sizeof(osmbuf::file_trailer));
+                    const uint64_t directory_end = file_size - sizeof(osmbuf::file_trailer);
+                    if (std::memcmp(trailer.magic, osmbuf::trailer_magic, sizeof(osmbuf::trailer_magic)) != 0 ||
+                        trailer.directory_offset % osmium::memory::align_bytes != 0 ||
+                        trailer.directory_offset < header_size ||
+                        trailer.directory_offset > directory_end - sizeof(osmbuf::block_header)) {
+                        throw osmium::osmbuf_error("missing block directory (file truncated?)");
+                    }
+
+                    osmbuf::block_header directory_header;
+                    std::memcpy(&directory_header, m_begin + trailer.directory_offset, sizeof(osmbuf::block_header));
+                    const uint64_t directory_begin = trailer.directory_offset + sizeof(osmbuf::block_header);
+                    if (directory_header.type != osmbuf::block_type::directory ||
+                        directory_header.size != directory_end - directory_begin ||
+                        directory_header.size % sizeof(osmbuf::directory_entry) != 0) {
+                        throw osmium::osmbuf_error("invalid block directory");
+                    }
+
+                    m_directory = reinterpret_cast<const osmbuf::directory_entry*>(m_begin + directory_begin);
+                    m_directory_end = reinterpret_cast<const osmbuf::directory_entry*>(m_begin + directory_end);
+
+                    // Every block must be properly aligned, come after the
+                    // previous one, end before the directory, and match its
+                    // block header. The checks are ordered so that none of
+                    // the subtractions can wrap around.
+                    uint64_t offset = header_size;
+                    for (auto entry = m_directory; entry != m_directory_end; ++entry) {
+                        if (entry->offset < offset ||
+                            entry->offset % osmium::memory::align_bytes != 0 ||
+                            entry->offset > trailer.directory_offset - sizeof(osmbuf::block_header) ||
+                            entry->size % osmium::memory::align_bytes != 0 ||
+                            entry->size > trailer.directory_offset - sizeof(osmbuf::block_header) - entry->offset) {
+                            throw osmium::osmbuf_error("invalid block directory");
+                        }
+
+                        osmbuf::block_header block_header;
+                        std::memcpy(&block_header, m_begin + entry->offset, sizeof(osmbuf::block_header));
+                        if (block_header.type != osmbuf::block_type::data ||
+                            block_header.size != entry->size ||
+                            block_header.entities != entry->entities) {
+                            throw osmium::osmbuf_error("block directory does not match blocks");
+                        }
+
+                        offset = entry->offset + sizeof(osmbuf::block_header) + entry->size;
+                    }
+                }
+
+                void read_header() {
+                    osmbuf::file_header fh;
+                    std::string data;
+                    if (m_input_queue) {
+                        if (!fill_input_buffer(sizeof(osmbuf::file_header))) {
+                            throw osmium::osmbuf_error("empty file");
+                        }
+                        fh = read_from_input_queue<osmbuf::file_header>();
+                        osmbuf::check_file_header(fh);
+                        if (!fill_input_buffer(fh.data_size)) {
+                            throw osmium::osmbuf_error("truncated data (EOF encountered)");
+                        }
+                        data = m_input_buffer.substr(0, fh.data_size);
+                        m_input_buffer.erase(0, fh.data_size);
+                    } else {
+                        if (static_cast<size_t>(m_end - m_begin) < sizeof(osmbuf::file_header)) {
+                            throw osmium::osmbuf_error("truncated data (EOF encountered)");
+                        }
+                        std::memcpy(&fh, m_begin, sizeof(osmbuf::file_header));
+                        const uint64_t header_size = osmbuf::check_file_header(fh);
+                        if (static_cast<uint64_t>(m_end - m_begin) < header_size) {
+                            throw osmium::osmbuf_error("truncated data (EOF encountered)");
+                        }
+                        data.assign(m_begin + sizeof(osmbuf::file_header), fh.data_size);
+                        read_directory(header_size);
+                    }
+
+                    const bool multiple_object_versions = m_header.has_multiple_object_versions();
+                    m_header = osmbuf::decode_header(fh, data.data());
+                    if (multiple_object_versions) {
+                        m_header.set_has_multiple_object_versions(true);
+                    }
+                }
+
+                osmium::memory::Buffer read_from_memory() {
+                    for (; m_directory != m_directory_end; ++m_directory) {
+                        if (!(m_directory->entities & m_options.read_which_entities)) {
+                            continue;
+                        }
+
+                        // The Buffer class wants non-const memory. We never
+                        // change it, but users of the Reader might.
+                        auto data = reinterpret_cast<unsigned char*>(const_cast<char*>(m_begin + m_directory->offset + sizeof(osmbuf::block_header)));
+                        osmium::memory::Buffer buffer(data, m_directory->size, m_directory->size);
+
+                        const uint32_t entities = m_directory->entities;
+                        ++m_directory;
+                        if (needs_filtering(entities)) {
+                            return filter(buffer);
+                        }
+                        return buffer;
+                    }
+                    return osmium::memory::Buffer();
+                }
+
+                osmium::memory::Buffer read_from_queue() {
+                    while (true) {
+                        const auto header = read_from_input_queue<osmbuf::block_header>();
+                        if (header.type == osmbuf::block_type::directory) {
+                            // The directory is the last block. Nothing
+                            // interesting left after it.
+                            return osmium::memory::Buffer();
+                        }
+                        if (header.type != osmbuf::block_type::data || header.size % osmium::memory::align_bytes != 0) {
+                            throw osmium::osmbuf_error("invalid block header");
+                        }
+                        if (!fill_input_buffer(header.size)) {
+                            throw osmium::osmbuf_error("truncated data (EOF encountered)");
+                        }
+
+                        if (header.entities & m_options.read_which_entities) {
+                            auto data = reinterpret_cast<unsigned char*>(&m_input_buffer[0]);
+                            osmium::memory::Buffer input(data, header.size, header.size);
+                            osmium::memory::Buffer buffer;
+                            if (needs_filtering(header.entities)) {
+                                buffer = filter(input);
+                            } else {
+                                buffer = m_buffer_pool->get_buffer(header.size);
+                                buffer.add_buffer(input);
+                                buffer.commit();
+                            }
+                            m_input_buffer.erase(0, header.size);
+                            return buffer;
+                        }
+
+                        m_input_buffer.erase(0, header.size);
+                    }
+                }
+
+            public:
+
+                /**
+                 * Instantiate OSMBUF Parser
+                 *
+                 * @param file osmium::io::File instance describing file to be read from.
+                 * @param options Options from the Reader (which entities to read etc.).
+                 * @param input_queue String queue where data is read from.
+                 */
+                OSMBUFInputFormat(const osmium::io::File& file, const osmium::io::detail::reader_options& options, osmium::io::detail::input_queue_type& input_queue) :
+                    osmium::io::detail::InputFormat(file, options),
+                    m_input_queue(&input_queue),
+                    m_input_buffer(),
+                    m_begin(nullptr),
+                    m_end(nullptr),
+                    m_directory(nullptr),
+                    m_directory_end(nullptr),
+                    m_done(false) {
+                    read_header();
+                }
+
+                /**
+                 * Instantiate OSMBUF Parser reading from memory.
+                 *
+                 * @param file osmium::io::File instance describing file to be read from.
+                 * @param options Options from the Reader (which entities to read etc.).
+                 * @param data Pointer to the complete OSMBUF file in memory.
+                 *             This memory must stay valid as long as any of
+                 *             the buffers returned from read() are used.
+                 *             It must be aligned to
+                 *             osmium::memory::align_bytes.
+                 * @param size Size of the data.
+                 */
+                OSMBUFInputFormat(const osmium::io::File& file, const osmium::io::detail::reader_options& options, const char* data, size_t size) :
+                    osmium::io::detail::InputFormat(file, options),
+                    m_input_queue(nullptr),
+                    m_input_buffer(),
+                    m_begin(data),
+                    m_end(data + size),
+                    m_directory(nullptr),
+                    m_directory_end(nullptr),
+                    m_done(false) {
+                    if (reinterpret_cast<uintptr_t>(data) % osmium::memory::align_bytes != 0) {
+                        throw osmium::osmbuf_error("data in memory is not aligned");
+                    }
+                    read_header();
+                }
+
+                /**
+                 * Returns the next buffer with OSM data. Returns an invalid
+                 * buffer at end of input.
+                 */
+                osmium::memory::Buffer read() override {
+                    if (m_done) {
+                        return osmium::memory::Buffer();
+                    }
+                    osmium::memory::Buffer buffer = m_input_queue ? read_from_queue() : read_from_memory();
+                    if (!buffer) {
+                        m_done = true;
+                    }
+                    return buffer;
+                }
+
+            }; // class OSMBUFInputFormat
+
+            namespace {
+
+                const bool registered_osmbuf_input = osmium::io::detail::InputFormatFactory::instance().register_input_format(osmium::io::file_format::osmbuf,
+                    [](const osmium::io::File& file, const osmium::io::detail::reader_options& options, osmium::io::detail::input_queue_type& input_queue) {
+                        return new osmium::io::detail::OSMBUFInputFormat(file, options, input_queue);
+                });
+
+                const bool registered_osmbuf_memory_input = osmium::io::detail::InputFormatFactory::instance().register_memory_input_format(osmium::io::file_format::osmbuf,
+                    [](const osmium::io::File& file, const osmium::io::detail::reader_options& options, const char* data, size_t size) {
+                        return new osmium::io::detail::OSMBUFInputFormat(file, options, data, size);
+                });
+
+            } // anonymous namespace
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_OSMBUF_INPUT_FORMAT_HPP
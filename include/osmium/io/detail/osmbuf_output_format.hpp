@@ -0,0 +1,149 @@
+#ifndef OSMIUM_IO_DETAIL_OSMBUF_OUTPUT_FORMAT_HPP
+#define OSMIUM_IO_DETAIL_OSMBUF_OUTPUT_FORMAT_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <osmium/io/detail/osmbuf.hpp>
+#include <osmium/io/detail/output_format.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/file_format.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/thread/queue.hpp>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * Writes buffers in the native OSMBUF format. The committed
+             * part of each buffer is written as is into one data block.
+             * On close() a directory of all blocks is written at the end
+             * of the file. See osmium::io::detail::osmbuf for the layout.
+             */
+            class OSMBUFOutputFormat : public osmium::io::detail::OutputFormat {
+
+                std::vector<osmbuf::directory_entry> m_directory;
+
+                /// Number of bytes written so far.
+                uint64_t m_offset;
+
+                void push(std::string&& data) {
+                    m_offset += data.size();
+                    std::promise<std::string> promise;
+                    m_output_queue.push(promise.get_future());
+                    promise.set_value(std::move(data));
+                }
+
+                OSMBUFOutputFormat(const OSMBUFOutputFormat&) = delete;
+                OSMBUFOutputFormat& operator=(const OSMBUFOutputFormat&) = delete;
+
+            public:
+
+                OSMBUFOutputFormat(const osmium::io::File& file, data_queue_type& output_queue, osmium::thread::Pool& pool) :
+                    OutputFormat(file, output_queue, pool),
+                    m_directory(),
+                    m_offset(0) {
+                }
+
+                void write_header(const osmium::io::Header& header) override final {
+                    osmium::io::Header file_header(header);
+                    if (m_file.has_multiple_object_versions()) {
+                        file_header.set_has_multiple_object_versions(true);
+                    }
+                    push(osmbuf::encode_header(file_header));
+                }
+
+                void write_buffer(osmium::memory::Buffer&& buffer) override final {
+                    const osmbuf::block_header header{
+                        buffer.committed(),
+                        osmbuf::block_type::data,
+                        static_cast<uint32_t>(osmbuf::buffer_entities(buffer))
+                    };
+                    m_directory.push_back(osmbuf::directory_entry{m_offset, header.size, header.entities, 0});
+
+                    std::string out;
+                    out.reserve(sizeof(osmbuf::block_header) + buffer.committed());
+                    osmbuf::append(out, header);
+                    out.append(reinterpret_cast<const char*>(buffer.data()), buffer.committed());
+                    push(std::move(out));
+                }
+
+                void close() override final {
+                    osmbuf::file_trailer trailer;
+                    trailer.directory_offset = m_offset;
+                    std::memcpy(trailer.magic, osmbuf::trailer_magic, sizeof(osmbuf::trailer_magic));
+
+                    std::string out;
+                    osmbuf::append(out, osmbuf::block_header{m_directory.size() * sizeof(osmbuf::directory_entry), osmbuf::block_type::directory, 0});
+                    for (const auto& entry : m_directory) {
+                        osmbuf::append(out, entry);
+                    }
+                    osmbuf::append(out, trailer);
+                    m_directory.clear();
+                    push(std::move(out));
+
+                    // end of data marker
+                    push(std::string());
+                }
+
+            }; // class OSMBUFOutputFormat
+
+            namespace {
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+                const bool registered_osmbuf_output = osmium::io::detail::OutputFormatFactory::instance().register_output_format(osmium::io::file_format::osmbuf,
+                    [](const osmium::io::File& file, data_queue_type& output_queue, osmium::thread::Pool& pool) {
+                        return new osmium::io::detail::OSMBUFOutputFormat(file, output_queue, pool);
+                });
+#pragma GCC diagnostic pop
+
+            } // anonymous namespace
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_OSMBUF_OUTPUT_FORMAT_HPP
@@ -44,7 +44,8 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/file.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
-#include <osmium/thread/queue.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/spsc_queue.hpp>
 
 namespace osmium {
 
@@ -54,9 +55,26 @@ namespace osmium {
 
     namespace io {
 
+        /**
+         * Writer option: Should the raw data attached to buffers be written
+         * out instead of the objects in them? See
+         * osmium::io::keep_raw_data. Currently only the PBF output format
+         * supports this. Changes to objects in place can not be detected,
+         * so only set this if the objects in buffers with raw data are not
+         * changed between reading and writing.
+         */
+        enum class copy_raw_data {
+            no  = 0,
+            yes = 1
+        }; // enum class copy_raw_data
+
         namespace detail {
 
-            typedef osmium::thread::Queue<std::future<std::string>> data_queue_type;
+            /**
+             * Queue for the output data between the output format and the
+             * WriteThread. There is always exactly one thread on each side.
+             */
+            typedef osmium::thread::SPSCQueue<std::future<std::string>> data_queue_type;
 
             /**
              * Virtual base class for all classes writing OSM files in different
@@ -72,11 +90,15 @@ namespace osmium {
                 osmium::io::File m_file;
                 data_queue_type& m_output_queue;
 
+                /// Thread pool used for encoding the data.
+                osmium::thread::Pool& m_pool;
+
             public:
 
-                explicit OutputFormat(const osmium::io::File& file, data_queue_type& output_queue) :
+                explicit OutputFormat(const osmium::io::File& file, data_queue_type& output_queue, osmium::thread::Pool& pool) :
                     m_file(file),
-                    m_output_queue(output_queue) {
+                    m_output_queue(output_queue),
+                    m_pool(pool) {
                 }
 
                 OutputFormat(const OutputFormat&) = delete;
@@ -108,7 +130,7 @@ namespace osmium {
 
             public:
 
-                typedef std::function<osmium::io::detail::OutputFormat*(const osmium::io::File&, data_queue_type&)> create_output_type;
+                typedef std::function<osmium::io::detail::OutputFormat*(const osmium::io::File&, data_queue_type&, osmium::thread::Pool&)> create_output_type;
 
             private:
 
@@ -134,12 +156,12 @@ namespace osmium {
                     return true;
                 }
 
-                std::unique_ptr<osmium::io::detail::OutputFormat> create_output(const osmium::io::File& file, data_queue_type& output_queue) {
+                std::unique_ptr<osmium::io::detail::OutputFormat> create_output(const osmium::io::File& file, data_queue_type& output_queue, osmium::thread::Pool& pool) {
                     file.check();
 
                     auto it = m_callbacks.find(file.format());
                     if (it != m_callbacks.end()) {
-                        return std::unique_ptr<osmium::io::detail::OutputFormat>((it->second)(file, output_queue));
+                        return std::unique_ptr<osmium::io::detail::OutputFormat>((it->second)(file, output_queue, pool));
                     }
 
                     throw std::runtime_error(std::string("Support for output format '") + as_string(file.format()) + "' not compiled into this binary.");
@@ -33,9 +33,8 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
-#include <stdexcept>
-
-#include <osmpbf/osmpbf.h>
+#include <cstdint>
+#include <string>
 
 // needed for htonl and ntohl
 #ifndef _WIN32
@@ -49,33 +48,31 @@ DEALINGS IN THE SOFTWARE.
 
 namespace osmium {
 
-// avoid g++ false positive
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wreturn-type"
-    inline item_type osmpbf_membertype_to_item_type(const OSMPBF::Relation::MemberType mt) {
-        switch (mt) {
-            case OSMPBF::Relation::NODE:
-                return item_type::node;
-            case OSMPBF::Relation::WAY:
-                return item_type::way;
-            case OSMPBF::Relation::RELATION:
-                return item_type::relation;
-        }
-    }
-#pragma GCC diagnostic pop
-
-    inline OSMPBF::Relation::MemberType item_type_to_osmpbf_membertype(const item_type type) {
-        switch (type) {
-            case item_type::node:
-                return OSMPBF::Relation::NODE;
-            case item_type::way:
-                return OSMPBF::Relation::WAY;
-            case item_type::relation:
-                return OSMPBF::Relation::RELATION;
-            default:
-                throw std::runtime_error("Unknown relation member type");
-        }
-    }
+    namespace io {
+
+        namespace detail {
+
+            // These constants are defined by the PBF format.
+
+            /// Maximum size of a BlobHeader in bytes.
+            const int max_blob_header_size = 64 * 1024;
+
+            /// Maximum size of an uncompressed Blob in bytes.
+            const int max_uncompressed_blob_size = 32 * 1024 * 1024;
+
+            /// Resolution of coordinates in the PBF format (nanodegrees).
+            const int64_t lonlat_resolution = 1000 * 1000 * 1000;
+
+            /**
+             * Flag for the raw data of buffers read from PBF files: The
+             * blob is from a file with the HistoricalInformation feature,
+             * so the objects in it have visible flags.
+             */
+            const uint32_t pbf_raw_blob_history = 1;
+
+        } // namespace detail
+
+    } // namespace io
 
     /**
      * Exception thrown when there was a problem with parsing the PBF format of
@@ -93,6 +90,24 @@ namespace osmium {
 
     }; // struct pbf_error
 
+    /**
+     * Convert the PBF Relation.MemberType enum value into item_type.
+     *
+     * @throws osmium::pbf_error If the member type is unknown.
+     */
+    inline item_type osmpbf_membertype_to_item_type(const int32_t mt) {
+        switch (mt) {
+            case 0:
+                return item_type::node;
+            case 1:
+                return item_type::way;
+            case 2:
+                return item_type::relation;
+            default:
+                throw osmium::pbf_error("unknown relation member type");
+        }
+    }
+
 } // namespace osmium
 
 #endif // OSMIUM_IO_DETAIL_PBF_HPP
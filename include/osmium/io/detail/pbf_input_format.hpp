@@ -40,6 +40,7 @@ DEALINGS IN THE SOFTWARE.
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <exception>
 #include <future>
 #include <memory>
 #include <ratio>
@@ -52,9 +53,11 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/detail/input_format.hpp>
 #include <osmium/io/detail/pbf.hpp> // IWYU pragma: export
 #include <osmium/io/detail/pbf_parser.hpp>
+#include <osmium/io/detail/protobuf.hpp>
 #include <osmium/io/error.hpp>
 #include <osmium/io/file.hpp>
 #include <osmium/io/file_format.hpp>
+#include <osmium/io/pbf_blob_index.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm.hpp>
 #include <osmium/osm/box.hpp>
@@ -80,15 +83,33 @@ namespace osmium {
 
             /**
              * Class for parsing PBF files.
+             *
+             * The data can either come through an input queue (filled by
+             * the ReadThread) or it can be read directly from a block of
+             * memory containing the whole file (usually a memory mapped
+             * file). In the latter case no copies of the raw blob data are
+             * made, the parser threads read directly from that memory.
              */
             class PBFInputFormat : public osmium::io::detail::InputFormat {
 
+                /**
+                 * Maximum number of blobs being parsed or waiting for
+                 * read() to pick up their results. The reader thread blocks
+                 * when this many futures are in the queue.
+                 */
+                static constexpr size_t max_queue_size = 20;
+
                 bool m_use_thread_pool;
                 queue_type m_queue;
                 std::atomic<bool> m_done;
                 std::thread m_reader;
-                osmium::thread::Queue<std::string>& m_input_queue;
+                osmium::io::detail::input_queue_type* m_input_queue;
                 std::string m_input_buffer;
+                const char* m_begin;
+                const char* m_data;
+                const char* m_end;
+                bool m_use_index;
+                osmium::io::PBFBlobIndex m_index;
 
                 /**
                  * Read the given number of bytes from the input queue.
@@ -100,7 +121,7 @@ namespace osmium {
                 std::string read_from_input_queue(size_t size) {
                     while (m_input_buffer.size() < size) {
                         std::string new_data;
-                        m_input_queue.wait_and_pop(new_data);
+                        m_input_queue->wait_and_pop(new_data);
                         if (new_data.empty()) {
                             throw osmium::pbf_error("truncated data (EOF encountered)");
                         }
@@ -113,6 +134,22 @@ namespace osmium {
                     return output;
                 }
 
+                /**
+                 * Get the given number of bytes from the input memory.
+                 *
+                 * @param size Number of bytes to read
+                 * @returns Pointer to the data
+                 * @throws osmium::pbf_error If size bytes can't be read
+                 */
+                const char* read_from_memory(size_t size) {
+                    if (m_data > m_end || static_cast<size_t>(m_end - m_data) < size) {
+                        throw osmium::pbf_error("truncated data (EOF encountered)");
+                    }
+                    const char* data = m_data;
+                    m_data += size;
+                    return data;
+                }
+
                 /**
                  * Read BlobHeader by first reading the size and then the
                  * BlobHeader. The BlobHeader contains a type field (which is
@@ -126,96 +163,342 @@ namespace osmium {
                     uint32_t size_in_network_byte_order;
 
                     try {
-                        std::string input_data = read_from_input_queue(sizeof(size_in_network_byte_order));
-                        size_in_network_byte_order = *reinterpret_cast<const uint32_t*>(input_data.data());
+                        if (m_input_queue) {
+                            std::string input_data = read_from_input_queue(sizeof(size_in_network_byte_order));
+                            size_in_network_byte_order = *reinterpret_cast<const uint32_t*>(input_data.data());
+                        } else {
+                            std::memcpy(&size_in_network_byte_order, read_from_memory(sizeof(size_in_network_byte_order)), sizeof(size_in_network_byte_order));
+                        }
                     } catch (osmium::pbf_error&) {
                         return 0; // EOF
                     }
 
                     uint32_t size = ntohl(size_in_network_byte_order);
-                    if (size > static_cast<uint32_t>(OSMPBF::max_blob_header_size)) {
+                    if (size > static_cast<uint32_t>(max_blob_header_size)) {
                         throw osmium::pbf_error("invalid BlobHeader size (> max_blob_header_size)");
                     }
 
-                    OSMPBF::BlobHeader blob_header;
-                    if (!blob_header.ParseFromString(read_from_input_queue(size))) {
-                        throw osmium::pbf_error("failed to parse BlobHeader");
+                    std::string blob_header_buffer;
+                    const char* blob_header_data;
+                    if (m_input_queue) {
+                        blob_header_buffer = read_from_input_queue(size);
+                        blob_header_data = blob_header_buffer.data();
+                    } else {
+                        blob_header_data = read_from_memory(size);
                     }
 
-                    if (blob_header.type() != expected_type) {
-                        throw osmium::pbf_error("blob does not have expected type (OSMHeader in first blob, OSMData in following blobs)");
+                    return decode_blob_header(blob_header_data, size, expected_type);
+                }
+
+                /**
+                 * Push a future onto the result queue that will deliver an
+                 * invalid buffer (signalling end of data) or the given
+                 * exception.
+                 */
+                void push_end_of_data(std::exception_ptr exception = nullptr) {
+                    std::promise<osmium::memory::Buffer> promise;
+                    m_queue.push(promise.get_future());
+                    if (exception) {
+                        promise.set_exception(exception);
+                    } else {
+                        promise.set_value(osmium::memory::Buffer());
+                    }
+                }
+
+                /**
+                 * The data of one OSMData blob. If the data was read
+                 * through the input queue, it is stored in the buffer,
+                 * otherwise it points into the input memory.
+                 */
+                struct data_blob {
+
+                    std::string buffer;
+                    const char* ptr = nullptr;
+                    size_t size = 0;
+
+                    const char* data() const noexcept {
+                        return ptr ? ptr : buffer.data();
                     }
 
-                    return static_cast<size_t>(blob_header.datasize());
+                }; // struct data_blob
+
+                /**
+                 * Read the next blob (which must be an OSMData blob).
+                 *
+                 * @returns false on EOF, true otherwise.
+                 */
+                bool read_data_blob(data_blob& blob) {
+                    blob.size = read_blob_header("OSMData");
+                    if (!blob.size) {
+                        return false;
+                    }
+
+                    if (m_input_queue) {
+                        blob.buffer = read_from_input_queue(blob.size);
+                        blob.ptr = nullptr;
+                    } else {
+                        blob.ptr = read_from_memory(blob.size);
+                    }
+
+                    return true;
                 }
 
-                void parse_osm_data(osmium::osm_entity_bits::type read_types) {
-                    osmium::thread::set_thread_name("_osmium_pbf_in");
-                    int n=0;
-                    while (auto size = read_blob_header("OSMData")) {
+                /**
+                 * Parse the blob and put the result into the queue.
+                 */
+                void submit_data_blob(data_blob&& blob) {
+                    // The size of the decoded data is not known yet, use
+                    // the uncompressed size of the blob as estimate.
+                    // DataBlobParser corrects this once it is done.
+                    const size_t estimated_size = uncompressed_blob_size(blob.data(), blob.size);
+                    m_budget.acquire(estimated_size);
+
+                    DataBlobParser data_blob_parser = blob.ptr ?
+                        DataBlobParser{blob.ptr, blob.size, m_options} :
+                        DataBlobParser{std::move(blob.buffer), m_options};
+                    data_blob_parser.set_budget(&m_budget, estimated_size);
+                    data_blob_parser.set_buffer_pool(m_buffer_pool);
+                    if (m_header.has_multiple_object_versions()) {
+                        data_blob_parser.set_raw_data_flags(pbf_raw_blob_history);
+                    }
 
-                        if (m_use_thread_pool) {
-                            m_queue.push(osmium::thread::Pool::instance().submit(DataBlobParser{read_from_input_queue(size), read_types}));
-                        } else {
-                            std::promise<osmium::memory::Buffer> promise;
-                            m_queue.push(promise.get_future());
-                            DataBlobParser data_blob_parser{read_from_input_queue(size), read_types};
-                            promise.set_value(data_blob_parser());
+                    if (m_use_thread_pool) {
+                        m_queue.push(m_options.thread_pool().submit(std::move(data_blob_parser)));
+                    } else {
+                        std::promise<osmium::memory::Buffer> promise;
+                        m_queue.push(promise.get_future());
+                        promise.set_value(data_blob_parser());
+                    }
+                }
+
+                /**
+                 * Parse the next blob (which must be an OSMData blob) and
+                 * put the result into the queue.
+                 *
+                 * @returns false on EOF, true otherwise.
+                 */
+                bool parse_next_blob() {
+                    data_blob blob;
+                    if (!read_data_blob(blob)) {
+                        return false;
+                    }
+                    submit_data_blob(std::move(blob));
+                    return true;
+                }
+
+                /**
+                 * Can a blob in a file sorted by type and ID, whose first
+                 * entity is of type first_type, contain entities of any of
+                 * the read_types? The blob can only contain entities of
+                 * types between its own first type and the first type of
+                 * the next blob (next_type).
+                 */
+                static bool blob_might_contain(osmium::item_type first_type, osmium::item_type next_type, osmium::osm_entity_bits::type read_types) noexcept {
+                    if (first_type == osmium::item_type::undefined) {
+                        return true;
+                    }
+                    if (next_type == osmium::item_type::undefined || next_type < first_type) {
+                        next_type = osmium::item_type::relation;
+                    }
+                    const auto lowest = static_cast<unsigned int>(osmium::osm_entity_bits::from_item_type(first_type));
+                    const auto highest = static_cast<unsigned int>(osmium::osm_entity_bits::from_item_type(next_type));
+                    return (((highest << 1) - lowest) & read_types) != 0;
+                }
+
+                /**
+                 * Parse the OSMData blobs of a file that is sorted by type
+                 * and ID. The first entity type in each blob is determined
+                 * by looking at its beginning. Blobs which can't contain
+                 * any of the read_types are skipped without being
+                 * uncompressed and reading stops when the file is past all
+                 * entity types we are interested in.
+                 */
+                void parse_sorted_blobs(osmium::osm_entity_bits::type read_types) {
+                    const auto wanted_types = read_types & osmium::osm_entity_bits::nwr;
+
+                    data_blob blob;
+                    if (!read_data_blob(blob)) {
+                        return;
+                    }
+                    osmium::item_type first_type = peek_first_item_type(blob.data(), blob.size);
+
+                    while (!m_done) {
+                        if (first_type != osmium::item_type::undefined &&
+                            osmium::osm_entity_bits::from_item_type(first_type) > wanted_types) {
+                            return;
+                        }
+
+                        data_blob next_blob;
+                        const bool has_next = read_data_blob(next_blob);
+                        const osmium::item_type next_type = has_next ? peek_first_item_type(next_blob.data(), next_blob.size) : osmium::item_type::undefined;
+
+                        if (blob_might_contain(first_type, next_type, wanted_types)) {
+                            submit_data_blob(std::move(blob));
                         }
-                        ++n;
 
-                        if (m_done) {
+                        if (!has_next) {
                             return;
                         }
+                        blob = std::move(next_blob);
+                        first_type = next_type;
                     }
+                }
+
+                void parse_osm_data(osmium::osm_entity_bits::type read_types) {
+                    osmium::thread::set_thread_name("_osmium_pbf_in");
+                    try {
+                        if (m_use_index) {
+                            // Only look at the blobs containing entities
+                            // we are interested in.
+                            for (const auto& blob : m_index) {
+                                if (!blob.contains(read_types)) {
+                                    continue;
+                                }
+                                // The index was checked against the file
+                                // size, make sure the blob is where the
+                                // index says it is.
+                                m_data = m_begin + blob.offset;
+                                if (!parse_next_blob() || m_data != m_begin + blob.offset + blob.size) {
+                                    throw osmium::pbf_error("PBF blob index does not match file");
+                                }
+                                if (m_done) {
+                                    return;
+                                }
+                            }
+                        } else if (m_header.get("sorting") == "Type_then_ID" &&
+                                   (read_types & osmium::osm_entity_bits::nwr) != osmium::osm_entity_bits::nwr) {
+                            parse_sorted_blobs(read_types);
+                            if (m_done) {
+                                return;
+                            }
+                        } else {
+                            while (parse_next_blob()) {
+                                if (m_done) {
+                                    return;
+                                }
+                            }
+                        }
+                        push_end_of_data();
+                    } catch (...) {
+                        push_end_of_data(std::current_exception());
+                    }
+
+                    // The end marker must be in the queue before m_done is
+                    // set, otherwise read() might miss it.
                     m_done = true;
                 }
 
+                void handle_header_and_start_reader() {
+                    // handle OSMHeader
+                    auto size = read_blob_header("OSMHeader");
+                    if (m_input_queue) {
+                        m_header = parse_header_blob(read_from_input_queue(size));
+                    } else {
+                        m_header = parse_header_blob(read_from_memory(size), size);
+
+                        const std::string index_filename = m_file.get("pbf_index");
+                        if (!index_filename.empty() && m_options.read_which_entities != osmium::osm_entity_bits::nothing) {
+                            m_index = load_or_build_pbf_blob_index(index_filename, m_begin, static_cast<size_t>(m_end - m_begin));
+                            m_use_index = true;
+                        }
+                    }
+
+                    if (m_options.read_which_entities != osmium::osm_entity_bits::nothing) {
+                        m_reader = std::thread(&PBFInputFormat::parse_osm_data, this, m_options.read_which_entities);
+                    }
+                }
+
+                /**
+                 * Wait for all outstanding results and throw them away.
+                 * Parser tasks might still be running in the thread pool
+                 * and they might reference the input memory, so we have to
+                 * make sure they are all done before we go away.
+                 */
+                void drain_queue() {
+                    std::future<osmium::memory::Buffer> buffer_future;
+                    while (m_queue.try_pop(buffer_future)) {
+                        if (buffer_future.valid()) {
+                            buffer_future.wait();
+                        }
+                    }
+                }
+
             public:
 
                 /**
                  * Instantiate PBF Parser
                  *
                  * @param file osmium::io::File instance describing file to be read from.
-                 * @param read_which_entities Which types of OSM entities (nodes, ways, relations, changesets) should be parsed?
+                 * @param options Options from the Reader (which entities to read etc.).
                  * @param input_queue String queue where data is read from.
                  */
-                PBFInputFormat(const osmium::io::File& file, osmium::osm_entity_bits::type read_which_entities, osmium::thread::Queue<std::string>& input_queue) :
-                    osmium::io::detail::InputFormat(file, read_which_entities),
+                PBFInputFormat(const osmium::io::File& file, const osmium::io::detail::reader_options& options, osmium::io::detail::input_queue_type& input_queue) :
+                    osmium::io::detail::InputFormat(file, options),
                     m_use_thread_pool(osmium::config::use_pool_threads_for_pbf_parsing()),
-                    m_queue(20, "pbf_parser_results"), // XXX
+                    m_queue(max_queue_size, "pbf_parser_results"),
                     m_done(false),
-                    m_input_queue(input_queue),
-                    m_input_buffer() {
-                    GOOGLE_PROTOBUF_VERIFY_VERSION;
-
-                    // handle OSMHeader
-                    auto size = read_blob_header("OSMHeader");
-                    m_header = parse_header_blob(read_from_input_queue(size));
+                    m_input_queue(&input_queue),
+                    m_input_buffer(),
+                    m_begin(nullptr),
+                    m_data(nullptr),
+                    m_end(nullptr),
+                    m_use_index(false),
+                    m_index() {
+                    handle_header_and_start_reader();
+                }
 
-                    if (m_read_which_entities != osmium::osm_entity_bits::nothing) {
-                        m_reader = std::thread(&PBFInputFormat::parse_osm_data, this, m_read_which_entities);
-                    }
+                /**
+                 * Instantiate PBF Parser reading from memory.
+                 *
+                 * @param file osmium::io::File instance describing file to be read from.
+                 * @param options Options from the Reader (which entities to read etc.).
+                 * @param data Pointer to the complete PBF file in memory. This
+                 *             memory must stay valid until this object is
+                 *             destructed.
+                 * @param size Size of the data.
+                 */
+                PBFInputFormat(const osmium::io::File& file, const osmium::io::detail::reader_options& options, const char* data, size_t size) :
+                    osmium::io::detail::InputFormat(file, options),
+                    m_use_thread_pool(osmium::config::use_pool_threads_for_pbf_parsing()),
+                    m_queue(max_queue_size, "pbf_parser_results"),
+                    m_done(false),
+                    m_input_queue(nullptr),
+                    m_input_buffer(),
+                    m_begin(data),
+                    m_data(data),
+                    m_end(data + size),
+                    m_use_index(false),
+                    m_index() {
+                    handle_header_and_start_reader();
                 }
 
                 ~PBFInputFormat() {
                     m_done = true;
+                    m_budget.shutdown(); // so the reader is not stuck waiting for the budget
+                    drain_queue(); // so the reader is not stuck on a full queue
                     if (m_reader.joinable()) {
                         m_reader.join();
                     }
+                    drain_queue();
                 }
 
                 /**
                  * Returns the next buffer with OSM data read from the PBF file.
                  * Blocks if data is not available yet.
-                 * Returns an empty buffer at end of input.
+                 * Returns an invalid buffer at end of input.
                  */
                 osmium::memory::Buffer read() override {
                     if (!m_done || !m_queue.empty()) {
                         std::future<osmium::memory::Buffer> buffer_future;
                         m_queue.wait_and_pop(buffer_future);
                         try {
-                            return buffer_future.get();
+                            osmium::memory::Buffer buffer = buffer_future.get();
+                            if (!buffer) {
+                                m_done = true;
+                            } else {
+                                m_budget.release(buffer.committed());
+                            }
+                            return buffer;
                         } catch (...) {
                             m_done = true;
                             throw;
@@ -230,8 +513,13 @@ namespace osmium {
             namespace {
 
                 const bool registered_pbf_input = osmium::io::detail::InputFormatFactory::instance().register_input_format(osmium::io::file_format::pbf,
-                    [](const osmium::io::File& file, osmium::osm_entity_bits::type read_which_entities, osmium::thread::Queue<std::string>& input_queue) {
-                        return new osmium::io::detail::PBFInputFormat(file, read_which_entities, input_queue);
+                    [](const osmium::io::File& file, const osmium::io::detail::reader_options& options, osmium::io::detail::input_queue_type& input_queue) {
+                        return new osmium::io::detail::PBFInputFormat(file, options, input_queue);
+                });
+
+                const bool registered_pbf_memory_input = osmium::io::detail::InputFormatFactory::instance().register_memory_input_format(osmium::io::file_format::pbf,
+                    [](const osmium::io::File& file, const osmium::io::detail::reader_options& options, const char* data, size_t size) {
+                        return new osmium::io::detail::PBFInputFormat(file, options, data, size);
                 });
 
             } // anonymous namespace
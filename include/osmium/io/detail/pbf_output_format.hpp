@@ -49,7 +49,8 @@ file contains multiple sequences of
  3. a Blob
 
 The BlobHeader tells the reader about the type and size of the following Blob. The
-Blob can contain data in raw or zlib-compressed form. After uncompressing the blob
+Blob can contain data in raw or zlib-compressed form (or zstd/lz4-compressed
+if support for those is compiled in, see pbf_compression below). After uncompressing the blob
 it is treated differently depending on the type specified in the BlobHeader.
 
 The contents of the Blob belongs to the higher level. It contains either an HeaderBlock
@@ -96,24 +97,32 @@ More complete outlines of real .osm.pbf files can be created using the osmpbf-ou
 */
 
 #include <algorithm>
+#include <array>
+#include <cassert>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <future>
-#include <iostream>
 #include <memory>
 #include <ratio>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <time.h>
 #include <utility>
 
-#include <osmium/handler.hpp>
 #include <osmium/io/detail/output_format.hpp>
 #include <osmium/io/detail/pbf.hpp> // IWYU pragma: export
 #include <osmium/io/detail/pbf_stringtable.hpp>
+#include <osmium/io/detail/protobuf.hpp>
 #include <osmium/io/detail/zlib.hpp>
+#ifdef OSMIUM_WITH_ZSTD
+# include <osmium/io/detail/zstd.hpp>
+#endif
+#ifdef OSMIUM_WITH_LZ4
+# include <osmium/io/detail/lz4.hpp>
+#endif
 #include <osmium/io/file.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
@@ -129,49 +138,83 @@ More complete outlines of real .osm.pbf files can be created using the osmpbf-ou
 #include <osmium/osm/timestamp.hpp>
 #include <osmium/osm/way.hpp>
 #include <osmium/util/cast.hpp>
-#include <osmium/visitor.hpp>
 
 namespace osmium {
 
+    /**
+     * Convert item_type into the PBF Relation.MemberType enum value.
+     */
+    inline int32_t item_type_to_osmpbf_membertype(const item_type type) {
+        switch (type) {
+            case item_type::node:
+                return 0;
+            case item_type::way:
+                return 1;
+            case item_type::relation:
+                return 2;
+            default:
+                throw std::runtime_error("Unknown relation member type");
+        }
+    }
+
     namespace io {
 
         namespace detail {
 
+            /**
+             * Compression used for the blobs in a PBF file.
+             */
+            enum class pbf_compression {
+                none,
+                zlib,
+                zstd,
+                lz4
+            }; // enum class pbf_compression
+
+            /**
+             * Get the PBF blob compression from the value of the
+             * "pbf_compression" file option. An empty value means the
+             * default zlib compression.
+             *
+             * @throws std::runtime_error If the compression type is unknown
+             *         or support for it was not compiled in.
+             */
+            inline pbf_compression get_pbf_compression(const std::string& value) {
+                if (value.empty() || value == "zlib" || value == "true") {
+                    return pbf_compression::zlib;
+                }
+                if (value == "none" || value == "false") {
+                    return pbf_compression::none;
+                }
+                if (value == "zstd") {
+#ifdef OSMIUM_WITH_ZSTD
+                    return pbf_compression::zstd;
+#else
+                    throw std::runtime_error("PBF compression 'zstd' not supported (compiled without zstd)");
+#endif
+                }
+                if (value == "lz4") {
+#ifdef OSMIUM_WITH_LZ4
+                    return pbf_compression::lz4;
+#else
+                    throw std::runtime_error("PBF compression 'lz4' not supported (compiled without lz4)");
+#endif
+                }
+                throw std::runtime_error(std::string("Unknown PBF compression '") + value + "'");
+            }
+
             namespace {
 
                 /**
-                 * Serialize a protobuf message into a Blob, optionally apply compression
-                 * and return it together with a BlobHeader ready to be written to a file.
-                 *
-                 * @param type Type-string used in the BlobHeader.
-                 * @param msg Protobuf-message.
-                 * @param use_compression Should the output be compressed using zlib?
+                 * Put a serialized Blob behind a BlobHeader with the given
+                 * type and the 4-byte size of the BlobHeader, ready to be
+                 * written to a file.
                  */
-                std::string serialize_blob(const std::string& type, const google::protobuf::MessageLite& msg, bool use_compression) {
-                    OSMPBF::Blob pbf_blob;
-
-                    {
-                        std::string content;
-                        msg.SerializeToString(&content);
-
-                        pbf_blob.set_raw_size(static_cast_with_assert<::google::protobuf::int32>(content.size()));
-
-                        if (use_compression) {
-                            pbf_blob.set_zlib_data(osmium::io::detail::zlib_compress(content));
-                        } else {
-                            pbf_blob.set_raw(content);
-                        }
-                    }
-
-                    std::string blob_data;
-                    pbf_blob.SerializeToString(&blob_data);
-
-                    OSMPBF::BlobHeader pbf_blob_header;
-                    pbf_blob_header.set_type(type);
-                    pbf_blob_header.set_datasize(static_cast_with_assert<::google::protobuf::int32>(blob_data.size()));
-
+                std::string frame_blob(const std::string& type, const std::string& blob_data) {
                     std::string blob_header_data;
-                    pbf_blob_header.SerializeToString(&blob_header_data);
+                    ProtobufWriter pbf_blob_header(blob_header_data);
+                    pbf_blob_header.add_bytes(1, type);
+                    pbf_blob_header.add_int32(3, static_cast_with_assert<int32_t>(blob_data.size()));
 
                     uint32_t sz = htonl(static_cast_with_assert<uint32_t>(blob_header_data.size()));
 
@@ -185,77 +228,54 @@ namespace osmium {
                     return output;
                 }
 
-            } // anonymous namespace
-
-            class PBFOutputFormat : public osmium::io::detail::OutputFormat, public osmium::handler::Handler {
-
-                /**
-                 * This class models a variable that keeps track of the value
-                 * it was last set to and returns the delta between old and
-                 * new value from the update() call.
-                 */
-                template <typename T>
-                class Delta {
-
-                    T m_value;
-
-                public:
-
-                    Delta() :
-                        m_value(0) {
-                    }
-
-                    void clear() {
-                        m_value = 0;
-                    }
-
-                    T update(T new_value) {
-                        using std::swap;
-                        swap(m_value, new_value);
-                        return m_value - new_value;
-                    }
-
-                }; // class Delta
-
                 /**
-                 * Maximum number of items in a primitive block.
+                 * Put the serialized contents of a protobuf message into a
+                 * Blob, optionally apply compression and return it together
+                 * with a BlobHeader ready to be written to a file.
                  *
-                 * The uncompressed length of a Blob *should* be less
-                 * than 16 megabytes and *must* be less than 32 megabytes.
-                 *
-                 * A block may contain any number of entities, as long as
-                 * the size limits for the surrounding blob are obeyed.
-                 * However, for simplicity, the current Osmosis (0.38)
-                 * as well as Osmium implementation always
-                 * uses at most 8k entities in a block.
-                 */
-                static constexpr uint32_t max_block_contents = 8000;
-
-                /**
-                 * The output buffer (block) will be filled to about
-                 * 95% and then written to disk. This leaves more than
-                 * enough space for the string table (which typically
-                 * needs about 0.1 to 0.3% of the block size).
+                 * @param type Type-string used in the BlobHeader.
+                 * @param content Serialized protobuf-message.
+                 * @param compression Compression used for the blob data.
                  */
-                static constexpr int64_t buffer_fill_percent = 95;
+                std::string serialize_blob(const std::string& type, const std::string& content, pbf_compression compression) {
+                    std::string blob_data;
+                    ProtobufWriter pbf_blob(blob_data);
+
+                    switch (compression) {
+                        case pbf_compression::none:
+                            pbf_blob.add_bytes(1, content);
+                            pbf_blob.add_int32(2, static_cast_with_assert<int32_t>(content.size()));
+                            break;
+                        case pbf_compression::zlib:
+                            pbf_blob.add_int32(2, static_cast_with_assert<int32_t>(content.size()));
+                            pbf_blob.add_bytes(3, osmium::io::detail::zlib_compress(content));
+                            break;
+#ifdef OSMIUM_WITH_ZSTD
+                        case pbf_compression::zstd:
+                            pbf_blob.add_int32(2, static_cast_with_assert<int32_t>(content.size()));
+                            pbf_blob.add_bytes(7, osmium::io::detail::zstd_compress(content));
+                            break;
+#endif
+#ifdef OSMIUM_WITH_LZ4
+                        case pbf_compression::lz4:
+                            pbf_blob.add_int32(2, static_cast_with_assert<int32_t>(content.size()));
+                            pbf_blob.add_bytes(6, osmium::io::detail::lz4_compress(content));
+                            break;
+#endif
+                        default:
+                            break;
+                    }
 
-                /**
-                 * protobuf-struct of a HeaderBlock
-                 */
-                OSMPBF::HeaderBlock pbf_header_block;
+                    return frame_blob(type, blob_data);
+                }
 
-                /**
-                 * protobuf-struct of a PrimitiveBlock
-                 */
-                OSMPBF::PrimitiveBlock pbf_primitive_block;
+            } // anonymous namespace
 
-                /**
-                 * pointer to PrimitiveGroups inside the current PrimitiveBlock,
-                 * used for writing nodes, ways or relations
-                 */
-                OSMPBF::PrimitiveGroup* pbf_nodes;
-                OSMPBF::PrimitiveGroup* pbf_ways;
-                OSMPBF::PrimitiveGroup* pbf_relations;
+            /**
+             * Settings for encoding PBF primitive blocks. They are the same
+             * for all blocks in a file.
+             */
+            struct pbf_block_options {
 
                 /**
                  * To flexibly handle multiple resolutions, the granularity, or
@@ -264,446 +284,650 @@ namespace osmium {
                  * nanodegrees, corresponding to about ~1cm at the equator.
                  * This is the current resolution of the OSM database.
                  */
-                int m_location_granularity;
+                int location_granularity = 100;
 
                 /**
                  * The granularity used for representing timestamps is also adjustable in
                  * multiples of 1 millisecond. The default scaling factor is 1000
                  * milliseconds, which is the current resolution of the OSM database.
                  */
-                int m_date_granularity;
+                int date_granularity = 1000;
 
                 /**
                  * should nodes be serialized into the dense format?
                  *
                  * nodes can be encoded one of two ways, as a Node
-                 * (m_use_dense_nodes = false) and a special dense format.
+                 * (use_dense_nodes = false) and a special dense format.
                  * In the dense format, all information is stored 'column wise',
                  * as an array of ID's, array of latitudes, and array of
                  * longitudes. Each column is delta-encoded. This reduces
                  * header overheads and allows delta-coding to work very effectively.
                  */
-                bool m_use_dense_nodes {true};
+                bool use_dense_nodes = true;
 
                 /**
-                 * should the PBF blobs contain zlib compressed data?
+                 * how should the PBF blobs be compressed?
                  *
-                 * the zlib compression is optional, it's possible to store the
+                 * the compression is optional, it's possible to store the
                  * blobs in raw format. Disabling the compression can improve the
                  * writing speed a little but the output will be 2x to 3x bigger.
+                 * zstd and lz4 (if compiled in) uncompress much faster than
+                 * zlib, but many other programs can't read them.
                  */
-                bool m_use_compression {true};
+                pbf_compression compression = pbf_compression::zlib;
 
                 /**
                  * While the .osm.pbf-format is able to carry all meta information, it is
                  * also able to omit this information to reduce size.
                  */
-                bool m_should_add_metadata {true};
+                bool add_metadata = true;
 
                 /**
                  * Should the visible flag be added on objects?
                  */
-                bool m_add_visible;
+                bool add_visible = false;
+
+            }; // struct pbf_block_options
+
+            /**
+             * Encodes the OSM objects in a buffer into one PrimitiveBlock
+             * and serializes it into a (compressed) blob.
+             *
+             * The objects are read twice: First all strings are recorded
+             * in the string table, then the block is written out directly
+             * in the protobuf format with the final string ids. Each
+             * column of the DenseNodes is written in a separate pass over
+             * the nodes, so no intermediate copy of the data is needed.
+             */
+            class PBFPrimitiveBlockEncoder {
 
                 /**
-                 * counter used to quickly check the number of objects stored inside
-                 * the current PrimitiveBlock. When the counter reaches max_block_contents
-                 * the PrimitiveBlock is serialized into a Blob and flushed to the file.
-                 *
-                 * this check is performed in check_block_contents_counter() which is
-                 * called once for each object.
-                 */
-                uint16_t primitive_block_contents;
-                int primitive_block_size;
-
-                // StringTable management
-                StringTable string_table;
-
-                /**
-                 * These variables are used to calculate the
-                 * delta-encoding while storing dense-nodes. It holds the last seen values
-                 * from which the difference is stored into the protobuf.
+                 * This class models a variable that keeps track of the value
+                 * it was last set to and returns the delta between old and
+                 * new value from the update() call.
                  */
-                Delta<int64_t> m_delta_id;
-                Delta<int64_t> m_delta_lat;
-                Delta<int64_t> m_delta_lon;
-                Delta<int64_t> m_delta_timestamp;
-                Delta<int64_t> m_delta_changeset;
-                Delta<int64_t> m_delta_uid;
-                Delta<::google::protobuf::int32> m_delta_user_sid;
-
-                bool debug;
-
-                bool has_debug_level(int) {
-                    return false;
-                }
-
-                ///// Blob writing /////
-
-                /**
-                 * Before a PrimitiveBlock gets serialized, all interim StringTable-ids needs to be
-                 * mapped to the associated real StringTable ids. This is done in this function.
-                 *
-                 * This function needs to know about the concrete structure of all item types to find
-                 * all occurrences of string-ids.
-                 */
-                void map_string_ids() {
-                    // test, if the node-block has been allocated
-                    if (pbf_nodes) {
-                        // iterate over all nodes, passing them to the map_common_string_ids function
-                        for (int i=0, l=pbf_nodes->nodes_size(); i<l; ++i) {
-                            map_common_string_ids(pbf_nodes->mutable_nodes(i));
-                        }
+                template <typename T>
+                class Delta {
 
-                        // test, if the node-block has a densenodes structure
-                        if (pbf_nodes->has_dense()) {
-                            // get a pointer to the densenodes structure
-                            OSMPBF::DenseNodes* dense = pbf_nodes->mutable_dense();
-
-                            // in the densenodes structure keys and vals are encoded in an intermixed
-                            // array, individual nodes are seperated by a value of 0 (0 in the StringTable
-                            // is always unused). String-ids of 0 are thus kept alone.
-                            for (int i=0, l=dense->keys_vals_size(); i<l; ++i) {
-                                // map interim string-ids > 0 to real string ids
-                                auto sid = dense->keys_vals(i);
-                                if (sid > 0) {
-                                    dense->set_keys_vals(i, string_table.map_string_id(sid));
-                                }
-                            }
+                    T m_value;
 
-                            // test if the densenodes block has meta infos
-                            if (dense->has_denseinfo()) {
-                                // get a pointer to the denseinfo structure
-                                OSMPBF::DenseInfo* denseinfo = dense->mutable_denseinfo();
+                public:
 
-                                // iterate over all username string-ids
-                                for (int i=0, l=denseinfo->user_sid_size(); i<l; ++i) {
-                                    // map interim string-ids > 0 to real string ids
-                                    auto user_sid = string_table.map_string_id(denseinfo->user_sid(i));
+                    Delta() :
+                        m_value(0) {
+                    }
 
-                                    // delta encode the string-id
-                                    denseinfo->set_user_sid(i, m_delta_user_sid.update(user_sid));
-                                }
-                            }
-                        }
+                    void clear() {
+                        m_value = 0;
                     }
 
-                    // test, if the ways-block has been allocated
-                    if (pbf_ways) {
-                        // iterate over all ways, passing them to the map_common_string_ids function
-                        for (int i=0, l=pbf_ways->ways_size(); i<l; ++i) {
-                            map_common_string_ids(pbf_ways->mutable_ways(i));
-                        }
+                    T update(T new_value) {
+                        using std::swap;
+                        swap(m_value, new_value);
+                        return m_value - new_value;
                     }
 
-                    // test, if the relations-block has been allocated
-                    if (pbf_relations) {
-                        // iterate over all relations
-                        for (int i=0, l=pbf_relations->relations_size(); i<l; ++i) {
-                            // get a pointer to the relation
-                            OSMPBF::Relation* relation = pbf_relations->mutable_relations(i);
+                }; // class Delta
 
-                            // pass them to the map_common_string_ids function
-                            map_common_string_ids(relation);
+                const pbf_block_options& m_options;
 
-                            // iterate over all relation members, mapping the interim string-ids
-                            // of the role to real string ids
-                            for (int mi=0; mi < relation->roles_sid_size(); ++mi) {
-                                relation->set_roles_sid(mi, string_table.map_string_id(relation->roles_sid(mi)));
-                            }
-                        }
-                    }
-                }
+                const osmium::memory::Buffer& m_buffer;
 
-                /**
-                * a helper function used in map_string_ids to map common interim string-ids of the
-                * user name and all tags to real string ids.
-                *
-                * TPBFObject is either OSMPBF::Node, OSMPBF::Way or OSMPBF::Relation.
-                */
-                template <class TPBFObject>
-                void map_common_string_ids(TPBFObject* in) {
-                    // if the object has meta-info attached
-                    if (in->has_info()) {
-                        // map the interim-id of the user name to a real id
-                        OSMPBF::Info* info = in->mutable_info();
-                        info->set_user_sid(string_table.map_string_id(info->user_sid()));
-                    }
-
-                    // iterate over all tags and map the interim-ids of the key and the value to real ids
-                    for (int i=0, l=in->keys_size(); i<l; ++i) {
-                        in->set_keys(i, string_table.map_string_id(in->keys(i)));
-                        in->set_vals(i, string_table.map_string_id(in->vals(i)));
-                    }
-                }
+                // StringTable management
+                StringTable& m_string_table;
 
+                /**
+                 * The encoded PrimitiveBlock.
+                 */
+                ProtobufWriter m_pbf;
 
-                ///// MetaData helper /////
+                /**
+                 * Types of the PrimitiveGroups in the block in the order
+                 * in which the first object of each type was found.
+                 */
+                std::array<osmium::item_type, 3> m_group_types;
+                size_t m_num_groups;
 
                 /**
                  * convert a double lat or lon value to an int, respecting the current blocks granularity
                  */
                 int64_t lonlat2int(double lonlat) {
-                    return static_cast<int64_t>(std::round(lonlat * OSMPBF::lonlat_resolution / location_granularity()));
+                    return static_cast<int64_t>(std::round(lonlat * lonlat_resolution / m_options.location_granularity));
                 }
 
                 /**
                  * convert a timestamp to an int, respecting the current blocks granularity
                  */
                 int64_t timestamp2int(time_t timestamp) {
-                    return static_cast<int64_t>(std::round(timestamp * (1000.0 / date_granularity())));
+                    return static_cast<int64_t>(std::round(timestamp * (1000.0 / m_options.date_granularity)));
                 }
 
                 /**
-                 * helper function used in the write()-calls to apply common information from an osmium-object
-                 * onto a pbf-object.
-                 *
-                 * TPBFObject is either OSMPBF::Node, OSMPBF::Way or OSMPBF::Relation.
+                 * Record the strings of the tags of an object, first all
+                 * keys, then all values, as they are written by write_tags().
                  */
-                template <class TPBFObject>
-                void apply_common_info(const osmium::OSMObject& in, TPBFObject* out) {
-                    // set the object-id
-                    out->set_id(in.id());
+                void record_tags(const osmium::OSMObject& object) {
+                    for (const auto& tag : object.tags()) {
+                        m_string_table.record_string(tag.key());
+                    }
+                    for (const auto& tag : object.tags()) {
+                        m_string_table.record_string(tag.value());
+                    }
+                }
 
-                    // iterate over all tags and set the keys and vals, recording the strings in the
-                    // interim StringTable and storing the interim ids
-                    for (const auto& tag : in.tags()) {
-                        out->add_keys(string_table.record_string(tag.key()));
-                        out->add_vals(string_table.record_string(tag.value()));
+                void record_user(const osmium::OSMObject& object) {
+                    if (m_options.add_metadata) {
+                        m_string_table.record_string(object.user());
                     }
+                }
 
-                    if (m_should_add_metadata) {
-                        // add an info-section to the pbf object and set the meta-info on it
-                        OSMPBF::Info* out_info = out->mutable_info();
-                        if (m_add_visible) {
-                            out_info->set_visible(in.visible());
+                /**
+                 * Find out which PrimitiveGroups are needed and record all
+                 * strings used by the objects in the block in the interim
+                 * StringTable.
+                 *
+                 * The strings are recorded in exactly the order in which
+                 * the write_*() functions need their ids, so they can get
+                 * them from the StringTable without looking up the strings
+                 * again.
+                 */
+                void record_strings() {
+                    for (const auto& item : m_buffer) {
+                        const auto type = item.type();
+                        if (type != osmium::item_type::node && type != osmium::item_type::way && type != osmium::item_type::relation) {
+                            continue;
+                        }
+                        if (std::find(m_group_types.begin(), m_group_types.begin() + m_num_groups, type) == m_group_types.begin() + m_num_groups) {
+                            m_group_types[m_num_groups++] = type;
                         }
-                        out_info->set_version(static_cast<::google::protobuf::int32>(in.version()));
-                        out_info->set_timestamp(timestamp2int(in.timestamp()));
-                        out_info->set_changeset(in.changeset());
-                        out_info->set_uid(static_cast<::google::protobuf::int32>(in.uid()));
-                        out_info->set_user_sid(string_table.record_string(in.user()));
                     }
-                }
 
+                    for (size_t i = 0; i < m_num_groups; ++i) {
+                        switch (m_group_types[i]) {
+                            case osmium::item_type::node:
+                                if (m_options.use_dense_nodes) {
+                                    // user column first, then keys_vals column
+                                    for (auto it = m_buffer.cbegin<osmium::Node>(); it != m_buffer.cend<osmium::Node>(); ++it) {
+                                        record_user(*it);
+                                    }
+                                    for (auto it = m_buffer.cbegin<osmium::Node>(); it != m_buffer.cend<osmium::Node>(); ++it) {
+                                        for (const auto& tag : it->tags()) {
+                                            m_string_table.record_string(tag.key());
+                                            m_string_table.record_string(tag.value());
+                                        }
+                                    }
+                                } else {
+                                    for (auto it = m_buffer.cbegin<osmium::Node>(); it != m_buffer.cend<osmium::Node>(); ++it) {
+                                        record_tags(*it);
+                                        record_user(*it);
+                                    }
+                                }
+                                break;
+                            case osmium::item_type::way:
+                                for (auto it = m_buffer.cbegin<osmium::Way>(); it != m_buffer.cend<osmium::Way>(); ++it) {
+                                    record_tags(*it);
+                                    record_user(*it);
+                                }
+                                break;
+                            default:
+                                for (auto it = m_buffer.cbegin<osmium::Relation>(); it != m_buffer.cend<osmium::Relation>(); ++it) {
+                                    record_tags(*it);
+                                    record_user(*it);
+                                    for (const auto& member : it->members()) {
+                                        m_string_table.record_string(member.role());
+                                    }
+                                }
+                                break;
+                        }
+                    }
+                }
 
-                ///// High-Level Block writing /////
+                /**
+                 * Write a packed repeated field with one value for each
+                 * node in the block. The function gets the node and has
+                 * to add the value with m_pbf.add_varint().
+                 */
+                template <typename TFunction>
+                void write_dense_column(uint32_t tag, TFunction&& func) {
+                    const auto pos = m_pbf.open_submessage(tag);
+                    for (auto it = m_buffer.cbegin<osmium::Node>(); it != m_buffer.cend<osmium::Node>(); ++it) {
+                        func(*it);
+                    }
+                    m_pbf.close_submessage(pos);
+                }
 
                 /**
-                 * store the current pbf_header_block into a Blob and clear this struct afterwards.
+                 * helper function used in the write()-calls to write the tags
+                 * of an osmium-object as keys and vals fields of a Node, Way,
+                 * or Relation.
                  */
-                void store_header_block() {
-                    if (debug && has_debug_level(1)) {
-                        std::cerr << "storing header block" << std::endl;
+                void write_tags(const osmium::OSMObject& object) {
+                    if (object.tags().empty()) {
+                        return;
                     }
 
-                    std::promise<std::string> promise;
-                    m_output_queue.push(promise.get_future());
-                    promise.set_value(serialize_blob("OSMHeader", pbf_header_block, m_use_compression));
+                    auto pos = m_pbf.open_submessage(2);
+                    for (const auto& tag : object.tags()) {
+                        m_pbf.add_varint(m_string_table.string_id());
+                    }
+                    m_pbf.close_submessage(pos);
 
-                    pbf_header_block.Clear();
+                    pos = m_pbf.open_submessage(3);
+                    for (const auto& tag : object.tags()) {
+                        m_pbf.add_varint(m_string_table.string_id());
+                    }
+                    m_pbf.close_submessage(pos);
                 }
 
                 /**
-                 * store the interim StringTable to the current pbf_primitive_block, map all interim string ids
-                 * to real StringTable ids and then store the current pbf_primitive_block into a Blob and clear
-                 * this struct and all related pointers and maps afterwards.
+                 * helper function used in the write()-calls to write the meta
+                 * information of an osmium-object as Info message.
                  */
-                void store_primitive_block() {
-                    if (debug && has_debug_level(1)) {
-                        std::cerr << "storing primitive block with " << primitive_block_contents << " items" << std::endl;
+                void write_info(const osmium::OSMObject& object) {
+                    if (!m_options.add_metadata) {
+                        return;
                     }
 
-                    // set the granularity
-                    pbf_primitive_block.set_granularity(location_granularity());
-                    pbf_primitive_block.set_date_granularity(date_granularity());
+                    const auto pos = m_pbf.open_submessage(4);
+                    m_pbf.add_int32(1, static_cast<int32_t>(object.version()));
+                    m_pbf.add_int64(2, timestamp2int(object.timestamp()));
+                    m_pbf.add_int64(3, object.changeset());
+                    m_pbf.add_int32(4, static_cast<int32_t>(object.uid()));
+                    m_pbf.add_uint32(5, m_string_table.string_id());
+                    if (m_options.add_visible) {
+                        m_pbf.add_bool(6, object.visible());
+                    }
+                    m_pbf.close_submessage(pos);
+                }
 
-                    // store the interim StringTable into the protobuf object
-                    string_table.store_stringtable(pbf_primitive_block.mutable_stringtable());
+                /**
+                 * Add all nodes to the PrimitiveGroup, one Node message
+                 * for each.
+                 */
+                void write_nodes() {
+                    for (auto it = m_buffer.cbegin<osmium::Node>(); it != m_buffer.cend<osmium::Node>(); ++it) {
+                        const auto pos = m_pbf.open_submessage(1);
+                        m_pbf.add_sint64(1, it->id());
+                        write_tags(*it);
+                        write_info(*it);
+
+                        // modify lat & lon to integers, respecting the block's granularity
+                        m_pbf.add_sint64(8, lonlat2int(it->location().lat_without_check()));
+                        m_pbf.add_sint64(9, lonlat2int(it->location().lon_without_check()));
+                        m_pbf.close_submessage(pos);
+                    }
+                }
 
-                    // map all interim string ids to real ids
-                    map_string_ids();
+                /**
+                 * Add all nodes to the PrimitiveGroup using DenseNodes.
+                 *
+                 * In the dense format all values are stored in columns
+                 * and most of them are delta encoded.
+                 */
+                void write_dense_nodes() {
+                    const auto pos = m_pbf.open_submessage(2);
 
-                    std::promise<std::string> promise;
-                    m_output_queue.push(promise.get_future());
-                    promise.set_value(serialize_blob("OSMData", pbf_primitive_block, m_use_compression));
+                    Delta<int64_t> delta_id;
+                    write_dense_column(1, [this, &delta_id](const osmium::Node& node) {
+                        m_pbf.add_varint(encode_zigzag64(delta_id.update(node.id())));
+                    });
+
+                    if (m_options.add_metadata) {
+                        const auto info_pos = m_pbf.open_submessage(5);
+
+                        write_dense_column(1, [this](const osmium::Node& node) {
+                            m_pbf.add_varint(static_cast<uint64_t>(static_cast<int32_t>(node.version())));
+                        });
+
+                        Delta<int64_t> delta_timestamp;
+                        write_dense_column(2, [this, &delta_timestamp](const osmium::Node& node) {
+                            m_pbf.add_varint(encode_zigzag64(delta_timestamp.update(timestamp2int(node.timestamp()))));
+                        });
+
+                        Delta<int64_t> delta_changeset;
+                        write_dense_column(3, [this, &delta_changeset](const osmium::Node& node) {
+                            m_pbf.add_varint(encode_zigzag64(delta_changeset.update(node.changeset())));
+                        });
+
+                        Delta<int64_t> delta_uid;
+                        write_dense_column(4, [this, &delta_uid](const osmium::Node& node) {
+                            m_pbf.add_varint(encode_zigzag32(static_cast<int32_t>(delta_uid.update(node.uid()))));
+                        });
+
+                        Delta<int32_t> delta_user_sid;
+                        write_dense_column(5, [this, &delta_user_sid](const osmium::Node& node) {
+                            const auto user_sid = static_cast<int32_t>(m_string_table.string_id());
+                            m_pbf.add_varint(encode_zigzag32(delta_user_sid.update(user_sid)));
+                        });
+
+                        if (m_options.add_visible) {
+                            write_dense_column(6, [this](const osmium::Node& node) {
+                                m_pbf.add_varint(node.visible() ? 1 : 0);
+                            });
+                        }
 
-                    // clear the PrimitiveBlock struct
-                    pbf_primitive_block.Clear();
+                        m_pbf.close_submessage(info_pos);
+                    }
 
-                    // clear the interim StringTable and its id map
-                    string_table.clear();
+                    Delta<int64_t> delta_lat;
+                    write_dense_column(8, [this, &delta_lat](const osmium::Node& node) {
+                        m_pbf.add_varint(encode_zigzag64(delta_lat.update(lonlat2int(node.location().lat_without_check()))));
+                    });
 
-                    // reset the delta variables
-                    m_delta_id.clear();
-                    m_delta_lat.clear();
-                    m_delta_lon.clear();
-                    m_delta_timestamp.clear();
-                    m_delta_changeset.clear();
-                    m_delta_uid.clear();
-                    m_delta_user_sid.clear();
+                    Delta<int64_t> delta_lon;
+                    write_dense_column(9, [this, &delta_lon](const osmium::Node& node) {
+                        m_pbf.add_varint(encode_zigzag64(delta_lon.update(lonlat2int(node.location().lon_without_check()))));
+                    });
 
-                    // reset the contents-counter to zero
-                    primitive_block_contents = 0;
-                    primitive_block_size = 0;
+                    // in the densenodes structure keys and vals are encoded in an intermixed
+                    // array, individual nodes are seperated by a value of 0 (0 in the StringTable
+                    // is always unused)
+                    // so for three nodes the keys_vals array may look like this: 3 5 2 1 0 0 8 5 0
+                    // the first node has two tags (3=>5 and 2=>1), the second node does not
+                    // have any tags and the third node has a single tag (8=>5)
+                    write_dense_column(10, [this](const osmium::Node& node) {
+                        for (const auto& tag : node.tags()) {
+                            m_pbf.add_varint(m_string_table.string_id());
+                            m_pbf.add_varint(m_string_table.string_id());
+                        }
+                        m_pbf.add_varint(0);
+                    });
 
-                    // reset the node/way/relation pointers to nullptr
-                    pbf_nodes = nullptr;
-                    pbf_ways = nullptr;
-                    pbf_relations = nullptr;
+                    m_pbf.close_submessage(pos);
                 }
 
                 /**
-                 * this little function checks primitive_block_contents counter against its maximum and calls
-                 * store_primitive_block to flush the block to the disk when it's reached. It's also responsible
-                 * for increasing this counter.
-                 *
-                 * this function also checks the estimated size of the current block and calls store_primitive_block
-                 * when the estimated size reaches buffer_fill_percent of the maximum uncompressed blob size.
+                 * Add all ways to the PrimitiveGroup.
                  */
-                void check_block_contents_counter() {
-                    if (primitive_block_contents >= max_block_contents) {
-                        store_primitive_block();
-                    } else if (primitive_block_size > OSMPBF::max_uncompressed_blob_size * buffer_fill_percent / 100) {
-                        if (debug && has_debug_level(1)) {
-                            std::cerr << "storing primitive_block with only " << primitive_block_contents << " items, because its ByteSize (" << primitive_block_size << ") reached " <<
-                                      (static_cast<float>(primitive_block_size) / static_cast<float>(OSMPBF::max_uncompressed_blob_size) * 100.0) << "% of the maximum blob-size" << std::endl;
+                void write_ways() {
+                    for (auto it = m_buffer.cbegin<osmium::Way>(); it != m_buffer.cend<osmium::Way>(); ++it) {
+                        const auto pos = m_pbf.open_submessage(3);
+                        m_pbf.add_int64(1, it->id());
+                        write_tags(*it);
+                        write_info(*it);
+
+                        if (!it->nodes().empty()) {
+                            // last way-node-id used for delta-encoding
+                            Delta<int64_t> delta_id;
+
+                            const auto refs_pos = m_pbf.open_submessage(8);
+                            for (const auto& node_ref : it->nodes()) {
+                                m_pbf.add_varint(encode_zigzag64(delta_id.update(node_ref.ref())));
+                            }
+                            m_pbf.close_submessage(refs_pos);
                         }
 
-                        store_primitive_block();
+                        m_pbf.close_submessage(pos);
                     }
-
-                    ++primitive_block_contents;
                 }
 
-
-                ///// Block content writing /////
-
                 /**
-                 * Add a node to the block.
-                 *
-                 * @param node The node to add.
+                 * Add all relations to the PrimitiveGroup.
                  */
-                void write_node(const osmium::Node& node) {
-                    // add a way to the group
-                    OSMPBF::Node* pbf_node = pbf_nodes->add_nodes();
+                void write_relations() {
+                    for (auto it = m_buffer.cbegin<osmium::Relation>(); it != m_buffer.cend<osmium::Relation>(); ++it) {
+                        const auto pos = m_pbf.open_submessage(4);
+                        m_pbf.add_int64(1, it->id());
+                        write_tags(*it);
+                        write_info(*it);
+
+                        if (!it->members().empty()) {
+                            // the roles of the members
+                            auto members_pos = m_pbf.open_submessage(8);
+                            for (const auto& member : it->members()) {
+                                m_pbf.add_varint(m_string_table.string_id());
+                            }
+                            m_pbf.close_submessage(members_pos);
+
+                            // the member ids, delta encoded
+                            Delta<int64_t> delta_id;
+                            members_pos = m_pbf.open_submessage(9);
+                            for (const auto& member : it->members()) {
+                                m_pbf.add_varint(encode_zigzag64(delta_id.update(member.ref())));
+                            }
+                            m_pbf.close_submessage(members_pos);
 
-                    // copy the common meta-info from the osmium-object to the pbf-object
-                    apply_common_info(node, pbf_node);
+                            // the member types, mapped to the OSMPBF enum
+                            members_pos = m_pbf.open_submessage(10);
+                            for (const auto& member : it->members()) {
+                                m_pbf.add_varint(static_cast<uint64_t>(item_type_to_osmpbf_membertype(member.type())));
+                            }
+                            m_pbf.close_submessage(members_pos);
+                        }
 
-                    // modify lat & lon to integers, respecting the block's granularity and copy
-                    // the ints to the pbf-object
-                    pbf_node->set_lon(lonlat2int(node.location().lon_without_check()));
-                    pbf_node->set_lat(lonlat2int(node.location().lat_without_check()));
+                        m_pbf.close_submessage(pos);
+                    }
                 }
 
+            public:
+
                 /**
-                 * Add a node to the block using DenseNodes.
-                 *
-                 * @param node The node to add.
+                 * Create encoder for the objects in the buffer. The string
+                 * table must be empty, it is given from outside so its
+                 * memory can be reused. The block is written into data.
                  */
-                void write_dense_node(const osmium::Node& node) {
-                    // add a DenseNodes-Section to the PrimitiveGroup
-                    OSMPBF::DenseNodes* dense = pbf_nodes->mutable_dense();
-
-                    // copy the id, delta encoded
-                    dense->add_id(m_delta_id.update(node.id()));
-
-                    // copy the longitude, delta encoded
-                    dense->add_lon(m_delta_lon.update(lonlat2int(node.location().lon_without_check())));
+                PBFPrimitiveBlockEncoder(const pbf_block_options& options, const osmium::memory::Buffer& buffer, StringTable& table, std::string& data) :
+                    m_options(options),
+                    m_buffer(buffer),
+                    m_string_table(table),
+                    m_pbf(data),
+                    m_group_types(),
+                    m_num_groups(0) {
+                }
 
-                    // copy the latitude, delta encoded
-                    dense->add_lat(m_delta_lat.update(lonlat2int(node.location().lat_without_check())));
+                PBFPrimitiveBlockEncoder(const PBFPrimitiveBlockEncoder&) = delete;
+                PBFPrimitiveBlockEncoder& operator=(const PBFPrimitiveBlockEncoder&) = delete;
 
-                    // in the densenodes structure keys and vals are encoded in an intermixed
-                    // array, individual nodes are seperated by a value of 0 (0 in the StringTable
-                    // is always unused)
-                    // so for three nodes the keys_vals array may look like this: 3 5 2 1 0 0 8 5
-                    // the first node has two tags (3=>5 and 2=>1), the second node does not
-                    // have any tags and the third node has a single tag (8=>5)
-                    for (const auto& tag : node.tags()) {
-                        dense->add_keys_vals(string_table.record_string(tag.key()));
-                        dense->add_keys_vals(string_table.record_string(tag.value()));
+                /**
+                 * Encode the block. Afterwards the serialized PrimitiveBlock
+                 * is in the data string given to the constructor.
+                 */
+                void encode() {
+                    record_strings();
+
+                    // store the interim StringTable into the block, after
+                    // that the real string ids are known
+                    const auto pos = m_pbf.open_submessage(1);
+                    m_string_table.store_stringtable(m_pbf);
+                    m_pbf.close_submessage(pos);
+
+                    for (size_t i = 0; i < m_num_groups; ++i) {
+                        const auto group_pos = m_pbf.open_submessage(2);
+                        switch (m_group_types[i]) {
+                            case osmium::item_type::node:
+                                if (m_options.use_dense_nodes) {
+                                    write_dense_nodes();
+                                } else {
+                                    write_nodes();
+                                }
+                                break;
+                            case osmium::item_type::way:
+                                write_ways();
+                                break;
+                            default:
+                                write_relations();
+                                break;
+                        }
+                        m_pbf.close_submessage(group_pos);
                     }
-                    dense->add_keys_vals(0);
 
-                    if (m_should_add_metadata) {
-                        // add a DenseInfo-Section to the PrimitiveGroup
-                        OSMPBF::DenseInfo* denseinfo = dense->mutable_denseinfo();
+                    assert(m_string_table.all_ids_used());
 
-                        denseinfo->add_version(static_cast<::google::protobuf::int32>(node.version()));
+                    // set the granularity
+                    m_pbf.add_int32(17, m_options.location_granularity);
+                    m_pbf.add_int32(18, m_options.date_granularity);
+                }
 
-                        if (m_add_visible) {
-                            denseinfo->add_visible(node.visible());
-                        }
+            }; // class PBFPrimitiveBlockEncoder
 
-                        // copy the timestamp, delta encoded
-                        denseinfo->add_timestamp(m_delta_timestamp.update(timestamp2int(node.timestamp())));
+            /**
+             * Pool task encoding the objects in a buffer into one
+             * PrimitiveBlock.
+             */
+            struct PBFEncodeBlock {
 
-                        // copy the changeset, delta encoded
-                        denseinfo->add_changeset(m_delta_changeset.update(node.changeset()));
+                osmium::memory::Buffer buffer;
+                pbf_block_options options;
 
-                        // copy the user id, delta encoded
-                        denseinfo->add_uid(static_cast<::google::protobuf::int32>(m_delta_uid.update(node.uid())));
+                std::string operator()() {
+                    // the string table and the memory for the encoded
+                    // block are reused for all blocks encoded in a thread
+                    static thread_local StringTable string_table;
+                    static thread_local std::string data;
+                    string_table.clear();
+                    data.clear();
 
-                        // record the user-name to the interim stringtable and copy the
-                        // interim string-id to the pbf-object
-                        denseinfo->add_user_sid(string_table.record_string(node.user()));
-                    }
+                    PBFPrimitiveBlockEncoder encoder(options, buffer, string_table, data);
+                    encoder.encode();
+                    return serialize_blob("OSMData", data, options.compression);
                 }
 
+            }; // struct PBFEncodeBlock
+
+            /**
+             * Writes PBF files. The objects are cut into blocks of at most
+             * max_block_contents objects in the calling thread, the blocks
+             * are then encoded and compressed in the thread pool. Buffers
+             * that still carry the blob they were read from are written
+             * out as that blob.
+             */
+            class PBFOutputFormat : public osmium::io::detail::OutputFormat {
+
                 /**
-                 * Add a way to the block.
+                 * Maximum number of items in a primitive block.
                  *
-                 * @param way The way to add.
+                 * The uncompressed length of a Blob *should* be less
+                 * than 16 megabytes and *must* be less than 32 megabytes.
+                 *
+                 * A block may contain any number of entities, as long as
+                 * the size limits for the surrounding blob are obeyed.
+                 * However, for simplicity, the current Osmosis (0.38)
+                 * as well as Osmium implementation always
+                 * uses at most 8k entities in a block.
                  */
-                void write_way(const osmium::Way& way) {
-                    // add a way to the group
-                    OSMPBF::Way* pbf_way = pbf_ways->add_ways();
+                static constexpr uint32_t max_block_contents = 8000;
 
-                    // copy the common meta-info from the osmium-object to the pbf-object
-                    apply_common_info(way, pbf_way);
+                /**
+                 * A block is written when the objects in it take up more than
+                 * this percentage of the maximum uncompressed blob size in
+                 * memory. The encoded block is always smaller than that.
+                 */
+                static constexpr int64_t buffer_fill_percent = 95;
 
-                    // last way-node-id used for delta-encoding
-                    Delta<int64_t> delta_id;
+                /**
+                 * Initial size of the buffers collecting the objects for a
+                 * block.
+                 */
+                static constexpr size_t initial_block_buffer_size = 1024 * 1024;
 
-                    for (const auto& node_ref : way.nodes()) {
-                        // copy the way-node-id, delta encoded
-                        pbf_way->add_refs(delta_id.update(node_ref.ref()));
-                    }
+                pbf_block_options m_options;
 
-                    // count up blob size by the size of the Way
-                    primitive_block_size += pbf_way->ByteSize();
+                /**
+                 * The objects for the next block.
+                 */
+                osmium::memory::Buffer m_block_buffer;
+
+                /**
+                 * Number of objects in m_block_buffer.
+                 */
+                uint32_t m_block_contents;
+
+                /**
+                 * Set the Sort.Type_then_ID optional feature in the header?
+                 * The sort order of the input is not checked, so this is
+                 * only done if requested with the pbf_sort_type_then_id
+                 * file option and never copied from the input header.
+                 */
+                bool m_sort_type_then_id;
+
+                /**
+                 * store the serialized HeaderBlock into a Blob.
+                 */
+                void store_header_block(const std::string& header_block) {
+                    std::promise<std::string> promise;
+                    m_output_queue.push(promise.get_future());
+                    promise.set_value(serialize_blob("OSMHeader", header_block, m_options.compression));
                 }
 
                 /**
-                 * Add a relation to the block.
-                 *
-                 * @param relation The relation to add.
+                 * Hand the current block to the thread pool for encoding and
+                 * start a new one.
                  */
-                void write_relation(const osmium::Relation& relation) {
-                    // add a relation to the group
-                    OSMPBF::Relation* pbf_relation = pbf_relations->add_relations();
+                void store_primitive_block() {
+                    m_output_queue.push(m_pool.submit(PBFEncodeBlock{std::move(m_block_buffer), m_options}));
+                    m_block_buffer = osmium::memory::Buffer(initial_block_buffer_size);
+                    m_block_contents = 0;
+                }
 
-                    // copy the common meta-info from the osmium-object to the pbf-object
-                    apply_common_info(relation, pbf_relation);
+                /**
+                 * Can the raw blob a buffer was read from be copied to the
+                 * output as it is? This is the case if it uses the same
+                 * compression as the blobs written here, none of the
+                 * options changing the encoding of the blocks was set, and
+                 * both the input and output are history files or both
+                 * aren't.
+                 */
+                bool can_copy_blob(const std::string& blob, uint32_t flags) const {
+                    // blobs from history files contain visible flags, the
+                    // others don't
+                    if (((flags & pbf_raw_blob_history) != 0) != m_options.add_visible) {
+                        return false;
+                    }
 
-                    Delta<int64_t> delta_id;
+                    const pbf_block_options defaults;
+                    if (m_options.use_dense_nodes != defaults.use_dense_nodes ||
+                        m_options.add_metadata != defaults.add_metadata ||
+                        m_options.location_granularity != defaults.location_granularity ||
+                        m_options.date_granularity != defaults.date_granularity) {
+                        return false;
+                    }
 
-                    for (const auto& member : relation.members()) {
-                        // record the relation-member role to the interim stringtable and copy the
-                        // interim string-id to the pbf-object
-                        pbf_relation->add_roles_sid(string_table.record_string(member.role()));
+                    ProtobufReader pbf_blob(blob.data(), blob.size());
+                    while (pbf_blob.next()) {
+                        switch (pbf_blob.tag()) {
+                            case 1: // raw
+                                return m_options.compression == pbf_compression::none;
+                            case 3: // zlib_data
+                                return m_options.compression == pbf_compression::zlib;
+                            case 6: // lz4_data
+                                return m_options.compression == pbf_compression::lz4;
+                            case 7: // zstd_data
+                                return m_options.compression == pbf_compression::zstd;
+                            default:
+                                pbf_blob.skip();
+                        }
+                    }
 
-                        // copy the relation-member-id, delta encoded
-                        pbf_relation->add_memids(delta_id.update(member.ref()));
+                    return false;
+                }
 
-                        // copy the relation-member-type, mapped to the OSMPBF enum
-                        pbf_relation->add_types(item_type_to_osmpbf_membertype(member.type()));
+                /**
+                 * Write a raw blob unchanged. The current block is stored
+                 * first to keep the order of the objects.
+                 */
+                void store_raw_blob(const std::string& blob) {
+                    if (m_block_contents > 0) {
+                        store_primitive_block();
                     }
 
-                    // count up blob size by the size of the Relation
-                    primitive_block_size += pbf_relation->ByteSize();
+                    std::promise<std::string> promise;
+                    m_output_queue.push(promise.get_future());
+                    promise.set_value(frame_blob("OSMData", blob));
+                }
+
+                /**
+                 * Add an object to the current block. If the block is
+                 * full, it is stored first.
+                 */
+                void add_to_block(const osmium::OSMObject& object) {
+                    if (m_block_contents >= max_block_contents ||
+                        static_cast<int64_t>(m_block_buffer.committed() + object.padded_size()) > max_uncompressed_blob_size * buffer_fill_percent / 100) {
+                        store_primitive_block();
+                    }
+
+                    m_block_buffer.add_item(object);
+                    m_block_buffer.commit();
+                    ++m_block_contents;
                 }
 
                 // objects of this class can't be copied
@@ -715,41 +939,46 @@ namespace osmium {
                 /**
                  * Create PBFOutputFormat object from File.
                  */
-                explicit PBFOutputFormat(const osmium::io::File& file, data_queue_type& output_queue) :
-                    OutputFormat(file, output_queue),
-                    pbf_header_block(),
-                    pbf_primitive_block(),
-                    pbf_nodes(nullptr),
-                    pbf_ways(nullptr),
-                    pbf_relations(nullptr),
-                    m_location_granularity(pbf_primitive_block.granularity()),
-                    m_date_granularity(pbf_primitive_block.date_granularity()),
-                    m_add_visible(file.has_multiple_object_versions()),
-                    primitive_block_contents(0),
-                    primitive_block_size(0),
-                    string_table(),
-                    m_delta_id(),
-                    m_delta_lat(),
-                    m_delta_lon(),
-                    m_delta_timestamp(),
-                    m_delta_changeset(),
-                    m_delta_uid(),
-                    m_delta_user_sid(),
-                    debug(true) {
-                    GOOGLE_PROTOBUF_VERIFY_VERSION;
+                explicit PBFOutputFormat(const osmium::io::File& file, data_queue_type& output_queue, osmium::thread::Pool& pool) :
+                    OutputFormat(file, output_queue, pool),
+                    m_options(),
+                    m_block_buffer(initial_block_buffer_size),
+                    m_block_contents(0),
+                    m_sort_type_then_id(file.get("pbf_sort_type_then_id") == "true") {
                     if (file.get("pbf_dense_nodes") == "false") {
-                        m_use_dense_nodes = false;
-                    }
-                    if (file.get("pbf_compression") == "none" || file.get("pbf_compression") == "false") {
-                        m_use_compression = false;
+                        m_options.use_dense_nodes = false;
                     }
+                    m_options.compression = get_pbf_compression(file.get("pbf_compression"));
                     if (file.get("pbf_add_metadata") == "false") {
-                        m_should_add_metadata = false;
+                        m_options.add_metadata = false;
                     }
+                    m_options.add_visible = file.has_multiple_object_versions();
                 }
 
+                /**
+                 * Write the objects in the buffer. If the buffer was read
+                 * from a PBF file with osmium::io::keep_raw_data::yes and
+                 * the Writer was created with osmium::io::copy_raw_data::yes,
+                 * the original blob is copied instead.
+                 */
                 void write_buffer(osmium::memory::Buffer&& buffer) override final {
-                    osmium::apply(buffer.cbegin(), buffer.cend(), *this);
+                    const std::string* raw_data = buffer.raw_data();
+                    if (raw_data && can_copy_blob(*raw_data, buffer.raw_data_flags())) {
+                        store_raw_blob(*raw_data);
+                        return;
+                    }
+
+                    for (const auto& item : buffer) {
+                        switch (item.type()) {
+                            case osmium::item_type::node:
+                            case osmium::item_type::way:
+                            case osmium::item_type::relation:
+                                add_to_block(static_cast<const osmium::OSMObject&>(item));
+                                break;
+                            default:
+                                break;
+                        }
+                    }
                 }
 
 
@@ -757,14 +986,14 @@ namespace osmium {
                  * getter to access the granularity
                  */
                 int location_granularity() const {
-                    return m_location_granularity;
+                    return m_options.location_granularity;
                 }
 
                 /**
                  * setter to set the granularity
                  */
                 PBFOutputFormat& location_granularity(int g) {
-                    m_location_granularity = g;
+                    m_options.location_granularity = g;
                     return *this;
                 }
 
@@ -773,18 +1002,17 @@ namespace osmium {
                  * getter to access the date_granularity
                  */
                 int date_granularity() const {
-                    return m_date_granularity;
+                    return m_options.date_granularity;
                 }
 
                 /**
                  * Set date granularity.
                  */
                 PBFOutputFormat& date_granularity(int g) {
-                    m_date_granularity = g;
+                    m_options.date_granularity = g;
                     return *this;
                 }
 
-
                 /**
                  * Initialize the writing process.
                  *
@@ -792,117 +1020,59 @@ namespace osmium {
                  * the writing-program and adds the obligatory StringTable-Index 0.
                  */
                 void write_header(const osmium::io::Header& header) override final {
+                    std::string data;
+                    ProtobufWriter pbf_header_block(data);
+
+                    if (!header.boxes().empty()) {
+                        osmium::Box box = header.joined_boxes();
+                        const auto pos = pbf_header_block.open_submessage(1);
+                        pbf_header_block.add_sint64(1, static_cast<int64_t>(box.bottom_left().lon() * lonlat_resolution)); // left
+                        pbf_header_block.add_sint64(2, static_cast<int64_t>(box.top_right().lon() * lonlat_resolution));   // right
+                        pbf_header_block.add_sint64(3, static_cast<int64_t>(box.top_right().lat() * lonlat_resolution));   // top
+                        pbf_header_block.add_sint64(4, static_cast<int64_t>(box.bottom_left().lat() * lonlat_resolution)); // bottom
+                        pbf_header_block.close_submessage(pos);
+                    }
+
                     // add the schema version as required feature to the HeaderBlock
-                    pbf_header_block.add_required_features("OsmSchema-V0.6");
+                    pbf_header_block.add_bytes(4, "OsmSchema-V0.6");
 
                     // when the densenodes-feature is used, add DenseNodes as required feature
-                    if (m_use_dense_nodes) {
-                        pbf_header_block.add_required_features("DenseNodes");
+                    if (m_options.use_dense_nodes) {
+                        pbf_header_block.add_bytes(4, "DenseNodes");
                     }
 
                     // when the resulting file will carry history information, add
                     // HistoricalInformation as required feature
                     if (m_file.has_multiple_object_versions()) {
-                        pbf_header_block.add_required_features("HistoricalInformation");
+                        pbf_header_block.add_bytes(4, "HistoricalInformation");
                     }
 
-                    // set the writing program
-                    pbf_header_block.set_writingprogram(header.get("generator"));
-
-                    if (!header.boxes().empty()) {
-                        OSMPBF::HeaderBBox* pbf_bbox = pbf_header_block.mutable_bbox();
-                        osmium::Box box = header.joined_boxes();
-                        pbf_bbox->set_left(static_cast<::google::protobuf::int64>(box.bottom_left().lon() * OSMPBF::lonlat_resolution));
-                        pbf_bbox->set_bottom(static_cast<::google::protobuf::int64>(box.bottom_left().lat() * OSMPBF::lonlat_resolution));
-                        pbf_bbox->set_right(static_cast<::google::protobuf::int64>(box.top_right().lon() * OSMPBF::lonlat_resolution));
-                        pbf_bbox->set_top(static_cast<::google::protobuf::int64>(box.top_right().lat() * OSMPBF::lonlat_resolution));
+                    // readers can use this to skip blobs they are not
+                    // interested in
+                    if (m_sort_type_then_id) {
+                        pbf_header_block.add_bytes(5, "Sort.Type_then_ID");
                     }
 
+                    // set the writing program
+                    pbf_header_block.add_bytes(16, header.get("generator"));
+
                     std::string osmosis_replication_timestamp = header.get("osmosis_replication_timestamp");
                     if (!osmosis_replication_timestamp.empty()) {
                         osmium::Timestamp ts(osmosis_replication_timestamp.c_str());
-                        pbf_header_block.set_osmosis_replication_timestamp(ts);
+                        pbf_header_block.add_int64(32, ts.seconds_since_epoch());
                     }
 
                     std::string osmosis_replication_sequence_number = header.get("osmosis_replication_sequence_number");
                     if (!osmosis_replication_sequence_number.empty()) {
-                        pbf_header_block.set_osmosis_replication_sequence_number(std::atoll(osmosis_replication_sequence_number.c_str()));
+                        pbf_header_block.add_int64(33, std::atoll(osmosis_replication_sequence_number.c_str()));
                     }
 
                     std::string osmosis_replication_base_url = header.get("osmosis_replication_base_url");
                     if (!osmosis_replication_base_url.empty()) {
-                        pbf_header_block.set_osmosis_replication_base_url(osmosis_replication_base_url);
-                    }
-
-                    store_header_block();
-                }
-
-                /**
-                 * Add a node to the pbf.
-                 *
-                 * A call to this method won't write the node to the file directly but
-                 * cache it for later bulk-writing. Calling final() ensures that everything
-                 * gets written and every file pointer is closed.
-                 */
-                void node(const osmium::Node& node) {
-                    // first of we check the contents-counter which may flush the cached nodes to
-                    // disk if the limit is reached. This call also increases the contents-counter
-                    check_block_contents_counter();
-
-                    if (debug && has_debug_level(2)) {
-                        std::cerr << "node " << node.id() << " v" << node.version() << std::endl;
-                    }
-
-                    // if no PrimitiveGroup for nodes has been added, add one and save the pointer
-                    if (!pbf_nodes) {
-                        pbf_nodes = pbf_primitive_block.add_primitivegroup();
+                        pbf_header_block.add_bytes(34, osmosis_replication_base_url);
                     }
 
-                    if (m_use_dense_nodes) {
-                        write_dense_node(node);
-                    } else {
-                        write_node(node);
-                    }
-                }
-
-                /**
-                 * Add a way to the pbf.
-                 *
-                 * A call to this method won't write the way to the file directly but
-                 * cache it for later bulk-writing. Calling final() ensures that everything
-                 * gets written and every file pointer is closed.
-                 */
-                void way(const osmium::Way& way) {
-                    // first of we check the contents-counter which may flush the cached ways to
-                    // disk if the limit is reached. This call also increases the contents-counter
-                    check_block_contents_counter();
-
-                    // if no PrimitiveGroup for nodes has been added, add one and save the pointer
-                    if (!pbf_ways) {
-                        pbf_ways = pbf_primitive_block.add_primitivegroup();
-                    }
-
-                    write_way(way);
-                }
-
-                /**
-                 * Add a relation to the pbf.
-                 *
-                 * A call to this method won't write the way to the file directly but
-                 * cache it for later bulk-writing. Calling final() ensures that everything
-                 * gets written and every file pointer is closed.
-                 */
-                void relation(const osmium::Relation& relation) {
-                    // first of we check the contents-counter which may flush the cached relations to
-                    // disk if the limit is reached. This call also increases the contents-counter
-                    check_block_contents_counter();
-
-                    // if no PrimitiveGroup for relations has been added, add one and save the pointer
-                    if (!pbf_relations) {
-                        pbf_relations = pbf_primitive_block.add_primitivegroup();
-                    }
-
-                    write_relation(relation);
+                    store_header_block(data);
                 }
 
                 /**
@@ -910,12 +1080,8 @@ namespace osmium {
                  * close the file.
                  */
                 void close() override final {
-                    if (debug && has_debug_level(1)) {
-                        std::cerr << "finishing" << std::endl;
-                    }
-
                     // if the current block contains any elements, flush it to the protobuf
-                    if (primitive_block_contents > 0) {
+                    if (m_block_contents > 0) {
                         store_primitive_block();
                     }
 
@@ -929,8 +1095,8 @@ namespace osmium {
             namespace {
 
                 const bool registered_pbf_output = osmium::io::detail::OutputFormatFactory::instance().register_output_format(osmium::io::file_format::pbf,
-                    [](const osmium::io::File& file, data_queue_type& output_queue) {
-                        return new osmium::io::detail::PBFOutputFormat(file, output_queue);
+                    [](const osmium::io::File& file, data_queue_type& output_queue, osmium::thread::Pool& pool) {
+                        return new osmium::io::detail::PBFOutputFormat(file, output_queue, pool);
                 });
 
             } // anonymous namespace
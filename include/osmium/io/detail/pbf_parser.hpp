@@ -37,18 +37,31 @@ DEALINGS IN THE SOFTWARE.
 #include <cstddef>
 #include <cstdint>
 #include <algorithm>
-
-#include <osmpbf/osmpbf.h>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/io/detail/input_format.hpp>
 #include <osmium/io/detail/pbf.hpp> // IWYU pragma: export
+#include <osmium/io/detail/protobuf.hpp>
 #include <osmium/io/detail/zlib.hpp>
+#ifdef OSMIUM_WITH_ZSTD
+# include <osmium/io/detail/zstd.hpp>
+#endif
+#ifdef OSMIUM_WITH_LZ4
+# include <osmium/io/detail/lz4.hpp>
+#endif
 #include <osmium/io/header.hpp>
+#include <osmium/osm/box.hpp>
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/node.hpp>
 #include <osmium/osm/types.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/memory/buffer_pool.hpp>
 #include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/thread/byte_budget.hpp>
 #include <osmium/util/cast.hpp>
 
 namespace osmium {
@@ -57,19 +70,27 @@ namespace osmium {
 
         namespace detail {
 
+            /**
+             * Parses a PrimitiveBlock from a PBF file into a Buffer. This
+             * decodes the protobuf data directly using the ProtobufReader,
+             * all strings are referenced in place until they are copied
+             * into the buffer.
+             */
             class PBFPrimitiveBlockParser {
 
                 static constexpr size_t initial_buffer_size = 2 * 1024 * 1024;
 
-                const std::string& m_data;
+                data_view m_data;
 
-                const OSMPBF::StringTable* m_stringtable;
+                std::vector<data_view> m_stringtable;
                 int64_t m_lon_offset;
                 int64_t m_lat_offset;
                 int64_t m_date_factor;
                 int32_t m_granularity;
 
                 osmium::osm_entity_bits::type m_read_types;
+                osmium::Box m_bbox;
+                bool m_read_metadata;
 
                 osmium::memory::Buffer m_buffer;
 
@@ -81,178 +102,418 @@ namespace osmium {
 
             public:
 
-                explicit PBFPrimitiveBlockParser(const std::string& data, osmium::osm_entity_bits::type read_types) :
+                /**
+                 * @param data The PrimitiveBlock to parse.
+                 * @param options Options from the Reader.
+                 * @param buffer_pool If set, the buffer for the result is
+                 *                    taken from this pool.
+                 */
+                explicit PBFPrimitiveBlockParser(const data_view& data, const osmium::io::detail::reader_options& options, osmium::memory::BufferPool* buffer_pool = nullptr) :
                     m_data(data),
-                    m_stringtable(nullptr),
+                    m_stringtable(),
                     m_lon_offset(0),
                     m_lat_offset(0),
                     m_date_factor(1000),
                     m_granularity(100),
-                    m_read_types(read_types),
-                    m_buffer(initial_buffer_size) {
+                    m_read_types(options.read_which_entities),
+                    m_bbox(options.bbox),
+                    m_read_metadata(options.read_metadata == osmium::io::read_meta::yes),
+                    m_buffer(buffer_pool ? buffer_pool->get_buffer(initial_buffer_size) : osmium::memory::Buffer(initial_buffer_size)) {
                 }
 
                 ~PBFPrimitiveBlockParser() = default;
 
                 osmium::memory::Buffer operator()() {
-                    OSMPBF::PrimitiveBlock pbf_primitive_block;
-                    if (!pbf_primitive_block.ParseFromString(m_data)) {
-                        throw osmium::pbf_error("failed to parse PrimitiveBlock");
-                    }
-
-                    m_stringtable = &pbf_primitive_block.stringtable();
-                    m_lon_offset  = pbf_primitive_block.lon_offset();
-                    m_lat_offset  = pbf_primitive_block.lat_offset();
-                    m_date_factor = pbf_primitive_block.date_granularity() / 1000;
-                    m_granularity = pbf_primitive_block.granularity();
-
-                    for (int i=0; i < pbf_primitive_block.primitivegroup_size(); ++i) {
-                        const OSMPBF::PrimitiveGroup& group = pbf_primitive_block.primitivegroup(i);
-
-                        if (group.has_dense())  {
-                            if (m_read_types & osmium::osm_entity_bits::node) parse_dense_node_group(group);
-                        } else if (group.ways_size() != 0) {
-                            if (m_read_types & osmium::osm_entity_bits::way) parse_way_group(group);
-                        } else if (group.relations_size() != 0) {
-                            if (m_read_types & osmium::osm_entity_bits::relation) parse_relation_group(group);
-                        } else if (group.nodes_size() != 0) {
-                            if (m_read_types & osmium::osm_entity_bits::node) parse_node_group(group);
-                        } else {
-                            throw osmium::pbf_error("group of unknown type");
+                    // The granularity and offsets are stored after the
+                    // groups, so we have to remember where the groups are
+                    // and parse them later.
+                    std::vector<data_view> groups;
+
+                    ProtobufReader pbf_primitive_block(m_data);
+                    while (pbf_primitive_block.next()) {
+                        switch (pbf_primitive_block.tag()) {
+                            case 1: // stringtable
+                                decode_stringtable(pbf_primitive_block.get_view());
+                                break;
+                            case 2: // primitivegroup
+                                groups.push_back(pbf_primitive_block.get_view());
+                                break;
+                            case 17: // granularity
+                                m_granularity = pbf_primitive_block.get_int32();
+                                break;
+                            case 18: // date_granularity
+                                m_date_factor = pbf_primitive_block.get_int32() / 1000;
+                                break;
+                            case 19: // lat_offset
+                                m_lat_offset = pbf_primitive_block.get_int64();
+                                break;
+                            case 20: // lon_offset
+                                m_lon_offset = pbf_primitive_block.get_int64();
+                                break;
+                            default:
+                                pbf_primitive_block.skip();
                         }
                     }
 
+                    for (const auto& group : groups) {
+                        parse_primitive_group(group);
+                    }
+
                     return std::move(m_buffer);
                 }
 
             private:
 
-                template <class TBuilder, class TPBFObject>
-                void parse_attributes(TBuilder& builder, const TPBFObject& pbf_object) {
-                    auto& object = builder.object();
+                void decode_stringtable(const data_view& data) {
+                    if (!m_stringtable.empty()) {
+                        throw osmium::pbf_error("more than one stringtable in block");
+                    }
+                    ProtobufReader pbf_string_table(data);
+                    while (pbf_string_table.next()) {
+                        if (pbf_string_table.tag() == 1) {
+                            m_stringtable.push_back(pbf_string_table.get_view());
+                        } else {
+                            pbf_string_table.skip();
+                        }
+                    }
+                }
 
-                    object.set_id(pbf_object.id());
+                const data_view& s(uint64_t index) const {
+                    if (index >= m_stringtable.size()) {
+                        throw osmium::pbf_error("string id out of range");
+                    }
+                    return m_stringtable[index];
+                }
+
+                osmium::Location make_location(int64_t lon, int64_t lat) const {
+                    return osmium::Location(
+                        (lon * m_granularity + m_lon_offset) / (lonlat_resolution / osmium::Location::coordinate_precision),
+                        (lat * m_granularity + m_lat_offset) / (lonlat_resolution / osmium::Location::coordinate_precision));
+                }
 
-                    if (pbf_object.has_info()) {
-                        object.set_version(static_cast_with_assert<object_version_type>(pbf_object.info().version()))
-                            .set_changeset(static_cast_with_assert<changeset_id_type>(pbf_object.info().changeset()))
-                            .set_timestamp(pbf_object.info().timestamp() * m_date_factor)
-                            .set_uid_from_signed(pbf_object.info().uid());
-                        if (pbf_object.info().has_visible()) {
-                            object.set_visible(pbf_object.info().visible());
+                void parse_primitive_group(const data_view& data) {
+                    bool known_type = false;
+
+                    ProtobufReader pbf_primitive_group(data);
+                    while (pbf_primitive_group.next()) {
+                        switch (pbf_primitive_group.tag()) {
+                            case 1: // nodes
+                                known_type = true;
+                                if (m_read_types & osmium::osm_entity_bits::node) {
+                                    parse_node(pbf_primitive_group.get_view());
+                                } else {
+                                    pbf_primitive_group.skip();
+                                }
+                                break;
+                            case 2: // dense
+                                known_type = true;
+                                if (m_read_types & osmium::osm_entity_bits::node) {
+                                    parse_dense_node_group(pbf_primitive_group.get_view());
+                                } else {
+                                    pbf_primitive_group.skip();
+                                }
+                                break;
+                            case 3: // ways
+                                known_type = true;
+                                if (m_read_types & osmium::osm_entity_bits::way) {
+                                    parse_way(pbf_primitive_group.get_view());
+                                } else {
+                                    pbf_primitive_group.skip();
+                                }
+                                break;
+                            case 4: // relations
+                                known_type = true;
+                                if (m_read_types & osmium::osm_entity_bits::relation) {
+                                    parse_relation(pbf_primitive_group.get_view());
+                                } else {
+                                    pbf_primitive_group.skip();
+                                }
+                                break;
+                            default:
+                                pbf_primitive_group.skip();
                         }
-                        builder.add_user(m_stringtable->s(static_cast_with_assert<int>(pbf_object.info().user_sid())));
-                    } else {
-                        builder.add_user("", 1);
+                    }
+
+                    if (!known_type) {
+                        throw osmium::pbf_error("group of unknown type");
                     }
                 }
 
-                void parse_node_group(const OSMPBF::PrimitiveGroup& group) {
-                    for (int i=0; i < group.nodes_size(); ++i) {
-                        osmium::builder::NodeBuilder builder(m_buffer);
-                        const OSMPBF::Node& pbf_node = group.nodes(i);
-                        parse_attributes(builder, pbf_node);
+                template <class TBuilder>
+                void parse_info(TBuilder& builder, const data_view& data) {
+                    auto& object = builder.object();
 
-                        if (builder.object().visible()) {
-                            builder.object().set_location(osmium::Location(
-                                              (pbf_node.lon() * m_granularity + m_lon_offset) / (OSMPBF::lonlat_resolution / osmium::Location::coordinate_precision),
-                                              (pbf_node.lat() * m_granularity + m_lat_offset) / (OSMPBF::lonlat_resolution / osmium::Location::coordinate_precision)));
+                    int32_t version = -1;
+                    uint32_t user_sid = 0;
+
+                    ProtobufReader pbf_info(data);
+                    while (pbf_info.next()) {
+                        switch (pbf_info.tag()) {
+                            case 1: // version
+                                version = pbf_info.get_int32();
+                                break;
+                            case 2: // timestamp
+                                object.set_timestamp(pbf_info.get_int64() * m_date_factor);
+                                break;
+                            case 3: // changeset
+                                object.set_changeset(static_cast_with_assert<changeset_id_type>(pbf_info.get_int64()));
+                                break;
+                            case 4: // uid
+                                object.set_uid_from_signed(pbf_info.get_int32());
+                                break;
+                            case 5: // user_sid
+                                user_sid = pbf_info.get_uint32();
+                                break;
+                            case 6: // visible
+                                object.set_visible(pbf_info.get_bool());
+                                break;
+                            default:
+                                pbf_info.skip();
                         }
+                    }
 
-                        if (pbf_node.keys_size() > 0) {
-                            osmium::builder::TagListBuilder tl_builder(m_buffer, &builder);
-                            for (int tag=0; tag < pbf_node.keys_size(); ++tag) {
-                                tl_builder.add_tag(m_stringtable->s(static_cast<int>(pbf_node.keys(tag))),
-                                                   m_stringtable->s(static_cast<int>(pbf_node.vals(tag))));
-                            }
+                    object.set_version(static_cast_with_assert<object_version_type>(version));
+                    const data_view& user = s(user_sid);
+                    builder.set_user(user.data, user.size);
+                }
+
+                template <class TBuilder>
+                void parse_attributes(TBuilder& builder, const data_view& info) {
+                    if (info.data) {
+                        if (m_read_metadata) {
+                            parse_info(builder, info);
+                            return;
                         }
+                        // without metadata only the visible flag is needed
+                        builder.object().set_visible(info_visible(info));
+                    }
+                    builder.add_user("", 1);
+                }
 
-                        m_buffer.commit();
+                void add_tags(osmium::builder::Builder* builder, PackedVarintReader keys, PackedVarintReader vals) {
+                    if (keys.empty()) {
+                        return;
+                    }
+
+                    osmium::builder::TagListBuilder tl_builder(m_buffer, builder);
+                    while (!keys.empty()) {
+                        const data_view& key   = s(keys.next_uint32());
+                        const data_view& value = s(vals.next_uint32());
+                        tl_builder.add_tag(key.data, key.size, value.data, value.size);
                     }
                 }
 
-                void parse_way_group(const OSMPBF::PrimitiveGroup& group) {
-                    for (int i=0; i < group.ways_size(); ++i) {
-                        osmium::builder::WayBuilder builder(m_buffer);
-                        const OSMPBF::Way& pbf_way = group.ways(i);
-                        parse_attributes(builder, pbf_way);
+                /**
+                 * Is the node with the given location inside the bounding
+                 * box? Nodes without location are never inside. Always
+                 * true if no bounding box was set.
+                 */
+                bool in_bbox(bool visible, int64_t lon, int64_t lat) const {
+                    return !m_bbox || (visible && m_bbox.contains(make_location(lon, lat)));
+                }
 
-                        if (pbf_way.refs_size() > 0) {
-                            osmium::builder::WayNodeListBuilder wnl_builder(m_buffer, &builder);
-                            int64_t ref = 0;
-                            for (int n=0; n < pbf_way.refs_size(); ++n) {
-                                ref += pbf_way.refs(n);
-                                wnl_builder.add_node_ref(ref);
-                            }
+                static bool info_visible(const data_view& info) {
+                    ProtobufReader pbf_info(info);
+                    while (pbf_info.next()) {
+                        if (pbf_info.tag() == 6) { // visible
+                            return pbf_info.get_bool();
                         }
+                        pbf_info.skip();
+                    }
+                    return true;
+                }
 
-                        if (pbf_way.keys_size() > 0) {
-                            osmium::builder::TagListBuilder tl_builder(m_buffer, &builder);
-                            for (int tag=0; tag < pbf_way.keys_size(); ++tag) {
-                                tl_builder.add_tag(m_stringtable->s(static_cast<int>(pbf_way.keys(tag))),
-                                                   m_stringtable->s(static_cast<int>(pbf_way.vals(tag))));
-                            }
+                void parse_node(const data_view& data) {
+                    int64_t id = 0;
+                    data_view info;
+                    PackedVarintReader keys;
+                    PackedVarintReader vals;
+                    int64_t lon = 0;
+                    int64_t lat = 0;
+
+                    ProtobufReader pbf_node(data);
+                    while (pbf_node.next()) {
+                        switch (pbf_node.tag()) {
+                            case 1: // id
+                                id = pbf_node.get_sint64();
+                                break;
+                            case 2: // keys
+                                keys = pbf_node.get_packed();
+                                break;
+                            case 3: // vals
+                                vals = pbf_node.get_packed();
+                                break;
+                            case 4: // info
+                                info = pbf_node.get_view();
+                                break;
+                            case 8: // lat
+                                lat = pbf_node.get_sint64();
+                                break;
+                            case 9: // lon
+                                lon = pbf_node.get_sint64();
+                                break;
+                            default:
+                                pbf_node.skip();
                         }
+                    }
 
-                        m_buffer.commit();
+                    if (m_bbox && !in_bbox(!info.data || info_visible(info), lon, lat)) {
+                        return;
+                    }
+
+                    osmium::builder::NodeBuilder builder(m_buffer);
+                    osmium::Node& node = builder.object();
+
+                    node.set_id(id);
+
+                    parse_attributes(builder, info);
+
+                    if (node.visible()) {
+                        node.set_location(make_location(lon, lat));
                     }
+
+                    add_tags(&builder, keys, vals);
+
+                    m_buffer.commit();
                 }
 
-                void parse_relation_group(const OSMPBF::PrimitiveGroup& group) {
-                    for (int i=0; i < group.relations_size(); ++i) {
-                        osmium::builder::RelationBuilder builder(m_buffer);
-                        const OSMPBF::Relation& pbf_relation = group.relations(i);
-                        parse_attributes(builder, pbf_relation);
+                void parse_way(const data_view& data) {
+                    osmium::builder::WayBuilder builder(m_buffer);
+
+                    data_view info;
+                    PackedVarintReader keys;
+                    PackedVarintReader vals;
+                    PackedVarintReader refs;
+
+                    ProtobufReader pbf_way(data);
+                    while (pbf_way.next()) {
+                        switch (pbf_way.tag()) {
+                            case 1: // id
+                                builder.object().set_id(pbf_way.get_int64());
+                                break;
+                            case 2: // keys
+                                keys = pbf_way.get_packed();
+                                break;
+                            case 3: // vals
+                                vals = pbf_way.get_packed();
+                                break;
+                            case 4: // info
+                                info = pbf_way.get_view();
+                                break;
+                            case 8: // refs
+                                refs = pbf_way.get_packed();
+                                break;
+                            default:
+                                pbf_way.skip();
+                        }
+                    }
 
-                        if (pbf_relation.types_size() > 0) {
-                            osmium::builder::RelationMemberListBuilder rml_builder(m_buffer, &builder);
-                            int64_t ref = 0;
-                            for (int n=0; n < pbf_relation.types_size(); ++n) {
-                                ref += pbf_relation.memids(n);
-                                rml_builder.add_member(osmpbf_membertype_to_item_type(pbf_relation.types(n)), ref, m_stringtable->s(pbf_relation.roles_sid(n)));
-                            }
+                    parse_attributes(builder, info);
+
+                    if (!refs.empty()) {
+                        osmium::builder::WayNodeListBuilder wnl_builder(m_buffer, &builder);
+                        int64_t ref = 0;
+                        while (!refs.empty()) {
+                            ref += refs.next_sint64();
+                            wnl_builder.add_node_ref(ref);
                         }
+                    }
 
-                        if (pbf_relation.keys_size() > 0) {
-                            osmium::builder::TagListBuilder tl_builder(m_buffer, &builder);
-                            for (int tag=0; tag < pbf_relation.keys_size(); ++tag) {
-                                tl_builder.add_tag(m_stringtable->s(static_cast<int>(pbf_relation.keys(tag))),
-                                                   m_stringtable->s(static_cast<int>(pbf_relation.vals(tag))));
-                            }
+                    add_tags(&builder, keys, vals);
+
+                    m_buffer.commit();
+                }
+
+                void parse_relation(const data_view& data) {
+                    osmium::builder::RelationBuilder builder(m_buffer);
+
+                    data_view info;
+                    PackedVarintReader keys;
+                    PackedVarintReader vals;
+                    PackedVarintReader roles;
+                    PackedVarintReader memids;
+                    PackedVarintReader types;
+
+                    ProtobufReader pbf_relation(data);
+                    while (pbf_relation.next()) {
+                        switch (pbf_relation.tag()) {
+                            case 1: // id
+                                builder.object().set_id(pbf_relation.get_int64());
+                                break;
+                            case 2: // keys
+                                keys = pbf_relation.get_packed();
+                                break;
+                            case 3: // vals
+                                vals = pbf_relation.get_packed();
+                                break;
+                            case 4: // info
+                                info = pbf_relation.get_view();
+                                break;
+                            case 8: // roles_sid
+                                roles = pbf_relation.get_packed();
+                                break;
+                            case 9: // memids
+                                memids = pbf_relation.get_packed();
+                                break;
+                            case 10: // types
+                                types = pbf_relation.get_packed();
+                                break;
+                            default:
+                                pbf_relation.skip();
                         }
+                    }
 
-                        m_buffer.commit();
+                    parse_attributes(builder, info);
+
+                    if (!types.empty()) {
+                        osmium::builder::RelationMemberListBuilder rml_builder(m_buffer, &builder);
+                        int64_t ref = 0;
+                        while (!types.empty()) {
+                            ref += memids.next_sint64();
+                            const data_view& role = s(static_cast<uint32_t>(roles.next_int32()));
+                            rml_builder.add_member(osmpbf_membertype_to_item_type(types.next_int32()), ref, role.data, role.size);
+                        }
                     }
+
+                    add_tags(&builder, keys, vals);
+
+                    m_buffer.commit();
                 }
 
-                int add_tags(const OSMPBF::DenseNodes& dense, int n, osmium::builder::NodeBuilder* builder) {
-                    if (n >= dense.keys_vals_size()) {
-                        return n;
+                void add_dense_tags(PackedVarintReader& keys_vals, osmium::builder::NodeBuilder* builder) {
+                    if (keys_vals.empty()) {
+                        return;
                     }
 
-                    if (dense.keys_vals(n) == 0) {
-                        return n+1;
+                    uint32_t tag_key_pos = keys_vals.next_uint32();
+                    if (tag_key_pos == 0) {
+                        return;
                     }
 
                     osmium::builder::TagListBuilder tl_builder(m_buffer, builder);
 
-                    while (n < dense.keys_vals_size()) {
-                        int tag_key_pos = dense.keys_vals(n++);
+                    while (true) {
+                        const data_view& key   = s(tag_key_pos);
+                        const data_view& value = s(keys_vals.next_uint32());
+                        tl_builder.add_tag(key.data, key.size, value.data, value.size);
 
+                        if (keys_vals.empty()) {
+                            break;
+                        }
+                        tag_key_pos = keys_vals.next_uint32();
                         if (tag_key_pos == 0) {
                             break;
                         }
-
-                        tl_builder.add_tag(m_stringtable->s(tag_key_pos),
-                                           m_stringtable->s(dense.keys_vals(n)));
-
-                        ++n;
                     }
+                }
 
-                    return n;
+                static void skip_dense_tags(PackedVarintReader& keys_vals) {
+                    while (!keys_vals.empty() && keys_vals.next_uint32() != 0) {
+                        keys_vals.next_uint32();
+                    }
                 }
 
-                void parse_dense_node_group(const OSMPBF::PrimitiveGroup& group) {
+                void parse_dense_node_group(const data_view& data) {
                     int64_t last_dense_id        = 0;
                     int64_t last_dense_latitude  = 0;
                     int64_t last_dense_longitude = 0;
@@ -260,29 +521,94 @@ namespace osmium {
                     int64_t last_dense_user_sid  = 0;
                     int64_t last_dense_changeset = 0;
                     int64_t last_dense_timestamp = 0;
-                    int     last_dense_tag       = 0;
 
-                    const OSMPBF::DenseNodes& dense = group.dense();
+                    PackedVarintReader ids;
+                    PackedVarintReader lats;
+                    PackedVarintReader lons;
+                    PackedVarintReader keys_vals;
+
+                    bool has_info = false;
+                    PackedVarintReader versions;
+                    PackedVarintReader timestamps;
+                    PackedVarintReader changesets;
+                    PackedVarintReader uids;
+                    PackedVarintReader user_sids;
+                    PackedVarintReader visibles;
+
+                    ProtobufReader pbf_dense_nodes(data);
+                    while (pbf_dense_nodes.next()) {
+                        switch (pbf_dense_nodes.tag()) {
+                            case 1: // id
+                                ids = pbf_dense_nodes.get_packed();
+                                break;
+                            case 5: { // denseinfo
+                                    // without metadata only the visible flags are needed
+                                    has_info = m_read_metadata;
+                                    ProtobufReader pbf_dense_info(pbf_dense_nodes.get_view());
+                                    while (pbf_dense_info.next()) {
+                                        switch (pbf_dense_info.tag()) {
+                                            case 1: // version
+                                                versions = pbf_dense_info.get_packed();
+                                                break;
+                                            case 2: // timestamp
+                                                timestamps = pbf_dense_info.get_packed();
+                                                break;
+                                            case 3: // changeset
+                                                changesets = pbf_dense_info.get_packed();
+                                                break;
+                                            case 4: // uid
+                                                uids = pbf_dense_info.get_packed();
+                                                break;
+                                            case 5: // user_sid
+                                                user_sids = pbf_dense_info.get_packed();
+                                                break;
+                                            case 6: // visible
+                                                visibles = pbf_dense_info.get_packed();
+                                                break;
+                                            default:
+                                                pbf_dense_info.skip();
+                                        }
+                                    }
+                                }
+                                break;
+                            case 8: // lat
+                                lats = pbf_dense_nodes.get_packed();
+                                break;
+                            case 9: // lon
+                                lons = pbf_dense_nodes.get_packed();
+                                break;
+                            case 10: // keys_vals
+                                keys_vals = pbf_dense_nodes.get_packed();
+                                break;
+                            default:
+                                pbf_dense_nodes.skip();
+                        }
+                    }
+
+                    const bool has_visibles = !visibles.empty();
 
-                    for (int i=0; i < dense.id_size(); ++i) {
+                    while (!ids.empty()) {
                         bool visible = true;
 
-                        last_dense_id        += dense.id(i);
-                        last_dense_latitude  += dense.lat(i);
-                        last_dense_longitude += dense.lon(i);
-
-                        if (dense.has_denseinfo()) {
-                            last_dense_changeset += dense.denseinfo().changeset(i);
-                            last_dense_timestamp += dense.denseinfo().timestamp(i);
-                            last_dense_uid       += dense.denseinfo().uid(i);
-                            last_dense_user_sid  += dense.denseinfo().user_sid(i);
-                            if (dense.denseinfo().visible_size() > 0) {
-                                visible = dense.denseinfo().visible(i);
-                            }
-                            assert(last_dense_changeset >= 0);
-                            assert(last_dense_timestamp >= 0);
-                            assert(last_dense_uid >= -1);
-                            assert(last_dense_user_sid >= 0);
+                        last_dense_id        += ids.next_sint64();
+                        last_dense_latitude  += lats.next_sint64();
+                        last_dense_longitude += lons.next_sint64();
+
+                        int32_t version = 0;
+                        if (has_info) {
+                            version = versions.next_int32();
+                            last_dense_timestamp += timestamps.next_sint64();
+                            last_dense_changeset += changesets.next_sint64();
+                            last_dense_uid       += uids.next_sint32();
+                            last_dense_user_sid  += user_sids.next_sint32();
+                        }
+                        if (has_visibles) {
+                            visible = visibles.next_bool();
+                        }
+
+                        if (!in_bbox(visible, last_dense_longitude, last_dense_latitude)) {
+                            skip_dense_tags(keys_vals);
+                            continue;
                         }
 
                         osmium::builder::NodeBuilder builder(m_buffer);
@@ -290,26 +616,29 @@ namespace osmium {
 
                         node.set_id(last_dense_id);
 
-                        if (dense.has_denseinfo()) {
-                            auto v = dense.denseinfo().version(i);
-                            assert(v > 0);
-                            node.set_version(static_cast<osmium::object_version_type>(v));
+                        if (has_info) {
+                            assert(version > 0);
+                            assert(last_dense_changeset >= 0);
+                            assert(last_dense_timestamp >= 0);
+                            assert(last_dense_uid >= -1);
+                            assert(last_dense_user_sid >= 0);
+
+                            node.set_version(static_cast<osmium::object_version_type>(version));
                             node.set_changeset(static_cast<osmium::changeset_id_type>(last_dense_changeset));
                             node.set_timestamp(last_dense_timestamp * m_date_factor);
                             node.set_uid_from_signed(static_cast<osmium::signed_user_id_type>(last_dense_uid));
-                            node.set_visible(visible);
-                            builder.add_user(m_stringtable->s(static_cast<int>(last_dense_user_sid)));
+                            const data_view& user = s(static_cast<uint64_t>(last_dense_user_sid));
+                            builder.set_user(user.data, user.size);
                         } else {
                             builder.add_user("", 1);
                         }
+                        node.set_visible(visible);
 
                         if (visible) {
-                            builder.object().set_location(osmium::Location(
-                                              (last_dense_longitude * m_granularity + m_lon_offset) / (OSMPBF::lonlat_resolution / osmium::Location::coordinate_precision),
-                                              (last_dense_latitude  * m_granularity + m_lat_offset) / (OSMPBF::lonlat_resolution / osmium::Location::coordinate_precision)));
+                            node.set_location(make_location(last_dense_longitude, last_dense_latitude));
                         }
 
-                        last_dense_tag = add_tags(dense, last_dense_tag, &builder);
+                        add_dense_tags(keys_vals, &builder);
                         m_buffer.commit();
                     }
                 }
@@ -317,118 +646,400 @@ namespace osmium {
             }; // class PBFPrimitiveBlockParser
 
             /**
-             * PBF blobs can optionally be packed with the zlib algorithm.
-             * This function returns the raw data (if it was unpacked) or
-             * the unpacked data (if it was packed).
+             * Decode a BlobHeader. The BlobHeader contains a type field
+             * (which is checked against the expected type) and a size field.
              *
-             * @param input_data Reference to input data.
-             * @returns Unpacked data
+             * @param data Pointer to BlobHeader message.
+             * @param size Size of BlobHeader message.
+             * @param expected_type Expected type of data ("OSMHeader" or
+             *                      "OSMData").
+             * @returns Size of the Blob following the BlobHeader.
              * @throws osmium::pbf_error If there was a problem parsing the PBF
              */
-            inline std::unique_ptr<const std::string> unpack_blob(const std::string& input_data) {
-                OSMPBF::Blob pbf_blob;
-                if (!pbf_blob.ParseFromString(input_data)) {
-                    throw osmium::pbf_error("failed to parse blob");
-                }
-
-                if (pbf_blob.has_raw()) {
-                    return std::unique_ptr<std::string>(pbf_blob.release_raw());
-                } else if (pbf_blob.has_zlib_data()) {
-                    auto raw_size = pbf_blob.raw_size();
-                    assert(raw_size >= 0);
-                    assert(raw_size <= OSMPBF::max_uncompressed_blob_size);
-                    return osmium::io::detail::zlib_uncompress(pbf_blob.zlib_data(), static_cast<unsigned long>(raw_size));
-                } else if (pbf_blob.has_lzma_data()) {
-                    throw osmium::pbf_error("lzma blobs not implemented");
-                } else {
-                    throw osmium::pbf_error("blob contains no data");
+            inline size_t decode_blob_header(const char* data, size_t size, const char* expected_type) {
+                bool has_type = false;
+                int32_t datasize = -1;
+
+                ProtobufReader pbf_blob_header(data, size);
+                while (pbf_blob_header.next()) {
+                    switch (pbf_blob_header.tag()) {
+                        case 1: // type
+                            if (pbf_blob_header.get_view() != expected_type) {
+                                throw osmium::pbf_error("blob does not have expected type (OSMHeader in first blob, OSMData in following blobs)");
+                            }
+                            has_type = true;
+                            break;
+                        case 3: // datasize
+                            datasize = pbf_blob_header.get_int32();
+                            break;
+                        default:
+                            pbf_blob_header.skip();
+                    }
+                }
+
+                if (!has_type || datasize < 0) {
+                    throw osmium::pbf_error("failed to parse BlobHeader");
                 }
+
+                return static_cast<size_t>(datasize);
             }
 
             /**
-             * Parse blob as a HeaderBlock.
-             *
-             * @param input_buffer Blob data
-             * @returns Header object
-             * @throws osmium::pbf_error If there was a parsing error
+             * The contents of a Blob message. The views point into the
+             * message.
              */
-            inline osmium::io::Header parse_header_blob(const std::string& input_buffer) {
-                const std::unique_ptr<const std::string> data = unpack_blob(input_buffer);
+            struct blob_contents {
 
-                OSMPBF::HeaderBlock pbf_header_block;
-                if (!pbf_header_block.ParseFromString(*data)) {
-                    throw osmium::pbf_error("failed to parse HeaderBlock");
-                }
+                data_view raw;
+                data_view zlib_data;
+                data_view lz4_data;
+                data_view zstd_data;
+                int32_t raw_size = -1;
+                bool has_lzma_data = false;
 
-                osmium::io::Header header;
-                for (int i=0; i < pbf_header_block.required_features_size(); ++i) {
-                    const std::string& feature = pbf_header_block.required_features(i);
+            }; // struct blob_contents
 
-                    if (feature == "OsmSchema-V0.6") continue;
-                    if (feature == "DenseNodes") {
-                        header.set("pbf_dense_nodes", true);
-                        continue;
-                    }
-                    if (feature == "HistoricalInformation") {
-                        header.set_has_multiple_object_versions(true);
-                        continue;
+            /**
+             * Decode a Blob message without unpacking its data.
+             *
+             * @param data Pointer to Blob message.
+             * @param size Size of Blob message.
+             * @throws osmium::pbf_error If there was a problem parsing the PBF
+             */
+            inline blob_contents decode_blob(const char* data, size_t size) {
+                blob_contents blob;
+
+                ProtobufReader pbf_blob(data, size);
+                while (pbf_blob.next()) {
+                    switch (pbf_blob.tag()) {
+                        case 1: // raw
+                            blob.raw = pbf_blob.get_view();
+                            break;
+                        case 2: // raw_size
+                            blob.raw_size = pbf_blob.get_int32();
+                            break;
+                        case 3: // zlib_data
+                            blob.zlib_data = pbf_blob.get_view();
+                            break;
+                        case 4: // lzma_data
+                            blob.has_lzma_data = true;
+                            pbf_blob.skip();
+                            break;
+                        case 6: // lz4_data
+                            blob.lz4_data = pbf_blob.get_view();
+                            break;
+                        case 7: // zstd_data
+                            blob.zstd_data = pbf_blob.get_view();
+                            break;
+                        default:
+                            pbf_blob.skip();
                     }
-
-                    throw osmium::pbf_error(std::string("required feature not supported: ") + feature);
                 }
 
-                for (int i=0; i < pbf_header_block.optional_features_size(); ++i) {
-                    const std::string& feature = pbf_header_block.optional_features(i);
-                    header.set("pbf_optional_feature_" + std::to_string(i), feature);
+                const bool compressed = blob.zlib_data.data || blob.lz4_data.data || blob.zstd_data.data;
+                if (compressed && (blob.raw_size < 0 || blob.raw_size > max_uncompressed_blob_size)) {
+                    throw osmium::pbf_error("invalid raw_size in blob");
                 }
 
-                if (pbf_header_block.has_writingprogram()) {
-                    header.set("generator", pbf_header_block.writingprogram());
+                return blob;
+            }
+
+            /**
+             * Get the size of the data in a Blob message after unpacking.
+             *
+             * @param data Pointer to Blob message.
+             * @param size Size of Blob message.
+             * @throws osmium::pbf_error If there was a problem parsing the PBF
+             */
+            inline size_t uncompressed_blob_size(const char* data, size_t size) {
+                const blob_contents blob = decode_blob(data, size);
+                if (blob.raw.data) {
+                    return blob.raw.size;
                 }
+                return blob.raw_size > 0 ? static_cast<size_t>(blob.raw_size) : 0;
+            }
 
-                if (pbf_header_block.has_bbox()) {
-                    const OSMPBF::HeaderBBox& pbf_bbox = pbf_header_block.bbox();
-                    const int64_t resolution_convert = OSMPBF::lonlat_resolution / osmium::Location::coordinate_precision;
-                    osmium::Box box;
-                    box.extend(osmium::Location(pbf_bbox.left()  / resolution_convert, pbf_bbox.bottom() / resolution_convert));
-                    box.extend(osmium::Location(pbf_bbox.right() / resolution_convert, pbf_bbox.top()    / resolution_convert));
-                    header.add_box(box);
+            /**
+             * PBF blobs can optionally be packed with the zlib, zstd, or lz4
+             * algorithm. Support for zstd and lz4 has to be enabled at
+             * compile time by defining OSMIUM_WITH_ZSTD and OSMIUM_WITH_LZ4,
+             * respectively. This function returns the raw data (if it was not packed) or
+             * the unpacked data (if it was packed).
+             *
+             * @param data Pointer to Blob message.
+             * @param size Size of Blob message.
+             * @param output String used to store the unpacked data if the
+             *               data has to be unpacked.
+             * @returns View of the unpacked data. This points either into
+             *          the input data or into the output string.
+             * @throws osmium::pbf_error If there was a problem parsing the PBF
+             */
+            inline data_view unpack_blob(const char* data, size_t size, std::string& output) {
+                const blob_contents blob = decode_blob(data, size);
+
+                if (blob.raw.data) {
+                    return blob.raw;
+                } else if (blob.zlib_data.data) {
+                    osmium::io::detail::zlib_uncompress(blob.zlib_data.data, blob.zlib_data.size, static_cast<unsigned long>(blob.raw_size), output);
+                    return data_view(output.data(), output.size());
+                } else if (blob.zstd_data.data) {
+#ifdef OSMIUM_WITH_ZSTD
+                    osmium::io::detail::zstd_uncompress(blob.zstd_data.data, blob.zstd_data.size, static_cast<size_t>(blob.raw_size), output);
+                    return data_view(output.data(), output.size());
+#else
+                    throw osmium::pbf_error("zstd blobs not supported (compiled without zstd)");
+#endif
+                } else if (blob.lz4_data.data) {
+#ifdef OSMIUM_WITH_LZ4
+                    osmium::io::detail::lz4_uncompress(blob.lz4_data.data, blob.lz4_data.size, static_cast<size_t>(blob.raw_size), output);
+                    return data_view(output.data(), output.size());
+#else
+                    throw osmium::pbf_error("lz4 blobs not supported (compiled without lz4)");
+#endif
+                } else if (blob.has_lzma_data) {
+                    throw osmium::pbf_error("lzma blobs not implemented");
+                } else {
+                    throw osmium::pbf_error("blob contains no data");
                 }
+            }
 
-                if (pbf_header_block.has_osmosis_replication_timestamp()) {
-                    header.set("osmosis_replication_timestamp", osmium::Timestamp(pbf_header_block.osmosis_replication_timestamp()).to_iso());
+            /**
+             * Find out which type of OSM entity comes first in the given
+             * OSMData blob without parsing (or, in most cases, unpacking)
+             * all of it. Only the beginning of the PrimitiveBlock up to the
+             * first key of the first PrimitiveGroup is looked at. For zlib
+             * compressed blobs only that part is uncompressed. Blobs with
+             * other compression types are never looked into, they are cheap
+             * to uncompress completely anyway.
+             *
+             * @param data Pointer to Blob message.
+             * @param size Size of Blob message.
+             * @returns Type of the first entity or item_type::undefined if
+             *          this could not be determined.
+             * @throws osmium::pbf_error If there was a problem parsing the PBF
+             */
+            inline osmium::item_type peek_first_item_type(const char* data, size_t size) {
+                // a key or length varint is never longer than this
+                constexpr const size_t max_varint_length = 10;
+
+                const blob_contents blob = decode_blob(data, size);
+
+                std::unique_ptr<ZlibPartialUncompressor> uncompressor;
+                const char* begin;
+                size_t available;
+                if (blob.raw.data) {
+                    begin = blob.raw.data;
+                    available = blob.raw.size;
+                } else if (blob.zlib_data.data) {
+                    uncompressor.reset(new ZlibPartialUncompressor(blob.zlib_data.data, blob.zlib_data.size, static_cast<unsigned long>(blob.raw_size)));
+                    begin = uncompressor->data();
+                    available = 0;
+                } else {
+                    return osmium::item_type::undefined;
                 }
 
-                if (pbf_header_block.has_osmosis_replication_sequence_number()) {
-                    header.set("osmosis_replication_sequence_number", std::to_string(pbf_header_block.osmosis_replication_sequence_number()));
+                // Make sure at least min_size bytes are available (or as
+                // many as there are) and return the number of available
+                // bytes.
+                auto ensure = [&](size_t min_size) -> size_t {
+                    if (uncompressor && available < min_size) {
+                        available = uncompressor->uncompress_at_least(min_size);
+                    }
+                    return available;
+                };
+
+                size_t offset = 0;
+                while (offset < ensure(offset + 1)) {
+                    const char* pos = begin + offset;
+                    const char* end = begin + ensure(offset + 2 * max_varint_length);
+                    const uint64_t key = decode_varint(&pos, end);
+                    uint64_t length = 0;
+
+                    switch (key & 0x7) {
+                        case ProtobufReader::varint:
+                            decode_varint(&pos, end);
+                            break;
+                        case ProtobufReader::fixed64:
+                            length = 8;
+                            break;
+                        case ProtobufReader::length_delimited:
+                            length = decode_varint(&pos, end);
+                            if ((key >> 3) == 2 && length > 0) { // primitivegroup
+                                end = begin + ensure(static_cast<size_t>(pos - begin) + max_varint_length);
+                                switch (decode_varint(&pos, end) >> 3) {
+                                    case 1: // nodes
+                                    case 2: // dense
+                                        return osmium::item_type::node;
+                                    case 3: // ways
+                                        return osmium::item_type::way;
+                                    case 4: // relations
+                                        return osmium::item_type::relation;
+                                    default:
+                                        return osmium::item_type::undefined;
+                                }
+                            }
+                            break;
+                        case ProtobufReader::fixed32:
+                            length = 4;
+                            break;
+                        default:
+                            throw osmium::pbf_error("unsupported protobuf wire type");
+                    }
+
+                    if (length > static_cast<uint64_t>(max_uncompressed_blob_size)) {
+                        throw osmium::pbf_error("invalid field length in PrimitiveBlock");
+                    }
+                    offset = static_cast<size_t>(pos - begin) + static_cast<size_t>(length);
                 }
 
-                if (pbf_header_block.has_osmosis_replication_base_url()) {
-                    header.set("osmosis_replication_base_url", pbf_header_block.osmosis_replication_base_url());
+                return osmium::item_type::undefined;
+            }
+
+            /**
+             * Parse blob as a HeaderBlock.
+             *
+             * @param input_data Pointer to blob data
+             * @param input_size Size of blob data
+             * @returns Header object
+             * @throws osmium::pbf_error If there was a parsing error
+             */
+            inline osmium::io::Header parse_header_blob(const char* input_data, size_t input_size) {
+                std::string unpack_buffer;
+                const data_view data = unpack_blob(input_data, input_size, unpack_buffer);
+
+                osmium::io::Header header;
+                int num_optional_features = 0;
+
+                ProtobufReader pbf_header_block(data);
+                while (pbf_header_block.next()) {
+                    switch (pbf_header_block.tag()) {
+                        case 1: { // bbox
+                                int64_t left   = 0;
+                                int64_t right  = 0;
+                                int64_t top    = 0;
+                                int64_t bottom = 0;
+                                ProtobufReader pbf_bbox(pbf_header_block.get_view());
+                                while (pbf_bbox.next()) {
+                                    switch (pbf_bbox.tag()) {
+                                        case 1:
+                                            left = pbf_bbox.get_sint64();
+                                            break;
+                                        case 2:
+                                            right = pbf_bbox.get_sint64();
+                                            break;
+                                        case 3:
+                                            top = pbf_bbox.get_sint64();
+                                            break;
+                                        case 4:
+                                            bottom = pbf_bbox.get_sint64();
+                                            break;
+                                        default:
+                                            pbf_bbox.skip();
+                                    }
+                                }
+                                const int64_t resolution_convert = lonlat_resolution / osmium::Location::coordinate_precision;
+                                osmium::Box box;
+                                box.extend(osmium::Location(left  / resolution_convert, bottom / resolution_convert));
+                                box.extend(osmium::Location(right / resolution_convert, top    / resolution_convert));
+                                header.add_box(box);
+                            }
+                            break;
+                        case 4: { // required_features
+                                const data_view feature = pbf_header_block.get_view();
+                                if (feature == "OsmSchema-V0.6") {
+                                    break;
+                                }
+                                if (feature == "DenseNodes") {
+                                    header.set("pbf_dense_nodes", true);
+                                    break;
+                                }
+                                if (feature == "HistoricalInformation") {
+                                    header.set_has_multiple_object_versions(true);
+                                    break;
+                                }
+                                throw osmium::pbf_error(std::string("required feature not supported: ") + feature.to_string());
+                            }
+                        case 5: { // optional_features
+                                const std::string feature = pbf_header_block.get_string();
+                                if (feature == "Sort.Type_then_ID") {
+                                    header.set("sorting", "Type_then_ID");
+                                }
+                                header.set("pbf_optional_feature_" + std::to_string(num_optional_features++), feature);
+                            }
+                            break;
+                        case 16: // writingprogram
+                            header.set("generator", pbf_header_block.get_string());
+                            break;
+                        case 32: // osmosis_replication_timestamp
+                            header.set("osmosis_replication_timestamp", osmium::Timestamp(pbf_header_block.get_int64()).to_iso());
+                            break;
+                        case 33: // osmosis_replication_sequence_number
+                            header.set("osmosis_replication_sequence_number", std::to_string(pbf_header_block.get_int64()));
+                            break;
+                        case 34: // osmosis_replication_base_url
+                            header.set("osmosis_replication_base_url", pbf_header_block.get_string());
+                            break;
+                        default:
+                            pbf_header_block.skip();
+                    }
                 }
 
                 return header;
             }
 
+            inline osmium::io::Header parse_header_blob(const std::string& input_buffer) {
+                return parse_header_blob(input_buffer.data(), input_buffer.size());
+            }
+
+            /**
+             * Functor parsing one OSMData blob into a Buffer. The blob data
+             * is either owned by the parser (when it was read through the
+             * input queue) or it points into memory owned by someone else
+             * (for instance a memory mapped file). In the latter case the
+             * memory must stay valid until the parser has run.
+             */
             class DataBlobParser {
 
                 std::shared_ptr<std::string> m_input_buffer;
-                osmium::osm_entity_bits::type m_read_types;
+                const char* m_data;
+                size_t m_size;
+                osmium::io::detail::reader_options m_options;
+                osmium::thread::ByteBudget* m_budget;
+                size_t m_acquired;
+                std::shared_ptr<osmium::memory::BufferPool> m_buffer_pool;
+                uint32_t m_raw_data_flags;
+
+                static void check_size(size_t size) {
+                    if (size > static_cast<size_t>(max_uncompressed_blob_size)) {
+                        throw osmium::pbf_error(std::string("invalid blob size: " + std::to_string(size)));
+                    }
+                }
 
             public:
 
-                DataBlobParser(std::string&& input_buffer, osmium::osm_entity_bits::type read_types) :
+                DataBlobParser(std::string&& input_buffer, const osmium::io::detail::reader_options& options) :
                     m_input_buffer(std::make_shared<std::string>(std::move(input_buffer))),
-                    m_read_types(read_types) {
-                    if (input_buffer.size() > OSMPBF::max_uncompressed_blob_size) {
-                        throw osmium::pbf_error(std::string("invalid blob size: " + std::to_string(input_buffer.size())));
-                    }
+                    m_data(m_input_buffer->data()),
+                    m_size(m_input_buffer->size()),
+                    m_options(options),
+                    m_budget(nullptr),
+                    m_acquired(0),
+                    m_buffer_pool(),
+                    m_raw_data_flags(0) {
+                    check_size(m_size);
+                }
+
+                DataBlobParser(const char* data, size_t size, const osmium::io::detail::reader_options& options) :
+                    m_input_buffer(),
+                    m_data(data),
+                    m_size(size),
+                    m_options(options),
+                    m_budget(nullptr),
+                    m_acquired(0),
+                    m_buffer_pool(),
+                    m_raw_data_flags(0) {
+                    check_size(m_size);
                 }
-/*
-                DataBlobParser(const DataBlobParser& other) :
-                    m_input_buffer(std::move(other.m_input_buffer)),
-                    m_read_types(other.m_read_types) {
-                }*/
 
                 DataBlobParser(const DataBlobParser&) = default;
                 DataBlobParser& operator=(const DataBlobParser&) = default;
@@ -438,10 +1049,53 @@ namespace osmium {
 
                 ~DataBlobParser() = default;
 
+                /**
+                 * Set the budget from which acquired bytes were taken for
+                 * the result of this parser. Once the result is known, the
+                 * budget is corrected to its actual size.
+                 */
+                void set_budget(osmium::thread::ByteBudget* budget, size_t acquired) noexcept {
+                    m_budget = budget;
+                    m_acquired = acquired;
+                }
+
+                /**
+                 * Set the pool from which the buffer for the result is taken.
+                 */
+                void set_buffer_pool(const std::shared_ptr<osmium::memory::BufferPool>& buffer_pool) noexcept {
+                    m_buffer_pool = buffer_pool;
+                }
+
+                /**
+                 * Set the flags attached to the buffer together with the
+                 * raw data (see pbf_raw_blob_history).
+                 */
+                void set_raw_data_flags(uint32_t flags) noexcept {
+                    m_raw_data_flags = flags;
+                }
+
                 osmium::memory::Buffer operator()() {
-                    const std::unique_ptr<const std::string> data = unpack_blob(*m_input_buffer);
-                    PBFPrimitiveBlockParser parser(*data, m_read_types);
-                    return parser();
+                    // The memory for the uncompressed data is kept around
+                    // for the next blob parsed in the same thread.
+                    static thread_local std::string unpack_buffer;
+                    PBFPrimitiveBlockParser parser(unpack_blob(m_data, m_size, unpack_buffer), m_options, m_buffer_pool.get());
+                    osmium::memory::Buffer buffer = parser();
+
+                    // The blob is copied if it is in the input memory,
+                    // because the buffer might outlive the Reader.
+                    if (m_options.keeps_raw_data()) {
+                        buffer.set_raw_data(m_input_buffer ? m_input_buffer : std::make_shared<std::string>(m_data, m_size), m_raw_data_flags);
+                    }
+
+                    if (m_budget) {
+                        if (buffer.committed() > m_acquired) {
+                            m_budget->force_acquire(buffer.committed() - m_acquired);
+                        } else {
+                            m_budget->release(m_acquired - buffer.committed());
+                        }
+                    }
+
+                    return buffer;
                 }
 
             }; // class DataBlobParser
@@ -34,15 +34,14 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
 #include <cstdint>
-#include <iterator>
-#include <map>
+#include <cstring>
 #include <string>
-#include <utility>
 #include <vector>
 
-#include <osmpbf/osmpbf.h>
-
+#include <osmium/io/detail/protobuf.hpp>
 #include <osmium/util/cast.hpp>
 
 namespace osmium {
@@ -58,27 +57,29 @@ namespace osmium {
              * one row for each used string, so strings that are used multiple times need to be
              * stored only once. The StringTable is sorted by usage-count, so the most often used
              * string is stored at index 1.
+             *
+             * The strings of a block are copied into one arena and found
+             * through an open-addressing hash table with linear probing.
+             * All memory is kept when the table is cleared, so it is reused
+             * for the next block.
              */
             class StringTable {
 
             public:
 
                 /// type for string IDs (interim and final)
-                typedef uint16_t string_id_type;
+                typedef uint32_t string_id_type;
 
             private:
 
                 /**
-                 * this is the struct used to build the StringTable. It is stored as
-                 * the value-part in the strings-map.
+                 * When a new string is recorded, it gets the next interim id
+                 * which is then stored into the pbf-objects.
                  *
-                 * when a new string is added to the map, its count is set to 0 and
-                 * the interim_id is set to the current size of the map. This interim_id
-                 * is then stored into the pbf-objects.
-                 *
-                 * before the PrimitiveBlock is serialized, the map is sorted by count
-                 * and stored into the pbf-StringTable. Afterwards the interim-ids are
-                 * mapped to the "real" id in the StringTable.
+                 * before the PrimitiveBlock is serialized, the strings are
+                 * sorted by count and stored into the pbf-StringTable.
+                 * Afterwards the interim-ids are mapped to the "real" id in
+                 * the StringTable.
                  *
                  * this way often used strings get lower ids in the StringTable. As the
                  * protobuf-serializer stores numbers in variable bit-lengths, lower
@@ -86,89 +87,210 @@ namespace osmium {
                  */
                 struct string_info {
 
-                    /// number of occurrences of this string
-                    uint16_t count;
+                    /// offset of the string in the arena
+                    uint32_t offset;
+
+                    /// length of the string
+                    uint32_t length;
 
-                    /// an intermediate-id
-                    string_id_type interim_id;
+                    /// hash of the string
+                    uint32_t hash;
+
+                    /// number of occurrences of this string (minus one)
+                    uint32_t count;
+
+                    /// slot in the hash table containing this string
+                    uint32_t slot;
 
                 }; // struct string_info
 
+                static constexpr size_t min_slots = 1024;
+
+                /// Contents of all strings, one after the other.
+                std::string m_arena;
+
+                /// Strings indexed by interim id - 1.
+                std::vector<string_info> m_strings;
+
                 /**
-                 * Interim StringTable, storing all strings that should be written to
-                 * the StringTable once the block is written to disk.
+                 * Hash table containing interim ids. 0 marks an empty slot.
+                 * The size is always a power of two.
                  */
-                typedef std::map<std::string, string_info> string2string_info_type;
-                string2string_info_type m_strings;
+                std::vector<string_id_type> m_slots;
 
                 /**
                  * This vector is used to map the interim IDs to real StringTable IDs after
                  * writing all strings to the StringTable.
                  */
-                typedef std::vector<string_id_type> interim_id2id_type;
-                interim_id2id_type m_id2id_map;
+                std::vector<string_id_type> m_id2id_map;
 
-                size_t m_size = 0;
+                /// Scratch space for sorting the strings.
+                std::vector<string_id_type> m_order;
 
-            public:
+                /// Interim ids of all recorded strings in recording order.
+                std::vector<string_id_type> m_recorded_ids;
 
-                StringTable() {
+                /// Position in m_recorded_ids of the next string_id() call.
+                size_t m_next_id;
+
+                static uint32_t hash(const char* string, size_t length) noexcept {
+                    // FNV-1a
+                    uint32_t h = 2166136261u;
+                    for (size_t i = 0; i < length; ++i) {
+                        h ^= static_cast<unsigned char>(string[i]);
+                        h *= 16777619u;
+                    }
+                    return h;
                 }
 
-                friend bool operator<(const string_info& lhs, const string_info& rhs) {
-                    return lhs.count > rhs.count;
+                const char* data(const string_info& info) const noexcept {
+                    return m_arena.data() + info.offset;
+                }
+
+                /**
+                 * Compare strings by count (descending) and then
+                 * lexicographically.
+                 */
+                bool comes_before(const string_info& lhs, const string_info& rhs) const noexcept {
+                    if (lhs.count != rhs.count) {
+                        return lhs.count > rhs.count;
+                    }
+                    const int cmp = std::memcmp(data(lhs), data(rhs), std::min(lhs.length, rhs.length));
+                    if (cmp != 0) {
+                        return cmp < 0;
+                    }
+                    return lhs.length < rhs.length;
+                }
+
+                void grow() {
+                    // min_slots must not be bound to a reference (by std::max),
+                    // it has no out-of-class definition
+                    const size_t min_size = min_slots;
+                    std::vector<string_id_type> slots(std::max(min_size, m_slots.size() * 2), 0);
+                    const size_t mask = slots.size() - 1;
+                    for (size_t i = 0; i < m_strings.size(); ++i) {
+                        size_t slot = m_strings[i].hash & mask;
+                        while (slots[slot] != 0) {
+                            slot = (slot + 1) & mask;
+                        }
+                        slots[slot] = static_cast_with_assert<string_id_type>(i + 1);
+                        m_strings[i].slot = static_cast<uint32_t>(slot);
+                    }
+                    using std::swap;
+                    swap(m_slots, slots);
+                }
+
+                /**
+                 * Find the slot in the hash table containing the given
+                 * string or the empty slot where it should be added.
+                 */
+                size_t find_slot(const char* string, size_t length, uint32_t h) const noexcept {
+                    const size_t mask = m_slots.size() - 1;
+                    size_t slot = h & mask;
+                    while (m_slots[slot] != 0) {
+                        const string_info& info = m_strings[m_slots[slot] - 1];
+                        if (info.hash == h && info.length == length && std::memcmp(data(info), string, length) == 0) {
+                            break;
+                        }
+                        slot = (slot + 1) & mask;
+                    }
+                    return slot;
+                }
+
+            public:
+
+                StringTable() :
+                    m_arena(),
+                    m_strings(),
+                    m_slots(min_slots, 0),
+                    m_id2id_map(),
+                    m_order(),
+                    m_recorded_ids(),
+                    m_next_id(0) {
                 }
 
                 /**
                  * record a string in the interim StringTable if it's missing, otherwise just increase its counter,
                  * return the interim-id assigned to the string.
+                 *
+                 * The interim id is also remembered, so that string_id()
+                 * can later return the real ids in the same order without
+                 * looking up the strings again.
                  */
-                string_id_type record_string(const std::string& string) {
-                    string_info& info = m_strings[string];
-                    if (info.interim_id == 0) {
-                        ++m_size;
-                        info.interim_id = static_cast_with_assert<string_id_type>(m_size);
-                    } else {
-                        info.count++;
+                string_id_type record_string(const char* string, size_t length) {
+                    const uint32_t h = hash(string, length);
+                    const size_t slot = find_slot(string, length, h);
+
+                    if (m_slots[slot] != 0) {
+                        ++m_strings[m_slots[slot] - 1].count;
+                        m_recorded_ids.push_back(m_slots[slot]);
+                        return m_slots[slot];
                     }
-                    return info.interim_id;
+
+                    m_strings.push_back(string_info{static_cast_with_assert<uint32_t>(m_arena.size()), static_cast_with_assert<uint32_t>(length), h, 0, static_cast<uint32_t>(slot)});
+                    m_arena.append(string, length);
+                    const string_id_type interim_id = static_cast_with_assert<string_id_type>(m_strings.size());
+                    m_slots[slot] = interim_id;
+                    m_recorded_ids.push_back(interim_id);
+
+                    // keep the load factor below 1/2
+                    if (m_strings.size() * 2 > m_slots.size()) {
+                        grow();
+                    }
+
+                    return interim_id;
+                }
+
+                string_id_type record_string(const char* string) {
+                    return record_string(string, std::strlen(string));
+                }
+
+                string_id_type record_string(const std::string& string) {
+                    return record_string(string.data(), string.size());
+                }
+
+                /**
+                 * Number of different strings recorded.
+                 */
+                size_t size() const noexcept {
+                    return m_strings.size();
                 }
 
                 /**
-                 * Sort the interim StringTable and store it to the real protobuf StringTable.
-                 * while storing to the real table, this function fills the id2id_map with
-                 * pairs, mapping the interim-ids to final and real StringTable ids.
+                 * Sort the interim StringTable and add the strings to the
+                 * protobuf StringTable message. While storing to the real table,
+                 * this function fills the id2id_map with pairs, mapping the
+                 * interim-ids to final and real StringTable ids.
                  *
-                 * Note that the m_strings table is a std::map and as such is sorted lexicographically.
-                 * When the transformation into the sortedby multimap is done, it gets sorted by
-                 * the count. The end result (at least with the glibc standard container/algorithm
-                 * implementation) is that the string table is sorted first by reverse count (ie descending)
-                 * and then by reverse lexicographic order.
+                 * The string table is sorted first by reverse count (ie descending)
+                 * and then by lexicographic order, so the output doesn't
+                 * depend on the order the strings were recorded in.
                  */
-                void store_stringtable(OSMPBF::StringTable* st) {
+                void store_stringtable(ProtobufWriter& pbf_string_table) {
                     // add empty StringTable entry at index 0
                     // StringTable index 0 is reserved as delimiter in the densenodes key/value list
                     // this line also ensures that there's always a valid StringTable
-                    st->add_s("");
-
-                    std::multimap<string_info, std::string> sortedbycount;
-
-                    m_id2id_map.resize(m_size+1);
+                    pbf_string_table.add_bytes(1, "", 0);
 
-                    std::transform(m_strings.begin(), m_strings.end(),
-                                std::inserter(sortedbycount, sortedbycount.begin()),
-                                [](const std::pair<std::string, string_info>& p) {
-                                        return std::pair<string_info, std::string>(p.second, p.first);
-                                });
+                    m_order.resize(m_strings.size());
+                    for (size_t i = 0; i < m_strings.size(); ++i) {
+                        m_order[i] = static_cast_with_assert<string_id_type>(i);
+                    }
+                    std::sort(m_order.begin(), m_order.end(), [this](string_id_type lhs, string_id_type rhs) {
+                        return comes_before(m_strings[lhs], m_strings[rhs]);
+                    });
 
-                    string_id_type n=0;
+                    m_id2id_map.resize(m_strings.size() + 1);
+                    m_id2id_map[0] = 0;
+                    string_id_type n = 0;
+                    for (const auto index : m_order) {
+                        const string_info& info = m_strings[index];
 
-                    for (const auto& mapping : sortedbycount) {
                         // add the string of the current item to the pbf StringTable
-                        st->add_s(mapping.second);
+                        pbf_string_table.add_bytes(1, data(info), info.length);
 
                         // store the mapping from the interim-id to the real id
-                        m_id2id_map[mapping.first.interim_id] = ++n;
+                        m_id2id_map[index + 1] = ++n;
                     }
                 }
 
@@ -185,12 +307,38 @@ namespace osmium {
                 }
 
                 /**
-                 * Clear the stringtable, preparing for the next block.
+                 * Get the real StringTable ID of the next string. The
+                 * strings must be asked for in exactly the order they were
+                 * recorded in and store_stringtable() must have been called
+                 * before.
+                 */
+                string_id_type string_id() {
+                    assert(m_next_id < m_recorded_ids.size());
+                    return map_string_id(m_recorded_ids[m_next_id++]);
+                }
+
+                /**
+                 * Have the real ids of all recorded strings been asked for?
+                 */
+                bool all_ids_used() const noexcept {
+                    return m_next_id == m_recorded_ids.size();
+                }
+
+                /**
+                 * Clear the stringtable, preparing for the next block. The
+                 * memory is kept for reuse. Only the used slots of the
+                 * hash table are reset.
                  */
                 void clear() {
+                    for (const auto& info : m_strings) {
+                        m_slots[info.slot] = 0;
+                    }
+                    m_arena.clear();
                     m_strings.clear();
                     m_id2id_map.clear();
-                    m_size = 0;
+                    m_order.clear();
+                    m_recorded_ids.clear();
+                    m_next_id = 0;
                 }
 
             }; // class StringTable
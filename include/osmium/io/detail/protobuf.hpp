@@ -0,0 +1,522 @@
+#ifndef OSMIUM_IO_DETAIL_PROTOBUF_HPP
+#define OSMIUM_IO_DETAIL_PROTOBUF_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <osmium/io/detail/pbf.hpp>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * A pointer to some data and its size. The data is not owned.
+             * Used to reference strings and sub-messages inside protobuf
+             * encoded data without copying them.
+             */
+            struct data_view {
+
+                const char* data;
+                size_t size;
+
+                data_view() noexcept :
+                    data(nullptr),
+                    size(0) {
+                }
+
+                data_view(const char* d, size_t s) noexcept :
+                    data(d),
+                    size(s) {
+                }
+
+                bool empty() const noexcept {
+                    return size == 0;
+                }
+
+                std::string to_string() const {
+                    return std::string(data, size);
+                }
+
+                bool operator==(const char* str) const noexcept {
+                    size_t i = 0;
+                    for (; i < size; ++i) {
+                        if (str[i] != data[i]) {
+                            return false;
+                        }
+                    }
+                    return str[i] == '\0';
+                }
+
+                bool operator!=(const char* str) const noexcept {
+                    return !(*this == str);
+                }
+
+            }; // struct data_view
+
+            /**
+             * Decode a varint from the data pointed to by *data and advance
+             * *data to the first byte after it.
+             *
+             * @throws osmium::pbf_error If the varint is truncated or too long.
+             */
+            inline uint64_t decode_varint(const char** data, const char* end) {
+                const int8_t* p = reinterpret_cast<const int8_t*>(*data);
+                const int8_t* const e = reinterpret_cast<const int8_t*>(end);
+
+                // fast path for the very common one byte case
+                if (p != e && *p >= 0) {
+                    ++*data;
+                    return static_cast<uint64_t>(*p);
+                }
+
+                uint64_t value = 0;
+                int shift = 0;
+                while (p != e && shift < 64) {
+                    const uint8_t byte = static_cast<uint8_t>(*p++);
+                    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                    if (!(byte & 0x80)) {
+                        *data = reinterpret_cast<const char*>(p);
+                        return value;
+                    }
+                    shift += 7;
+                }
+
+                throw osmium::pbf_error(p == e ? "truncated varint" : "varint too long");
+            }
+
+            inline constexpr int64_t decode_zigzag64(uint64_t value) noexcept {
+                return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+            }
+
+            inline constexpr int32_t decode_zigzag32(uint32_t value) noexcept {
+                return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+            }
+
+            inline constexpr uint64_t encode_zigzag64(int64_t value) noexcept {
+                return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+            }
+
+            inline constexpr uint32_t encode_zigzag32(int32_t value) noexcept {
+                return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+            }
+
+            /**
+             * Iterates over the values of a packed repeated varint field
+             * (protobuf type int32, int64, uint32, uint64, sint32, sint64,
+             * bool, or enum). Call one of the next_*() functions matching
+             * the field type while empty() returns false.
+             */
+            class PackedVarintReader {
+
+                const char* m_data;
+                const char* m_end;
+
+            public:
+
+                PackedVarintReader() noexcept :
+                    m_data(nullptr),
+                    m_end(nullptr) {
+                }
+
+                explicit PackedVarintReader(const data_view& view) noexcept :
+                    m_data(view.data),
+                    m_end(view.data + view.size) {
+                }
+
+                bool empty() const noexcept {
+                    return m_data == m_end;
+                }
+
+                /**
+                 * The number of values left. This has to look at all the
+                 * data, so it is O(n).
+                 */
+                size_t count() const noexcept {
+                    size_t n = 0;
+                    for (const char* p = m_data; p != m_end; ++p) {
+                        if (!(static_cast<uint8_t>(*p) & 0x80)) {
+                            ++n;
+                        }
+                    }
+                    return n;
+                }
+
+                uint64_t next_uint64() {
+                    if (empty()) {
+                        throw osmium::pbf_error("packed field too short");
+                    }
+                    return decode_varint(&m_data, m_end);
+                }
+
+                uint32_t next_uint32() {
+                    return static_cast<uint32_t>(next_uint64());
+                }
+
+                int64_t next_int64() {
+                    return static_cast<int64_t>(next_uint64());
+                }
+
+                int32_t next_int32() {
+                    return static_cast<int32_t>(next_uint64());
+                }
+
+                int64_t next_sint64() {
+                    return decode_zigzag64(next_uint64());
+                }
+
+                int32_t next_sint32() {
+                    return decode_zigzag32(static_cast<uint32_t>(next_uint64()));
+                }
+
+                bool next_bool() {
+                    return next_uint64() != 0;
+                }
+
+            }; // class PackedVarintReader
+
+            /**
+             * Minimal streaming decoder for protobuf messages. It works
+             * directly on the encoded data, nothing is copied and there is
+             * no need for generated code.
+             *
+             * Usage:
+             * @code
+             * ProtobufReader message(data, size);
+             * while (message.next()) {
+             *     switch (message.tag()) {
+             *         case 1:
+             *             id = message.get_int64();
+             *             break;
+             *         default:
+             *             message.skip();
+             *     }
+             * }
+             * @endcode
+             *
+             * All functions throw osmium::pbf_error if the data is not
+             * valid.
+             */
+            class ProtobufReader {
+
+                const char* m_data;
+                const char* m_end;
+                uint32_t m_tag;
+                uint32_t m_wire_type;
+
+                void check_wire_type(uint32_t wire_type) const {
+                    if (m_wire_type != wire_type) {
+                        throw osmium::pbf_error("unexpected protobuf wire type");
+                    }
+                }
+
+                void skip_bytes(size_t len) {
+                    if (static_cast<size_t>(m_end - m_data) < len) {
+                        throw osmium::pbf_error("truncated protobuf data");
+                    }
+                    m_data += len;
+                }
+
+            public:
+
+                enum wire_type : uint32_t {
+                    varint           = 0,
+                    fixed64          = 1,
+                    length_delimited = 2,
+                    fixed32          = 5
+                };
+
+                ProtobufReader() noexcept :
+                    m_data(nullptr),
+                    m_end(nullptr),
+                    m_tag(0),
+                    m_wire_type(0) {
+                }
+
+                ProtobufReader(const char* data, size_t size) noexcept :
+                    m_data(data),
+                    m_end(data + size),
+                    m_tag(0),
+                    m_wire_type(0) {
+                }
+
+                explicit ProtobufReader(const data_view& view) noexcept :
+                    ProtobufReader(view.data, view.size) {
+                }
+
+                /**
+                 * Move to the next field. Returns false at the end of the
+                 * message.
+                 */
+                bool next() {
+                    if (m_data == m_end) {
+                        return false;
+                    }
+                    const uint64_t key = decode_varint(&m_data, m_end);
+                    m_tag = static_cast<uint32_t>(key >> 3);
+                    m_wire_type = static_cast<uint32_t>(key & 0x7);
+                    if (m_tag == 0) {
+                        throw osmium::pbf_error("invalid protobuf field tag");
+                    }
+                    return true;
+                }
+
+                /// The tag (field number) of the current field.
+                uint32_t tag() const noexcept {
+                    return m_tag;
+                }
+
+                /**
+                 * Skip the current field.
+                 */
+                void skip() {
+                    switch (m_wire_type) {
+                        case varint:
+                            decode_varint(&m_data, m_end);
+                            break;
+                        case fixed64:
+                            skip_bytes(8);
+                            break;
+                        case length_delimited:
+                            skip_bytes(static_cast<size_t>(decode_varint(&m_data, m_end)));
+                            break;
+                        case fixed32:
+                            skip_bytes(4);
+                            break;
+                        default:
+                            throw osmium::pbf_error("unsupported protobuf wire type");
+                    }
+                }
+
+                uint64_t get_uint64() {
+                    check_wire_type(varint);
+                    return decode_varint(&m_data, m_end);
+                }
+
+                uint32_t get_uint32() {
+                    return static_cast<uint32_t>(get_uint64());
+                }
+
+                int64_t get_int64() {
+                    return static_cast<int64_t>(get_uint64());
+                }
+
+                int32_t get_int32() {
+                    return static_cast<int32_t>(get_uint64());
+                }
+
+                int64_t get_sint64() {
+                    return decode_zigzag64(get_uint64());
+                }
+
+                int32_t get_sint32() {
+                    return decode_zigzag32(static_cast<uint32_t>(get_uint64()));
+                }
+
+                bool get_bool() {
+                    return get_uint64() != 0;
+                }
+
+                /**
+                 * Get the contents of a length-delimited field (string,
+                 * bytes, embedded message, or packed repeated field).
+                 */
+                data_view get_view() {
+                    check_wire_type(length_delimited);
+                    const size_t len = static_cast<size_t>(decode_varint(&m_data, m_end));
+                    const char* data = m_data;
+                    skip_bytes(len);
+                    return data_view(data, len);
+                }
+
+                std::string get_string() {
+                    return get_view().to_string();
+                }
+
+                /**
+                 * Get a reader for a packed repeated varint field.
+                 */
+                PackedVarintReader get_packed() {
+                    return PackedVarintReader(get_view());
+                }
+
+            }; // class ProtobufReader
+
+            /**
+             * Minimal protobuf encoder appending the fields of a message
+             * to a string. This is the counterpart of the ProtobufReader.
+             *
+             * Fields are written in the order the add_*() functions are
+             * called. To get the same output as the protobuf library
+             * creates they must be added ordered by their tags.
+             *
+             * Embedded messages and packed repeated fields are written
+             * between open_submessage() and close_submessage(). Their
+             * contents are added with add_varint() or the add_*() functions
+             * with a tag, respectively. Because the length isn't known in
+             * advance, some space is reserved for it and the contents are
+             * moved back when the length is written.
+             *
+             * Usage:
+             * @code
+             * std::string data;
+             * ProtobufWriter message(data);
+             * message.add_int64(1, id);
+             * const auto pos = message.open_submessage(8);
+             * for (const auto ref : refs) {
+             *     message.add_varint(encode_zigzag64(ref));
+             * }
+             * message.close_submessage(pos);
+             * @endcode
+             */
+            class ProtobufWriter {
+
+                /// Number of bytes reserved for the length of a submessage.
+                static constexpr size_t reserved_length_bytes = 5;
+
+                std::string& m_data;
+
+                static size_t encode_varint(char* buffer, uint64_t value) noexcept {
+                    size_t n = 0;
+                    while (value >= 0x80) {
+                        buffer[n++] = static_cast<char>((value & 0x7f) | 0x80);
+                        value >>= 7;
+                    }
+                    buffer[n++] = static_cast<char>(value);
+                    return n;
+                }
+
+                void add_key(uint32_t tag, ProtobufReader::wire_type type) {
+                    add_varint((static_cast<uint64_t>(tag) << 3) | type);
+                }
+
+            public:
+
+                explicit ProtobufWriter(std::string& data) noexcept :
+                    m_data(data) {
+                }
+
+                /**
+                 * Add a varint without a key. Used for the values of packed
+                 * repeated fields.
+                 */
+                void add_varint(uint64_t value) {
+                    char buffer[10];
+                    m_data.append(buffer, encode_varint(buffer, value));
+                }
+
+                void add_uint64(uint32_t tag, uint64_t value) {
+                    add_key(tag, ProtobufReader::varint);
+                    add_varint(value);
+                }
+
+                void add_uint32(uint32_t tag, uint32_t value) {
+                    add_uint64(tag, value);
+                }
+
+                void add_int64(uint32_t tag, int64_t value) {
+                    add_uint64(tag, static_cast<uint64_t>(value));
+                }
+
+                void add_int32(uint32_t tag, int32_t value) {
+                    // negative values are sign extended to 64 bit
+                    add_uint64(tag, static_cast<uint64_t>(value));
+                }
+
+                void add_sint64(uint32_t tag, int64_t value) {
+                    add_uint64(tag, encode_zigzag64(value));
+                }
+
+                void add_sint32(uint32_t tag, int32_t value) {
+                    add_uint64(tag, encode_zigzag32(value));
+                }
+
+                void add_bool(uint32_t tag, bool value) {
+                    add_uint64(tag, value ? 1 : 0);
+                }
+
+                /**
+                 * Add a string or bytes field.
+                 */
+                void add_bytes(uint32_t tag, const char* data, size_t size) {
+                    add_key(tag, ProtobufReader::length_delimited);
+                    add_varint(size);
+                    m_data.append(data, size);
+                }
+
+                void add_bytes(uint32_t tag, const std::string& data) {
+                    add_bytes(tag, data.data(), data.size());
+                }
+
+                /**
+                 * Start an embedded message or a packed repeated field with
+                 * the given tag. Returns the position that has to be given
+                 * to close_submessage().
+                 */
+                size_t open_submessage(uint32_t tag) {
+                    add_key(tag, ProtobufReader::length_delimited);
+                    const size_t pos = m_data.size();
+                    m_data.append(reserved_length_bytes, '\0');
+                    return pos;
+                }
+
+                /**
+                 * Finish an embedded message or a packed repeated field
+                 * started with open_submessage(). Submessages opened later
+                 * must be closed first.
+                 */
+                void close_submessage(size_t pos) {
+                    const size_t length = m_data.size() - pos - reserved_length_bytes;
+                    assert(length < (1ULL << (7 * reserved_length_bytes)));
+                    char buffer[10];
+                    const size_t n = encode_varint(buffer, length);
+                    std::copy_n(buffer, n, &m_data[pos]);
+                    m_data.erase(pos + n, reserved_length_bytes - n);
+                }
+
+            }; // class ProtobufWriter
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_PROTOBUF_HPP
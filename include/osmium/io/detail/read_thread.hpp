@@ -34,14 +34,11 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <atomic>
-#include <chrono>
-#include <ratio>
 #include <string>
-#include <thread>
 #include <utility>
 
 #include <osmium/io/compression.hpp>
-#include <osmium/thread/queue.hpp>
+#include <osmium/io/detail/input_format.hpp>
 #include <osmium/thread/util.hpp>
 
 namespace osmium {
@@ -52,7 +49,7 @@ namespace osmium {
 
             class ReadThread {
 
-                osmium::thread::Queue<std::string>& m_queue;
+                osmium::io::detail::input_queue_type& m_queue;
                 osmium::io::Decompressor* m_decompressor;
 
                 // If this is set in the main thread, we have to wrap up at the
@@ -61,7 +58,7 @@ namespace osmium {
 
             public:
 
-                explicit ReadThread(osmium::thread::Queue<std::string>& queue, osmium::io::Decompressor* decompressor, std::atomic<bool>& done) :
+                explicit ReadThread(osmium::io::detail::input_queue_type& queue, osmium::io::Decompressor* decompressor, std::atomic<bool>& done) :
                     m_queue(queue),
                     m_decompressor(decompressor),
                     m_done(done) {
@@ -77,10 +74,10 @@ namespace osmium {
                                 m_queue.push(std::move(data));
                                 break;
                             }
+                            // Blocks while the queue is full. The Reader
+                            // shuts the queue down when it is closed, so
+                            // this will not block forever.
                             m_queue.push(std::move(data));
-                            while (m_queue.size() > 10 && !m_done) {
-                                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                            }
                         }
 
                         m_decompressor->close();
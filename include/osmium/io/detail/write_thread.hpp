@@ -60,18 +60,35 @@ namespace osmium {
                     m_compressor(compressor) {
                 }
 
+                /**
+                 * Write all data from the queue until the empty string
+                 * marking the end of data arrives.
+                 *
+                 * @returns true if all data was written, false if the
+                 *          queue was shut down before the end of data.
+                 */
                 bool operator()() {
                     osmium::thread::set_thread_name("_osmium_output");
 
-                    std::future<std::string> data_future;
-                    std::string data;
-                    do {
-                        m_input_queue.wait_and_pop(data_future);
-                        data = data_future.get();
-                        m_compressor->write(data);
-                    } while (!data.empty());
-
-                    m_compressor->close();
+                    try {
+                        std::future<std::string> data_future;
+                        std::string data;
+                        do {
+                            if (!m_input_queue.wait_and_pop(data_future)) {
+                                return false;
+                            }
+                            data = data_future.get();
+                            m_compressor->write(data);
+                        } while (!data.empty());
+
+                        m_compressor->close();
+                    } catch (...) {
+                        // Nobody will read from the queue any more, make
+                        // sure the Writer doesn't block on a full queue
+                        // before it sees the exception.
+                        m_input_queue.shutdown();
+                        throw;
+                    }
                     return true;
                 }
 
@@ -33,12 +33,15 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <exception>
 #include <future>
 #include <iostream>
@@ -49,6 +52,7 @@ DEALINGS IN THE SOFTWARE.
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include <expat.h>
 
@@ -59,13 +63,17 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/memory/buffer_pool.hpp>
 #include <osmium/osm.hpp>
 #include <osmium/osm/box.hpp>
 #include <osmium/osm/entity_bits.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/object.hpp>
+#include <osmium/osm/timestamp.hpp>
 #include <osmium/osm/types.hpp>
+#include <osmium/thread/byte_budget.hpp>
+#include <osmium/thread/pool.hpp>
 #include <osmium/thread/queue.hpp>
 #include <osmium/thread/util.hpp>
 #include <osmium/util/cast.hpp>
@@ -143,6 +151,30 @@ namespace osmium {
             class ParserIsDone : std::exception {
             };
 
+            /**
+             * A helper class that makes sure a promise is kept. It stores
+             * a reference to some piece of data and to a promise and, on
+             * destruction, sets the value of the promise from the data.
+             */
+            template <class T>
+            class PromiseKeeper {
+
+                T& m_data;
+                std::promise<T>& m_promise;
+
+            public:
+
+                PromiseKeeper(T& data, std::promise<T>& promise) :
+                    m_data(data),
+                    m_promise(promise) {
+                }
+
+                ~PromiseKeeper() {
+                    m_promise.set_value(m_data);
+                }
+
+            }; // class PromiseKeeper
+
             class XMLParser {
 
                 static constexpr int buffer_size = 10 * 1000 * 1000;
@@ -172,6 +204,8 @@ namespace osmium {
 
                 osmium::io::Header m_header;
 
+                std::shared_ptr<osmium::memory::BufferPool> m_buffer_pool;
+
                 osmium::memory::Buffer m_buffer;
 
                 std::unique_ptr<osmium::builder::NodeBuilder>               m_node_builder;
@@ -183,13 +217,17 @@ namespace osmium {
                 std::unique_ptr<osmium::builder::WayNodeListBuilder>        m_wnl_builder;
                 std::unique_ptr<osmium::builder::RelationMemberListBuilder> m_rml_builder;
 
-                osmium::thread::Queue<std::string>& m_input_queue;
-                osmium::thread::Queue<osmium::memory::Buffer>& m_queue;
-                std::promise<osmium::io::Header>& m_header_promise;
+                // These are not set when parsing chunks of XML data
+                // (see parse_chunk()).
+                osmium::io::detail::input_queue_type* m_input_queue;
+                osmium::thread::Queue<osmium::memory::Buffer>* m_queue;
+                std::promise<osmium::io::Header>* m_header_promise;
 
                 osmium::osm_entity_bits::type m_read_types;
+                osmium::Box m_bbox;
+                bool m_read_metadata;
 
-                std::atomic<bool>& m_done;
+                std::atomic<bool>* m_done;
 
                 /**
                  * A C++ wrapper for the Expat parser that makes sure no memory is leaked.
@@ -236,38 +274,15 @@ namespace osmium {
 
                 }; // class ExpatXMLParser
 
-                /**
-                 * A helper class that makes sure a promise is kept. It stores
-                 * a reference to some piece of data and to a promise and, on
-                 * destruction, sets the value of the promise from the data.
-                 */
-                template <class T>
-                class PromiseKeeper {
-
-                    T& m_data;
-                    std::promise<T>& m_promise;
-
-                public:
-
-                    PromiseKeeper(T& data, std::promise<T>& promise) :
-                        m_data(data),
-                        m_promise(promise) {
-                    }
-
-                    ~PromiseKeeper() {
-                        m_promise.set_value(m_data);
-                    }
-
-                }; // class PromiseKeeper
-
             public:
 
-                explicit XMLParser(osmium::thread::Queue<std::string>& input_queue, osmium::thread::Queue<osmium::memory::Buffer>& queue, std::promise<osmium::io::Header>& header_promise, osmium::osm_entity_bits::type read_types, std::atomic<bool>& done) :
+                explicit XMLParser(osmium::io::detail::input_queue_type& input_queue, osmium::thread::Queue<osmium::memory::Buffer>& queue, std::promise<osmium::io::Header>& header_promise, const osmium::io::detail::reader_options& options, const std::shared_ptr<osmium::memory::BufferPool>& buffer_pool, std::atomic<bool>& done) :
                     m_context(context::root),
                     m_last_context(context::root),
                     m_in_delete_section(false),
                     m_header(),
-                    m_buffer(buffer_size),
+                    m_buffer_pool(buffer_pool),
+                    m_buffer(m_buffer_pool->get_buffer(buffer_size)),
                     m_node_builder(),
                     m_way_builder(),
                     m_relation_builder(),
@@ -275,11 +290,46 @@ namespace osmium {
                     m_tl_builder(),
                     m_wnl_builder(),
                     m_rml_builder(),
-                    m_input_queue(input_queue),
-                    m_queue(queue),
-                    m_header_promise(header_promise),
-                    m_read_types(read_types),
-                    m_done(done) {
+                    m_input_queue(&input_queue),
+                    m_queue(&queue),
+                    m_header_promise(&header_promise),
+                    m_read_types(options.read_which_entities),
+                    m_bbox(options.bbox),
+                    m_read_metadata(options.read_metadata == osmium::io::read_meta::yes),
+                    m_done(&done) {
+                }
+
+                /**
+                 * Create a parser for use with parse_header() or
+                 * parse_chunk().
+                 *
+                 * @param options Options from the Reader.
+                 * @param buffer_pool The buffer for the result is taken from
+                 *                    this pool.
+                 * @param initial_buffer_size Initial size of the buffer for
+                 *                            the result. It grows as needed.
+                 */
+                XMLParser(const osmium::io::detail::reader_options& options, const std::shared_ptr<osmium::memory::BufferPool>& buffer_pool, size_t initial_buffer_size) :
+                    m_context(context::root),
+                    m_last_context(context::root),
+                    m_in_delete_section(false),
+                    m_header(),
+                    m_buffer_pool(buffer_pool),
+                    m_buffer(m_buffer_pool->get_buffer(initial_buffer_size)),
+                    m_node_builder(),
+                    m_way_builder(),
+                    m_relation_builder(),
+                    m_changeset_builder(),
+                    m_tl_builder(),
+                    m_wnl_builder(),
+                    m_rml_builder(),
+                    m_input_queue(nullptr),
+                    m_queue(nullptr),
+                    m_header_promise(nullptr),
+                    m_read_types(options.read_which_entities),
+                    m_bbox(options.bbox),
+                    m_read_metadata(options.read_metadata == osmium::io::read_meta::yes),
+                    m_done(nullptr) {
                 }
 
                 /**
@@ -293,7 +343,8 @@ namespace osmium {
                     m_last_context(context::root),
                     m_in_delete_section(false),
                     m_header(),
-                    m_buffer(buffer_size),
+                    m_buffer_pool(other.m_buffer_pool),
+                    m_buffer(m_buffer_pool->get_buffer(buffer_size)),
                     m_node_builder(),
                     m_way_builder(),
                     m_relation_builder(),
@@ -305,6 +356,8 @@ namespace osmium {
                     m_queue(other.m_queue),
                     m_header_promise(other.m_header_promise),
                     m_read_types(other.m_read_types),
+                    m_bbox(other.m_bbox),
+                    m_read_metadata(other.m_read_metadata),
                     m_done(other.m_done) {
                 }
 
@@ -318,28 +371,61 @@ namespace osmium {
 
                 bool operator()() {
                     ExpatXMLParser<XMLParser> parser(this);
-                    PromiseKeeper<osmium::io::Header> promise_keeper(m_header, m_header_promise);
+                    PromiseKeeper<osmium::io::Header> promise_keeper(m_header, *m_header_promise);
                     bool last;
                     do {
                         std::string data;
-                        m_input_queue.wait_and_pop(data);
+                        if (!m_input_queue->wait_and_pop(data)) {
+                            break; // reading was cancelled
+                        }
                         last = data.empty();
                         try {
                             parser(data, last);
                         } catch (ParserIsDone&) {
                             return true;
                         } catch (...) {
-                            m_queue.push(osmium::memory::Buffer()); // empty buffer to signify eof
+                            m_queue->push(osmium::memory::Buffer()); // empty buffer to signify eof
                             throw;
                         }
-                    } while (!last && !m_done);
+                    } while (!last && !*m_done);
                     if (m_buffer.committed() > 0) {
-                        m_queue.push(std::move(m_buffer));
+                        m_queue->push(std::move(m_buffer));
                     }
-                    m_queue.push(osmium::memory::Buffer()); // empty buffer to signify eof
+                    m_queue->push(osmium::memory::Buffer()); // empty buffer to signify eof
                     return true;
                 }
 
+                /**
+                 * Parse the beginning of an XML file up to (but not
+                 * including) the first OSM object and return the header.
+                 *
+                 * @param data The beginning of the XML file.
+                 * @param last Is this the whole file?
+                 * @throws osmium::xml_error If the data is not valid XML.
+                 * @throws osmium::format_version_error If the version is unknown.
+                 */
+                osmium::io::Header parse_header(const std::string& data, bool last) {
+                    ExpatXMLParser<XMLParser> parser(this);
+                    try {
+                        parser(data, last);
+                    } catch (ParserIsDone&) {
+                    }
+                    return m_header;
+                }
+
+                /**
+                 * Parse a complete XML document containing OSM objects and
+                 * return a buffer with those objects.
+                 *
+                 * @param data The XML document.
+                 * @throws osmium::xml_error If the data is not valid XML.
+                 */
+                osmium::memory::Buffer parse_chunk(const std::string& data) {
+                    ExpatXMLParser<XMLParser> parser(this);
+                    parser(data, true);
+                    return std::move(m_buffer);
+                }
+
             private:
 
                 const char* init_object(osmium::OSMObject& object, const XML_Char** attrs) {
@@ -356,6 +442,10 @@ namespace osmium {
                             location.set_lon(std::atof(attrs[count+1])); // XXX doesn't detect garbage after the number
                         } else if (!strcmp(attrs[count], "lat")) {
                             location.set_lat(std::atof(attrs[count+1])); // XXX doesn't detect garbage after the number
+                        } else if (!m_read_metadata) {
+                            if (!strcmp(attrs[count], "id") || !strcmp(attrs[count], "visible")) {
+                                object.set_attribute(attrs[count], attrs[count+1]);
+                            }
                         } else if (!strcmp(attrs[count], "user")) {
                             user = attrs[count+1];
                         } else {
@@ -370,6 +460,31 @@ namespace osmium {
                     return user;
                 }
 
+                /**
+                 * Is the node with the given attributes inside the bounding
+                 * box? Nodes without location are never inside. Always
+                 * true if no bounding box was set.
+                 */
+                bool node_in_bbox(const XML_Char** attrs) const {
+                    if (!m_bbox) {
+                        return true;
+                    }
+                    if (m_in_delete_section) {
+                        return false;
+                    }
+
+                    osmium::Location location;
+                    for (int count = 0; attrs[count]; count += 2) {
+                        if (!strcmp(attrs[count], "lon")) {
+                            location.set_lon(std::atof(attrs[count+1]));
+                        } else if (!strcmp(attrs[count], "lat")) {
+                            location.set_lat(std::atof(attrs[count+1]));
+                        }
+                    }
+
+                    return location && m_bbox.contains(location);
+                }
+
                 void init_changeset(osmium::builder::ChangesetBuilder* builder, const XML_Char** attrs) {
                     static const char* empty = "";
                     const char* user = empty;
@@ -455,7 +570,7 @@ namespace osmium {
                             assert(!m_tl_builder);
                             if (!strcmp(element, "node")) {
                                 header_is_done();
-                                if (m_read_types & osmium::osm_entity_bits::node) {
+                                if ((m_read_types & osmium::osm_entity_bits::node) && node_in_bbox(attrs)) {
                                     m_node_builder = std::unique_ptr<osmium::builder::NodeBuilder>(new osmium::builder::NodeBuilder(m_buffer));
                                     m_node_builder->add_user(init_object(m_node_builder->object(), attrs));
                                     m_context = context::node;
@@ -655,55 +770,1311 @@ namespace osmium {
                 }
 
                 void flush_buffer() {
-                    if (m_buffer.capacity() - m_buffer.committed() < 1000 * 1000) {
-                        m_queue.push(std::move(m_buffer));
-                        osmium::memory::Buffer buffer(buffer_size);
+                    if (m_queue && m_buffer.capacity() - m_buffer.committed() < 1000 * 1000) {
+                        m_queue->push(std::move(m_buffer));
+                        osmium::memory::Buffer buffer = m_buffer_pool->get_buffer(buffer_size);
                         std::swap(m_buffer, buffer);
                     }
                 }
 
             }; // class XMLParser
 
-            class XMLInputFormat : public osmium::io::detail::InputFormat {
+            /**
+             * Parser for OSM XML files that does not use Expat. It knows
+             * the elements and attributes used in OSM files and writes the
+             * data directly into the buffer. Attribute values are decoded
+             * in place in the input data, numbers, coordinates and
+             * timestamps are parsed without going through strings or
+             * doubles.
+             *
+             * This is used if the file option "xml_parser" is set to
+             * "builtin". It understands the subset of XML used in OSM files
+             * as written by the usual tools: UTF-8 encoding, comments and
+             * processing instructions are allowed, DTDs and CDATA sections
+             * are not. Use the default Expat parser for other files.
+             */
+            class BuiltinXMLParser {
 
-                static constexpr size_t max_queue_size = 100;
+                static constexpr int buffer_size = 10 * 1000 * 1000;
 
-                osmium::thread::Queue<osmium::memory::Buffer> m_queue;
-                std::atomic<bool> m_done;
-                std::promise<osmium::io::Header> m_header_promise;
-                std::future<bool> m_parser_future;
+                struct attribute {
 
-            public:
+                    // name and value are \0-terminated in the input data
+                    const char* name;
+                    size_t name_length;
+                    const char* value;
+                    size_t value_length;
+
+                    template <size_t N>
+                    bool is(const char (&str)[N]) const noexcept {
+                        return name_length == N - 1 && !std::memcmp(name, str, N - 1);
+                    }
+
+                }; // struct attribute
+
+                // input data not yet parsed, the attribute values are
+                // decoded in here
+                std::string m_data;
+
+                // current position in m_data
+                size_t m_pos;
+
+                // number of bytes already removed from the front of m_data
+                size_t m_offset;
+
+                bool m_root_started;
+                bool m_root_done;
 
                 /**
-                 * Instantiate XML Parser
+                 * This is used only for change files which contain create, modify,
+                 * and delete sections.
+                 */
+                bool m_in_delete_section;
+
+                osmium::io::Header m_header;
+
+                std::shared_ptr<osmium::memory::BufferPool> m_buffer_pool;
+
+                osmium::memory::Buffer m_buffer;
+
+                // attributes of the element currently parsed
+                std::vector<attribute> m_attributes;
+
+                // These are not set when parsing chunks of XML data
+                // (see parse_chunk()).
+                osmium::io::detail::input_queue_type* m_input_queue;
+                osmium::thread::Queue<osmium::memory::Buffer>* m_queue;
+                std::promise<osmium::io::Header>* m_header_promise;
+
+                osmium::osm_entity_bits::type m_read_types;
+                osmium::Box m_bbox;
+                bool m_read_metadata;
+
+                std::atomic<bool>* m_done;
+
+                static bool is_space(char c) noexcept {
+                    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+                }
+
+                static bool is_name_end(char c) noexcept {
+                    return is_space(c) || c == '/' || c == '>' || c == '=';
+                }
+
+                static bool is_digit(char c) noexcept {
+                    return c >= '0' && c <= '9';
+                }
+
+                [[noreturn]] void error(size_t pos, const std::string& message) const {
+                    throw osmium::xml_error(std::string("XML parsing error at byte ") + std::to_string(m_offset + pos) + ": " + message);
+                }
+
+                [[noreturn]] void error(const char* pos, const std::string& message) const {
+                    error(static_cast<size_t>(pos - m_data.data()), message);
+                }
+
+                /**
+                 * Find the end of the name of an element starting at pos.
                  *
-                 * @param file osmium::io::File instance describing file to be read from.
-                 * @param read_which_entities Which types of OSM entities (nodes, ways, relations, changesets) should be parsed?
-                 * @param input_queue String queue where data is read from.
+                 * @returns Position after the name or std::string::npos if
+                 *          the data ends before.
                  */
-                explicit XMLInputFormat(const osmium::io::File& file, osmium::osm_entity_bits::type read_which_entities, osmium::thread::Queue<std::string>& input_queue) :
-                    osmium::io::detail::InputFormat(file, read_which_entities),
-                    m_queue(max_queue_size, "xml_parser_results"),
-                    m_done(false),
-                    m_header_promise(),
-                    m_parser_future(std::async(std::launch::async, XMLParser(input_queue, m_queue, m_header_promise, read_which_entities, m_done))) {
+                size_t find_name_end(size_t pos) const {
+                    while (pos < m_data.size()) {
+                        if (is_name_end(m_data[pos])) {
+                            return pos;
+                        }
+                        ++pos;
+                    }
+                    return std::string::npos;
                 }
 
-                ~XMLInputFormat() {
-                    try {
-                        close();
-                    } catch (...) {
-                        // ignore any exceptions at this point because destructor should not throw
+                /**
+                 * Find the '>' at the end of the tag starting at pos. Quoted
+                 * attribute values can contain '>'.
+                 *
+                 * @returns Position of the '>' or std::string::npos if the
+                 *          data ends before.
+                 */
+                size_t find_tag_end(size_t pos) const {
+                    while (true) {
+                        pos = m_data.find_first_of("\"'>", pos);
+                        if (pos == std::string::npos || m_data[pos] == '>') {
+                            return pos;
+                        }
+                        pos = m_data.find(m_data[pos], pos + 1);
+                        if (pos == std::string::npos) {
+                            return pos;
+                        }
+                        ++pos;
                     }
                 }
 
-                virtual osmium::io::Header header() override final {
-                    osmium::thread::check_for_exception(m_parser_future);
-                    return m_header_promise.get_future().get();
+                /**
+                 * Find the end of the element with the given name whose
+                 * start tag ends at tag_end.
+                 *
+                 * @returns Position after the element or std::string::npos
+                 *          if the data ends before.
+                 */
+                size_t find_element_end(size_t tag_end, const char* name, size_t name_length) const {
+                    if (m_data[tag_end - 1] == '/') {
+                        return tag_end + 1;
+                    }
+                    size_t pos = tag_end;
+                    while (true) {
+                        pos = m_data.find("</", pos);
+                        if (pos == std::string::npos || pos + 2 + name_length >= m_data.size()) {
+                            return std::string::npos;
+                        }
+                        if (!m_data.compare(pos + 2, name_length, name, name_length) && is_name_end(m_data[pos + 2 + name_length])) {
+                            pos = m_data.find('>', pos);
+                            return pos == std::string::npos ? pos : pos + 1;
+                        }
+                        pos += 2;
+                    }
                 }
 
-                osmium::memory::Buffer read() override {
+                static char* append_utf8(char* out, uint32_t c) noexcept {
+                    if (c < 0x80) {
+                        *out++ = static_cast<char>(c);
+                    } else if (c < 0x800) {
+                        *out++ = static_cast<char>(0xc0 | (c >> 6));
+                        *out++ = static_cast<char>(0x80 | (c & 0x3f));
+                    } else if (c < 0x10000) {
+                        *out++ = static_cast<char>(0xe0 | (c >> 12));
+                        *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+                        *out++ = static_cast<char>(0x80 | (c & 0x3f));
+                    } else {
+                        *out++ = static_cast<char>(0xf0 | (c >> 18));
+                        *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+                        *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+                        *out++ = static_cast<char>(0x80 | (c & 0x3f));
+                    }
+                    return out;
+                }
+
+                /**
+                 * Decode character and entity references and normalize
+                 * white space in the attribute value from begin to end. The
+                 * result is never longer than the input, so this is done in
+                 * place.
+                 *
+                 * @returns New end of the value.
+                 */
+                char* decode_value(char* begin, char* end) const {
+                    char* out = begin;
+                    while (begin != end) {
+                        const char c = *begin;
+                        if (c == '&') {
+                            char* semicolon = static_cast<char*>(std::memchr(begin, ';', static_cast<size_t>(end - begin)));
+                            if (!semicolon) {
+                                error(begin, "invalid entity reference");
+                            }
+                            const char* name = begin + 1;
+                            const size_t length = static_cast<size_t>(semicolon - name);
+                            if (length == 2 && !std::memcmp(name, "lt", 2)) {
+                                *out++ = '<';
+                            } else if (length == 2 && !std::memcmp(name, "gt", 2)) {
+                                *out++ = '>';
+                            } else if (length == 3 && !std::memcmp(name, "amp", 3)) {
+                                *out++ = '&';
+                            } else if (length == 4 && !std::memcmp(name, "quot", 4)) {
+                                *out++ = '"';
+                            } else if (length == 4 && !std::memcmp(name, "apos", 4)) {
+                                *out++ = '\'';
+                            } else if (length > 1 && name[0] == '#') {
+                                const bool hex = name[1] == 'x';
+                                const char* digits = name + (hex ? 2 : 1);
+                                if (digits == semicolon || semicolon - digits > 8) {
+                                    error(begin, "invalid character reference");
+                                }
+                                uint32_t code = 0;
+                                for (; digits != semicolon; ++digits) {
+                                    const char d = *digits;
+                                    if (is_digit(d)) {
+                                        code = code * (hex ? 16 : 10) + static_cast<uint32_t>(d - '0');
+                                    } else if (hex && d >= 'a' && d <= 'f') {
+                                        code = code * 16 + static_cast<uint32_t>(d - 'a' + 10);
+                                    } else if (hex && d >= 'A' && d <= 'F') {
+                                        code = code * 16 + static_cast<uint32_t>(d - 'A' + 10);
+                                    } else {
+                                        error(begin, "invalid character reference");
+                                    }
+                                }
+                                if (code == 0 || code > 0x10ffff || (code >= 0xd800 && code <= 0xdfff)) {
+                                    error(begin, "invalid character reference");
+                                }
+                                out = append_utf8(out, code);
+                            } else {
+                                error(begin, "undefined entity");
+                            }
+                            begin = semicolon + 1;
+                        } else if (c == '\r') {
+                            *out++ = ' ';
+                            ++begin;
+                            if (begin != end && *begin == '\n') {
+                                ++begin;
+                            }
+                        } else if (c == '\t' || c == '\n') {
+                            *out++ = ' ';
+                            ++begin;
+                        } else if (c == '<') {
+                            error(begin, "'<' in attribute value");
+                        } else {
+                            *out++ = c;
+                            ++begin;
+                        }
+                    }
+                    return out;
+                }
+
+                /**
+                 * Parse the attributes of a tag from pos up to the '>' at
+                 * end into m_attributes. Names and values are
+                 * \0-terminated in place.
+                 */
+                void parse_attributes(size_t pos, size_t end) {
+                    m_attributes.clear();
+                    char* data = &m_data[0];
+                    while (true) {
+                        while (pos < end && is_space(data[pos])) {
+                            ++pos;
+                        }
+                        if (pos >= end || data[pos] == '/') {
+                            return;
+                        }
+
+                        const size_t name_start = pos;
+                        while (pos < end && !is_name_end(data[pos])) {
+                            ++pos;
+                        }
+                        const size_t name_end = pos;
+                        while (pos < end && is_space(data[pos])) {
+                            ++pos;
+                        }
+                        if (name_end == name_start || pos >= end || data[pos] != '=') {
+                            error(pos, "invalid attribute");
+                        }
+                        ++pos;
+                        while (pos < end && is_space(data[pos])) {
+                            ++pos;
+                        }
+                        if (pos >= end || (data[pos] != '"' && data[pos] != '\'')) {
+                            error(pos, "invalid attribute value");
+                        }
+                        const char quote = data[pos++];
+                        char* value = data + pos;
+                        char* value_end = static_cast<char*>(std::memchr(value, quote, end - pos));
+                        if (!value_end) {
+                            error(pos, "invalid attribute value");
+                        }
+                        pos = static_cast<size_t>(value_end - data) + 1;
+
+                        char* special = value;
+                        while (special != value_end && *special != '&' && *special != '<' && *special != '\t' && *special != '\n' && *special != '\r') {
+                            ++special;
+                        }
+                        if (special != value_end) {
+                            value_end = decode_value(special, value_end);
+                        }
+
+                        data[name_end] = '\0';
+                        *value_end = '\0';
+                        m_attributes.push_back(attribute{data + name_start, name_end - name_start, value, static_cast<size_t>(value_end - value)});
+                    }
+                }
+
+                int64_t parse_integer(const attribute& attr) const {
+                    const char* str = attr.value;
+                    const char* end = str + attr.value_length;
+                    bool negative = false;
+                    if (str != end && *str == '-') {
+                        negative = true;
+                        ++str;
+                    }
+                    if (str == end || end - str > 18) {
+                        error(attr.value, std::string("invalid number in attribute ") + attr.name);
+                    }
+                    int64_t result = 0;
+                    for (; str != end; ++str) {
+                        if (!is_digit(*str)) {
+                            error(attr.value, std::string("invalid number in attribute ") + attr.name);
+                        }
+                        result = result * 10 + (*str - '0');
+                    }
+                    return negative ? -result : result;
+                }
+
+                int32_t parse_coordinate(const attribute& attr) const {
+                    int32_t value;
+                    if (!osmium::detail::string_to_location_coordinate(attr.value, attr.value + attr.value_length, value)) {
+                        error(attr.value, std::string("invalid coordinate in attribute ") + attr.name);
+                    }
+                    return value;
+                }
+
+                /**
+                 * Parse a timestamp. The usual format
+                 * "yyyy-mm-ddThh:mm:ssZ" is parsed directly, anything
+                 * else is handed to osmium::Timestamp.
+                 */
+                static osmium::Timestamp parse_timestamp(const attribute& attr) {
+                    time_t timestamp;
+                    if (osmium::detail::parse_iso_timestamp(attr.value, attr.value_length, timestamp)) {
+                        return osmium::Timestamp(timestamp);
+                    }
+                    return osmium::Timestamp(attr.value);
+                }
+
+                osmium::Location get_location(const char* lon_name, const char* lat_name) const {
+                    osmium::Location location;
+                    for (const auto& attr : m_attributes) {
+                        if (!std::strcmp(attr.name, lon_name)) {
+                            location.set_x(parse_coordinate(attr));
+                        } else if (!std::strcmp(attr.name, lat_name)) {
+                            location.set_y(parse_coordinate(attr));
+                        }
+                    }
+                    return location;
+                }
+
+                template <class TBuilder>
+                void init_object(TBuilder& builder) {
+                    osmium::OSMObject& object = builder.object();
+                    if (m_in_delete_section) {
+                        object.set_visible(false);
+                    }
+
+                    const attribute* user = nullptr;
+                    for (const auto& attr : m_attributes) {
+                        if (attr.is("id")) {
+                            object.set_id(parse_integer(attr));
+                        } else if (attr.is("visible")) {
+                            object.set_visible(attr.value);
+                        } else if (!m_read_metadata) {
+                            continue;
+                        } else if (attr.is("version")) {
+                            object.set_version(static_cast<osmium::object_version_type>(parse_integer(attr)));
+                        } else if (attr.is("changeset")) {
+                            object.set_changeset(static_cast<osmium::changeset_id_type>(parse_integer(attr)));
+                        } else if (attr.is("timestamp")) {
+                            object.set_timestamp(parse_timestamp(attr));
+                        } else if (attr.is("uid")) {
+                            object.set_uid_from_signed(static_cast<osmium::signed_user_id_type>(parse_integer(attr)));
+                        } else if (attr.is("user")) {
+                            user = &attr;
+                        }
+                    }
+
+                    if (user) {
+                        builder.add_user(user->value, static_cast_with_assert<string_size_type>(user->value_length + 1));
+                    } else {
+                        builder.add_user("", 1);
+                    }
+                }
+
+                void init_changeset(osmium::builder::ChangesetBuilder& builder) {
+                    osmium::Changeset& changeset = builder.object();
+
+                    const attribute* user = nullptr;
+                    for (const auto& attr : m_attributes) {
+                        if (attr.is("user")) {
+                            user = &attr;
+                        } else {
+                            changeset.set_attribute(attr.name, attr.value);
+                        }
+                    }
+
+                    changeset.bounds().extend(get_location("min_lon", "min_lat"));
+                    changeset.bounds().extend(get_location("max_lon", "max_lat"));
+
+                    if (user) {
+                        builder.add_user(user->value, static_cast_with_assert<string_size_type>(user->value_length + 1));
+                    } else {
+                        builder.add_user("", 1);
+                    }
+                }
+
+                const attribute* find_attribute(const char* name) const {
+                    for (const auto& attr : m_attributes) {
+                        if (!std::strcmp(attr.name, name)) {
+                            return &attr;
+                        }
+                    }
+                    return nullptr;
+                }
+
+                /**
+                 * Parse the tags, node references and members of an object
+                 * from pos to end and add them to the object.
+                 */
+                void parse_children(osmium::builder::Builder* builder, osmium::builder::WayBuilder* way_builder, osmium::builder::RelationBuilder* relation_builder, size_t pos, size_t end) {
+                    std::unique_ptr<osmium::builder::TagListBuilder>            tl_builder;
+                    std::unique_ptr<osmium::builder::WayNodeListBuilder>        wnl_builder;
+                    std::unique_ptr<osmium::builder::RelationMemberListBuilder> rml_builder;
+
+                    while (true) {
+                        pos = m_data.find('<', pos);
+                        if (pos >= end) {
+                            return;
+                        }
+                        if (m_data[pos + 1] == '/' || m_data[pos + 1] == '?') {
+                            pos = m_data.find('>', pos) + 1;
+                            continue;
+                        }
+                        if (m_data[pos + 1] == '!') {
+                            if (m_data.compare(pos, 4, "<!--")) {
+                                error(pos, "DTDs and CDATA sections are not supported by the builtin XML parser");
+                            }
+                            const size_t comment_end = m_data.find("-->", pos);
+                            if (comment_end >= end) {
+                                error(pos, "unterminated comment");
+                            }
+                            pos = comment_end + 3;
+                            continue;
+                        }
+
+                        const size_t name_end = find_name_end(pos + 1);
+                        const size_t tag_end = find_tag_end(name_end);
+                        if (tag_end >= end) {
+                            error(pos, "invalid tag");
+                        }
+                        parse_attributes(name_end, tag_end);
+                        const char* name = m_data.data() + pos + 1;
+                        const size_t name_length = name_end - pos - 1;
+
+                        if (name_length == 3 && !std::memcmp(name, "tag", 3)) {
+                            wnl_builder.reset();
+                            rml_builder.reset();
+
+                            static const attribute empty { "", 0, "", 0 };
+                            const attribute* key = &empty;
+                            const attribute* value = &empty;
+                            for (const auto& attr : m_attributes) {
+                                if (attr.is("k")) {
+                                    key = &attr;
+                                } else if (attr.is("v")) {
+                                    value = &attr;
+                                }
+                            }
+                            if (!tl_builder) {
+                                tl_builder = std::unique_ptr<osmium::builder::TagListBuilder>(new osmium::builder::TagListBuilder(m_buffer, builder));
+                            }
+                            tl_builder->add_tag(key->value, key->value_length, value->value, value->value_length);
+                        } else if (way_builder && name_length == 2 && !std::memcmp(name, "nd", 2)) {
+                            tl_builder.reset();
+
+                            if (!wnl_builder) {
+                                wnl_builder = std::unique_ptr<osmium::builder::WayNodeListBuilder>(new osmium::builder::WayNodeListBuilder(m_buffer, way_builder));
+                            }
+                            const attribute* ref = find_attribute("ref");
+                            if (ref) {
+                                wnl_builder->add_node_ref(parse_integer(*ref));
+                            }
+                        } else if (relation_builder && name_length == 6 && !std::memcmp(name, "member", 6)) {
+                            tl_builder.reset();
+
+                            if (!rml_builder) {
+                                rml_builder = std::unique_ptr<osmium::builder::RelationMemberListBuilder>(new osmium::builder::RelationMemberListBuilder(m_buffer, relation_builder));
+                            }
+                            char type = 'x';
+                            osmium::object_id_type ref = 0;
+                            const char* role = "";
+                            size_t role_length = 0;
+                            for (const auto& attr : m_attributes) {
+                                if (attr.is("type")) {
+                                    type = attr.value[0];
+                                } else if (attr.is("ref")) {
+                                    ref = parse_integer(attr);
+                                } else if (attr.is("role")) {
+                                    role = attr.value;
+                                    role_length = attr.value_length;
+                                }
+                            }
+                            rml_builder->add_member(osmium::char_to_item_type(type), ref, role, role_length);
+                        }
+
+                        pos = tag_end + 1;
+                    }
+                }
+
+                void header_is_done() {
+                    if (m_read_types == osmium::osm_entity_bits::nothing) {
+                        throw ParserIsDone();
+                    }
+                }
+
+                /**
+                 * Parse the complete OSM object whose start tag starts at
+                 * pos.
+                 */
+                void parse_object(osmium::item_type type, size_t name_end, size_t tag_end, size_t element_end) {
+                    header_is_done();
+                    if (!(m_read_types & osmium::osm_entity_bits::from_item_type(type))) {
+                        return;
+                    }
+
+                    parse_attributes(name_end, tag_end);
+                    switch (type) {
+                        case osmium::item_type::node: {
+                                const osmium::Location location = get_location("lon", "lat");
+                                if (m_bbox && (m_in_delete_section || !location || !m_bbox.contains(location))) {
+                                    return;
+                                }
+                                osmium::builder::NodeBuilder builder(m_buffer);
+                                init_object(builder);
+                                if (location) {
+                                    builder.object().set_location(location);
+                                }
+                                parse_children(&builder, nullptr, nullptr, tag_end + 1, element_end);
+                            }
+                            break;
+                        case osmium::item_type::way: {
+                                osmium::builder::WayBuilder builder(m_buffer);
+                                init_object(builder);
+                                parse_children(&builder, &builder, nullptr, tag_end + 1, element_end);
+                            }
+                            break;
+                        case osmium::item_type::relation: {
+                                osmium::builder::RelationBuilder builder(m_buffer);
+                                init_object(builder);
+                                parse_children(&builder, nullptr, &builder, tag_end + 1, element_end);
+                            }
+                            break;
+                        default: {
+                                osmium::builder::ChangesetBuilder builder(m_buffer);
+                                init_changeset(builder);
+                                parse_children(&builder, nullptr, nullptr, tag_end + 1, element_end);
+                            }
+                            break;
+                    }
+                    m_buffer.commit();
+                    flush_buffer();
+                }
+
+                void parse_root(size_t pos, size_t name_end, size_t tag_end) {
+                    const std::string name = m_data.substr(pos + 1, name_end - pos - 1);
+                    if (name != "osm" && name != "osmChange") {
+                        throw osmium::xml_error(std::string("Unknown top-level element: ") + name);
+                    }
+                    if (name == "osmChange") {
+                        m_header.set_has_multiple_object_versions(true);
+                    }
+
+                    parse_attributes(name_end, tag_end);
+                    for (const auto& attr : m_attributes) {
+                        if (attr.is("version")) {
+                            m_header.set("version", attr.value);
+                            if (std::strcmp(attr.value, "0.6")) {
+                                throw osmium::format_version_error(attr.value);
+                            }
+                        } else if (attr.is("generator")) {
+                            m_header.set("generator", attr.value);
+                        }
+                    }
+                    if (m_header.get("version") == "") {
+                        throw osmium::format_version_error();
+                    }
+                    m_root_started = true;
+                }
+
+                static osmium::item_type object_type(const char* name, size_t length) noexcept {
+                    switch (length) {
+                        case 3:
+                            return std::memcmp(name, "way", 3) ? osmium::item_type::undefined : osmium::item_type::way;
+                        case 4:
+                            return std::memcmp(name, "node", 4) ? osmium::item_type::undefined : osmium::item_type::node;
+                        case 8:
+                            return std::memcmp(name, "relation", 8) ? osmium::item_type::undefined : osmium::item_type::relation;
+                        case 9:
+                            return std::memcmp(name, "changeset", 9) ? osmium::item_type::undefined : osmium::item_type::changeset;
+                        default:
+                            return osmium::item_type::undefined;
+                    }
+                }
+
+                /**
+                 * Parse as much of the data in m_data as possible. Only
+                 * complete OSM objects are parsed, the rest is kept until
+                 * more data arrives.
+                 *
+                 * @param last Is all data there?
+                 */
+                void parse(bool last) {
+                    while (true) {
+                        const size_t pos = m_data.find('<', m_pos);
+                        if (pos == std::string::npos) {
+                            m_pos = m_data.size();
+                            break;
+                        }
+                        m_pos = pos;
+                        if (pos + 4 > m_data.size()) {
+                            break;
+                        }
+
+                        const char c = m_data[pos + 1];
+                        if (c == '?' || c == '!') {
+                            const bool comment = !m_data.compare(pos, 4, "<!--");
+                            if (c == '!' && !comment) {
+                                error(pos, "DTDs and CDATA sections are not supported by the builtin XML parser");
+                            }
+                            const size_t end = m_data.find(comment ? "-->" : "?>", pos + 2);
+                            if (end == std::string::npos) {
+                                break;
+                            }
+                            m_pos = end + (comment ? 3 : 2);
+                            continue;
+                        }
+
+                        if (m_root_done) {
+                            error(pos, "junk after document element");
+                        }
+
+                        const size_t name_end = find_name_end(pos + (c == '/' ? 2 : 1));
+                        if (name_end == std::string::npos) {
+                            break;
+                        }
+                        const size_t tag_end = find_tag_end(name_end);
+                        if (tag_end == std::string::npos) {
+                            break;
+                        }
+
+                        if (!m_root_started) {
+                            if (c == '/') {
+                                error(pos, "end tag without start tag");
+                            }
+                            parse_root(pos, name_end, tag_end);
+                            m_pos = tag_end + 1;
+                            if (m_data[tag_end - 1] == '/') {
+                                header_is_done();
+                                m_root_done = true;
+                            }
+                            continue;
+                        }
+
+                        const char* name = m_data.data() + pos + 1;
+                        const size_t name_length = name_end - pos - 1;
+
+                        if (c == '/') {
+                            if ((name_length == 4 && !std::memcmp(name, "/osm", 4)) ||
+                                (name_length == 10 && !std::memcmp(name, "/osmChange", 10))) {
+                                header_is_done();
+                                m_root_done = true;
+                            } else if (name_length == 7 && !std::memcmp(name, "/delete", 7)) {
+                                m_in_delete_section = false;
+                            }
+                            m_pos = tag_end + 1;
+                            continue;
+                        }
+
+                        const osmium::item_type type = object_type(name, name_length);
+                        if (type != osmium::item_type::undefined) {
+                            const size_t element_end = find_element_end(tag_end, name, name_length);
+                            if (element_end == std::string::npos) {
+                                break;
+                            }
+                            parse_object(type, name_end, tag_end, element_end);
+                            m_pos = element_end;
+                            continue;
+                        }
+
+                        if (name_length == 6 && !std::memcmp(name, "bounds", 6)) {
+                            parse_attributes(name_end, tag_end);
+                            osmium::Box box;
+                            box.extend(get_location("minlon", "minlat")).extend(get_location("maxlon", "maxlat"));
+                            m_header.add_box(box);
+                        } else if (name_length == 6 && !std::memcmp(name, "delete", 6)) {
+                            m_in_delete_section = m_data[tag_end - 1] != '/';
+                        }
+                        m_pos = tag_end + 1;
+                    }
+
+                    if (last) {
+                        if (!m_root_started) {
+                            error(m_pos, "no element found");
+                        }
+                        if (!m_root_done || m_pos != m_data.size()) {
+                            error(m_pos, "unexpected end of data");
+                        }
+                    }
+
+                    // remove data that is not needed any more
+                    m_data.erase(0, m_pos);
+                    m_offset += m_pos;
+                    m_pos = 0;
+                }
+
+                void flush_buffer() {
+                    if (m_queue && m_buffer.capacity() - m_buffer.committed() < 1000 * 1000) {
+                        m_queue->push(std::move(m_buffer));
+                        osmium::memory::Buffer buffer = m_buffer_pool->get_buffer(buffer_size);
+                        std::swap(m_buffer, buffer);
+                    }
+                }
+
+            public:
+
+                explicit BuiltinXMLParser(osmium::io::detail::input_queue_type& input_queue, osmium::thread::Queue<osmium::memory::Buffer>& queue, std::promise<osmium::io::Header>& header_promise, const osmium::io::detail::reader_options& options, const std::shared_ptr<osmium::memory::BufferPool>& buffer_pool, std::atomic<bool>& done) :
+                    m_data(),
+                    m_pos(0),
+                    m_offset(0),
+                    m_root_started(false),
+                    m_root_done(false),
+                    m_in_delete_section(false),
+                    m_header(),
+                    m_buffer_pool(buffer_pool),
+                    m_buffer(m_buffer_pool->get_buffer(buffer_size)),
+                    m_attributes(),
+                    m_input_queue(&input_queue),
+                    m_queue(&queue),
+                    m_header_promise(&header_promise),
+                    m_read_types(options.read_which_entities),
+                    m_bbox(options.bbox),
+                    m_read_metadata(options.read_metadata == osmium::io::read_meta::yes),
+                    m_done(&done) {
+                }
+
+                /**
+                 * Create a parser for use with parse_header() or
+                 * parse_chunk().
+                 *
+                 * @param options Options from the Reader.
+                 * @param buffer_pool The buffer for the result is taken from
+                 *                    this pool.
+                 * @param initial_buffer_size Initial size of the buffer for
+                 *                            the result. It grows as needed.
+                 */
+                BuiltinXMLParser(const osmium::io::detail::reader_options& options, const std::shared_ptr<osmium::memory::BufferPool>& buffer_pool, size_t initial_buffer_size) :
+                    m_data(),
+                    m_pos(0),
+                    m_offset(0),
+                    m_root_started(false),
+                    m_root_done(false),
+                    m_in_delete_section(false),
+                    m_header(),
+                    m_buffer_pool(buffer_pool),
+                    m_buffer(m_buffer_pool->get_buffer(initial_buffer_size)),
+                    m_attributes(),
+                    m_input_queue(nullptr),
+                    m_queue(nullptr),
+                    m_header_promise(nullptr),
+                    m_read_types(options.read_which_entities),
+                    m_bbox(options.bbox),
+                    m_read_metadata(options.read_metadata == osmium::io::read_meta::yes),
+                    m_done(nullptr) {
+                }
+
+                BuiltinXMLParser(const BuiltinXMLParser&) = delete;
+                BuiltinXMLParser(BuiltinXMLParser&&) = default;
+
+                BuiltinXMLParser& operator=(const BuiltinXMLParser&) = delete;
+                BuiltinXMLParser& operator=(BuiltinXMLParser&&) = default;
+
+                ~BuiltinXMLParser() = default;
+
+                bool operator()() {
+                    PromiseKeeper<osmium::io::Header> promise_keeper(m_header, *m_header_promise);
+                    bool last;
+                    do {
+                        std::string data;
+                        if (!m_input_queue->wait_and_pop(data)) {
+                            break; // reading was cancelled
+                        }
+                        last = data.empty();
+                        try {
+                            m_data.append(data);
+                            parse(last);
+                        } catch (ParserIsDone&) {
+                            return true;
+                        } catch (...) {
+                            m_queue->push(osmium::memory::Buffer()); // empty buffer to signify eof
+                            throw;
+                        }
+                    } while (!last && !*m_done);
+                    if (m_buffer.committed() > 0) {
+                        m_queue->push(std::move(m_buffer));
+                    }
+                    m_queue->push(osmium::memory::Buffer()); // empty buffer to signify eof
+                    return true;
+                }
+
+                /**
+                 * Parse the beginning of an XML file up to (but not
+                 * including) the first OSM object and return the header.
+                 *
+                 * @param data The beginning of the XML file.
+                 * @param last Is this the whole file?
+                 * @throws osmium::xml_error If the data is not valid XML.
+                 * @throws osmium::format_version_error If the version is unknown.
+                 */
+                osmium::io::Header parse_header(const std::string& data, bool last) {
+                    m_data = data;
+                    try {
+                        parse(last);
+                    } catch (ParserIsDone&) {
+                    }
+                    return m_header;
+                }
+
+                /**
+                 * Parse a complete XML document containing OSM objects and
+                 * return a buffer with those objects.
+                 *
+                 * @param data The XML document. It is modified while
+                 *             parsing, so it is taken over by the parser.
+                 * @throws osmium::xml_error If the data is not valid XML.
+                 */
+                osmium::memory::Buffer parse_chunk(std::string&& data) {
+                    m_data = std::move(data);
+                    parse(true);
+                    return std::move(m_buffer);
+                }
+
+            }; // class BuiltinXMLParser
+
+            /**
+             * Parses one chunk of XML data cut out of an XML file by the
+             * ParallelXMLParser. This is run in the thread pool.
+             */
+            class XMLChunkParser {
+
+                static constexpr size_t initial_buffer_size = 2 * 1024 * 1024;
+
+                std::shared_ptr<std::string> m_document;
+                osmium::io::detail::reader_options m_options;
+                std::shared_ptr<osmium::memory::BufferPool> m_buffer_pool;
+                osmium::thread::ByteBudget* m_budget;
+                size_t m_acquired;
+                bool m_builtin_parser;
+
+                osmium::memory::Buffer parse() {
+                    if (m_builtin_parser) {
+                        BuiltinXMLParser parser(m_options, m_buffer_pool, initial_buffer_size);
+                        return parser.parse_chunk(std::move(*m_document));
+                    }
+                    XMLParser parser(m_options, m_buffer_pool, initial_buffer_size);
+                    return parser.parse_chunk(*m_document);
+                }
+
+            public:
+
+                /**
+                 * @param document Complete XML document with the chunk.
+                 * @param options Options from the Reader.
+                 * @param buffer_pool The buffer for the result is taken from
+                 *                    this pool.
+                 * @param budget Budget from which the bytes for the result
+                 *               were acquired.
+                 * @param acquired Number of bytes acquired from the budget.
+                 *                 This is corrected to the actual size of
+                 *                 the result once it is known.
+                 * @param builtin_parser Use BuiltinXMLParser instead of Expat.
+                 */
+                XMLChunkParser(const std::shared_ptr<std::string>& document, const osmium::io::detail::reader_options& options, const std::shared_ptr<osmium::memory::BufferPool>& buffer_pool, osmium::thread::ByteBudget* budget, size_t acquired, bool builtin_parser) :
+                    m_document(document),
+                    m_options(options),
+                    m_buffer_pool(buffer_pool),
+                    m_budget(budget),
+                    m_acquired(acquired),
+                    m_builtin_parser(builtin_parser) {
+                }
+
+                osmium::memory::Buffer operator()() {
+                    osmium::memory::Buffer buffer = parse();
+
+                    if (buffer.committed() > m_acquired) {
+                        m_budget->force_acquire(buffer.committed() - m_acquired);
+                    } else {
+                        m_budget->release(m_acquired - buffer.committed());
+                    }
+
+                    return buffer;
+                }
+
+            }; // class XMLChunkParser
+
+            /**
+             * Parses OSM XML files using several threads. The input is cut
+             * into chunks at the start tags of OSM objects. The chunks are
+             * parsed by XMLChunkParser in the thread pool. The results are
+             * put into the queue in the same order as the chunks so that
+             * the order of the objects is kept.
+             *
+             * The chunks are found by looking at the names of the tags
+             * only, so this works with OSM XML files as written by the
+             * usual tools, but not with all possible XML files. Tags
+             * inside comments are ignored, but CDATA sections and
+             * processing instructions must not contain OSM object tags.
+             * Line numbers in error messages are relative to the chunk.
+             */
+            class ParallelXMLParser {
+
+                /// Chunks are cut at the first object after this many bytes.
+                static constexpr size_t chunk_size = 1024 * 1024;
+
+                /// This many characters are enough to find out which tag it is.
+                static constexpr size_t max_tag_length = 12; // "</osmChange>"
+
+                osmium::io::detail::input_queue_type& m_input_queue;
+                osmium::thread::Queue<std::future<osmium::memory::Buffer>>& m_queue;
+                std::promise<osmium::io::Header>& m_header_promise;
+                osmium::io::detail::reader_options m_options;
+                std::shared_ptr<osmium::memory::BufferPool> m_buffer_pool;
+                osmium::thread::ByteBudget& m_budget;
+                std::atomic<bool>& m_done;
+                bool m_builtin_parser;
+
+                // input data not yet handed out in chunks
+                std::string m_data;
+
+                // position in m_data where to look for the next tag
+                size_t m_scan_offset;
+
+                // start of the current chunk in m_data
+                size_t m_chunk_start;
+
+                bool m_in_delete_section;
+                bool m_header_done;
+
+                static bool is_name_end(char c) noexcept {
+                    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '/' || c == '>';
+                }
+
+                /**
+                 * Is there a tag with the given name (including a leading
+                 * '/' for end tags) at pos?
+                 */
+                bool tag_is(size_t pos, const char* name) const {
+                    const size_t length = std::strlen(name);
+                    return pos + length + 1 < m_data.size() &&
+                           !m_data.compare(pos + 1, length, name) &&
+                           is_name_end(m_data[pos + length + 1]);
+                }
+
+                bool is_object_tag(size_t pos) const {
+                    return tag_is(pos, "node") ||
+                           tag_is(pos, "way") ||
+                           tag_is(pos, "relation") ||
+                           tag_is(pos, "changeset");
+                }
+
+                bool is_section_tag(size_t pos) const {
+                    return tag_is(pos, "create") || tag_is(pos, "/create") ||
+                           tag_is(pos, "modify") || tag_is(pos, "/modify") ||
+                           tag_is(pos, "delete") || tag_is(pos, "/delete") ||
+                           tag_is(pos, "/osm") || tag_is(pos, "/osmChange");
+                }
+
+                void set_header(const osmium::io::Header& header) {
+                    m_header_done = true;
+                    m_header_promise.set_value(header);
+                }
+
+                /**
+                 * Parse everything in m_data before end as header and
+                 * remove it.
+                 */
+                void parse_header(size_t end, bool last) {
+                    if (m_builtin_parser) {
+                        BuiltinXMLParser parser(m_options, m_buffer_pool, osmium::memory::align_bytes);
+                        set_header(parser.parse_header(m_data.substr(0, end), last));
+                    } else {
+                        XMLParser parser(m_options, m_buffer_pool, osmium::memory::align_bytes);
+                        set_header(parser.parse_header(m_data.substr(0, end), last));
+                    }
+                    m_data.erase(0, end);
+                }
+
+                /**
+                 * Hand the data from the start of the current chunk to end
+                 * to the thread pool for parsing.
+                 */
+                void submit_chunk(size_t end) {
+                    const char* prefix = m_in_delete_section ? "<osm version=\"0.6\"><delete>" : "<osm version=\"0.6\">";
+                    const char* suffix = m_in_delete_section ? "</delete></osm>" : "</osm>";
+
+                    auto document = std::make_shared<std::string>();
+                    document->reserve(std::strlen(prefix) + (end - m_chunk_start) + std::strlen(suffix));
+                    document->append(prefix);
+                    document->append(m_data, m_chunk_start, end - m_chunk_start);
+                    document->append(suffix);
+                    m_chunk_start = std::string::npos;
+
+                    // The size of the decoded data is not known yet, use
+                    // the size of the XML data as estimate. XMLChunkParser
+                    // corrects this once it is done.
+                    m_budget.acquire(document->size());
+                    m_queue.push(m_options.thread_pool().submit(XMLChunkParser{document, m_options, m_buffer_pool, &m_budget, document->size(), m_builtin_parser}));
+                }
+
+                /**
+                 * Look for tags in the data and cut it into chunks.
+                 *
+                 * @param last Is all data there?
+                 * @returns false if no more data is needed.
+                 */
+                bool split(bool last) {
+                    while (true) {
+                        size_t pos = m_data.find('<', m_scan_offset);
+                        if (pos == std::string::npos) {
+                            m_scan_offset = m_data.size();
+                            break;
+                        }
+                        if (pos + max_tag_length > m_data.size() && !last) {
+                            m_scan_offset = pos;
+                            break;
+                        }
+
+                        if (!m_data.compare(pos, 4, "<!--")) {
+                            const size_t end = m_data.find("-->", pos + 4);
+                            if (end == std::string::npos) {
+                                m_scan_offset = pos;
+                                break;
+                            }
+                            m_scan_offset = end + 3;
+                            continue;
+                        }
+
+                        const bool object = is_object_tag(pos);
+                        if (!object && !is_section_tag(pos)) {
+                            m_scan_offset = pos + 1;
+                            continue;
+                        }
+
+                        if (!m_header_done) {
+                            parse_header(pos, false);
+                            pos = 0;
+                            if (m_options.read_which_entities == osmium::osm_entity_bits::nothing) {
+                                return false;
+                            }
+                        }
+
+                        if (object) {
+                            if (m_chunk_start == std::string::npos) {
+                                m_chunk_start = pos;
+                            } else if (pos - m_chunk_start >= chunk_size) {
+                                submit_chunk(pos);
+                                m_chunk_start = pos;
+                            }
+                        } else {
+                            if (m_chunk_start != std::string::npos) {
+                                submit_chunk(pos);
+                            }
+                            if (tag_is(pos, "delete")) {
+                                const size_t end = m_data.find('>', pos);
+                                m_in_delete_section = (end == std::string::npos || m_data[end - 1] != '/');
+                            } else if (tag_is(pos, "/delete")) {
+                                m_in_delete_section = false;
+                            }
+                        }
+                        m_scan_offset = pos + 1;
+                    }
+
+                    // remove data that is not needed any more
+                    if (m_header_done) {
+                        const size_t keep = std::min(m_chunk_start, m_scan_offset);
+                        m_data.erase(0, keep);
+                        m_scan_offset -= keep;
+                        if (m_chunk_start != std::string::npos) {
+                            m_chunk_start -= keep;
+                        }
+                    }
+
+                    return true;
+                }
+
+                void push_eof() {
+                    std::promise<osmium::memory::Buffer> promise;
+                    m_queue.push(promise.get_future());
+                    promise.set_value(osmium::memory::Buffer());
+                }
+
+                void run() {
+                    bool last = false;
+                    while (!last && !m_done) {
+                        std::string data;
+                        if (!m_input_queue.wait_and_pop(data)) {
+                            // reading was cancelled
+                            if (!m_header_done) {
+                                set_header(osmium::io::Header());
+                            }
+                            return;
+                        }
+                        last = data.empty();
+                        m_data.append(data);
+                        if (!split(last)) {
+                            return;
+                        }
+                    }
+
+                    if (!m_header_done) {
+                        if (m_done) {
+                            set_header(osmium::io::Header());
+                            return;
+                        }
+                        parse_header(m_data.size(), true);
+                    }
+
+                    if (m_chunk_start != std::string::npos) {
+                        submit_chunk(m_data.size());
+                    }
+                }
+
+            public:
+
+                ParallelXMLParser(osmium::io::detail::input_queue_type& input_queue, osmium::thread::Queue<std::future<osmium::memory::Buffer>>& queue, std::promise<osmium::io::Header>& header_promise, const osmium::io::detail::reader_options& options, const std::shared_ptr<osmium::memory::BufferPool>& buffer_pool, osmium::thread::ByteBudget& budget, std::atomic<bool>& done, bool builtin_parser) :
+                    m_input_queue(input_queue),
+                    m_queue(queue),
+                    m_header_promise(header_promise),
+                    m_options(options),
+                    m_buffer_pool(buffer_pool),
+                    m_budget(budget),
+                    m_done(done),
+                    m_builtin_parser(builtin_parser),
+                    m_data(),
+                    m_scan_offset(0),
+                    m_chunk_start(std::string::npos),
+                    m_in_delete_section(false),
+                    m_header_done(false) {
+                }
+
+                bool operator()() {
+                    try {
+                        run();
+                    } catch (...) {
+                        if (!m_header_done) {
+                            set_header(osmium::io::Header());
+                        }
+                        push_eof();
+                        throw;
+                    }
+                    push_eof();
+                    return true;
+                }
+
+            }; // class ParallelXMLParser
+
+            class XMLInputFormat : public osmium::io::detail::InputFormat {
+
+                static constexpr size_t max_queue_size = 100;
+                static constexpr size_t max_chunk_queue_size = 20;
+
+                // Parse in several threads? Set with the "xml_parallel"
+                // file option.
+                const bool m_parallel;
+
+                // Use BuiltinXMLParser instead of Expat? Set with the
+                // "xml_parser" file option.
+                const bool m_builtin_parser;
+
+                osmium::thread::Queue<osmium::memory::Buffer> m_queue;
+                osmium::thread::Queue<std::future<osmium::memory::Buffer>> m_chunk_queue;
+                std::atomic<bool> m_done;
+                std::promise<osmium::io::Header> m_header_promise;
+                std::future<bool> m_parser_future;
+
+                static bool use_builtin_parser(const osmium::io::File& file) {
+                    const std::string parser = file.get("xml_parser");
+                    if (parser.empty() || parser == "expat") {
+                        return false;
+                    }
+                    if (parser == "builtin") {
+                        return true;
+                    }
+                    throw std::runtime_error(std::string("Unknown value for xml_parser option: '") + parser + "'");
+                }
+
+                std::future<bool> start_parser(const osmium::io::detail::reader_options& options, osmium::io::detail::input_queue_type& input_queue) {
+                    if (m_parallel) {
+                        return std::async(std::launch::async, ParallelXMLParser(input_queue, m_chunk_queue, m_header_promise, options, m_buffer_pool, m_budget, m_done, m_builtin_parser));
+                    }
+                    if (m_builtin_parser) {
+                        return std::async(std::launch::async, BuiltinXMLParser(input_queue, m_queue, m_header_promise, options, m_buffer_pool, m_done));
+                    }
+                    return std::async(std::launch::async, XMLParser(input_queue, m_queue, m_header_promise, options, m_buffer_pool, m_done));
+                }
+
+                osmium::memory::Buffer read_chunk() {
+                    osmium::memory::Buffer buffer;
+                    if (!m_done || !m_chunk_queue.empty()) {
+                        std::future<osmium::memory::Buffer> buffer_future;
+                        m_chunk_queue.wait_and_pop(buffer_future);
+                        try {
+                            buffer = buffer_future.get();
+                        } catch (...) {
+                            m_done = true;
+                            throw;
+                        }
+                        if (buffer) {
+                            m_budget.release(buffer.committed());
+                        } else {
+                            // the parser is done, make sure we see its errors
+                            m_done = true;
+                            osmium::thread::wait_until_done(m_parser_future);
+                        }
+                    }
+                    return buffer;
+                }
+
+                /**
+                 * Wait for all outstanding chunk results and throw them
+                 * away.
+                 */
+                void drain_chunk_queue() {
+                    std::future<osmium::memory::Buffer> buffer_future;
+                    while (m_chunk_queue.try_pop(buffer_future)) {
+                        if (buffer_future.valid()) {
+                            buffer_future.wait();
+                        }
+                    }
+                }
+
+            public:
+
+                /**
+                 * Instantiate XML Parser
+                 *
+                 * If the file option "xml_parallel" is set to "true", the
+                 * file is parsed in several threads, see ParallelXMLParser.
+                 *
+                 * If the file option "xml_parser" is set to "builtin", the
+                 * BuiltinXMLParser is used instead of Expat. The default
+                 * is "expat".
+                 *
+                 * @param file osmium::io::File instance describing file to be read from.
+                 * @param options Options from the Reader (which entities to read etc.).
+                 * @param input_queue String queue where data is read from.
+                 * @throws std::runtime_error If the xml_parser option is invalid.
+                 */
+                explicit XMLInputFormat(const osmium::io::File& file, const osmium::io::detail::reader_options& options, osmium::io::detail::input_queue_type& input_queue) :
+                    osmium::io::detail::InputFormat(file, options),
+                    m_parallel(file.get("xml_parallel") == "true"),
+                    m_builtin_parser(use_builtin_parser(file)),
+                    m_queue(max_queue_size, "xml_parser_results", m_budget, [](const osmium::memory::Buffer& buffer) { return buffer.committed(); }),
+                    m_chunk_queue(max_chunk_queue_size, "xml_chunk_parser_results"),
+                    m_done(false),
+                    m_header_promise(),
+                    m_parser_future(start_parser(options, input_queue)) {
+                }
+
+                ~XMLInputFormat() {
+                    try {
+                        close();
+                    } catch (...) {
+                        // ignore any exceptions at this point because destructor should not throw
+                    }
+                }
+
+                virtual osmium::io::Header header() override final {
+                    osmium::thread::check_for_exception(m_parser_future);
+                    return m_header_promise.get_future().get();
+                }
+
+                osmium::memory::Buffer read() override {
+                    if (m_parallel) {
+                        return read_chunk();
+                    }
+
                     osmium::memory::Buffer buffer;
                     if (!m_done || !m_queue.empty()) {
                         m_queue.wait_and_pop(buffer);
@@ -715,7 +2086,11 @@ namespace osmium {
 
                 void close() override {
                     m_done = true;
+                    m_budget.shutdown();
+                    m_queue.shutdown(); // so the parser is not stuck on a full queue
+                    drain_chunk_queue(); // so the parser is not stuck on a full queue
                     osmium::thread::wait_until_done(m_parser_future);
+                    drain_chunk_queue();
                 }
 
             }; // class XMLInputFormat
@@ -723,8 +2098,8 @@ namespace osmium {
             namespace {
 
                 const bool registered_xml_input = osmium::io::detail::InputFormatFactory::instance().register_input_format(osmium::io::file_format::xml,
-                    [](const osmium::io::File& file, osmium::osm_entity_bits::type read_which_entities, osmium::thread::Queue<std::string>& input_queue) {
-                        return new osmium::io::detail::XMLInputFormat(file, read_which_entities, input_queue);
+                    [](const osmium::io::File& file, const osmium::io::detail::reader_options& options, osmium::io::detail::input_queue_type& input_queue) {
+                        return new osmium::io::detail::XMLInputFormat(file, options, input_queue);
                 });
 
             } // anonymous namespace
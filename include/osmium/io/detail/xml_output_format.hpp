@@ -396,8 +396,8 @@ namespace osmium {
 
             public:
 
-                XMLOutputFormat(const osmium::io::File& file, data_queue_type& output_queue) :
-                    OutputFormat(file, output_queue),
+                XMLOutputFormat(const osmium::io::File& file, data_queue_type& output_queue, osmium::thread::Pool& pool) :
+                    OutputFormat(file, output_queue, pool),
                     m_write_visible_flag(file.has_multiple_object_versions() || m_file.is_true("force_visible_flag")) {
                 }
 
@@ -408,7 +408,7 @@ namespace osmium {
                 }
 
                 void write_buffer(osmium::memory::Buffer&& buffer) override final {
-                    m_output_queue.push(osmium::thread::Pool::instance().submit(XMLOutputBlock{std::move(buffer), m_write_visible_flag, m_file.is_true("xml_change_format")}));
+                    m_output_queue.push(m_pool.submit(XMLOutputBlock{std::move(buffer), m_write_visible_flag, m_file.is_true("xml_change_format")}));
                 }
 
                 void write_header(const osmium::io::Header& header) override final {
@@ -469,8 +469,8 @@ namespace osmium {
             namespace {
 
                 const bool registered_xml_output = osmium::io::detail::OutputFormatFactory::instance().register_output_format(osmium::io::file_format::xml,
-                    [](const osmium::io::File& file, data_queue_type& output_queue) {
-                        return new osmium::io::detail::XMLOutputFormat(file, output_queue);
+                    [](const osmium::io::File& file, data_queue_type& output_queue, osmium::thread::Pool& pool) {
+                        return new osmium::io::detail::XMLOutputFormat(file, output_queue, pool);
                 });
 
             } // anonymous namespace
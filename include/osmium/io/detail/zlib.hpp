@@ -33,6 +33,8 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <algorithm>
+#include <cstddef>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -78,32 +80,131 @@ namespace osmium {
             }
 
             /**
-             * Uncompress data using zlib.
+             * Uncompress data using zlib into the given string. The string
+             * is resized as needed, its old contents are lost. Reusing the
+             * same output string for many calls saves memory allocations.
              *
              * Note that this function can not uncompress data larger than
              * what fits in an unsigned long, on Windows this is usually 32bit.
              *
-             * @param input Compressed input data.
+             * @param input Pointer to compressed input data.
+             * @param input_size Size of compressed input data.
              * @param raw_size Size of uncompressed data.
-             * @returns Uncompressed data.
+             * @param output String the uncompressed data is written to.
              */
-            inline std::unique_ptr<std::string> zlib_uncompress(const std::string& input, unsigned long raw_size) {
-                auto output = std::unique_ptr<std::string>(new std::string(raw_size, '\0'));
+            inline void zlib_uncompress(const char* input, size_t input_size, unsigned long raw_size, std::string& output) {
+                output.resize(raw_size);
 
                 auto result = ::uncompress(
-                    reinterpret_cast<unsigned char*>(const_cast<char *>(output->data())),
+                    reinterpret_cast<unsigned char*>(const_cast<char *>(output.data())),
                     &raw_size,
-                    reinterpret_cast<const unsigned char*>(input.data()),
-                    osmium::static_cast_with_assert<unsigned long>(input.size())
+                    reinterpret_cast<const unsigned char*>(input),
+                    osmium::static_cast_with_assert<unsigned long>(input_size)
                 );
 
                 if (result != Z_OK) {
                     throw std::runtime_error(std::string("failed to uncompress data: ") + zError(result));
                 }
 
+                output.resize(raw_size);
+            }
+
+            /**
+             * Uncompress data using zlib.
+             *
+             * Note that this function can not uncompress data larger than
+             * what fits in an unsigned long, on Windows this is usually 32bit.
+             *
+             * @param input Compressed input data.
+             * @param raw_size Size of uncompressed data.
+             * @returns Uncompressed data.
+             */
+            inline std::unique_ptr<std::string> zlib_uncompress(const std::string& input, unsigned long raw_size) {
+                auto output = std::unique_ptr<std::string>(new std::string());
+                zlib_uncompress(input.data(), input.size(), raw_size, *output);
                 return output;
             }
 
+            /**
+             * Uncompresses zlib data incrementally, only as far as needed.
+             * This is used to look at the beginning of some compressed data
+             * without paying for uncompressing all of it.
+             */
+            class ZlibPartialUncompressor {
+
+                z_stream m_stream;
+                std::unique_ptr<char[]> m_output;
+                size_t m_raw_size;
+                bool m_done;
+
+            public:
+
+                /**
+                 * @param input Pointer to compressed input data. Must stay
+                 *              valid as long as this object is in use.
+                 * @param input_size Size of compressed input data.
+                 * @param raw_size Size of uncompressed data.
+                 */
+                ZlibPartialUncompressor(const char* input, size_t input_size, size_t raw_size) :
+                    m_stream(),
+                    m_output(new char[raw_size]),
+                    m_raw_size(raw_size),
+                    m_done(false) {
+                    m_stream.next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(input));
+                    m_stream.avail_in = osmium::static_cast_with_assert<unsigned int>(input_size);
+                    m_stream.next_out = reinterpret_cast<unsigned char*>(m_output.get());
+                    m_stream.avail_out = 0;
+                    auto result = ::inflateInit(&m_stream);
+                    if (result != Z_OK) {
+                        throw std::runtime_error(std::string("failed to initialize zlib: ") + zError(result));
+                    }
+                }
+
+                ZlibPartialUncompressor(const ZlibPartialUncompressor&) = delete;
+                ZlibPartialUncompressor& operator=(const ZlibPartialUncompressor&) = delete;
+
+                ~ZlibPartialUncompressor() {
+                    ::inflateEnd(&m_stream);
+                }
+
+                /// Pointer to the uncompressed data.
+                const char* data() const noexcept {
+                    return m_output.get();
+                }
+
+                /// Number of bytes uncompressed so far.
+                size_t size() const noexcept {
+                    return static_cast<size_t>(reinterpret_cast<char*>(m_stream.next_out) - m_output.get());
+                }
+
+                /**
+                 * Uncompress data until at least min_size bytes are available
+                 * or all data has been uncompressed.
+                 *
+                 * @returns Number of bytes available.
+                 */
+                size_t uncompress_at_least(size_t min_size) {
+                    size_t available = size();
+                    while (!m_done && available < min_size) {
+                        // uncompress in exponentially growing steps
+                        const size_t step = std::min(m_raw_size - available, std::max(min_size - available, available));
+                        m_stream.avail_out = osmium::static_cast_with_assert<unsigned int>(step);
+                        auto result = ::inflate(&m_stream, Z_SYNC_FLUSH);
+                        if (result == Z_STREAM_END) {
+                            m_done = true;
+                        } else if (result != Z_OK) {
+                            throw std::runtime_error(std::string("failed to uncompress data: ") + zError(result));
+                        }
+                        available = size();
+                        if (available == m_raw_size) {
+                            m_done = true;
+                        }
+                    }
+                    return available;
+                }
+
+            }; // class ZlibPartialUncompressor
+
         } // namespace detail
 
     } // namespace io
@@ -0,0 +1,118 @@
+#ifndef OSMIUM_IO_DETAIL_ZSTD_HPP
+#define OSMIUM_IO_DETAIL_ZSTD_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+// The contents of this file are only compiled in if OSMIUM_WITH_ZSTD is
+// defined, so it can be included (and checked on its own) even if the
+// zstd library isn't available.
+#ifdef OSMIUM_WITH_ZSTD
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include <zstd.h>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * Compress data using zstd.
+             *
+             * @param input Data to compress.
+             * @returns Compressed data.
+             */
+            inline std::string zstd_compress(const std::string& input) {
+                std::string output(::ZSTD_compressBound(input.size()), '\0');
+
+                const size_t result = ::ZSTD_compress(
+                    const_cast<char*>(output.data()),
+                    output.size(),
+                    input.data(),
+                    input.size(),
+                    ZSTD_CLEVEL_DEFAULT
+                );
+
+                if (::ZSTD_isError(result)) {
+                    throw std::runtime_error(std::string("failed to compress data: ") + ::ZSTD_getErrorName(result));
+                }
+
+                output.resize(result);
+
+                return output;
+            }
+
+            /**
+             * Uncompress data using zstd into the given string. The string
+             * is resized as needed, its old contents are lost. Reusing the
+             * same output string for many calls saves memory allocations.
+             *
+             * @param input Pointer to compressed input data.
+             * @param input_size Size of compressed input data.
+             * @param raw_size Size of uncompressed data.
+             * @param output String the uncompressed data is written to.
+             * @throws std::runtime_error If the data could not be
+             *         uncompressed or does not have the expected size.
+             */
+            inline void zstd_uncompress(const char* input, size_t input_size, size_t raw_size, std::string& output) {
+                output.resize(raw_size);
+
+                const size_t result = ::ZSTD_decompress(
+                    const_cast<char*>(output.data()),
+                    raw_size,
+                    input,
+                    input_size
+                );
+
+                if (::ZSTD_isError(result)) {
+                    throw std::runtime_error(std::string("failed to uncompress data: ") + ::ZSTD_getErrorName(result));
+                }
+
+                if (result != raw_size) {
+                    throw std::runtime_error("failed to uncompress data: wrong size");
+                }
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_WITH_ZSTD
+
+#endif // OSMIUM_IO_DETAIL_ZSTD_HPP
@@ -220,6 +220,9 @@ namespace osmium {
                 } else if (suffixes.back() == "opl") {
                     m_file_format = file_format::opl;
                     suffixes.pop_back();
+                } else if (suffixes.back() == "osmbuf") {
+                    m_file_format = file_format::osmbuf;
+                    suffixes.pop_back();
                 }
 
                 if (suffixes.empty()) return;
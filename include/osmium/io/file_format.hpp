@@ -44,7 +44,8 @@ namespace osmium {
             xml     = 1,
             pbf     = 2,
             opl     = 3,
-            json    = 4
+            json    = 4,
+            osmbuf  = 5
         };
 
 // avoid g++ false positive
@@ -62,6 +63,8 @@ namespace osmium {
                     return "OPL";
                 case file_format::json:
                     return "JSON";
+                case file_format::osmbuf:
+                    return "OSMBUF";
             }
         }
 #pragma GCC diagnostic pop
@@ -0,0 +1,322 @@
+#ifndef OSMIUM_IO_MERGE_READER_HPP
+#define OSMIUM_IO_MERGE_READER_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <memory>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <osmium/io/error.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/io/input_iterator.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/object_comparisons.hpp>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Reads several OSM files that are each sorted by type, id, and
+         * version and returns the objects from all of them as one sorted
+         * stream. If the same version of an object is in several inputs,
+         * it is only returned once (the copy from the first input in the
+         * list is used). Changesets are not returned.
+         *
+         * There is one osmium::io::Reader for each input. They all read
+         * and decode their data in their own threads and the thread pool
+         * in parallel, this class only does the merging.
+         *
+         * The interface is the same as for the Reader, so a MergeReader
+         * can be used with osmium::apply() etc.
+         */
+        class MergeReader {
+
+            struct input {
+
+                std::unique_ptr<osmium::io::Reader> reader;
+                osmium::memory::Buffer buffer;
+                osmium::memory::Buffer::t_iterator<osmium::OSMObject> it;
+
+                const osmium::OSMObject& object() const {
+                    return *it;
+                }
+
+                /**
+                 * Read buffers until one with at least one object is
+                 * found.
+                 *
+                 * @returns false at the end of the input.
+                 */
+                bool next_buffer() {
+                    while ((buffer = reader->read())) {
+                        it = buffer.begin<osmium::OSMObject>();
+                        if (it != buffer.end<osmium::OSMObject>()) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                /**
+                 * Move to the next object.
+                 *
+                 * @returns false at the end of the input.
+                 * @throws osmium::io_error if the input is not sorted.
+                 */
+                bool next() {
+                    const osmium::OSMObject& last = object();
+                    ++it;
+                    if (it != buffer.end<osmium::OSMObject>()) {
+                        if (object() < last) {
+                            throw osmium::io_error("MergeReader: input not sorted");
+                        }
+                        return true;
+                    }
+
+                    // keep the last object alive until we have compared it
+                    osmium::memory::Buffer old_buffer = std::move(buffer);
+                    if (!next_buffer()) {
+                        return false;
+                    }
+                    if (object() < last) {
+                        throw osmium::io_error("MergeReader: input not sorted");
+                    }
+                    return true;
+                }
+
+            }; // struct input
+
+            /**
+             * Orders the inputs in the heap by their current object. If
+             * the objects are the same, the input given first comes first.
+             */
+            struct input_order {
+
+                const std::vector<input>* inputs;
+
+                bool operator()(size_t lhs, size_t rhs) const noexcept {
+                    const osmium::OSMObject& l = (*inputs)[lhs].object();
+                    const osmium::OSMObject& r = (*inputs)[rhs].object();
+                    if (l == r) {
+                        return lhs > rhs;
+                    }
+                    return osmium::object_order_type_id_version()(r, l);
+                }
+
+            }; // struct input_order
+
+            std::vector<input> m_inputs;
+            std::priority_queue<size_t, std::vector<size_t>, input_order> m_heap;
+            osmium::io::Header m_header;
+            osmium::memory::Buffer m_spare_buffer;
+            bool m_eof;
+
+            void advance(size_t index) {
+                if (m_inputs[index].next()) {
+                    m_heap.push(index);
+                }
+            }
+
+            template <typename... TArgs>
+            void open(const std::vector<osmium::io::File>& files, TArgs&&... args) {
+                m_inputs.reserve(files.size());
+                for (const auto& file : files) {
+                    m_inputs.emplace_back();
+                    m_inputs.back().reader.reset(new osmium::io::Reader(file, args...));
+                }
+
+                // headers are only available after all Readers are started
+                for (auto& in : m_inputs) {
+                    const osmium::io::Header header = in.reader->header();
+                    if (&in == &m_inputs.front()) {
+                        m_header = header;
+                        m_header.boxes().clear();
+                    }
+                    for (const auto& box : header.boxes()) {
+                        m_header.add_box(box);
+                    }
+                    if (header.has_multiple_object_versions()) {
+                        m_header.set_has_multiple_object_versions(true);
+                    }
+                }
+
+                for (size_t i = 0; i < m_inputs.size(); ++i) {
+                    if (m_inputs[i].next_buffer()) {
+                        m_heap.push(i);
+                    }
+                }
+            }
+
+        public:
+
+            /// The size of the buffers returned by read().
+            static constexpr size_t buffer_size = 1024 * 1024;
+
+            /**
+             * Open the given files for reading.
+             *
+             * @param files The files to merge.
+             * @param args All further arguments are handed to the
+             *             constructor of each osmium::io::Reader, see
+             *             there for details.
+             *
+             * @throws osmium::io_error If no files are given.
+             */
+            template <typename... TArgs>
+            explicit MergeReader(const std::vector<osmium::io::File>& files, TArgs&&... args) :
+                m_inputs(),
+                m_heap(input_order{&m_inputs}),
+                m_header(),
+                m_spare_buffer(),
+                m_eof(false) {
+                if (files.empty()) {
+                    throw osmium::io_error("MergeReader needs at least one input file");
+                }
+                open(files, std::forward<TArgs>(args)...);
+            }
+
+            template <typename... TArgs>
+            explicit MergeReader(const std::vector<std::string>& filenames, TArgs&&... args) :
+                MergeReader(std::vector<osmium::io::File>(filenames.begin(), filenames.end()), std::forward<TArgs>(args)...) {
+            }
+
+            MergeReader(const MergeReader&) = delete;
+            MergeReader& operator=(const MergeReader&) = delete;
+
+            MergeReader(MergeReader&&) = delete;
+            MergeReader& operator=(MergeReader&&) = delete;
+
+            ~MergeReader() = default;
+
+            /**
+             * Close all inputs.
+             */
+            void close() {
+                for (auto& in : m_inputs) {
+                    in.reader->close();
+                }
+            }
+
+            /**
+             * Get the header of the merged data. This is the header of
+             * the first input with the bounding boxes of all inputs.
+             */
+            osmium::io::Header header() const {
+                return m_header;
+            }
+
+            /**
+             * Reads the next buffer of merged data. An invalid buffer is
+             * returned at the end of the input.
+             *
+             * @throws Any exception a Reader can throw.
+             * @throws osmium::io_error If one of the inputs is not sorted.
+             */
+            osmium::memory::Buffer read() {
+                if (m_heap.empty()) {
+                    m_eof = true;
+                    return osmium::memory::Buffer();
+                }
+
+                osmium::memory::Buffer buffer = m_spare_buffer ? std::move(m_spare_buffer) : osmium::memory::Buffer(buffer_size);
+
+                while (!m_heap.empty()) {
+                    const size_t index = m_heap.top();
+                    const osmium::OSMObject& object = m_inputs[index].object();
+
+                    if (buffer.committed() > 0 && buffer.committed() + object.padded_size() > buffer.capacity()) {
+                        break;
+                    }
+
+                    buffer.add_item(object);
+                    buffer.commit();
+                    m_heap.pop();
+
+                    // skip copies of the same object in other inputs
+                    while (!m_heap.empty() && m_inputs[m_heap.top()].object() == object) {
+                        const size_t dup = m_heap.top();
+                        m_heap.pop();
+                        advance(dup);
+                    }
+
+                    advance(index);
+                }
+
+                return buffer;
+            }
+
+            /**
+             * Give a buffer returned by read() back to the MergeReader
+             * for reuse.
+             */
+            void recycle(osmium::memory::Buffer&& buffer) {
+                if (buffer && buffer.capacity() == buffer_size) {
+                    buffer.clear();
+                    m_spare_buffer = std::move(buffer);
+                }
+            }
+
+            /**
+             * Has the end of all inputs been reached?
+             */
+            bool eof() const {
+                return m_eof;
+            }
+
+        }; // class MergeReader
+
+    } // namespace io
+
+} // namespace osmium
+
+namespace std {
+
+    inline osmium::io::InputIterator<osmium::io::MergeReader> begin(osmium::io::MergeReader& reader) {
+        return osmium::io::InputIterator<osmium::io::MergeReader>(reader);
+    }
+
+    inline osmium::io::InputIterator<osmium::io::MergeReader> end(osmium::io::MergeReader&) {
+        return osmium::io::InputIterator<osmium::io::MergeReader>();
+    }
+
+} // namespace std
+
+#endif // OSMIUM_IO_MERGE_READER_HPP
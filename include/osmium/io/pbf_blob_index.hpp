@@ -0,0 +1,582 @@
+#ifndef OSMIUM_IO_PBF_BLOB_INDEX_HPP
+#define OSMIUM_IO_PBF_BLOB_INDEX_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Include this file if you want to build, read or write an index of the
+ * blobs in a PBF file.
+ *
+ * @attention If you include this file, you'll need to link with
+ *            `ws2_32` (Windows only) and `libz`.
+ */
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+#ifndef _MSC_VER
+# include <unistd.h>
+#else
+# include <io.h>
+#endif
+
+#include <osmium/io/detail/memory_mapping.hpp>
+#include <osmium/io/detail/pbf.hpp>
+#include <osmium/io/detail/pbf_parser.hpp>
+#include <osmium/io/detail/protobuf.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/io/overwrite.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/types.hpp>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Information about one OSMData blob in a PBF file.
+         */
+        struct PBFBlobInfo {
+
+            /// Offset of the blob in the file (pointing to the length of
+            /// the BlobHeader).
+            uint64_t offset;
+
+            /// Size of the blob in bytes including the BlobHeader and its
+            /// length.
+            uint32_t size;
+
+            /// The types of all OSM entities in this blob.
+            osmium::osm_entity_bits::type types;
+
+            /// Type and ID of the first object in the blob.
+            osmium::item_type first_type;
+            osmium::object_id_type first_id;
+
+            /// Type and ID of the last object in the blob.
+            osmium::item_type last_type;
+            osmium::object_id_type last_id;
+
+            PBFBlobInfo() :
+                offset(0),
+                size(0),
+                types(osmium::osm_entity_bits::nothing),
+                first_type(osmium::item_type::undefined),
+                first_id(0),
+                last_type(osmium::item_type::undefined),
+                last_id(0) {
+            }
+
+            /**
+             * Does this blob contain objects of any of the given types?
+             */
+            bool contains(osmium::osm_entity_bits::type entities) const noexcept {
+                return (types & entities) != 0;
+            }
+
+        }; // struct PBFBlobInfo
+
+        namespace detail {
+
+            /**
+             * Finds the types and the first and last object in a
+             * PrimitiveBlock without building any objects.
+             */
+            class PBFBlockScanner {
+
+                PBFBlobInfo& m_info;
+
+                void add(osmium::item_type type, osmium::object_id_type id) {
+                    if (m_info.types == osmium::osm_entity_bits::nothing) {
+                        m_info.first_type = type;
+                        m_info.first_id = id;
+                    }
+                    m_info.types |= osmium::osm_entity_bits::from_item_type(type);
+                    m_info.last_type = type;
+                    m_info.last_id = id;
+                }
+
+                static osmium::object_id_type get_id(const data_view& data, bool zigzag) {
+                    ProtobufReader pbf_object(data);
+                    while (pbf_object.next()) {
+                        if (pbf_object.tag() == 1) {
+                            return zigzag ? pbf_object.get_sint64() : pbf_object.get_int64();
+                        }
+                        pbf_object.skip();
+                    }
+                    throw osmium::pbf_error("object without id");
+                }
+
+                void scan_dense_nodes(const data_view& data) {
+                    ProtobufReader pbf_dense_nodes(data);
+                    while (pbf_dense_nodes.next()) {
+                        if (pbf_dense_nodes.tag() == 1) {
+                            PackedVarintReader ids = pbf_dense_nodes.get_packed();
+                            osmium::object_id_type id = 0;
+                            while (!ids.empty()) {
+                                id += ids.next_sint64();
+                                add(osmium::item_type::node, id);
+                            }
+                        } else {
+                            pbf_dense_nodes.skip();
+                        }
+                    }
+                }
+
+                void scan_group(const data_view& data) {
+                    ProtobufReader pbf_primitive_group(data);
+                    while (pbf_primitive_group.next()) {
+                        switch (pbf_primitive_group.tag()) {
+                            case 1: // nodes
+                                add(osmium::item_type::node, get_id(pbf_primitive_group.get_view(), true));
+                                break;
+                            case 2: // dense
+                                scan_dense_nodes(pbf_primitive_group.get_view());
+                                break;
+                            case 3: // ways
+                                add(osmium::item_type::way, get_id(pbf_primitive_group.get_view(), false));
+                                break;
+                            case 4: // relations
+                                add(osmium::item_type::relation, get_id(pbf_primitive_group.get_view(), false));
+                                break;
+                            default:
+                                pbf_primitive_group.skip();
+                        }
+                    }
+                }
+
+            public:
+
+                explicit PBFBlockScanner(PBFBlobInfo& info) :
+                    m_info(info) {
+                }
+
+                void operator()(const data_view& data) {
+                    ProtobufReader pbf_primitive_block(data);
+                    while (pbf_primitive_block.next()) {
+                        if (pbf_primitive_block.tag() == 2) {
+                            scan_group(pbf_primitive_block.get_view());
+                        } else {
+                            pbf_primitive_block.skip();
+                        }
+                    }
+                }
+
+            }; // class PBFBlockScanner
+
+            /**
+             * Get the size of the BlobHeader starting at data.
+             */
+            inline uint32_t get_blob_header_size(const char* data) {
+                uint32_t size_in_network_byte_order;
+                std::memcpy(&size_in_network_byte_order, data, sizeof(size_in_network_byte_order));
+                const uint32_t size = ntohl(size_in_network_byte_order);
+                if (size > static_cast<uint32_t>(max_blob_header_size)) {
+                    throw osmium::pbf_error("invalid BlobHeader size (> max_blob_header_size)");
+                }
+                return size;
+            }
+
+            template <typename T>
+            inline void append_raw(std::string& out, T value) {
+                out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            template <typename T>
+            inline T get_raw(const char** data) {
+                T value;
+                std::memcpy(&value, *data, sizeof(T));
+                *data += sizeof(T);
+                return value;
+            }
+
+            /**
+             * Number of bytes at the beginning and at the end of a PBF
+             * file that go into the checksum stored in the blob index.
+             */
+            constexpr size_t pbf_blob_index_checksum_size = 64 * 1024;
+
+            inline uint64_t fnv1a_64(uint64_t hash, const char* data, size_t size) noexcept {
+                for (const char* end = data + size; data != end; ++data) {
+                    hash ^= static_cast<unsigned char>(*data);
+                    hash *= 1099511628211ULL;
+                }
+                return hash;
+            }
+
+            /**
+             * Calculate the checksum used to detect whether a blob index
+             * still fits a PBF file. It covers the beginning of the file
+             * with the OSMHeader blob and the first BlobHeaders and the
+             * end of the file. Together with the file size this catches
+             * files that were replaced by a new version without having to
+             * read the whole file.
+             */
+            inline uint64_t pbf_blob_index_checksum(const char* data, size_t size) noexcept {
+                uint64_t hash = 14695981039346656037ULL;
+                if (size <= 2 * pbf_blob_index_checksum_size) {
+                    return fnv1a_64(hash, data, size);
+                }
+                hash = fnv1a_64(hash, data, pbf_blob_index_checksum_size);
+                return fnv1a_64(hash, data + size - pbf_blob_index_checksum_size, pbf_blob_index_checksum_size);
+            }
+
+        } // namespace detail
+
+        /**
+         * Index of all OSMData blobs in a PBF file with their offsets,
+         * sizes and the types and IDs of the objects in them. With this
+         * index the PBF input format can go directly to the blobs it
+         * needs instead of reading and decompressing all of them.
+         *
+         * The index can be built by scanning a PBF file (which needs to
+         * decompress all blobs once) and it can be stored in a sidecar
+         * file for later use. The sidecar file is in the native byte
+         * order of the machine, it is not meant to be moved between
+         * machines.
+         *
+         * To have the Reader use an index, set the file option
+         * "pbf_index" to the name of the sidecar file. If the sidecar
+         * file does not exist or doesn't match the PBF file (as determined
+         * by the file size and a checksum over the beginning and end of
+         * the file), the index is built and the sidecar file (re)written.
+         * If the sidecar file can't be written, the index is only kept
+         * in memory. The index is only
+         * used if the PBF file is read through a memory mapping (ie. it
+         * is an uncompressed local file).
+         *
+         * @code
+         * osmium::io::File file("planet.osm.pbf", "pbf,pbf_index=planet.osm.pbf.idx");
+         * osmium::io::Reader reader(file, osmium::osm_entity_bits::relation);
+         * @endcode
+         */
+        class PBFBlobIndex {
+
+            static const char* magic() noexcept {
+                return "OSMIUMBI";
+            }
+
+            static constexpr size_t magic_size = 8;
+            static constexpr uint32_t format_version = 2;
+
+            uint64_t m_file_size;
+            uint64_t m_checksum;
+            std::vector<PBFBlobInfo> m_blobs;
+
+        public:
+
+            typedef std::vector<PBFBlobInfo>::const_iterator const_iterator;
+
+            PBFBlobIndex() :
+                m_file_size(0),
+                m_checksum(0),
+                m_blobs() {
+            }
+
+            /**
+             * Build index for a PBF file in memory.
+             *
+             * @param data Pointer to the complete PBF file.
+             * @param size Size of the file.
+             * @throws osmium::pbf_error If the PBF file is not valid.
+             */
+            static PBFBlobIndex build(const char* data, size_t size) {
+                PBFBlobIndex index;
+                index.m_file_size = size;
+                index.m_checksum = detail::pbf_blob_index_checksum(data, size);
+
+                std::string unpack_buffer;
+                const char* blob = data;
+                const char* const end = data + size;
+                bool first_blob = true;
+                while (static_cast<size_t>(end - blob) >= sizeof(uint32_t)) {
+                    const uint32_t header_size = detail::get_blob_header_size(blob);
+                    const char* header = blob + sizeof(uint32_t);
+                    if (static_cast<size_t>(end - header) < header_size) {
+                        throw osmium::pbf_error("truncated data (EOF encountered)");
+                    }
+                    const size_t blob_size = detail::decode_blob_header(header, header_size, first_blob ? "OSMHeader" : "OSMData");
+                    const char* blob_data = header + header_size;
+                    if (static_cast<size_t>(end - blob_data) < blob_size) {
+                        throw osmium::pbf_error("truncated data (EOF encountered)");
+                    }
+
+                    if (!first_blob) {
+                        PBFBlobInfo info;
+                        info.offset = static_cast<uint64_t>(blob - data);
+                        info.size = static_cast<uint32_t>(blob_data + blob_size - blob);
+                        detail::PBFBlockScanner scanner(info);
+                        scanner(detail::unpack_blob(blob_data, blob_size, unpack_buffer));
+                        index.m_blobs.push_back(info);
+                    }
+
+                    first_blob = false;
+                    blob = blob_data + blob_size;
+                }
+
+                return index;
+            }
+
+            /**
+             * Build index for a PBF file.
+             *
+             * @param filename Name of the (uncompressed) PBF file.
+             * @throws osmium::pbf_error If the PBF file is not valid.
+             * @throws std::system_error If the file can not be read.
+             */
+            static PBFBlobIndex build(const std::string& filename) {
+                const detail::MemoryMapping mapping = detail::map_regular_file(filename);
+                if (!mapping) {
+                    throw osmium::io_error(std::string("can not build PBF blob index for '") + filename + "': not a regular file");
+                }
+                return build(mapping.data(), mapping.size());
+            }
+
+            /**
+             * Read index from a sidecar file.
+             *
+             * @param filename Name of the index file.
+             * @throws osmium::io_error If the file is not a valid index file
+             *         or contains blobs outside the PBF file.
+             * @throws std::system_error If the file can not be read.
+             */
+            static PBFBlobIndex read(const std::string& filename) {
+                const detail::MemoryMapping mapping = detail::map_regular_file(filename);
+                const size_t header_size = magic_size + sizeof(uint32_t) + 3 * sizeof(uint64_t);
+                if (mapping.size() < header_size || std::memcmp(mapping.data(), magic(), magic_size) != 0) {
+                    throw osmium::io_error(std::string("not a PBF blob index file: '") + filename + "'");
+                }
+
+                const char* data = mapping.data() + magic_size;
+                if (detail::get_raw<uint32_t>(&data) != format_version) {
+                    throw osmium::io_error(std::string("unsupported PBF blob index version in '") + filename + "'");
+                }
+
+                PBFBlobIndex index;
+                index.m_file_size = detail::get_raw<uint64_t>(&data);
+                index.m_checksum = detail::get_raw<uint64_t>(&data);
+                const uint64_t count = detail::get_raw<uint64_t>(&data);
+                if ((mapping.size() - header_size) / entry_size != count) {
+                    throw osmium::io_error(std::string("truncated PBF blob index file: '") + filename + "'");
+                }
+
+                index.m_blobs.reserve(count);
+                for (uint64_t i = 0; i < count; ++i) {
+                    PBFBlobInfo info;
+                    info.offset     = detail::get_raw<uint64_t>(&data);
+                    info.size       = detail::get_raw<uint32_t>(&data);
+                    info.types      = static_cast<osmium::osm_entity_bits::type>(detail::get_raw<uint8_t>(&data));
+                    info.first_type = static_cast<osmium::item_type>(detail::get_raw<uint8_t>(&data));
+                    info.last_type  = static_cast<osmium::item_type>(detail::get_raw<uint8_t>(&data));
+                    detail::get_raw<uint8_t>(&data); // unused
+                    info.first_id   = detail::get_raw<int64_t>(&data);
+                    info.last_id    = detail::get_raw<int64_t>(&data);
+                    if (info.offset > index.m_file_size || info.size > index.m_file_size - info.offset) {
+                        throw osmium::io_error(std::string("invalid blob in PBF blob index file: '") + filename + "'");
+                    }
+                    index.m_blobs.push_back(info);
+                }
+
+                return index;
+            }
+
+            /**
+             * Write index to a sidecar file.
+             *
+             * @param filename Name of the index file.
+             * @param allow_overwrite Allow overwriting of existing file?
+             * @throws std::system_error If the file can not be written.
+             */
+            void write(const std::string& filename, osmium::io::overwrite allow_overwrite = osmium::io::overwrite::allow) const {
+                std::string out(magic(), magic_size);
+                detail::append_raw<uint32_t>(out, format_version);
+                detail::append_raw<uint64_t>(out, m_file_size);
+                detail::append_raw<uint64_t>(out, m_checksum);
+                detail::append_raw<uint64_t>(out, m_blobs.size());
+                for (const auto& info : m_blobs) {
+                    detail::append_raw<uint64_t>(out, info.offset);
+                    detail::append_raw<uint32_t>(out, info.size);
+                    detail::append_raw<uint8_t>(out, static_cast<uint8_t>(info.types));
+                    detail::append_raw<uint8_t>(out, static_cast<uint8_t>(info.first_type));
+                    detail::append_raw<uint8_t>(out, static_cast<uint8_t>(info.last_type));
+                    detail::append_raw<uint8_t>(out, 0);
+                    detail::append_raw<int64_t>(out, info.first_id);
+                    detail::append_raw<int64_t>(out, info.last_id);
+                }
+
+                const int fd = detail::open_for_writing(filename, allow_overwrite);
+                try {
+                    detail::reliable_write(fd, out.data(), out.size());
+                } catch (...) {
+                    ::close(fd);
+                    throw;
+                }
+                if (::close(fd) != 0) {
+                    throw std::system_error(errno, std::system_category(), "Close failed");
+                }
+            }
+
+            /**
+             * Size of the PBF file this index was built for.
+             */
+            uint64_t file_size() const noexcept {
+                return m_file_size;
+            }
+
+            /**
+             * Checksum of the PBF file this index was built for.
+             */
+            uint64_t checksum() const noexcept {
+                return m_checksum;
+            }
+
+            /**
+             * Does this index fit the PBF file with the given data? Only
+             * the size and the checksum over the beginning and end of the
+             * file are compared. The input format checks that each blob
+             * it reads through the index is where the index says it is.
+             */
+            bool matches(const char* data, size_t size) const noexcept {
+                return m_file_size == size && m_checksum == detail::pbf_blob_index_checksum(data, size);
+            }
+
+            /**
+             * Number of OSMData blobs in the index.
+             */
+            size_t size() const noexcept {
+                return m_blobs.size();
+            }
+
+            bool empty() const noexcept {
+                return m_blobs.empty();
+            }
+
+            const_iterator begin() const noexcept {
+                return m_blobs.cbegin();
+            }
+
+            const_iterator end() const noexcept {
+                return m_blobs.cend();
+            }
+
+            const PBFBlobInfo& operator[](size_t n) const {
+                return m_blobs[n];
+            }
+
+            /**
+             * Find the first blob containing any objects of the given
+             * types.
+             *
+             * @returns Iterator to the blob info or end() if there is none.
+             */
+            const_iterator first_with(osmium::osm_entity_bits::type entities) const {
+                for (auto it = begin(); it != end(); ++it) {
+                    if (it->contains(entities)) {
+                        return it;
+                    }
+                }
+                return end();
+            }
+
+            /**
+             * Find all blobs that can contain objects of the given type
+             * with IDs in the range [first_id, last_id]. This only works
+             * if the file is sorted by type, then ID (as are all planet
+             * files and extracts).
+             */
+            std::vector<PBFBlobInfo> find(osmium::item_type type, osmium::object_id_type first_id, osmium::object_id_type last_id) const {
+                std::vector<PBFBlobInfo> result;
+                const auto range_begin = std::make_tuple(type, first_id);
+                const auto range_end   = std::make_tuple(type, last_id);
+                for (const auto& info : m_blobs) {
+                    if (info.types != osmium::osm_entity_bits::nothing &&
+                        std::make_tuple(info.first_type, info.first_id) <= range_end &&
+                        range_begin <= std::make_tuple(info.last_type, info.last_id)) {
+                        result.push_back(info);
+                    }
+                }
+                return result;
+            }
+
+        private:
+
+            static constexpr size_t entry_size = sizeof(uint64_t) + sizeof(uint32_t) + 4 * sizeof(uint8_t) + 2 * sizeof(int64_t);
+
+        }; // class PBFBlobIndex
+
+        namespace detail {
+
+            /**
+             * Read the PBF blob index from the given sidecar file. If it
+             * doesn't exist or doesn't fit the data, build the index from
+             * the data and write it out. If the sidecar file can't be
+             * written, the index is still returned.
+             */
+            inline PBFBlobIndex load_or_build_pbf_blob_index(const std::string& index_filename, const char* data, size_t size) {
+                try {
+                    PBFBlobIndex index = PBFBlobIndex::read(index_filename);
+                    if (index.matches(data, size)) {
+                        return index;
+                    }
+                } catch (const std::system_error&) {
+                    // index file doesn't exist or can't be read
+                } catch (const osmium::io_error&) {
+                    // index file isn't valid
+                }
+
+                PBFBlobIndex index = PBFBlobIndex::build(data, size);
+                try {
+                    index.write(index_filename);
+                } catch (const std::system_error&) {
+                    // index file can't be written, only use it in memory
+                }
+                return index;
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_PBF_BLOB_INDEX_HPP
@@ -39,8 +39,7 @@ DEALINGS IN THE SOFTWARE.
  * Include this file if you want to write OSM PBF files.
  *
  * @attention If you include this file, you'll need to link with
- *            `libprotobuf-lite`, `libosmpbf`, `ws2_32` (Windows only),
- *            `libz`, and enable multithreading.
+ *            `ws2_32` (Windows only), `libz`, and enable multithreading.
  */
 
 #include <osmium/io/writer.hpp> // IWYU pragma: export
@@ -0,0 +1,388 @@
+#ifndef OSMIUM_IO_PIPELINE_HPP
+#define OSMIUM_IO_PIPELINE_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/spsc_queue.hpp>
+#include <osmium/thread/util.hpp>
+#include <osmium/visitor.hpp>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Connects a source of buffers (usually an osmium::io::Reader),
+         * any number of processing stages, and a sink (usually an
+         * osmium::io::Writer). The source and each stage run in their own
+         * thread, the sink runs in the thread calling run(). Buffers are
+         * handed from one stage to the next through queues holding at
+         * most queue_size buffers, so a slow stage slows down the stages
+         * before it instead of letting the buffers pile up.
+         *
+         * If any stage, the source, or the sink throws an exception, all
+         * threads are stopped and the exception is re-thrown from run().
+         *
+         * Usage:
+         * @code
+         * osmium::io::Reader reader(infile);
+         * osmium::io::Writer writer(outfile, reader.header());
+         * osmium::io::Pipeline pipeline;
+         * pipeline.add_handlers(location_handler)
+         *         .add_parallel_stage(transform);
+         * pipeline.run(reader, writer);
+         * writer.close();
+         * @endcode
+         */
+        class Pipeline {
+
+        public:
+
+            /**
+             * A stage gets a buffer and returns the buffer to be handed to
+             * the next stage. This can be the same buffer or a new one. If
+             * an invalid buffer is returned, nothing is handed on.
+             */
+            typedef std::function<osmium::memory::Buffer(osmium::memory::Buffer&&)> stage_function;
+
+            static constexpr size_t default_queue_size = 4;
+
+        private:
+
+            typedef osmium::thread::SPSCQueue<osmium::memory::Buffer> queue_type;
+
+            struct stage {
+                stage_function process;
+                std::function<void()> finish;
+                bool parallel;
+            }; // struct stage
+
+            /**
+             * Pool task running a parallel stage on one buffer.
+             */
+            struct stage_task {
+
+                osmium::memory::Buffer buffer;
+                const stage_function* process;
+
+                osmium::memory::Buffer operator()() {
+                    return (*process)(std::move(buffer));
+                }
+
+            }; // struct stage_task
+
+            std::vector<stage> m_stages;
+            size_t m_queue_size;
+            osmium::thread::Pool& m_pool;
+
+            std::vector<std::unique_ptr<queue_type>> m_queues;
+            std::atomic<bool> m_cancelled;
+            std::mutex m_error_mutex;
+            std::exception_ptr m_error;
+
+            /**
+             * Stop all threads. The first exception reported here will be
+             * re-thrown from run().
+             */
+            void cancel(std::exception_ptr error) {
+                {
+                    std::lock_guard<std::mutex> lock(m_error_mutex);
+                    if (!m_error) {
+                        m_error = error;
+                    }
+                }
+                m_cancelled = true;
+                for (auto& queue : m_queues) {
+                    queue->shutdown();
+                }
+            }
+
+            template <typename TSource>
+            void run_source(TSource& source, queue_type& out) {
+                osmium::thread::set_thread_name("_osmium_pipe_in");
+                try {
+                    while (!m_cancelled) {
+                        osmium::memory::Buffer buffer = source.read();
+                        const bool done = !buffer;
+                        out.push(std::move(buffer));
+                        if (done) {
+                            return;
+                        }
+                    }
+                } catch (...) {
+                    cancel(std::current_exception());
+                }
+            }
+
+            void run_serial_stage(const stage& s, queue_type& in, queue_type& out) {
+                osmium::memory::Buffer buffer;
+                while (in.wait_and_pop(buffer) && !m_cancelled) {
+                    if (!buffer) {
+                        if (s.finish) {
+                            s.finish();
+                        }
+                        out.push(std::move(buffer));
+                        return;
+                    }
+                    osmium::memory::Buffer result = s.process(std::move(buffer));
+                    if (result) {
+                        out.push(std::move(result));
+                    }
+                }
+            }
+
+            void run_parallel_stage(const stage& s, queue_type& in, queue_type& out) {
+                std::deque<std::future<osmium::memory::Buffer>> results;
+
+                auto hand_on_oldest = [&] {
+                    osmium::memory::Buffer result = results.front().get();
+                    results.pop_front();
+                    if (result) {
+                        out.push(std::move(result));
+                    }
+                };
+
+                try {
+                    osmium::memory::Buffer buffer;
+                    while (in.wait_and_pop(buffer) && !m_cancelled) {
+                        if (!buffer) {
+                            while (!results.empty()) {
+                                hand_on_oldest();
+                            }
+                            if (s.finish) {
+                                s.finish();
+                            }
+                            out.push(std::move(buffer));
+                            return;
+                        }
+                        if (results.size() >= m_queue_size) {
+                            hand_on_oldest();
+                        }
+                        results.push_back(m_pool.submit(stage_task{std::move(buffer), &s.process}));
+                    }
+                } catch (...) {
+                    // tasks still running reference the stage function
+                    for (auto& result : results) {
+                        if (result.valid()) {
+                            result.wait();
+                        }
+                    }
+                    throw;
+                }
+
+                for (auto& result : results) {
+                    result.wait();
+                }
+            }
+
+            void run_stage(const stage& s, queue_type& in, queue_type& out) {
+                osmium::thread::set_thread_name("_osmium_pipe");
+                try {
+                    if (s.parallel) {
+                        run_parallel_stage(s, in, out);
+                    } else {
+                        run_serial_stage(s, in, out);
+                    }
+                } catch (...) {
+                    cancel(std::current_exception());
+                }
+            }
+
+            template <typename TSink>
+            void run_sink(TSink& sink, queue_type& in) {
+                osmium::memory::Buffer buffer;
+                while (in.wait_and_pop(buffer) && !m_cancelled) {
+                    if (!buffer) {
+                        return;
+                    }
+                    sink(std::move(buffer));
+                }
+            }
+
+        public:
+
+            /**
+             * Create an empty pipeline.
+             *
+             * @param queue_size Maximum number of buffers waiting between
+             *                   two stages and maximum number of buffers
+             *                   processed at the same time in a parallel
+             *                   stage.
+             * @param pool Thread pool for parallel stages.
+             */
+            explicit Pipeline(size_t queue_size = default_queue_size, osmium::thread::Pool& pool = osmium::thread::Pool::instance()) :
+                m_stages(),
+                m_queue_size(queue_size),
+                m_pool(pool),
+                m_queues(),
+                m_cancelled(false),
+                m_error_mutex(),
+                m_error() {
+            }
+
+            Pipeline(const Pipeline&) = delete;
+            Pipeline& operator=(const Pipeline&) = delete;
+
+            Pipeline(Pipeline&&) = delete;
+            Pipeline& operator=(Pipeline&&) = delete;
+
+            ~Pipeline() = default;
+
+            /**
+             * Add a stage calling the given function for each buffer in
+             * its own thread.
+             *
+             * @param process Function called for each buffer.
+             * @param finish Optional function called at the end of the
+             *               input.
+             */
+            Pipeline& add_stage(stage_function process, std::function<void()> finish = std::function<void()>()) {
+                m_stages.push_back(stage{std::move(process), std::move(finish), false});
+                return *this;
+            }
+
+            /**
+             * Add a stage calling the given function for several buffers
+             * at the same time in the thread pool. The function must be
+             * thread-safe. The results are still handed on in order.
+             *
+             * @param process Function called for each buffer.
+             * @param finish Optional function called at the end of the
+             *               input.
+             */
+            Pipeline& add_parallel_stage(stage_function process, std::function<void()> finish = std::function<void()>()) {
+                m_stages.push_back(stage{std::move(process), std::move(finish), true});
+                return *this;
+            }
+
+            /**
+             * Add a stage calling the handlers for all objects in each
+             * buffer like osmium::apply() does. The buffers are handed on
+             * unchanged. The handlers are flushed at the end of the input.
+             * The handlers must outlive the pipeline.
+             */
+            template <typename... THandlers>
+            Pipeline& add_handlers(THandlers&... handlers) {
+                return add_stage([&handlers...](osmium::memory::Buffer&& buffer) -> osmium::memory::Buffer {
+                    for (auto& item : buffer) {
+                        osmium::detail::apply_item_recurse(item, handlers...);
+                    }
+                    return std::move(buffer);
+                }, [&handlers...]() {
+                    osmium::detail::flush_recurse(handlers...);
+                });
+            }
+
+            /**
+             * Number of stages in this pipeline.
+             */
+            size_t size() const noexcept {
+                return m_stages.size();
+            }
+
+            /**
+             * Run the pipeline until the end of the input. Returns after
+             * all threads have finished.
+             *
+             * @param source Anything with a read() function returning
+             *               buffers and an invalid buffer at the end,
+             *               usually an osmium::io::Reader.
+             * @param sink Anything that can be called with a buffer,
+             *             usually an osmium::io::Writer. The Writer is not
+             *             closed by the pipeline.
+             * @throws Any exception thrown by the source, a stage, or the
+             *         sink.
+             */
+            template <typename TSource, typename TSink>
+            void run(TSource& source, TSink&& sink) {
+                m_cancelled = false;
+                m_error = nullptr;
+                m_queues.clear();
+                for (size_t i = 0; i <= m_stages.size(); ++i) {
+                    m_queues.emplace_back(new queue_type(m_queue_size, "pipeline"));
+                }
+
+                std::vector<std::future<void>> threads;
+                try {
+                    threads.push_back(std::async(std::launch::async, [this, &source] {
+                        run_source(source, *m_queues.front());
+                    }));
+                    for (size_t i = 0; i < m_stages.size(); ++i) {
+                        threads.push_back(std::async(std::launch::async, [this, i] {
+                            run_stage(m_stages[i], *m_queues[i], *m_queues[i + 1]);
+                        }));
+                    }
+                    run_sink(sink, *m_queues.back());
+                } catch (...) {
+                    cancel(std::current_exception());
+                }
+
+                for (auto& thread : threads) {
+                    thread.wait();
+                }
+                m_queues.clear();
+
+                if (m_error) {
+                    std::rethrow_exception(m_error);
+                }
+            }
+
+            /**
+             * Run the pipeline without a sink. Buffers coming out of the
+             * last stage are dropped.
+             */
+            template <typename TSource>
+            void run(TSource& source) {
+                run(source, [](osmium::memory::Buffer&&) {});
+            }
+
+        }; // class Pipeline
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_PIPELINE_HPP
@@ -37,6 +37,7 @@ DEALINGS IN THE SOFTWARE.
 #include <cerrno>
 #include <cstdlib>
 #include <fcntl.h>
+#include <initializer_list>
 #include <memory>
 #include <string>
 #include <system_error>
@@ -53,19 +54,53 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/io/compression.hpp>
 #include <osmium/io/detail/input_format.hpp>
+#include <osmium/io/detail/memory_mapping.hpp>
 #include <osmium/io/detail/read_thread.hpp>
 #include <osmium/io/detail/read_write.hpp>
 #include <osmium/io/file.hpp>
 #include <osmium/io/header.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/osm/box.hpp>
 #include <osmium/osm/entity_bits.hpp>
+#include <osmium/thread/byte_budget.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/spsc_queue.hpp>
 #include <osmium/thread/util.hpp>
-#include <osmium/thread/queue.hpp>
 
 namespace osmium {
 
     namespace io {
 
+        /**
+         * Reader option limiting the number of bytes of raw and decoded
+         * data in flight between the threads of the Reader. If the limit
+         * is reached, the threads reading and parsing the input block
+         * until the data has been consumed. See Reader::stats() for how
+         * often this happened.
+         */
+        struct memory_budget {
+
+            size_t bytes;
+
+            explicit memory_budget(size_t budget_bytes) noexcept :
+                bytes(budget_bytes) {
+            }
+
+        }; // struct memory_budget
+
+        /**
+         * Statistics about the data in flight in a Reader.
+         */
+        struct reader_stats {
+
+            /// Raw input data read but not yet parsed.
+            osmium::thread::budget_stats raw_data;
+
+            /// Data parsed but not yet returned from Reader::read().
+            osmium::thread::budget_stats decoded_data;
+
+        }; // struct reader_stats
+
         /**
          * This is the user-facing interface for reading OSM files. Instantiate
          * an object of this class with a file name or osmium::io::File object
@@ -75,15 +110,19 @@ namespace osmium {
         class Reader {
 
             osmium::io::File m_file;
-            osmium::osm_entity_bits::type m_read_which_entities;
+            osmium::io::detail::reader_options m_options;
             std::atomic<bool> m_input_done;
             int m_childpid;
 
-            osmium::thread::Queue<std::string> m_input_queue;
+            osmium::thread::ByteBudget m_input_budget;
+            osmium::io::detail::input_queue_type m_input_queue;
 
             std::unique_ptr<osmium::io::Decompressor> m_decompressor;
             std::future<bool> m_read_future;
 
+            // Must be declared before m_input so that it outlives it.
+            osmium::io::detail::MemoryMapping m_mapping;
+
             std::unique_ptr<osmium::io::detail::InputFormat> m_input;
 
 #ifndef _WIN32
@@ -144,8 +183,7 @@ namespace osmium {
              * @throws std::system_error if a system call fails.
              */
             static int open_input_file_or_url(const std::string& filename, int* childpid) {
-                std::string protocol = filename.substr(0, filename.find_first_of(':'));
-                if (protocol == "http" || protocol == "https" || protocol == "ftp" || protocol == "file") {
+                if (is_url(filename)) {
 #ifndef _WIN32
                     return execute("curl", filename, childpid);
 #else
@@ -156,36 +194,162 @@ namespace osmium {
                 }
             }
 
+            static bool is_url(const std::string& filename) {
+                std::string protocol = filename.substr(0, filename.find_first_of(':'));
+                return protocol == "http" || protocol == "https" || protocol == "ftp" || protocol == "file";
+            }
+
+            static void set_option(osmium::io::detail::reader_options& options, osmium::osm_entity_bits::type read_which_entities) noexcept {
+                options.read_which_entities = read_which_entities;
+            }
+
+            static void set_option(osmium::io::detail::reader_options& options, const osmium::Box& bbox) noexcept {
+                options.bbox = bbox;
+            }
+
+            static void set_option(osmium::io::detail::reader_options& options, osmium::io::read_meta read_metadata) noexcept {
+                options.read_metadata = read_metadata;
+            }
+
+            static void set_option(osmium::io::detail::reader_options& options, osmium::io::keep_raw_data keep_raw) noexcept {
+                options.keep_raw = keep_raw;
+            }
+
+            static void set_option(osmium::io::detail::reader_options& options, const osmium::io::memory_budget& budget) noexcept {
+                options.memory_budget = budget.bytes;
+            }
+
+            static void set_option(osmium::io::detail::reader_options& options, osmium::thread::Pool& pool) noexcept {
+                options.pool = &pool;
+            }
+
+            template <typename... TArgs>
+            static osmium::io::detail::reader_options make_options(TArgs&&... args) {
+                osmium::io::detail::reader_options options;
+                (void)std::initializer_list<int>{(set_option(options, std::forward<TArgs>(args)), 0)...};
+                return options;
+            }
+
+            /**
+             * Try to set up the input format so that it reads directly from
+             * memory. This works for uncompressed data if the input format
+             * supports it and if the data is either in a buffer already or
+             * comes from a regular file that can be memory mapped. Set the
+             * file option "mmap=false" to disable this.
+             *
+             * The mapping is read-only, except for the OSMBUF format, which
+             * returns buffers pointing into the mapped memory. Users can
+             * change the objects in those buffers, so OSMBUF files are
+             * mapped copy-on-write. If the file can't be mapped, for
+             * instance because there isn't enough address space, the input
+             * queue is used instead.
+             *
+             * @returns true if this worked, false if the input has to be
+             *          read through the input queue.
+             */
+            bool open_memory_input() {
+                if (m_file.compression() != osmium::io::file_compression::none ||
+                    m_file.get("mmap") == "false" ||
+                    !osmium::io::detail::InputFormatFactory::instance().supports_memory_input(m_file.format())) {
+                    return false;
+                }
+
+                if (m_file.buffer()) {
+                    m_input = osmium::io::detail::InputFormatFactory::instance().create_input(m_file, m_options, m_file.buffer(), m_file.buffer_size());
+                    return true;
+                }
+
+                if (is_url(m_file.filename())) {
+                    return false;
+                }
+
+                try {
+                    m_mapping = osmium::io::detail::map_regular_file(m_file.filename(), m_file.format() == osmium::io::file_format::osmbuf);
+                } catch (const std::system_error&) {
+                    return false;
+                }
+                if (!m_mapping) {
+                    return false;
+                }
+
+                m_input = osmium::io::detail::InputFormatFactory::instance().create_input(m_file, m_options, m_mapping.data(), m_mapping.size());
+                return true;
+            }
+
         public:
 
             /**
              * Create new Reader object.
              *
              * @param file The file we want to open.
-             * @param read_which_entities Which OSM entities (nodes, ways, relations, and/or changesets)
-             *                            should be read from the input file. It can speed the read up
-             *                            significantly if objects that are not needed anyway are not
-             *                            parsed.
+             * @param args All further arguments are optional and can appear
+             *             in any order:
+             *
+             * * osmium::osm_entity_bits::type: Which OSM entities (nodes,
+             *       ways, relations, and/or changesets) should be read from
+             *       the input file. It can speed the read up significantly
+             *       if objects that are not needed anyway are not parsed.
+             *
+             * * osmium::Box: Only nodes with a location inside this box
+             *       are read. All other nodes are skipped by the parser
+             *       before they are ever added to a buffer. Ways and
+             *       relations are not affected.
+             *
+             * * osmium::io::read_meta: Set to osmium::io::read_meta::no
+             *       if you don't need the metadata (version, timestamp,
+             *       changeset, uid, user) of the objects. It is not
+             *       decoded then, which makes reading faster.
+             *
+             * * osmium::io::keep_raw_data: Set to
+             *       osmium::io::keep_raw_data::yes to keep the raw blobs
+             *       of PBF files with the buffers, so that unchanged
+             *       buffers can be written to a PBF file without encoding
+             *       them again.
+             *
+             * * osmium::io::memory_budget: Limit for the number of bytes
+             *       of raw and decoded data in flight inside the Reader.
+             *
+             * * osmium::thread::Pool&: Thread pool used for parsing the
+             *       data. Default is osmium::thread::Pool::instance(). The
+             *       pool must outlive the Reader.
+             *
+             * Uncompressed local files in formats that support it (currently
+             * PBF, OPL, and OSMBUF) are memory mapped and parsed directly
+             * from memory. Buffers read from OSMBUF files point into the
+             * mapping, they can only be used as long as the Reader exists.
              */
-            explicit Reader(const osmium::io::File& file, osmium::osm_entity_bits::type read_which_entities = osmium::osm_entity_bits::all) :
+            template <typename... TArgs>
+            explicit Reader(const osmium::io::File& file, TArgs&&... args) :
                 m_file(file),
-                m_read_which_entities(read_which_entities),
+                m_options(make_options(std::forward<TArgs>(args)...)),
                 m_input_done(false),
                 m_childpid(0),
-                m_input_queue(20, "raw_input"), // XXX
-                m_decompressor(m_file.buffer() ?
+                m_input_budget(m_options.raw_data_budget()),
+                m_input_queue(20, "raw_input", m_input_budget, [](const std::string& data) { return data.size(); }), // XXX
+                m_decompressor(),
+                m_read_future(),
+                m_mapping(),
+                m_input() {
+                if (open_memory_input()) {
+                    return;
+                }
+
+                m_decompressor = m_file.buffer() ?
                     osmium::io::CompressionFactory::instance().create_decompressor(file.compression(), m_file.buffer(), m_file.buffer_size()) :
-                    osmium::io::CompressionFactory::instance().create_decompressor(file.compression(), open_input_file_or_url(m_file.filename(), &m_childpid))),
-                m_read_future(std::async(std::launch::async, detail::ReadThread(m_input_queue, m_decompressor.get(), m_input_done))),
-                m_input(osmium::io::detail::InputFormatFactory::instance().create_input(m_file, m_read_which_entities, m_input_queue)) {
+                    osmium::io::CompressionFactory::instance().create_decompressor(file.compression(), open_input_file_or_url(m_file.filename(), &m_childpid));
+                m_decompressor->set_pool(m_options.thread_pool());
+                m_read_future = std::async(std::launch::async, detail::ReadThread(m_input_queue, m_decompressor.get(), m_input_done));
+                m_input = osmium::io::detail::InputFormatFactory::instance().create_input(m_file, m_options, m_input_queue);
             }
 
-            explicit Reader(const std::string& filename, osmium::osm_entity_bits::type read_types = osmium::osm_entity_bits::all) :
-                Reader(osmium::io::File(filename), read_types) {
+            template <typename... TArgs>
+            explicit Reader(const std::string& filename, TArgs&&... args) :
+                Reader(osmium::io::File(filename), std::forward<TArgs>(args)...) {
             }
 
-            explicit Reader(const char* filename, osmium::osm_entity_bits::type read_types = osmium::osm_entity_bits::all) :
-                Reader(osmium::io::File(filename), read_types) {
+            template <typename... TArgs>
+            explicit Reader(const char* filename, TArgs&&... args) :
+                Reader(osmium::io::File(filename), std::forward<TArgs>(args)...) {
             }
 
             Reader(const Reader&) = delete;
@@ -210,6 +374,8 @@ namespace osmium {
             void close() {
                 // Signal to input child process that it should wrap up.
                 m_input_done = true;
+                m_input_budget.shutdown();
+                m_input_queue.shutdown();
 
                 m_input->close();
 
@@ -252,7 +418,7 @@ namespace osmium {
                 // it in this (the main) thread.
                 osmium::thread::check_for_exception(m_read_future);
 
-                if (m_read_which_entities == osmium::osm_entity_bits::nothing || m_input_done) {
+                if (m_options.read_which_entities == osmium::osm_entity_bits::nothing || m_input_done) {
                     // If the caller didn't want anything but the header, it will
                     // always get an empty buffer here.
                     return osmium::memory::Buffer();
@@ -271,9 +437,36 @@ namespace osmium {
                     if (buffer.committed() > 0) {
                         return buffer;
                     }
+                    m_input->recycle(std::move(buffer));
                 }
             }
 
+            /**
+             * Give a buffer returned from read() back to the Reader once
+             * you are done with it. Its memory will be reused for the
+             * buffers returned by later calls to read(), which saves
+             * allocating and initializing it again. The contents of the
+             * buffer are lost. Calling this is optional.
+             *
+             * @param buffer Buffer to recycle.
+             */
+            void recycle(osmium::memory::Buffer&& buffer) {
+                m_input->recycle(std::move(buffer));
+            }
+
+            /**
+             * Get statistics about the data in flight in this Reader, for
+             * instance how often and how long the threads reading and
+             * parsing the input had to wait because the memory_budget was
+             * used up.
+             */
+            reader_stats stats() const {
+                reader_stats result;
+                result.raw_data = m_input_budget.stats();
+                result.decoded_data = m_input->budget_stats();
+                return result;
+            }
+
             /**
              * Has the end of file been reached? This is set after the last
              * data has been read. It is also set by calling close().
@@ -33,6 +33,9 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <cassert>
+#include <future>
+#include <initializer_list>
 #include <memory>
 #include <string>
 #include <utility>
@@ -45,6 +48,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/header.hpp>
 #include <osmium/io/overwrite.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/thread/pool.hpp>
 #include <osmium/thread/util.hpp>
 
 namespace osmium {
@@ -59,6 +63,13 @@ namespace osmium {
          */
         class Writer {
 
+            struct options_type {
+                osmium::io::Header header;
+                overwrite allow_overwrite = overwrite::no;
+                osmium::thread::Pool* pool = nullptr;
+                copy_raw_data copy_raw = copy_raw_data::no;
+            }; // struct options_type
+
             osmium::io::File m_file;
 
             osmium::io::detail::data_queue_type m_output_queue;
@@ -69,6 +80,42 @@ namespace osmium {
 
             std::future<bool> m_write_future;
 
+            copy_raw_data m_copy_raw_data;
+
+            static void set_option(options_type& options, const osmium::io::Header& header) {
+                options.header = header;
+            }
+
+            static void set_option(options_type& options, overwrite allow_overwrite) noexcept {
+                options.allow_overwrite = allow_overwrite;
+            }
+
+            static void set_option(options_type& options, osmium::thread::Pool& pool) noexcept {
+                options.pool = &pool;
+            }
+
+            static void set_option(options_type& options, copy_raw_data copy_raw) noexcept {
+                options.copy_raw = copy_raw;
+            }
+
+            template <typename... TArgs>
+            static options_type make_options(TArgs&&... args) {
+                options_type options;
+                (void)std::initializer_list<int>{(set_option(options, std::forward<TArgs>(args)), 0)...};
+                return options;
+            }
+
+            Writer(const osmium::io::File& file, options_type&& options) :
+                m_file(file),
+                m_output_queue(20, "raw_output"), // XXX
+                m_output(osmium::io::detail::OutputFormatFactory::instance().create_output(m_file, m_output_queue, options.pool ? *options.pool : osmium::thread::Pool::instance())),
+                m_compressor(osmium::io::CompressionFactory::instance().create_compressor(file.compression(), osmium::io::detail::open_for_writing(m_file.filename(), options.allow_overwrite))),
+                m_write_future(std::async(std::launch::async, detail::WriteThread(m_output_queue, m_compressor.get()))),
+                m_copy_raw_data(options.copy_raw) {
+                assert(!m_file.buffer());
+                m_output->write_header(options.header);
+            }
+
         public:
 
             /**
@@ -76,32 +123,44 @@ namespace osmium {
              * header to it.
              *
              * @param file File (contains name and format info) to open.
-             * @param header Optional header data. If this is not given sensible
-             *               defaults will be used. See the default constructor
-             *               of osmium::io::Header for details.
-             * @param allow_overwrite Allow overwriting of existing file? Can be
-             *               osmium::io::overwrite::allow or osmium::io::overwrite::no
-             *               (default).
+             * @param args All further arguments are optional and can appear
+             *             in any order:
+             *
+             * * osmium::io::Header: Header data. If this is not given
+             *       sensible defaults will be used. See the default
+             *       constructor of osmium::io::Header for details.
+             *
+             * * osmium::io::overwrite: Allow overwriting of existing file?
+             *       Can be osmium::io::overwrite::allow or
+             *       osmium::io::overwrite::no (default).
+             *
+             * * osmium::thread::Pool&: Thread pool used for encoding the
+             *       data. Default is osmium::thread::Pool::instance(). The
+             *       pool must outlive the Writer.
+             *
+             * * osmium::io::copy_raw_data: Set to
+             *       osmium::io::copy_raw_data::yes to write out the raw
+             *       data attached to buffers (see osmium::io::keep_raw_data)
+             *       instead of encoding the objects again. Only use this if
+             *       objects are not changed in place, those changes would
+             *       be lost.
              *
              * @throws std::runtime_error If the file could not be opened.
              * @throws std::system_error If the file could not be opened.
              */
-            explicit Writer(const osmium::io::File& file, const osmium::io::Header& header = osmium::io::Header(), overwrite allow_overwrite = overwrite::no) :
-                m_file(file),
-                m_output_queue(20, "raw_output"), // XXX
-                m_output(osmium::io::detail::OutputFormatFactory::instance().create_output(m_file, m_output_queue)),
-                m_compressor(osmium::io::CompressionFactory::instance().create_compressor(file.compression(), osmium::io::detail::open_for_writing(m_file.filename(), allow_overwrite))),
-                m_write_future(std::async(std::launch::async, detail::WriteThread(m_output_queue, m_compressor.get()))) {
-                assert(!m_file.buffer());
-                m_output->write_header(header);
+            template <typename... TArgs>
+            explicit Writer(const osmium::io::File& file, TArgs&&... args) :
+                Writer(file, make_options(std::forward<TArgs>(args)...)) {
             }
 
-            explicit Writer(const std::string& filename, const osmium::io::Header& header = osmium::io::Header(), overwrite allow_overwrite = overwrite::no) :
-                Writer(osmium::io::File(filename), header, allow_overwrite) {
+            template <typename... TArgs>
+            explicit Writer(const std::string& filename, TArgs&&... args) :
+                Writer(osmium::io::File(filename), std::forward<TArgs>(args)...) {
             }
 
-            explicit Writer(const char* filename, const osmium::io::Header& header = osmium::io::Header(), overwrite allow_overwrite = overwrite::no) :
-                Writer(osmium::io::File(filename), header, allow_overwrite) {
+            template <typename... TArgs>
+            explicit Writer(const char* filename, TArgs&&... args) :
+                Writer(osmium::io::File(filename), std::forward<TArgs>(args)...) {
             }
 
             Writer(const Writer&) = delete;
@@ -118,6 +177,9 @@ namespace osmium {
              */
             void operator()(osmium::memory::Buffer&& buffer) {
                 osmium::thread::check_for_exception(m_write_future);
+                if (m_copy_raw_data == copy_raw_data::no) {
+                    buffer.clear_raw_data();
+                }
                 if (buffer.committed() > 0) {
                     m_output->write_buffer(std::move(buffer));
                 }
@@ -36,11 +36,14 @@ DEALINGS IN THE SOFTWARE.
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <exception>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -91,6 +94,9 @@ namespace osmium {
          * By default, if a buffer gets full it will throw a buffer_is_full exception.
          * You can use the set_full_callback() method to set a callback functor
          * which will be called instead of throwing an exception.
+         *
+         * A buffer can carry the raw data it was decoded from, see
+         * set_raw_data().
          */
         class Buffer {
 
@@ -111,6 +117,15 @@ namespace osmium {
             auto_grow m_auto_grow {auto_grow::no};
             std::function<void(Buffer&)> m_full;
 
+            /// Raw data the contents of this buffer were decoded from.
+            std::shared_ptr<const std::string> m_raw_data;
+
+            /// Committed size of the buffer when the raw data was set.
+            size_t m_raw_data_committed {0};
+
+            /// Format specific flags describing the raw data.
+            uint32_t m_raw_data_flags {0};
+
         public:
 
             typedef Item value_type;
@@ -294,9 +309,77 @@ namespace osmium {
                 const size_t committed = m_committed;
                 m_written = 0;
                 m_committed = 0;
+                m_raw_data.reset();
                 return committed;
             }
 
+            /**
+             * Attach the raw data the contents of this buffer were decoded
+             * from. Currently this is only done by the PBF input format
+             * (if the Reader was asked to keep the raw data). The data is
+             * then the original Blob of the PBF block and the PBF output
+             * format writes it out unchanged instead of encoding the
+             * buffer again.
+             *
+             * The raw data is dropped automatically when anything is
+             * committed to or removed from the buffer. Changes to objects
+             * in place can't be detected, so the Writer only uses the raw
+             * data if it was created with osmium::io::copy_raw_data::yes.
+             */
+            void set_raw_data(std::shared_ptr<const std::string> raw_data, uint32_t flags = 0) noexcept {
+                m_raw_data = std::move(raw_data);
+                m_raw_data_committed = m_committed;
+                m_raw_data_flags = flags;
+            }
+
+            /**
+             * Get the raw data the contents of this buffer were decoded
+             * from.
+             *
+             * @returns Pointer to the raw data or nullptr if there is none
+             *          or the buffer was changed since it was set.
+             */
+            const std::string* raw_data() const noexcept {
+                if (!m_raw_data || m_committed != m_raw_data_committed) {
+                    return nullptr;
+                }
+                return m_raw_data.get();
+            }
+
+            /**
+             * Get the format specific flags set together with the raw data.
+             * For PBF see osmium::io::detail::pbf_raw_blob_history.
+             */
+            uint32_t raw_data_flags() const noexcept {
+                return m_raw_data_flags;
+            }
+
+            /**
+             * Drop the raw data attached to this buffer.
+             */
+            void clear_raw_data() noexcept {
+                m_raw_data.reset();
+            }
+
+            /**
+             * Prepare the buffer for reuse. The buffer is cleared, the
+             * full callback is removed, and it is set to grow automatically.
+             * The memory is kept (and not zeroed). This works only with
+             * internally memory-managed buffers.
+             *
+             * @returns true if the buffer can be reused, false if it doesn't
+             *          use internal memory management.
+             */
+            bool reset_for_reuse() noexcept {
+                if (m_memory.empty()) {
+                    return false;
+                }
+                clear();
+                m_auto_grow = auto_grow::yes;
+                m_full = nullptr;
+                return true;
+            }
+
             /**
              * Get the data in the buffer at the given offset.
              *
@@ -473,6 +556,9 @@ namespace osmium {
                 swap(lhs.m_capacity, rhs.m_capacity);
                 swap(lhs.m_written, rhs.m_written);
                 swap(lhs.m_committed, rhs.m_committed);
+                swap(lhs.m_raw_data, rhs.m_raw_data);
+                swap(lhs.m_raw_data_committed, rhs.m_raw_data_committed);
+                swap(lhs.m_raw_data_flags, rhs.m_raw_data_flags);
             }
 
             /**
@@ -516,6 +602,7 @@ namespace osmium {
                 assert(it_write.data() >= data());
                 m_written = static_cast<size_t>(it_write.data() - data());
                 m_committed = m_written;
+                m_raw_data.reset();
             }
 
         }; // class Buffer
@@ -0,0 +1,131 @@
+#ifndef OSMIUM_MEMORY_BUFFER_POOL_HPP
+#define OSMIUM_MEMORY_BUFFER_POOL_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <osmium/memory/buffer.hpp>
+
+namespace osmium {
+
+    namespace memory {
+
+        /**
+         * A thread-safe pool of buffers that are not needed any more. Their
+         * memory can be reused for new buffers, which saves allocating and
+         * zero-filling it again.
+         *
+         * Buffers are put into the pool with return_buffer() and taken out
+         * again with get_buffer(). If the pool is empty, get_buffer()
+         * creates a new buffer.
+         */
+        class BufferPool {
+
+            const size_t m_max_buffers;
+
+            mutable std::mutex m_mutex;
+            std::vector<osmium::memory::Buffer> m_buffers;
+
+        public:
+
+            /**
+             * Create pool.
+             *
+             * @param max_buffers Maximum number of buffers kept in the pool.
+             *                    More buffers returned are freed.
+             */
+            explicit BufferPool(size_t max_buffers = 16) :
+                m_max_buffers(max_buffers),
+                m_mutex(),
+                m_buffers() {
+            }
+
+            BufferPool(const BufferPool&) = delete;
+            BufferPool& operator=(const BufferPool&) = delete;
+
+            BufferPool(BufferPool&&) = delete;
+            BufferPool& operator=(BufferPool&&) = delete;
+
+            ~BufferPool() = default;
+
+            /**
+             * Get an empty buffer with at least the given capacity. The
+             * buffer grows automatically. Its memory is not initialized.
+             *
+             * @param capacity Minimum capacity of the buffer. Must be a
+             *                 multiple of the alignment.
+             */
+            osmium::memory::Buffer get_buffer(size_t capacity) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!m_buffers.empty()) {
+                        osmium::memory::Buffer buffer = std::move(m_buffers.back());
+                        m_buffers.pop_back();
+                        buffer.grow(capacity);
+                        return buffer;
+                    }
+                }
+                return osmium::memory::Buffer(capacity);
+            }
+
+            /**
+             * Put a buffer into the pool. Its contents are lost. Buffers
+             * that don't use internal memory management are ignored.
+             */
+            void return_buffer(osmium::memory::Buffer&& buffer) {
+                if (!buffer.reset_for_reuse()) {
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_buffers.size() < m_max_buffers) {
+                    m_buffers.push_back(std::move(buffer));
+                }
+            }
+
+            /// The number of buffers currently in the pool.
+            size_t size() const {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_buffers.size();
+            }
+
+        }; // class BufferPool
+
+    } // namespace memory
+
+} // namespace osmium
+
+#endif // OSMIUM_MEMORY_BUFFER_POOL_HPP
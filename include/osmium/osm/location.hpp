@@ -280,6 +280,126 @@ namespace osmium {
         return out;
     }
 
+    namespace detail {
+
+        /**
+         * Parse a coordinate given as decimal number (optionally in
+         * exponential notation) into the fixed-point representation used
+         * by Location. The number is rounded to the nearest fixed-point
+         * value without going through a double, so it is exact for all
+         * numbers with up to 15 significant digits.
+         *
+         * @param str Start of the number. Does not need to be \0-terminated.
+         * @param end End of the number.
+         * @param result The coordinate is written here.
+         * @returns false if the string is not a valid number or the
+         *          coordinate is outside the range of the fixed-point
+         *          representation.
+         */
+        inline bool string_to_location_coordinate(const char* str, const char* end, int32_t& result) noexcept {
+            static constexpr int max_digits = 15;
+
+            bool negative = false;
+            if (str != end && (*str == '-' || *str == '+')) {
+                negative = (*str == '-');
+                ++str;
+            }
+
+            int64_t mantissa = 0;
+            int scale = 0; // value is mantissa * 10^scale
+            int digits = 0;
+            bool has_digits = false;
+
+            for (; str != end && *str >= '0' && *str <= '9'; ++str) {
+                has_digits = true;
+                if (digits < max_digits) {
+                    mantissa = mantissa * 10 + (*str - '0');
+                    if (mantissa) {
+                        ++digits;
+                    }
+                } else {
+                    ++scale;
+                }
+            }
+
+            if (str != end && *str == '.') {
+                for (++str; str != end && *str >= '0' && *str <= '9'; ++str) {
+                    has_digits = true;
+                    if (digits < max_digits) {
+                        mantissa = mantissa * 10 + (*str - '0');
+                        --scale;
+                        if (mantissa) {
+                            ++digits;
+                        }
+                    }
+                }
+            }
+
+            if (!has_digits) {
+                return false;
+            }
+
+            if (str != end && (*str == 'e' || *str == 'E')) {
+                ++str;
+                bool negative_exponent = false;
+                if (str != end && (*str == '-' || *str == '+')) {
+                    negative_exponent = (*str == '-');
+                    ++str;
+                }
+                if (str == end) {
+                    return false;
+                }
+                int exponent = 0;
+                for (; str != end && *str >= '0' && *str <= '9'; ++str) {
+                    if (exponent < 1000) {
+                        exponent = exponent * 10 + (*str - '0');
+                    }
+                }
+                scale += negative_exponent ? -exponent : exponent;
+            }
+
+            if (str != end) {
+                return false;
+            }
+
+            scale += 7; // Location::coordinate_precision is 10^7
+
+            if (mantissa == 0) {
+                result = 0;
+                return true;
+            }
+
+            if (scale >= 0) {
+                for (; scale > 0; --scale) {
+                    mantissa *= 10;
+                    if (mantissa >= Location::undefined_coordinate) {
+                        return false;
+                    }
+                }
+            } else if (scale < -18) {
+                mantissa = 0;
+            } else {
+                int64_t divisor = 1;
+                for (; scale < 0; ++scale) {
+                    divisor *= 10;
+                }
+                const int64_t remainder = mantissa % divisor;
+                mantissa /= divisor;
+                if (remainder * 2 >= divisor) {
+                    ++mantissa;
+                }
+            }
+
+            if (mantissa >= Location::undefined_coordinate) {
+                return false;
+            }
+
+            result = static_cast<int32_t>(negative ? -mantissa : mantissa);
+            return true;
+        }
+
+    } // namespace detail
+
 } // namespace osmium
 
 #endif // OSMIUM_OSM_LOCATION_HPP
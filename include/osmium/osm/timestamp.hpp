@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <cstddef>
 #include <cstdint>
 #include <ctime>
 #include <iosfwd>
@@ -166,6 +167,64 @@ namespace osmium {
         return out;
     }
 
+    namespace detail {
+
+        /**
+         * Parse a timestamp in the format "yyyy-mm-ddThh:mm:ssZ" without
+         * using strptime(). This is much faster than the Timestamp
+         * constructor taking a string.
+         *
+         * @param str Start of the timestamp. Does not need to be
+         *            \0-terminated.
+         * @param length Length of the timestamp.
+         * @param result Seconds since the epoch are written here.
+         * @returns false if the string is not in the expected format.
+         */
+        inline bool parse_iso_timestamp(const char* str, size_t length, time_t& result) noexcept {
+            if (length != 20 || str[4] != '-' || str[7] != '-' || str[10] != 'T' || str[13] != ':' || str[16] != ':' || str[19] != 'Z') {
+                return false;
+            }
+
+            static const int digit_positions[] = { 0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, 17, 18 };
+            for (int pos : digit_positions) {
+                if (str[pos] < '0' || str[pos] > '9') {
+                    return false;
+                }
+            }
+
+            auto number = [str](int pos, int len) {
+                int value = 0;
+                for (int i = 0; i < len; ++i) {
+                    value = value * 10 + (str[pos + i] - '0');
+                }
+                return value;
+            };
+
+            int year = number(0, 4);
+            const int month = number(5, 2);
+            const int day = number(8, 2);
+            const int hour = number(11, 2);
+            const int minute = number(14, 2);
+            const int second = number(17, 2);
+
+            if (year < 1970 || month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+                return false;
+            }
+
+            // days since 1970-01-01 in the proleptic Gregorian calendar
+            year -= month <= 2;
+            const int era = year / 400;
+            const int year_of_era = year - era * 400;
+            const int day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+            const int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+            const int64_t days = static_cast<int64_t>(era) * 146097 + day_of_era - 719468;
+
+            result = static_cast<time_t>(days * 86400 + hour * 3600 + minute * 60 + second);
+            return true;
+        }
+
+    } // namespace detail
+
 } // namespace osmium
 
 #endif // OSMIUM_OSM_TIMESTAMP_HPP
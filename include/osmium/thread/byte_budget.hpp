@@ -0,0 +1,250 @@
+#ifndef OSMIUM_THREAD_BYTE_BUDGET_HPP
+#define OSMIUM_THREAD_BYTE_BUDGET_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace osmium {
+
+    namespace thread {
+
+        /**
+         * Statistics about the use of a ByteBudget.
+         */
+        struct budget_stats {
+
+            /// Configured limit in bytes (0 means unlimited).
+            size_t limit = 0;
+
+            /// Number of bytes currently acquired.
+            size_t in_use = 0;
+
+            /// Largest number of bytes acquired at the same time.
+            size_t peak = 0;
+
+            /// Number of times a producer had to wait for the budget.
+            uint64_t stalls = 0;
+
+            /// Total time producers spent waiting for the budget.
+            std::chrono::nanoseconds stall_time {0};
+
+            /**
+             * Number of acquire()/release() calls that had to lock the
+             * mutex. This is always 0 for an unlimited budget.
+             */
+            uint64_t locks = 0;
+
+        }; // struct budget_stats
+
+        /**
+         * Limits the number of bytes "in flight" between producer and
+         * consumer threads. Producers acquire() the size of the data they
+         * are about to hand over, which blocks while the budget is
+         * exhausted. Consumers release() it once they are done with the
+         * data.
+         *
+         * To make sure data larger than the whole budget can't block
+         * forever, acquire() always succeeds if nothing else is acquired.
+         * After shutdown() acquire() never blocks, this is used to wake up
+         * producers when the consumer goes away.
+         *
+         * An unlimited budget only updates some atomic counters, it never
+         * locks a mutex. A limited budget only notifies producers if one
+         * of them is actually waiting.
+         */
+        class ByteBudget {
+
+            const size_t m_limit;
+
+            mutable std::mutex m_mutex;
+            std::condition_variable m_released;
+
+            std::atomic<size_t> m_in_use;
+            std::atomic<size_t> m_peak;
+            uint64_t m_stalls;
+            uint64_t m_locks;
+            std::chrono::nanoseconds m_stall_time;
+            int m_waiting;
+            bool m_shutdown;
+
+            void add(size_t bytes) noexcept {
+                const size_t in_use = m_in_use.fetch_add(bytes) + bytes;
+                size_t peak = m_peak.load();
+                while (in_use > peak && !m_peak.compare_exchange_weak(peak, in_use)) {
+                }
+            }
+
+            void sub(size_t bytes) noexcept {
+                size_t in_use = m_in_use.load();
+                while (!m_in_use.compare_exchange_weak(in_use, bytes < in_use ? in_use - bytes : 0)) {
+                }
+            }
+
+            bool available(size_t bytes) const noexcept {
+                const size_t in_use = m_in_use.load();
+                return m_shutdown || in_use == 0 || in_use + bytes <= m_limit;
+            }
+
+        public:
+
+            /**
+             * Create budget.
+             *
+             * @param limit Maximum number of bytes in flight. Set to 0 for
+             *              an unlimited budget which never blocks but
+             *              still keeps statistics.
+             */
+            explicit ByteBudget(size_t limit = 0) :
+                m_limit(limit),
+                m_mutex(),
+                m_released(),
+                m_in_use(0),
+                m_peak(0),
+                m_stalls(0),
+                m_locks(0),
+                m_stall_time(0),
+                m_waiting(0),
+                m_shutdown(false) {
+            }
+
+            ByteBudget(const ByteBudget&) = delete;
+            ByteBudget& operator=(const ByteBudget&) = delete;
+
+            ByteBudget(ByteBudget&&) = delete;
+            ByteBudget& operator=(ByteBudget&&) = delete;
+
+            ~ByteBudget() = default;
+
+            size_t limit() const noexcept {
+                return m_limit;
+            }
+
+            /**
+             * Acquire the given number of bytes from the budget. Blocks
+             * until they are available.
+             */
+            void acquire(size_t bytes) {
+                if (m_limit == 0) {
+                    add(bytes);
+                    return;
+                }
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                ++m_locks;
+                if (!available(bytes)) {
+                    const auto start = std::chrono::steady_clock::now();
+                    ++m_stalls;
+                    ++m_waiting;
+                    m_released.wait(lock, [this, bytes] {
+                        return available(bytes);
+                    });
+                    --m_waiting;
+                    m_stall_time += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                }
+                add(bytes);
+            }
+
+            /**
+             * Acquire the given number of bytes from the budget without
+             * blocking even if this takes the budget over the limit. Used
+             * when data turns out to be larger than was acquired for.
+             */
+            void force_acquire(size_t bytes) {
+                if (m_limit == 0) {
+                    add(bytes);
+                    return;
+                }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_locks;
+                add(bytes);
+            }
+
+            /**
+             * Give back the given number of bytes to the budget.
+             */
+            void release(size_t bytes) {
+                if (m_limit == 0) {
+                    sub(bytes);
+                    return;
+                }
+
+                bool waiting;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    ++m_locks;
+                    sub(bytes);
+                    waiting = m_waiting > 0;
+                }
+                if (waiting) {
+                    m_released.notify_all();
+                }
+            }
+
+            /**
+             * Stop limiting. All waiting and future acquire() calls return
+             * immediately.
+             */
+            void shutdown() {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_shutdown = true;
+                }
+                m_released.notify_all();
+            }
+
+            budget_stats stats() const {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                budget_stats result;
+                result.limit = m_limit;
+                result.in_use = m_in_use;
+                result.peak = m_peak;
+                result.stalls = m_stalls;
+                result.stall_time = m_stall_time;
+                result.locks = m_locks;
+                return result;
+            }
+
+        }; // class ByteBudget
+
+    } // namespace thread
+
+} // namespace osmium
+
+#endif // OSMIUM_THREAD_BYTE_BUDGET_HPP
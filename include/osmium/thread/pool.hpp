@@ -35,15 +35,20 @@ DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdlib>
+#include <deque>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <thread>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <osmium/thread/function_wrapper.hpp>
-#include <osmium/thread/queue.hpp>
 #include <osmium/thread/util.hpp>
 #include <osmium/util/config.hpp>
 
@@ -55,10 +60,34 @@ namespace osmium {
     namespace thread {
 
         /**
-         *  Thread pool.
+         * Priority of tasks submitted to the Pool. Workers always run the
+         * oldest task with the highest priority they can find.
+         */
+        enum class task_priority : int {
+            high   = 0,
+            normal = 1,
+            low    = 2
+        }; // enum class task_priority
+
+        /**
+         * Work-stealing thread pool.
+         *
+         * Every worker thread has its own task queues, one for each
+         * priority. Tasks submitted from outside the pool are spread over
+         * the workers round-robin, tasks submitted from a worker thread
+         * are added to the queues of that worker. An idle worker looks
+         * for a task in its own queues first, then it steals one from the
+         * other workers. If there is no work left, it sleeps until a new
+         * task is submitted.
+         *
+         * If too many tasks are waiting, submit() blocks when called from
+         * outside the pool. Submitting from a pool thread never blocks,
+         * because that could deadlock the pool.
          */
         class Pool {
 
+            static constexpr int num_priorities = 3;
+
             /**
              * This class makes sure all pool threads will be joined when
              * the pool is destructed.
@@ -83,23 +112,190 @@ namespace osmium {
 
             }; // class thread_joiner
 
+            /**
+             * The task queues of one worker thread.
+             */
+            struct worker_queues {
+
+                std::mutex mutex;
+                std::deque<function_wrapper> tasks[num_priorities];
+
+                bool pop(function_wrapper& task, int priority) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    auto& queue = tasks[priority];
+                    if (queue.empty()) {
+                        return false;
+                    }
+                    task = std::move(queue.front());
+                    queue.pop_front();
+                    return true;
+                }
+
+                size_t size() {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    size_t size = 0;
+                    for (const auto& queue : tasks) {
+                        size += queue.size();
+                    }
+                    return size;
+                }
+
+            }; // struct worker_queues
+
             std::atomic<bool> m_done;
-            osmium::thread::Queue<function_wrapper> m_work_queue;
+
+            /// Number of tasks waiting in all queues.
+            std::atomic<size_t> m_pending;
+
+            /// Number of workers waiting for new tasks.
+            std::atomic<int> m_sleeping;
+
+            std::mutex m_idle_mutex;
+            std::condition_variable m_work_available;
+            std::condition_variable m_space_available;
+
+            size_t m_max_queue_size;
+            std::atomic<size_t> m_next_queue;
+
+            /// CPUs the worker threads are restricted to (empty: all).
+            std::vector<int> m_cpus;
+
+            std::vector<std::unique_ptr<worker_queues>> m_queues;
             std::vector<std::thread> m_threads;
             thread_joiner m_joiner;
             int m_num_threads;
 
-            void worker_thread() {
+            /**
+             * The pool the current thread belongs to and its index there.
+             * Set once at the start of each worker thread.
+             */
+            struct worker_info {
+                const Pool* pool = nullptr;
+                int index = -1;
+            }; // struct worker_info
+
+            static worker_info& this_worker() noexcept {
+                static thread_local worker_info info;
+                return info;
+            }
+
+            /**
+             * Returns the index of the current thread in the pool or -1
+             * if it isn't a thread of this pool.
+             */
+            int worker_index() const noexcept {
+                const worker_info& info = this_worker();
+                return info.pool == this ? info.index : -1;
+            }
+
+            /**
+             * Find the next task for the worker with the given index.
+             * Higher priorities are checked first, for each priority
+             * the worker's own queue is checked before the others.
+             */
+            bool find_task(size_t index, function_wrapper& task) {
+                if (m_pending.load() == 0) {
+                    return false;
+                }
+                const size_t num_queues = m_queues.size();
+                for (int priority = 0; priority < num_priorities; ++priority) {
+                    for (size_t n = 0; n < num_queues; ++n) {
+                        if (m_queues[(index + n) % num_queues]->pop(task, priority)) {
+                            if (m_pending.fetch_sub(1) == m_max_queue_size) {
+                                std::lock_guard<std::mutex> lock(m_idle_mutex);
+                                m_space_available.notify_all();
+                            }
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+
+            void worker_thread(size_t index) {
+                this_worker().pool = this;
+                this_worker().index = static_cast<int>(index);
                 osmium::thread::set_thread_name("_osmium_worker");
-                while (!m_done) {
+                if (!m_cpus.empty()) {
+                    osmium::thread::set_thread_affinity(m_cpus);
+                }
+                while (true) {
                     function_wrapper task;
-                    m_work_queue.wait_and_pop_with_timeout(task);
-                    if (task) {
+                    if (find_task(index, task)) {
                         task();
+                        continue;
                     }
+
+                    if (m_done) {
+                        return;
+                    }
+
+                    std::unique_lock<std::mutex> lock(m_idle_mutex);
+                    ++m_sleeping;
+                    m_work_available.wait(lock, [this] {
+                        return m_pending.load() > 0 || m_done;
+                    });
+                    --m_sleeping;
                 }
             }
 
+            void push(function_wrapper&& task, task_priority priority) {
+                const int index = worker_index();
+
+                if (index < 0) {
+                    if (m_pending.load() >= m_max_queue_size) {
+                        std::unique_lock<std::mutex> lock(m_idle_mutex);
+                        m_space_available.wait(lock, [this] {
+                            return m_pending.load() < m_max_queue_size || m_done;
+                        });
+                    }
+
+                    // The workers might already be gone, nobody would run
+                    // the task. Tasks from the workers themselves are still
+                    // accepted, the workers empty the queues before ending.
+                    if (m_done) {
+                        throw std::runtime_error("thread pool is shutting down");
+                    }
+                }
+
+                auto& queues = *m_queues[index >= 0 ? static_cast<size_t>(index) : m_next_queue++ % m_queues.size()];
+
+                // m_pending is incremented before the task is visible to
+                // the workers, otherwise a worker could take the task and
+                // decrement m_pending below zero first.
+                ++m_pending;
+                try {
+                    std::lock_guard<std::mutex> lock(queues.mutex);
+                    queues.tasks[static_cast<int>(priority)].push_back(std::move(task));
+                } catch (...) {
+                    if (m_pending.fetch_sub(1) == m_max_queue_size) {
+                        std::lock_guard<std::mutex> lock(m_idle_mutex);
+                        m_space_available.notify_all();
+                    }
+                    throw;
+                }
+
+                // m_pending and m_sleeping are sequentially consistent, so
+                // either a worker about to sleep sees the new task or we
+                // see the sleeping worker here.
+                if (m_sleeping.load() > 0) {
+                    std::lock_guard<std::mutex> lock(m_idle_mutex);
+                    m_work_available.notify_one();
+                }
+            }
+
+            void shutdown() {
+                m_done = true;
+                std::lock_guard<std::mutex> lock(m_idle_mutex);
+                m_work_available.notify_all();
+                m_space_available.notify_all();
+            }
+
+        public:
+
+            static constexpr int default_num_threads = 0;
+            static constexpr size_t max_work_queue_size = 10;
+
             /**
              * Create thread pool with the given number of threads. If
              * num_threads is 0, the number of threads is read from
@@ -111,10 +307,30 @@ namespace osmium {
              * given number, ie it will leave a number of cores unused.
              *
              * In all cases the minimum number of threads in the pool is 1.
+             *
+             * Up to max_queue_size tasks per thread can be waiting in
+             * the pool before submit() blocks.
+             *
+             * If cpus is not empty, the worker threads will only run on
+             * those CPUs (only on Linux).
+             *
+             * Most programs just use the pool returned by instance().
+             * Additional pools can be used to keep independent jobs from
+             * competing for the same threads. They can be handed to the
+             * Reader and Writer and must outlive them. Tasks still waiting
+             * when a pool is destructed are run before the threads end.
              */
-            explicit Pool(int num_threads, size_t max_queue_size) :
+            explicit Pool(int num_threads = default_num_threads, size_t max_queue_size = max_work_queue_size, const std::vector<int>& cpus = std::vector<int>()) :
                 m_done(false),
-                m_work_queue(max_queue_size, "work"),
+                m_pending(0),
+                m_sleeping(0),
+                m_idle_mutex(),
+                m_work_available(),
+                m_space_available(),
+                m_max_queue_size(0),
+                m_next_queue(0),
+                m_cpus(cpus),
+                m_queues(),
                 m_threads(),
                 m_joiner(m_threads),
                 m_num_threads(num_threads) {
@@ -127,46 +343,78 @@ namespace osmium {
                     m_num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) + m_num_threads);
                 }
 
+                m_max_queue_size = std::max(size_t(1), max_queue_size) * static_cast<size_t>(m_num_threads);
+
+                for (int i = 0; i < m_num_threads; ++i) {
+                    m_queues.emplace_back(new worker_queues);
+                }
+
+                m_threads.reserve(static_cast<size_t>(m_num_threads));
                 try {
-                    for (int i=0; i < m_num_threads; ++i) {
-                        m_threads.push_back(std::thread(&Pool::worker_thread, this));
+                    for (int i = 0; i < m_num_threads; ++i) {
+                        m_threads.push_back(std::thread(&Pool::worker_thread, this, static_cast<size_t>(i)));
                     }
                 } catch (...) {
-                    m_done = true;
+                    shutdown();
                     throw;
                 }
             }
 
-        public:
+            Pool(const Pool&) = delete;
+            Pool& operator=(const Pool&) = delete;
 
-            static constexpr int default_num_threads = 0;
-            static constexpr size_t max_work_queue_size = 10;
+            Pool(Pool&&) = delete;
+            Pool& operator=(Pool&&) = delete;
 
+            /**
+             * The default pool used by the Reader, Writer and everything
+             * else if no pool is given explicitly.
+             */
             static Pool& instance() {
                 static Pool pool(default_num_threads, max_work_queue_size);
                 return pool;
             }
 
             ~Pool() {
-                m_done = true;
+                shutdown();
             }
 
+            int num_threads() const noexcept {
+                return m_num_threads;
+            }
+
+            /**
+             * Number of tasks waiting in the queues of all workers.
+             */
             size_t queue_size() const {
-                return m_work_queue.size();
+                size_t size = 0;
+                for (const auto& queues : m_queues) {
+                    size += queues->size();
+                }
+                return size;
             }
 
             bool queue_empty() const {
-                return m_work_queue.empty();
+                return queue_size() == 0;
             }
 
+            /**
+             * Submit a task to the pool. Returns a future for the result
+             * of the task. Tasks with a higher priority are run before
+             * tasks with a lower priority, otherwise tasks are started
+             * roughly in the order they were submitted.
+             *
+             * @throws std::runtime_error if the pool is being destructed
+             *         and this is not called from one of its threads.
+             */
             template <typename TFunction>
-            std::future<typename std::result_of<TFunction()>::type> submit(TFunction&& func) {
+            std::future<typename std::result_of<TFunction()>::type> submit(TFunction&& func, task_priority priority = task_priority::normal) {
 
                 typedef typename std::result_of<TFunction()>::type result_type;
 
                 std::packaged_task<result_type()> task(std::forward<TFunction>(func));
                 std::future<result_type> future_result(task.get_future());
-                m_work_queue.push(std::move(task));
+                push(std::move(task), priority);
 
                 return future_result;
             }
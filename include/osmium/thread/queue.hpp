@@ -37,22 +37,29 @@ DEALINGS IN THE SOFTWARE.
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <functional>
 #include <mutex>
 #include <queue>
 #include <string>
-#include <thread>
 #include <utility>
 
-#include <osmium/util/compatibility.hpp>
+#include <osmium/thread/byte_budget.hpp>
 
 namespace osmium {
 
     namespace thread {
 
-        OSMIUM_CONSTEXPR std::chrono::milliseconds full_queue_sleep_duration { 10 }; // XXX
-
         /**
-         *  A thread-safe queue.
+         * A thread-safe queue.
+         *
+         * If the queue has a maximum size, push() blocks while the queue
+         * is full and is woken up as soon as an element is popped.
+         *
+         * Calling shutdown() wakes up all waiting threads: push() never
+         * blocks after that and the pop functions return false instead of
+         * waiting once the queue is empty. This is used to cancel the
+         * threads on either end of the queue when the other end goes
+         * away.
          */
         template <typename T>
         class Queue {
@@ -71,6 +78,18 @@ namespace osmium {
             /// Used to signal readers when data is available in the queue.
             std::condition_variable m_data_available;
 
+            /// Used to signal writers when space is available in the queue.
+            std::condition_variable m_space_available;
+
+            /// Set by shutdown().
+            bool m_shutdown;
+
+            /// Optional budget for the number of bytes in the queue.
+            ByteBudget* m_budget;
+
+            /// Function returning the number of bytes in an element.
+            std::function<size_t(const T&)> m_weight;
+
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
             /// The largest size the queue has been so far.
             size_t m_largest_size;
@@ -80,6 +99,26 @@ namespace osmium {
             std::atomic<int> m_full_counter;
 #endif
 
+            void release(const T& value) {
+                if (m_budget) {
+                    m_budget->release(m_weight(value));
+                }
+            }
+
+            // this method expects that we already have the lock
+            bool has_space() const noexcept {
+                return m_max_size == 0 || m_shutdown || m_queue.size() < m_max_size;
+            }
+
+            // this method expects that we already have the lock
+            void pop_intern(T& value) {
+                value = std::move(m_queue.front());
+                m_queue.pop();
+                if (m_max_size) {
+                    m_space_available.notify_one();
+                }
+            }
+
         public:
 
             /**
@@ -94,7 +133,11 @@ namespace osmium {
                 m_name(name),
                 m_mutex(),
                 m_queue(),
-                m_data_available()
+                m_data_available(),
+                m_space_available(),
+                m_shutdown(false),
+                m_budget(nullptr),
+                m_weight()
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
                 ,
                 m_largest_size(0),
@@ -103,6 +146,24 @@ namespace osmium {
             {
             }
 
+            /**
+             * Construct a multithreaded queue limited by the number of
+             * bytes in it in addition to the number of elements.
+             *
+             * @param max_size Maximum number of elements in the queue. Set to
+             *                 0 for an unlimited size.
+             * @param name Name for this queue. (Used for debugging.)
+             * @param budget The size of all elements is acquired from this
+             *               budget when they are pushed and released when
+             *               they are popped.
+             * @param weight Function returning the size of an element.
+             */
+            Queue(size_t max_size, const std::string& name, ByteBudget& budget, std::function<size_t(const T&)> weight) :
+                Queue(max_size, name) {
+                m_budget = &budget;
+                m_weight = std::move(weight);
+            }
+
             ~Queue() {
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
                 std::cerr << "queue '" << m_name << "' with max_size=" << m_max_size << " had largest size " << m_largest_size << " and was full " << m_full_counter << " times\n";
@@ -111,57 +172,102 @@ namespace osmium {
 
             /**
              * Push an element onto the queue. If the queue has a max size, this
-             * call will block if the queue is full.
+             * call will block if the queue is full. If the queue has a
+             * budget, it will block until the budget allows the element.
              */
             void push(T value) {
-                if (m_max_size) {
-                    while (size() >= m_max_size) {
-                        std::this_thread::sleep_for(full_queue_sleep_duration);
+                if (m_budget) {
+                    m_budget->acquire(m_weight(value));
+                }
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    if (!has_space()) {
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
                         ++m_full_counter;
 #endif
+                        m_space_available.wait(lock, [this] {
+                            return has_space();
+                        });
                     }
-                }
-                std::lock_guard<std::mutex> lock(m_mutex);
-                m_queue.push(std::move(value));
+                    m_queue.push(std::move(value));
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
-                if (m_largest_size < m_queue.size()) {
-                    m_largest_size = m_queue.size();
-                }
+                    if (m_largest_size < m_queue.size()) {
+                        m_largest_size = m_queue.size();
+                    }
 #endif
+                }
                 m_data_available.notify_one();
             }
 
-            void wait_and_pop(T& value) {
-                std::unique_lock<std::mutex> lock(m_mutex);
-                m_data_available.wait(lock, [this] {
-                    return !m_queue.empty();
-                });
-                value=std::move(m_queue.front());
-                m_queue.pop();
+            /**
+             * Wait until an element is available and pop it.
+             *
+             * @returns true if an element was popped, false if the queue
+             *          was shut down and is empty.
+             */
+            bool wait_and_pop(T& value) {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_data_available.wait(lock, [this] {
+                        return !m_queue.empty() || m_shutdown;
+                    });
+                    if (m_queue.empty()) {
+                        return false;
+                    }
+                    pop_intern(value);
+                }
+                release(value);
+                return true;
             }
 
-            void wait_and_pop_with_timeout(T& value) {
-                std::unique_lock<std::mutex> lock(m_mutex);
-                if (!m_data_available.wait_for(lock, std::chrono::seconds(1), [this] {
-                    return !m_queue.empty();
-                })) {
-                    return;
+            /**
+             * Wait at most one second until an element is available and
+             * pop it.
+             *
+             * @returns true if an element was popped, false on timeout or
+             *          if the queue was shut down and is empty.
+             */
+            bool wait_and_pop_with_timeout(T& value) {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    if (!m_data_available.wait_for(lock, std::chrono::seconds(1), [this] {
+                        return !m_queue.empty() || m_shutdown;
+                    }) || m_queue.empty()) {
+                        return false;
+                    }
+                    pop_intern(value);
                 }
-                value=std::move(m_queue.front());
-                m_queue.pop();
+                release(value);
+                return true;
             }
 
             bool try_pop(T& value) {
-                std::lock_guard<std::mutex> lock(m_mutex);
-                if (m_queue.empty()) {
-                    return false;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (m_queue.empty()) {
+                        return false;
+                    }
+                    pop_intern(value);
                 }
-                value=std::move(m_queue.front());
-                m_queue.pop();
+                release(value);
                 return true;
             }
 
+            /**
+             * Shut down the queue. All threads waiting in push() or one
+             * of the pop functions are woken up. After this push() never
+             * blocks and the pop functions don't wait for new elements.
+             * Elements already in the queue can still be popped.
+             */
+            void shutdown() {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_shutdown = true;
+                }
+                m_data_available.notify_all();
+                m_space_available.notify_all();
+            }
+
             bool empty() const {
                 std::lock_guard<std::mutex> lock(m_mutex);
                 return m_queue.empty();
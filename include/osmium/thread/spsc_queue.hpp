@@ -0,0 +1,306 @@
+#ifndef OSMIUM_THREAD_SPSC_QUEUE_HPP
+#define OSMIUM_THREAD_SPSC_QUEUE_HPP
+
+/*
+
+This file is part of Osmium (http://osmcode.org/libosmium).
+
+Copyright 2013-2015 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <osmium/thread/byte_budget.hpp>
+
+namespace osmium {
+
+    namespace thread {
+
+        /**
+         * A bounded queue for exactly one producer thread and one
+         * consumer thread.
+         *
+         * Elements are stored in a ring buffer. As long as the queue is
+         * neither full nor empty, push() and the pop functions don't take
+         * any locks, they only use atomic head and tail counters. The
+         * counters live on different cache lines, so producer and
+         * consumer don't disturb each other.
+         *
+         * If the queue is full (or empty) the producer (or consumer)
+         * spins for a short while and then goes to sleep on a condition
+         * variable. The other side only takes the mutex to wake it up if
+         * it is actually sleeping.
+         *
+         * The interface is the same as that of osmium::thread::Queue,
+         * including the optional byte budget and shutdown(). After
+         * shutdown() push() never blocks. Elements that don't fit into
+         * the queue any more are dropped then, because nobody is going
+         * to read them anyway.
+         *
+         * Only one thread may call push() and only one thread may call
+         * the pop functions at any time. Other threads may call size(),
+         * empty(), and shutdown().
+         */
+        template <typename T>
+        class SPSCQueue {
+
+            static constexpr size_t cache_line_size = 64;
+
+            /// Number of times to try again before going to sleep.
+            static constexpr int spin_count = 64;
+
+            const size_t m_capacity;
+
+            /// Name of this queue (for debugging only).
+            const std::string m_name;
+
+            std::unique_ptr<T[]> m_slots;
+
+            /// Optional budget for the number of bytes in the queue.
+            ByteBudget* m_budget;
+
+            /// Function returning the number of bytes in an element.
+            std::function<size_t(const T&)> m_weight;
+
+            std::mutex m_mutex;
+            std::condition_variable m_wakeup;
+            std::atomic<bool> m_producer_waiting;
+            std::atomic<bool> m_consumer_waiting;
+            std::atomic<bool> m_shutdown;
+
+            char m_padding1[cache_line_size];
+
+            /// Number of elements popped so far. Written by the consumer.
+            std::atomic<size_t> m_head;
+
+            char m_padding2[cache_line_size - sizeof(std::atomic<size_t>)];
+
+            /// Number of elements pushed so far. Written by the producer.
+            std::atomic<size_t> m_tail;
+
+            char m_padding3[cache_line_size - sizeof(std::atomic<size_t>)];
+
+            bool has_space(size_t tail) const noexcept {
+                return tail - m_head.load(std::memory_order_acquire) < m_capacity;
+            }
+
+            bool has_data(size_t head) const noexcept {
+                return m_tail.load(std::memory_order_acquire) != head;
+            }
+
+            /**
+             * Wait until the condition is true or the queue is shut down.
+             *
+             * @returns The last value of the condition.
+             */
+            template <typename TCondition>
+            bool wait_for(std::atomic<bool>& waiting, TCondition condition) {
+                for (int i = 0; i < spin_count; ++i) {
+                    if (condition() || m_shutdown.load()) {
+                        return condition();
+                    }
+                    std::this_thread::yield();
+                }
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                waiting.store(true);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                m_wakeup.wait(lock, [&] {
+                    return condition() || m_shutdown.load();
+                });
+                waiting.store(false);
+                return condition();
+            }
+
+            /**
+             * Wake up the other side if it is waiting. The fence makes
+             * sure the other side either sees our change to the counters
+             * or we see its waiting flag.
+             */
+            void wake_up(const std::atomic<bool>& waiting) {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (waiting.load()) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_wakeup.notify_all();
+                }
+            }
+
+            void release(const T& value) {
+                if (m_budget) {
+                    m_budget->release(m_weight(value));
+                }
+            }
+
+        public:
+
+            /**
+             * Construct a single-producer single-consumer queue.
+             *
+             * @param capacity Maximum number of elements in the queue.
+             * @param name Optional name for this queue. (Used for debugging.)
+             * @throws std::invalid_argument If capacity is 0.
+             */
+            explicit SPSCQueue(size_t capacity = 20, const std::string& name = "") :
+                m_capacity(capacity),
+                m_name(name),
+                m_slots(new T[capacity]),
+                m_budget(nullptr),
+                m_weight(),
+                m_mutex(),
+                m_wakeup(),
+                m_producer_waiting(false),
+                m_consumer_waiting(false),
+                m_shutdown(false),
+                m_head(0),
+                m_tail(0) {
+                if (capacity == 0) {
+                    throw std::invalid_argument("SPSCQueue needs a capacity > 0");
+                }
+            }
+
+            /**
+             * Construct a single-producer single-consumer queue limited
+             * by the number of bytes in it in addition to the number of
+             * elements.
+             *
+             * @param capacity Maximum number of elements in the queue.
+             * @param name Name for this queue. (Used for debugging.)
+             * @param budget The size of all elements is acquired from this
+             *               budget when they are pushed and released when
+             *               they are popped.
+             * @param weight Function returning the size of an element.
+             * @throws std::invalid_argument If capacity is 0.
+             */
+            SPSCQueue(size_t capacity, const std::string& name, ByteBudget& budget, std::function<size_t(const T&)> weight) :
+                SPSCQueue(capacity, name) {
+                m_budget = &budget;
+                m_weight = std::move(weight);
+            }
+
+            SPSCQueue(const SPSCQueue&) = delete;
+            SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+            SPSCQueue(SPSCQueue&&) = delete;
+            SPSCQueue& operator=(SPSCQueue&&) = delete;
+
+            ~SPSCQueue() = default;
+
+            /**
+             * Push an element onto the queue. Blocks while the queue is
+             * full. If the queue has a budget, it will block until the
+             * budget allows the element.
+             */
+            void push(T value) {
+                if (m_budget) {
+                    m_budget->acquire(m_weight(value));
+                }
+
+                const size_t tail = m_tail.load(std::memory_order_relaxed);
+                if (!has_space(tail) && !wait_for(m_producer_waiting, [this, tail] { return has_space(tail); })) {
+                    release(value); // queue was shut down
+                    return;
+                }
+
+                m_slots[tail % m_capacity] = std::move(value);
+                m_tail.store(tail + 1, std::memory_order_release);
+                wake_up(m_consumer_waiting);
+            }
+
+            /**
+             * Wait until an element is available and pop it.
+             *
+             * @returns true if an element was popped, false if the queue
+             *          was shut down and is empty.
+             */
+            bool wait_and_pop(T& value) {
+                const size_t head = m_head.load(std::memory_order_relaxed);
+                if (!has_data(head) && !wait_for(m_consumer_waiting, [this, head] { return has_data(head); })) {
+                    return false;
+                }
+
+                value = std::move(m_slots[head % m_capacity]);
+                m_head.store(head + 1, std::memory_order_release);
+                wake_up(m_producer_waiting);
+                release(value);
+                return true;
+            }
+
+            bool try_pop(T& value) {
+                const size_t head = m_head.load(std::memory_order_relaxed);
+                if (!has_data(head)) {
+                    return false;
+                }
+
+                value = std::move(m_slots[head % m_capacity]);
+                m_head.store(head + 1, std::memory_order_release);
+                wake_up(m_producer_waiting);
+                release(value);
+                return true;
+            }
+
+            /**
+             * Shut down the queue. Threads waiting in push() or
+             * wait_and_pop() are woken up. After this push() never
+             * blocks and wait_and_pop() doesn't wait for new elements.
+             * Elements already in the queue can still be popped.
+             */
+            void shutdown() {
+                m_shutdown.store(true);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_wakeup.notify_all();
+            }
+
+            size_t capacity() const noexcept {
+                return m_capacity;
+            }
+
+            bool empty() const noexcept {
+                return size() == 0;
+            }
+
+            size_t size() const noexcept {
+                const size_t head = m_head.load(std::memory_order_acquire);
+                return m_tail.load(std::memory_order_acquire) - head;
+            }
+
+        }; // class SPSCQueue
+
+    } // namespace thread
+
+} // namespace osmium
+
+#endif // OSMIUM_THREAD_SPSC_QUEUE_HPP
@@ -35,8 +35,11 @@ DEALINGS IN THE SOFTWARE.
 
 #include <chrono>
 #include <future>
+#include <vector>
 
 #ifdef __linux__
+# include <pthread.h>
+# include <sched.h>
 # include <sys/prctl.h>
 #endif
 
@@ -80,6 +83,32 @@ namespace osmium {
         }
 #endif
 
+        /**
+         * Restrict the current thread to run only on the given CPUs. This
+         * only works on Linux, on other systems it does nothing.
+         *
+         * @returns true if the affinity was set.
+         */
+#ifdef __linux__
+        inline bool set_thread_affinity(const std::vector<int>& cpus) {
+            if (cpus.empty()) {
+                return false;
+            }
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            for (int cpu : cpus) {
+                if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                    CPU_SET(cpu, &cpu_set);
+                }
+            }
+            return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) == 0;
+        }
+#else
+        inline bool set_thread_affinity(const std::vector<int>&) {
+            return false;
+        }
+#endif
+
     } // namespace thread
 
 } // namespace osmium
@@ -68,14 +68,14 @@ std::string read_gz_file(const char* test_id, const char* suffix) {
 
 
 header_buffer_type parse_xml(std::string input) {
-    osmium::thread::Queue<std::string> input_queue;
+    osmium::io::detail::input_queue_type input_queue;
     osmium::thread::Queue<osmium::memory::Buffer> output_queue;
     std::promise<osmium::io::Header> header_promise;
     std::atomic<bool> done {false};
     input_queue.push(input);
     input_queue.push(std::string()); // EOF marker
 
-    osmium::io::detail::XMLParser parser(input_queue, output_queue, header_promise, osmium::osm_entity_bits::all, done);
+    osmium::io::detail::XMLParser parser(input_queue, output_queue, header_promise, osmium::io::detail::reader_options{}, std::make_shared<osmium::memory::BufferPool>(), done);
     parser();
 
     header_buffer_type result;
@@ -0,0 +1,60 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <osmium/handler.hpp>
+#include <osmium/osm.hpp>
+
+/**
+ * Handler describing each object read with one string containing all its
+ * attributes. Used to compare the results of different parsers.
+ */
+struct DescribeHandler : public osmium::handler::Handler {
+
+    std::vector<std::string> objects;
+
+    void osm_object(const osmium::OSMObject& object) {
+        std::ostringstream out;
+        out << osmium::item_type_to_char(object.type()) << object.id()
+            << " v" << object.version()
+            << (object.visible() ? " V" : " D")
+            << " c" << object.changeset()
+            << " t" << object.timestamp()
+            << " i" << object.uid()
+            << " u" << object.user();
+        for (const auto& tag : object.tags()) {
+            out << " " << tag.key() << "=" << tag.value();
+        }
+        objects.push_back(out.str());
+    }
+
+    void node(const osmium::Node& node) {
+        std::ostringstream out;
+        out << " x" << node.location().x() << " y" << node.location().y();
+        objects.back() += out.str();
+    }
+
+    void way(const osmium::Way& way) {
+        for (const auto& node_ref : way.nodes()) {
+            objects.back() += " n" + std::to_string(node_ref.ref());
+        }
+    }
+
+    void relation(const osmium::Relation& relation) {
+        for (const auto& member : relation.members()) {
+            objects.back() += std::string(" ") + osmium::item_type_to_char(member.type()) + std::to_string(member.ref()) + "@" + member.role();
+        }
+    }
+
+    void changeset(const osmium::Changeset& changeset) {
+        std::ostringstream out;
+        out << "c" << changeset.id() << " n" << changeset.num_changes()
+            << " " << changeset.created_at() << " " << changeset.closed_at()
+            << " " << changeset.bounds() << " i" << changeset.uid() << " u" << changeset.user();
+        for (const auto& tag : changeset.tags()) {
+            out << " " << tag.key() << "=" << tag.value();
+        }
+        objects.push_back(out.str());
+    }
+
+}; // struct DescribeHandler
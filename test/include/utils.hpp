@@ -16,3 +16,18 @@ inline std::string with_data_dir(const char* filename) {
     return result;
 }
 
+
+/**
+ * Create OPL data with num_nodes tagged nodes followed by num_ways ways.
+ * Ids start at 1.
+ */
+inline std::string make_opl(int num_nodes, int num_ways = 0) {
+    std::string data;
+    for (int i = 1; i <= num_nodes; ++i) {
+        data += "n" + std::to_string(i) + " v1 dV c1 t2015-01-01T00:00:00Z i1 uuser Tamenity=bench x1.5 y2.5\n";
+    }
+    for (int i = 1; i <= num_ways; ++i) {
+        data += "w" + std::to_string(i) + " v1 dV c1 t2015-01-01T00:00:00Z i1 uuser Thighway=primary Nn1,n2,n3\n";
+    }
+    return data;
+}
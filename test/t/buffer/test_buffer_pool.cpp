@@ -0,0 +1,66 @@
+#include "catch.hpp"
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/buffer_pool.hpp>
+#include <osmium/osm/node.hpp>
+
+TEST_CASE("Buffer pool") {
+
+    constexpr size_t buffer_size = 10000;
+
+    osmium::memory::BufferPool pool(2);
+
+    SECTION("creates new buffer if pool is empty") {
+        osmium::memory::Buffer buffer = pool.get_buffer(buffer_size);
+        REQUIRE(buffer);
+        REQUIRE(buffer.capacity() == buffer_size);
+        REQUIRE(buffer.committed() == 0);
+    }
+
+    SECTION("reuses memory of returned buffer") {
+        osmium::memory::Buffer buffer(buffer_size, osmium::memory::Buffer::auto_grow::no);
+        {
+            osmium::builder::NodeBuilder node_builder(buffer);
+            node_builder.add_user("testuser");
+        }
+        buffer.commit();
+        const unsigned char* data = buffer.data();
+
+        pool.return_buffer(std::move(buffer));
+        REQUIRE(pool.size() == 1);
+
+        osmium::memory::Buffer reused = pool.get_buffer(buffer_size);
+        REQUIRE(pool.size() == 0);
+        REQUIRE(reused.data() == data);
+        REQUIRE(reused.committed() == 0);
+        REQUIRE(reused.written() == 0);
+
+        // reused buffer grows automatically
+        reused.reserve_space(buffer_size * 2);
+        REQUIRE(reused.capacity() >= buffer_size * 2);
+    }
+
+    SECTION("grows returned buffer if it is too small") {
+        pool.return_buffer(osmium::memory::Buffer(buffer_size));
+        osmium::memory::Buffer reused = pool.get_buffer(buffer_size * 2);
+        REQUIRE(reused.capacity() == buffer_size * 2);
+    }
+
+    SECTION("ignores invalid and externally managed buffers") {
+        pool.return_buffer(osmium::memory::Buffer());
+
+        unsigned char data[buffer_size];
+        pool.return_buffer(osmium::memory::Buffer(data, buffer_size, 0));
+
+        REQUIRE(pool.size() == 0);
+    }
+
+    SECTION("keeps only up to the maximum number of buffers") {
+        pool.return_buffer(osmium::memory::Buffer(buffer_size));
+        pool.return_buffer(osmium::memory::Buffer(buffer_size));
+        pool.return_buffer(osmium::memory::Buffer(buffer_size));
+        REQUIRE(pool.size() == 2);
+    }
+
+}
+
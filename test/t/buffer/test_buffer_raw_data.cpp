@@ -0,0 +1,48 @@
+#include "catch.hpp"
+
+#include <memory>
+#include <string>
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/buffer.hpp>
+
+static void add_node(osmium::memory::Buffer& buffer, osmium::object_id_type id) {
+    osmium::builder::NodeBuilder builder(buffer);
+    builder.object().set_id(id);
+    builder.add_user("foo");
+    buffer.commit();
+}
+
+TEST_CASE("Raw data attached to buffer") {
+    osmium::memory::Buffer buffer(1024);
+    add_node(buffer, 1);
+
+    REQUIRE(buffer.raw_data() == nullptr);
+
+    buffer.set_raw_data(std::make_shared<std::string>("raw"));
+    REQUIRE(buffer.raw_data() != nullptr);
+    REQUIRE(*buffer.raw_data() == "raw");
+
+    SECTION("raw data moves with the buffer") {
+        osmium::memory::Buffer other = std::move(buffer);
+        REQUIRE(other.raw_data() != nullptr);
+        REQUIRE(*other.raw_data() == "raw");
+    }
+
+    SECTION("raw data is invalid after commit") {
+        add_node(buffer, 2);
+        REQUIRE(buffer.raw_data() == nullptr);
+    }
+
+    SECTION("raw data is dropped on clear") {
+        buffer.clear();
+        add_node(buffer, 1);
+        REQUIRE(buffer.raw_data() == nullptr);
+    }
+
+    SECTION("raw data can be dropped explicitly") {
+        buffer.clear_raw_data();
+        REQUIRE(buffer.raw_data() == nullptr);
+    }
+
+}
@@ -0,0 +1,113 @@
+#include "catch.hpp"
+#include "utils.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <osmium/apply_parallel.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/io/opl_input.hpp>
+
+struct AtomicCountHandler : public osmium::handler::Handler {
+
+    std::atomic<int> count {0};
+    std::atomic<int64_t> id_sum {0};
+    int flushed = 0;
+
+    void node(const osmium::Node& node) {
+        ++count;
+        id_sum += node.id();
+    }
+
+    void flush() {
+        ++flushed;
+    }
+
+}; // class AtomicCountHandler
+
+struct ThrowHandler : public osmium::handler::Handler {
+
+    void node(const osmium::Node& node) {
+        if (node.id() == 12345) {
+            throw std::runtime_error("test");
+        }
+    }
+
+}; // class ThrowHandler
+
+struct ThreadIdHandler : public osmium::handler::Handler {
+
+    std::mutex mutex;
+    std::set<std::thread::id> ids;
+
+    void node(const osmium::Node&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ids.insert(std::this_thread::get_id());
+    }
+
+}; // class ThreadIdHandler
+
+TEST_CASE("apply_parallel") {
+
+    const int num_nodes = 200000;
+    const std::string data = make_opl(num_nodes);
+    osmium::io::File file(data.data(), data.size(), "opl");
+
+    SECTION("calls handlers for all objects") {
+        osmium::io::Reader reader(file);
+        AtomicCountHandler handler;
+
+        osmium::apply_parallel(reader, handler);
+
+        REQUIRE(handler.count == num_nodes);
+        REQUIRE(handler.id_sum == int64_t(num_nodes) * (num_nodes + 1) / 2);
+        REQUIRE(handler.flushed == 1);
+    }
+
+    SECTION("calls ordered callback in input order") {
+        osmium::io::Reader reader(file);
+        AtomicCountHandler handler;
+
+        std::vector<osmium::object_id_type> ids;
+        int buffers = 0;
+        osmium::apply_parallel_ordered(reader, [&](const osmium::memory::Buffer& buffer) {
+            ++buffers;
+            for (auto it = buffer.cbegin<osmium::Node>(); it != buffer.cend<osmium::Node>(); ++it) {
+                ids.push_back(it->id());
+            }
+        }, handler);
+
+        REQUIRE(buffers > 1);
+        REQUIRE(handler.count == num_nodes);
+        REQUIRE(ids.size() == size_t(num_nodes));
+        bool in_order = true;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            in_order = in_order && ids[i] == osmium::object_id_type(i + 1);
+        }
+        REQUIRE(in_order);
+    }
+
+    SECTION("uses the given pool") {
+        osmium::io::Reader reader(file);
+        osmium::thread::Pool pool(1);
+        ThreadIdHandler handler;
+
+        osmium::apply_parallel(reader, pool, handler);
+
+        REQUIRE(handler.ids.size() == 1);
+        REQUIRE(handler.ids.count(std::this_thread::get_id()) == 0);
+    }
+
+    SECTION("forwards exceptions from handlers") {
+        osmium::io::Reader reader(file);
+        ThrowHandler handler;
+
+        REQUIRE_THROWS_AS(osmium::apply_parallel(reader, handler), std::runtime_error);
+    }
+
+}
@@ -5,6 +5,10 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#include <fstream>
+#include <iterator>
+#include <string>
+
 #include <osmium/io/bzip2_compression.hpp>
 
 TEST_CASE("Bzip2") {
@@ -29,5 +33,73 @@ SECTION("read_compressed_file") {
     REQUIRE("TESTDATA\n" == all);
 }
 
+SECTION("read_compressed_file_in_parallel") {
+    std::string input_file = with_data_dir("t/io/data_bzip2.txt.bz2");
+
+    int fd = ::open(input_file.c_str(), O_RDONLY);
+    REQUIRE(fd > 0);
+
+    std::string all;
+    {
+        osmium::io::Bzip2ParallelDecompressor decomp(fd);
+        for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+            all += data;
+        }
+    }
+
+    REQUIRE("TESTDATA\n" == all);
+}
+
+SECTION("read_multi_stream_file_in_parallel") {
+    std::string input_file = with_data_dir("t/io/data_bzip2_multi.txt.bz2");
+
+    int fd = ::open(input_file.c_str(), O_RDONLY);
+    REQUIRE(fd > 0);
+
+    std::string all;
+    int count = 0;
+    {
+        osmium::io::Bzip2ParallelDecompressor decomp(fd);
+        for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+            all += data;
+            ++count;
+        }
+    }
+
+    REQUIRE(count == 3); // the empty stream is skipped
+    REQUIRE(61784 == all.size());
+    REQUIRE(all.substr(0, 25) == "Line 0 of the first part\n");
+    REQUIRE(all.substr(all.size() - 22) == "Another line 1999\nEND\n");
+}
+
+SECTION("read_multi_stream_buffer_in_parallel") {
+    std::ifstream input_file(with_data_dir("t/io/data_bzip2_multi.txt.bz2"), std::ios::binary);
+    const std::string input((std::istreambuf_iterator<char>(input_file)), std::istreambuf_iterator<char>());
+
+    std::string all;
+    {
+        osmium::io::Bzip2ParallelDecompressor decomp(input.data(), input.size());
+        for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+            all += data;
+        }
+    }
+
+    REQUIRE(61784 == all.size());
+
+    SECTION("truncated_buffer") {
+        osmium::io::Bzip2ParallelDecompressor decomp(input.data(), input.size() - 10);
+        REQUIRE_THROWS_AS({
+            for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+            }
+        }, osmium::bzip2_error);
+    }
+}
+
+SECTION("find_stream_start") {
+    const std::string data("xxBZh9\x31\x41\x59\x26\x53\x59yyBZh9\x31\x41\x59\x26\x53", 25);
+    REQUIRE(osmium::io::detail::bzip2_find_stream_start(data, 0) == 2);
+    REQUIRE(osmium::io::detail::bzip2_find_stream_start(data, 3) == std::string::npos);
+}
+
 }
 
@@ -71,6 +71,14 @@ SECTION("detect_file_format_by_suffix_opl") {
     f.check();
 }
 
+SECTION("detect_file_format_by_suffix_osmbuf") {
+    osmium::io::File f {"test.osmbuf"};
+    REQUIRE(osmium::io::file_format::osmbuf == f.format());
+    REQUIRE(osmium::io::file_compression::none == f.compression());
+    REQUIRE(false == f.has_multiple_object_versions());
+    f.check();
+}
+
 SECTION("detect_file_format_by_suffix_osm_opl") {
     osmium::io::File f {"test.osm.opl"};
     REQUIRE(osmium::io::file_format::opl == f.format());
@@ -0,0 +1,99 @@
+#include "catch.hpp"
+#include "describe_handler.hpp"
+
+#include <string>
+#include <vector>
+
+#include <osmium/io/merge_reader.hpp>
+#include <osmium/io/opl_input.hpp>
+#include <osmium/visitor.hpp>
+
+static osmium::io::File opl_file(const std::string& data) {
+    return osmium::io::File(data.data(), data.size(), "opl");
+}
+
+static std::vector<std::string> describe(const osmium::io::File& file) {
+    osmium::io::Reader reader(file);
+    DescribeHandler handler;
+    osmium::apply(reader, handler);
+    reader.close();
+    return handler.objects;
+}
+
+TEST_CASE("MergeReader") {
+
+    const std::string data1 =
+        "n1 v1 x1 y1 Tsource=a\n"
+        "n2 v1 x1 y1 Tsource=a\n"
+        "n3 v1 x1 y1 Tsource=a\n"
+        "w1 v1 Nn1,n2 Tsource=a\n";
+
+    const std::string data2 =
+        "n2 v1 x1 y1 Tsource=b\n"
+        "n2 v2 x1 y1 Tsource=b\n"
+        "n4 v1 x1 y1 Tsource=b\n"
+        "r1 v1 Mn1@ Tsource=b\n";
+
+    SECTION("merges sorted inputs and removes duplicates") {
+        osmium::io::MergeReader reader({opl_file(data1), opl_file(data2)});
+        DescribeHandler handler;
+        osmium::apply(reader, handler);
+
+        const std::string merged =
+            "n1 v1 x1 y1 Tsource=a\n"
+            "n2 v1 x1 y1 Tsource=a\n"
+            "n2 v2 x1 y1 Tsource=b\n"
+            "n3 v1 x1 y1 Tsource=a\n"
+            "n4 v1 x1 y1 Tsource=b\n"
+            "w1 v1 Nn1,n2 Tsource=a\n"
+            "r1 v1 Mn1@ Tsource=b\n";
+        const auto expected = describe(opl_file(merged));
+        REQUIRE(expected.size() == 7);
+        REQUIRE(handler.objects == expected);
+        REQUIRE(reader.eof());
+    }
+
+    SECTION("passes options on to the readers") {
+        osmium::io::MergeReader reader({opl_file(data1), opl_file(data2)}, osmium::osm_entity_bits::way | osmium::osm_entity_bits::relation);
+        DescribeHandler handler;
+        osmium::apply(reader, handler);
+
+        const std::string merged = "w1 v1 Nn1,n2 Tsource=a\nr1 v1 Mn1@ Tsource=b\n";
+        const auto expected = describe(opl_file(merged));
+        REQUIRE(handler.objects == expected);
+    }
+
+    SECTION("detects unsorted input") {
+        const std::string unsorted = "n2 v1 x1 y1\nn1 v1 x1 y1\n";
+        osmium::io::MergeReader reader({opl_file(data1), opl_file(unsorted)});
+        DescribeHandler handler;
+        REQUIRE_THROWS_AS(osmium::apply(reader, handler), osmium::io_error);
+    }
+
+    SECTION("merges large inputs spread over many buffers") {
+        std::string even;
+        std::string odd;
+        for (int i = 1; i <= 100000; ++i) {
+            (i % 2 ? odd : even) += "n" + std::to_string(i) + " v1 dV c1 t2015-01-01T00:00:00Z i1 uuser Tamenity=bench x1.5 y2.5\n";
+        }
+
+        osmium::io::MergeReader reader({opl_file(even), opl_file(odd)});
+
+        int buffers = 0;
+        osmium::object_id_type next_id = 1;
+        bool in_order = true;
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            ++buffers;
+            for (auto it = buffer.cbegin<osmium::Node>(); it != buffer.cend<osmium::Node>(); ++it) {
+                in_order = in_order && it->id() == next_id;
+                ++next_id;
+            }
+            reader.recycle(std::move(buffer));
+        }
+
+        REQUIRE(buffers > 1);
+        REQUIRE(in_order);
+        REQUIRE(next_id == 100001);
+    }
+
+}
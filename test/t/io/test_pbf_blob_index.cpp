@@ -0,0 +1,179 @@
+#include "catch.hpp"
+#include "utils.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <osmium/handler.hpp>
+#include <osmium/io/pbf_blob_index.hpp>
+#include <osmium/io/pbf_input.hpp>
+#include <osmium/visitor.hpp>
+
+struct CountHandler : public osmium::handler::Handler {
+
+    int nodes = 0;
+    int ways = 0;
+    int relations = 0;
+
+    void node(const osmium::Node&) {
+        ++nodes;
+    }
+
+    void way(const osmium::Way&) {
+        ++ways;
+    }
+
+    void relation(const osmium::Relation&) {
+        ++relations;
+    }
+
+}; // class CountHandler
+
+TEST_CASE("PBF blob index") {
+
+    // this file has one blob with nodes 1, 2, 5 and one blob with
+    // ways 10, 11 and relation 100
+    const std::string filename = with_data_dir("t/io/data-nwr.osm.pbf");
+
+    SECTION("build index") {
+        const osmium::io::PBFBlobIndex index = osmium::io::PBFBlobIndex::build(filename);
+
+        REQUIRE(index.size() == 2);
+
+        REQUIRE(index[0].types == osmium::osm_entity_bits::node);
+        REQUIRE(index[0].first_type == osmium::item_type::node);
+        REQUIRE(index[0].first_id == 1);
+        REQUIRE(index[0].last_type == osmium::item_type::node);
+        REQUIRE(index[0].last_id == 5);
+
+        REQUIRE(index[1].types == (osmium::osm_entity_bits::way | osmium::osm_entity_bits::relation));
+        REQUIRE(index[1].first_type == osmium::item_type::way);
+        REQUIRE(index[1].first_id == 10);
+        REQUIRE(index[1].last_type == osmium::item_type::relation);
+        REQUIRE(index[1].last_id == 100);
+
+        REQUIRE(index[1].offset == index[0].offset + index[0].size);
+        REQUIRE(index.file_size() == index[1].offset + index[1].size);
+
+        REQUIRE(index.first_with(osmium::osm_entity_bits::way) == index.begin() + 1);
+        REQUIRE(index.first_with(osmium::osm_entity_bits::changeset) == index.end());
+
+        REQUIRE(index.find(osmium::item_type::node, 2, 3).size() == 1);
+        REQUIRE(index.find(osmium::item_type::way, 11, 20).size() == 1);
+        REQUIRE(index.find(osmium::item_type::relation, 200, 300).empty());
+    }
+
+    SECTION("write and read index") {
+        const osmium::io::PBFBlobIndex index = osmium::io::PBFBlobIndex::build(filename);
+        index.write("test_pbf_blob_index.idx");
+
+        const osmium::io::PBFBlobIndex index2 = osmium::io::PBFBlobIndex::read("test_pbf_blob_index.idx");
+        REQUIRE(index2.size() == 2);
+        REQUIRE(index2.file_size() == index.file_size());
+        REQUIRE(index2[1].offset == index[1].offset);
+        REQUIRE(index2[1].size == index[1].size);
+        REQUIRE(index2[1].types == index[1].types);
+        REQUIRE(index2[1].last_type == osmium::item_type::relation);
+        REQUIRE(index2[1].last_id == 100);
+
+        std::remove("test_pbf_blob_index.idx");
+    }
+
+    SECTION("reading invalid index throws") {
+        REQUIRE_THROWS_AS(osmium::io::PBFBlobIndex::read(filename), osmium::io_error);
+    }
+
+    SECTION("reader uses index") {
+        std::remove("test_pbf_blob_index_reader.idx");
+
+        for (int run = 0; run < 2; ++run) { // first run builds index, second uses it
+            osmium::io::File file(filename, "pbf,pbf_index=test_pbf_blob_index_reader.idx");
+
+            CountHandler handler;
+            osmium::io::Reader reader(file, osmium::osm_entity_bits::way | osmium::osm_entity_bits::relation);
+            osmium::apply(reader, handler);
+
+            REQUIRE(handler.nodes == 0);
+            REQUIRE(handler.ways == 2);
+            REQUIRE(handler.relations == 1);
+        }
+
+        REQUIRE(osmium::io::PBFBlobIndex::read("test_pbf_blob_index_reader.idx").size() == 2);
+
+        osmium::io::File file(filename, "pbf,pbf_index=test_pbf_blob_index_reader.idx");
+        CountHandler handler;
+        osmium::io::Reader reader(file);
+        osmium::apply(reader, handler);
+        REQUIRE(handler.nodes == 3);
+        REQUIRE(handler.ways == 2);
+        REQUIRE(handler.relations == 1);
+
+        std::remove("test_pbf_blob_index_reader.idx");
+    }
+
+    SECTION("index is rebuilt if file changed without changing its size") {
+        std::ifstream in(filename, std::ios::binary);
+        std::string data(std::istreambuf_iterator<char>(in), (std::istreambuf_iterator<char>()));
+        std::remove("test_pbf_blob_index_changed.idx");
+
+        const auto index = osmium::io::detail::load_or_build_pbf_blob_index("test_pbf_blob_index_changed.idx", data.data(), data.size());
+        REQUIRE(index.matches(data.data(), data.size()));
+
+        // change last byte of the OSMHeader blob
+        ++data[index[0].offset - 1];
+        REQUIRE_FALSE(index.matches(data.data(), data.size()));
+
+        const auto index2 = osmium::io::detail::load_or_build_pbf_blob_index("test_pbf_blob_index_changed.idx", data.data(), data.size());
+        REQUIRE(index2.matches(data.data(), data.size()));
+        REQUIRE(osmium::io::PBFBlobIndex::read("test_pbf_blob_index_changed.idx").checksum() == index2.checksum());
+
+        std::remove("test_pbf_blob_index_changed.idx");
+    }
+
+    SECTION("index with blob outside the file is invalid") {
+        const osmium::io::PBFBlobIndex index = osmium::io::PBFBlobIndex::build(filename);
+        index.write("test_pbf_blob_index_invalid.idx");
+        {
+            std::fstream file("test_pbf_blob_index_invalid.idx", std::ios::in | std::ios::out | std::ios::binary);
+            const uint64_t offset = index.file_size() + 100;
+            file.seekp(36); // offset of first blob
+            file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        }
+
+        REQUIRE_THROWS_AS(osmium::io::PBFBlobIndex::read("test_pbf_blob_index_invalid.idx"), osmium::io_error);
+
+        std::remove("test_pbf_blob_index_invalid.idx");
+    }
+
+    SECTION("reader checks blobs against index") {
+        const osmium::io::PBFBlobIndex index = osmium::io::PBFBlobIndex::build(filename);
+        index.write("test_pbf_blob_index_wrong.idx");
+        {
+            std::fstream file("test_pbf_blob_index_wrong.idx", std::ios::in | std::ios::out | std::ios::binary);
+            const uint32_t size = index[0].size + 1;
+            file.seekp(36 + 8); // size of first blob
+            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        }
+
+        osmium::io::File file(filename, "pbf,pbf_index=test_pbf_blob_index_wrong.idx");
+        CountHandler handler;
+        osmium::io::Reader reader(file);
+        REQUIRE_THROWS_AS(osmium::apply(reader, handler), osmium::pbf_error);
+        reader.close();
+
+        std::remove("test_pbf_blob_index_wrong.idx");
+    }
+
+    SECTION("index is used if sidecar file can't be written") {
+        osmium::io::File file(filename, "pbf,pbf_index=does_not_exist/test_pbf_blob_index.idx");
+
+        CountHandler handler;
+        osmium::io::Reader reader(file, osmium::osm_entity_bits::way);
+        osmium::apply(reader, handler);
+
+        REQUIRE(handler.ways == 2);
+    }
+
+}
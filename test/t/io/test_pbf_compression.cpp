@@ -0,0 +1,98 @@
+#include "catch.hpp"
+
+#include <string>
+
+#include <osmium/io/detail/pbf_parser.hpp>
+
+using osmium::io::detail::data_view;
+
+namespace {
+
+    void append_varint(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out += static_cast<char>((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+
+    // Build a Blob message with raw_size and the data in the given field.
+    std::string make_blob(uint32_t field, const std::string& data, size_t raw_size) {
+        std::string blob;
+        append_varint(blob, (2 << 3) | 0);
+        append_varint(blob, raw_size);
+        append_varint(blob, (field << 3) | 2);
+        append_varint(blob, data.size());
+        blob += data;
+        return blob;
+    }
+
+    const std::string content(1000, 'x');
+
+} // anonymous namespace
+
+TEST_CASE("Unpack PBF blobs") {
+
+    std::string output;
+
+    SECTION("raw") {
+        const std::string blob = make_blob(1, content, content.size());
+        const data_view view = osmium::io::detail::unpack_blob(blob.data(), blob.size(), output);
+        REQUIRE(std::string(view.data, view.size) == content);
+    }
+
+    SECTION("zlib") {
+        const std::string blob = make_blob(3, osmium::io::detail::zlib_compress(content), content.size());
+        const data_view view = osmium::io::detail::unpack_blob(blob.data(), blob.size(), output);
+        REQUIRE(std::string(view.data, view.size) == content);
+    }
+
+    SECTION("zstd") {
+#ifdef OSMIUM_WITH_ZSTD
+        const std::string compressed = osmium::io::detail::zstd_compress(content);
+        REQUIRE(compressed.size() < content.size());
+
+        const std::string blob = make_blob(7, compressed, content.size());
+        const data_view view = osmium::io::detail::unpack_blob(blob.data(), blob.size(), output);
+        REQUIRE(std::string(view.data, view.size) == content);
+
+        const std::string wrong_size_blob = make_blob(7, compressed, content.size() - 1);
+        REQUIRE_THROWS(osmium::io::detail::unpack_blob(wrong_size_blob.data(), wrong_size_blob.size(), output));
+#else
+        const std::string blob = make_blob(7, "foo", 3);
+        REQUIRE_THROWS_AS(osmium::io::detail::unpack_blob(blob.data(), blob.size(), output), osmium::pbf_error);
+#endif
+    }
+
+    SECTION("lz4") {
+#ifdef OSMIUM_WITH_LZ4
+        const std::string compressed = osmium::io::detail::lz4_compress(content);
+        REQUIRE(compressed.size() < content.size());
+
+        const std::string blob = make_blob(6, compressed, content.size());
+        const data_view view = osmium::io::detail::unpack_blob(blob.data(), blob.size(), output);
+        REQUIRE(std::string(view.data, view.size) == content);
+
+        const std::string wrong_size_blob = make_blob(6, compressed, content.size() + 1);
+        REQUIRE_THROWS(osmium::io::detail::unpack_blob(wrong_size_blob.data(), wrong_size_blob.size(), output));
+#else
+        const std::string blob = make_blob(6, "foo", 3);
+        REQUIRE_THROWS_AS(osmium::io::detail::unpack_blob(blob.data(), blob.size(), output), osmium::pbf_error);
+#endif
+    }
+
+    SECTION("compressed blob without raw_size") {
+        std::string blob;
+        append_varint(blob, (3 << 3) | 2);
+        append_varint(blob, 3);
+        blob += "foo";
+        REQUIRE_THROWS_AS(osmium::io::detail::unpack_blob(blob.data(), blob.size(), output), osmium::pbf_error);
+    }
+
+    SECTION("zstd and lz4 blobs are not peeked into") {
+        const std::string blob = make_blob(7, "foo", 3);
+        REQUIRE(osmium::io::detail::peek_first_item_type(blob.data(), blob.size()) == osmium::item_type::undefined);
+    }
+
+}
+
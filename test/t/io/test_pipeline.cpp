@@ -0,0 +1,144 @@
+#include "catch.hpp"
+#include "utils.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <osmium/handler.hpp>
+#include <osmium/io/opl_input.hpp>
+#include <osmium/io/pipeline.hpp>
+
+struct CountHandler : public osmium::handler::Handler {
+
+    int count = 0;
+    int flushed = 0;
+
+    void node(const osmium::Node&) {
+        ++count;
+    }
+
+    void flush() {
+        ++flushed;
+    }
+
+}; // class CountHandler
+
+struct CollectIds {
+
+    std::vector<osmium::object_id_type> ids;
+
+    void operator()(osmium::memory::Buffer&& buffer) {
+        for (auto it = buffer.cbegin<osmium::Node>(); it != buffer.cend<osmium::Node>(); ++it) {
+            ids.push_back(it->id());
+        }
+    }
+
+}; // struct CollectIds
+
+static bool in_order(const std::vector<osmium::object_id_type>& ids) {
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (ids[i] != osmium::object_id_type(i + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Pipeline") {
+
+    const int num_nodes = 100000;
+    const std::string data = make_opl(num_nodes);
+    osmium::io::File file(data.data(), data.size(), "opl");
+
+    SECTION("runs without stages") {
+        osmium::io::Reader reader(file);
+        osmium::io::Pipeline pipeline;
+        CollectIds sink;
+
+        pipeline.run(reader, sink);
+
+        REQUIRE(sink.ids.size() == size_t(num_nodes));
+        REQUIRE(in_order(sink.ids));
+    }
+
+    SECTION("runs handlers, serial and parallel stages in order") {
+        osmium::io::Reader reader(file);
+        CountHandler handler;
+        std::atomic<int> buffers {0};
+        int finished = 0;
+
+        osmium::io::Pipeline pipeline(2);
+        pipeline.add_handlers(handler)
+                .add_parallel_stage([&buffers](osmium::memory::Buffer&& buffer) {
+                    ++buffers;
+                    return std::move(buffer);
+                })
+                .add_stage([](osmium::memory::Buffer&& buffer) {
+                    return std::move(buffer);
+                }, [&finished]() {
+                    ++finished;
+                });
+        REQUIRE(pipeline.size() == 3);
+
+        CollectIds sink;
+        pipeline.run(reader, sink);
+
+        REQUIRE(handler.count == num_nodes);
+        REQUIRE(handler.flushed == 1);
+        REQUIRE(buffers > 1);
+        REQUIRE(finished == 1);
+        REQUIRE(sink.ids.size() == size_t(num_nodes));
+        REQUIRE(in_order(sink.ids));
+    }
+
+    SECTION("stages can drop buffers") {
+        osmium::io::Reader reader(file);
+        CountHandler handler;
+
+        osmium::io::Pipeline pipeline;
+        pipeline.add_stage([](osmium::memory::Buffer&&) {
+                    return osmium::memory::Buffer();
+                })
+                .add_handlers(handler);
+        pipeline.run(reader);
+
+        REQUIRE(handler.count == 0);
+        REQUIRE(handler.flushed == 1);
+    }
+
+    SECTION("forwards exception from stage") {
+        osmium::io::Reader reader(file);
+        osmium::io::Pipeline pipeline(1);
+        pipeline.add_stage([](osmium::memory::Buffer&&) -> osmium::memory::Buffer {
+            throw std::runtime_error("stage");
+        });
+        CollectIds sink;
+
+        REQUIRE_THROWS_AS(pipeline.run(reader, sink), std::runtime_error);
+    }
+
+    SECTION("forwards exception from parallel stage") {
+        osmium::io::Reader reader(file);
+        osmium::io::Pipeline pipeline(1);
+        pipeline.add_parallel_stage([](osmium::memory::Buffer&&) -> osmium::memory::Buffer {
+            throw std::runtime_error("parallel stage");
+        });
+
+        REQUIRE_THROWS_AS(pipeline.run(reader), std::runtime_error);
+    }
+
+    SECTION("forwards exception from sink") {
+        osmium::io::Reader reader(file);
+        osmium::io::Pipeline pipeline(1);
+        pipeline.add_stage([](osmium::memory::Buffer&& buffer) {
+            return std::move(buffer);
+        });
+
+        REQUIRE_THROWS_AS(pipeline.run(reader, [](osmium::memory::Buffer&&) {
+            throw std::runtime_error("sink");
+        }), std::runtime_error);
+    }
+
+}
@@ -0,0 +1,86 @@
+#include "catch.hpp"
+
+#include <string>
+
+#include <osmium/io/detail/protobuf.hpp>
+
+using osmium::io::detail::ProtobufReader;
+using osmium::io::detail::PackedVarintReader;
+using osmium::io::detail::data_view;
+
+TEST_CASE("ProtobufReader") {
+
+    SECTION("decode varints") {
+        // field 1: 150, field 2: -1 (int64), field 3: -2 (sint64)
+        const std::string data("\x08\x96\x01\x10\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01\x18\x03", 16);
+
+        ProtobufReader message(data.data(), data.size());
+
+        REQUIRE(message.next());
+        REQUIRE(message.tag() == 1);
+        REQUIRE(message.get_uint32() == 150);
+
+        REQUIRE(message.next());
+        REQUIRE(message.tag() == 2);
+        REQUIRE(message.get_int64() == -1);
+
+        REQUIRE(message.next());
+        REQUIRE(message.tag() == 3);
+        REQUIRE(message.get_sint64() == -2);
+
+        REQUIRE(!message.next());
+    }
+
+    SECTION("decode strings and skip unknown fields") {
+        // field 5: fixed32, field 2: "foo", field 4: fixed64
+        const std::string data("\x2d\x01\x02\x03\x04\x12\x03" "foo" "\x21\x01\x02\x03\x04\x05\x06\x07\x08", 19);
+
+        ProtobufReader message(data.data(), data.size());
+        std::string str;
+        while (message.next()) {
+            if (message.tag() == 2) {
+                const data_view view = message.get_view();
+                REQUIRE(view == "foo");
+                REQUIRE(view != "fo");
+                REQUIRE(view != "fooo");
+                str = view.to_string();
+            } else {
+                message.skip();
+            }
+        }
+        REQUIRE(str == "foo");
+    }
+
+    SECTION("decode packed fields") {
+        // field 8: packed sint64 1, -1, 64
+        const std::string data("\x42\x04\x02\x01\x80\x01", 6);
+
+        ProtobufReader message(data.data(), data.size());
+        REQUIRE(message.next());
+        REQUIRE(message.tag() == 8);
+        PackedVarintReader packed = message.get_packed();
+        REQUIRE(packed.count() == 3);
+        REQUIRE(packed.next_sint64() == 1);
+        REQUIRE(packed.next_sint64() == -1);
+        REQUIRE(packed.next_sint64() == 64);
+        REQUIRE(packed.empty());
+        REQUIRE_THROWS_AS(packed.next_sint64(), osmium::pbf_error);
+    }
+
+    SECTION("throw on truncated data") {
+        const std::string data("\x12\x05" "foo", 5);
+
+        ProtobufReader message(data.data(), data.size());
+        REQUIRE(message.next());
+        REQUIRE_THROWS_AS(message.get_view(), osmium::pbf_error);
+    }
+
+    SECTION("throw on wrong wire type") {
+        const std::string data("\x08\x01", 2);
+
+        ProtobufReader message(data.data(), data.size());
+        REQUIRE(message.next());
+        REQUIRE_THROWS_AS(message.get_view(), osmium::pbf_error);
+    }
+
+}
@@ -0,0 +1,84 @@
+#include "catch.hpp"
+
+#include <string>
+
+#include <osmium/io/detail/protobuf.hpp>
+
+using osmium::io::detail::ProtobufReader;
+using osmium::io::detail::ProtobufWriter;
+using osmium::io::detail::encode_zigzag64;
+
+TEST_CASE("ProtobufWriter") {
+
+    SECTION("encode varints") {
+        std::string data;
+        ProtobufWriter message(data);
+        message.add_uint32(1, 150);
+        message.add_int64(2, -1);
+        message.add_sint64(3, -2);
+
+        REQUIRE(data == std::string("\x08\x96\x01\x10\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01\x18\x03", 16));
+    }
+
+    SECTION("encode negative int32 like the protobuf library") {
+        std::string data;
+        ProtobufWriter message(data);
+        message.add_int32(1, -1);
+
+        REQUIRE(data == std::string("\x08\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01", 11));
+    }
+
+    SECTION("encode strings") {
+        std::string data;
+        ProtobufWriter message(data);
+        message.add_bytes(2, "foo");
+        message.add_bytes(3, "", 0);
+
+        REQUIRE(data == std::string("\x12\x03" "foo" "\x1a\x00", 7));
+    }
+
+    SECTION("encode packed fields") {
+        std::string data;
+        ProtobufWriter message(data);
+        const auto pos = message.open_submessage(8);
+        message.add_varint(encode_zigzag64(1));
+        message.add_varint(encode_zigzag64(-1));
+        message.add_varint(encode_zigzag64(64));
+        message.close_submessage(pos);
+
+        REQUIRE(data == std::string("\x42\x04\x02\x01\x80\x01", 6));
+    }
+
+    SECTION("encode nested messages with long contents") {
+        const std::string long_string(300, 'x');
+
+        std::string data;
+        ProtobufWriter message(data);
+        const auto outer = message.open_submessage(1);
+        const auto inner = message.open_submessage(2);
+        message.add_bytes(3, long_string);
+        message.close_submessage(inner);
+        message.add_bool(4, true);
+        message.close_submessage(outer);
+
+        ProtobufReader reader(data.data(), data.size());
+        REQUIRE(reader.next());
+        REQUIRE(reader.tag() == 1);
+        ProtobufReader outer_reader(reader.get_view());
+        REQUIRE(!reader.next());
+
+        REQUIRE(outer_reader.next());
+        REQUIRE(outer_reader.tag() == 2);
+        ProtobufReader inner_reader(outer_reader.get_view());
+        REQUIRE(inner_reader.next());
+        REQUIRE(inner_reader.tag() == 3);
+        REQUIRE(inner_reader.get_string() == long_string);
+        REQUIRE(!inner_reader.next());
+
+        REQUIRE(outer_reader.next());
+        REQUIRE(outer_reader.tag() == 4);
+        REQUIRE(outer_reader.get_bool());
+        REQUIRE(!outer_reader.next());
+    }
+
+}
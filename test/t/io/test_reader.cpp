@@ -4,6 +4,7 @@
 #include <osmium/handler.hpp>
 #include <osmium/io/any_compression.hpp>
 #include <osmium/io/xml_input.hpp>
+#include <osmium/io/xml_output.hpp>
 #include <osmium/visitor.hpp>
 #include <osmium/memory/buffer.hpp>
 
@@ -113,5 +114,30 @@ TEST_CASE("Reader") {
         REQUIRE(handler.count == 1);
     }
 
-}
+    SECTION("should work with its own thread pool") {
+        osmium::thread::Pool pool(2);
+        osmium::io::Reader reader(with_data_dir("t/io/data.osm.bz2"), pool);
+        CountHandler handler;
+
+        osmium::apply(reader, handler);
+        REQUIRE(handler.count == 1);
+    }
+
+    SECTION("should work with thread pool shared with writer") {
+        osmium::thread::Pool pool(2);
+        {
+            osmium::io::Reader reader(with_data_dir("t/io/data.osm"), pool);
+            osmium::io::Writer writer("test_reader_pool.osm", pool, osmium::io::overwrite::allow, reader.header());
+            while (osmium::memory::Buffer buffer = reader.read()) {
+                writer(std::move(buffer));
+            }
+            writer.close();
+        }
 
+        osmium::io::Reader reader("test_reader_pool.osm", pool);
+        CountHandler handler;
+        osmium::apply(reader, handler);
+        REQUIRE(handler.count == 1);
+    }
+
+}
@@ -0,0 +1,79 @@
+#include "catch.hpp"
+#include "utils.hpp"
+
+#include <string>
+#include <vector>
+
+#include <osmium/handler.hpp>
+#include <osmium/io/pbf_input.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/visitor.hpp>
+
+struct CollectHandler : public osmium::handler::Handler {
+
+    std::vector<osmium::object_id_type> node_ids;
+    std::string last_tag;
+    int ways = 0;
+
+    void node(const osmium::Node& node) {
+        node_ids.push_back(node.id());
+        const char* value = node.tags().get_value_by_key("x");
+        last_tag = value ? value : "(none)";
+    }
+
+    void way(const osmium::Way&) {
+        ++ways;
+    }
+
+}; // class CollectHandler
+
+static void check_bbox_filter(const std::string& filename) {
+
+    SECTION("without box all nodes are read") {
+        osmium::io::Reader reader(filename);
+        CollectHandler handler;
+        osmium::apply(reader, handler);
+        REQUIRE(handler.node_ids.size() == 3);
+        REQUIRE(handler.ways == 2);
+    }
+
+    SECTION("only nodes inside the box are read") {
+        const osmium::Box box(-3.0, 1.0, -2.0, 2.0);
+        osmium::io::Reader reader(filename, box);
+        CollectHandler handler;
+        osmium::apply(reader, handler);
+        REQUIRE(handler.node_ids.size() == 1);
+        REQUIRE(handler.node_ids[0] == 1);
+        REQUIRE(handler.ways == 2);
+    }
+
+    SECTION("tags of skipped nodes are skipped, too") {
+        const osmium::Box box(-1.0, -1.0, 1.0, 1.0);
+        osmium::io::Reader reader(filename, box, osmium::osm_entity_bits::node);
+        CollectHandler handler;
+        osmium::apply(reader, handler);
+        REQUIRE(handler.node_ids.size() == 1);
+        REQUIRE(handler.node_ids[0] == 5);
+        REQUIRE(handler.last_tag == "");
+        REQUIRE(handler.ways == 0);
+    }
+
+    SECTION("options can be given in any order") {
+        const osmium::Box box(-1.0, -1.0, 1.0, 1.0);
+        osmium::io::Reader reader(filename, osmium::osm_entity_bits::way, box);
+        CollectHandler handler;
+        osmium::apply(reader, handler);
+        REQUIRE(handler.node_ids.empty());
+        REQUIRE(handler.ways == 2);
+    }
+
+}
+
+TEST_CASE("Reader with bounding box on XML file") {
+    check_bbox_filter(with_data_dir("t/io/data-nwr.osm"));
+}
+
+TEST_CASE("Reader with bounding box on PBF file") {
+    check_bbox_filter(with_data_dir("t/io/data-nwr.osm.pbf"));
+}
@@ -0,0 +1,116 @@
+#include "catch.hpp"
+#include "describe_handler.hpp"
+#include "utils.hpp"
+
+#include <string>
+#include <vector>
+
+#include <osmium/io/opl_input.hpp>
+#include <osmium/io/opl_output.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/visitor.hpp>
+
+static std::vector<std::string> describe(osmium::io::Reader& reader) {
+    DescribeHandler handler;
+    osmium::apply(reader, handler);
+    reader.close();
+    return handler.objects;
+}
+
+static std::vector<std::string> describe(const osmium::io::File& file) {
+    osmium::io::Reader reader(file);
+    return describe(reader);
+}
+
+static std::vector<std::string> describe(const std::string& data) {
+    return describe(osmium::io::File(data.data(), data.size(), "opl"));
+}
+
+TEST_CASE("Reading OPL") {
+
+    SECTION("round trip through OPL writer") {
+        const auto expected = describe(osmium::io::File(with_data_dir("t/io/data-nwr.osm")));
+        REQUIRE(expected.size() == 6);
+
+        {
+            osmium::io::Reader reader(with_data_dir("t/io/data-nwr.osm"));
+            osmium::io::Writer writer("test_reader_opl.opl", reader.header(), osmium::io::overwrite::allow);
+            while (osmium::memory::Buffer buffer = reader.read()) {
+                writer(std::move(buffer));
+            }
+            writer.close();
+            reader.close();
+        }
+
+        REQUIRE(describe(osmium::io::File("test_reader_opl.opl")) == expected);
+    }
+
+    SECTION("decodes all fields") {
+        const std::string data =
+            "# comment\n"
+            "n1 v3 dV c12 t2015-03-01T12:34:56Z i7 u%3c%x%3e%%20%%e4%%4e2d% T%2c%=a%3d%b,name=%25% x179.9999999 y-89.12345675\r\n"
+            "\n"
+            "n2 v1 dD c0 t i0 u T x y\n"
+            "w5 v1 dV c2 t1970-01-01T00:00:00Z i1 ufoo Thighway=road Nn1,n2\n"
+            "r6 v1 dV c2 t2000-02-29T23:59:59Z i1 u T Mw5@%26%,n1@,r6@outer\n"
+            "c7 k3 s2015-01-01T00:00:00Z e2015-01-02T00:00:00Z i8 uu x2 y1 X4 Y3 Tcomment=c";
+
+        const auto result = describe(data);
+        REQUIRE(result.size() == 5);
+        REQUIRE(result[0] == "n1 v3 V c12 t2015-03-01T12:34:56Z i7 u<x> \xc3\xa4\xe4\xb8\xad ,=a=b name=% x1799999999 y-891234568");
+        REQUIRE(result[1] == "n2 v1 D c0 t i0 u x2147483647 y2147483647");
+        REQUIRE(result[2] == "w5 v1 V c2 t i1 ufoo highway=road n1 n2");
+        REQUIRE(result[3] == "r6 v1 V c2 t2000-02-29T23:59:59Z i1 u w5@& n1@ r6@outer");
+        REQUIRE(result[4] == "c7 n3 2015-01-01T00:00:00Z 2015-01-02T00:00:00Z (2,1,4,3) i8 uu comment=c");
+    }
+
+    SECTION("reads only requested entities") {
+        const std::string data = "n1 x1 y1\nw2 Nn1\nr3 Mn1@\nc4\n";
+        osmium::io::Reader reader(osmium::io::File(data.data(), data.size(), "opl"), osmium::osm_entity_bits::way);
+        const auto result = describe(reader);
+        REQUIRE(result.size() == 1);
+        REQUIRE(result[0].substr(0, 2) == "w2");
+    }
+
+    SECTION("reads without metadata") {
+        const std::string data = "n1 v3 dV c12 t2015-03-01T12:34:56Z i7 ufoo Ta=b x1 y2\n";
+        osmium::io::Reader reader(osmium::io::File(data.data(), data.size(), "opl"), osmium::io::read_meta::no);
+        const auto result = describe(reader);
+        REQUIRE(result.size() == 1);
+        REQUIRE(result[0] == "n1 v0 V c0 t i0 u a=b x10000000 y20000000");
+    }
+
+    SECTION("reads large input in multiple chunks in order") {
+        std::string data;
+        for (int i = 1; i <= 100000; ++i) {
+            data += "n" + std::to_string(i) + " v1 dV c1 t2015-01-01T00:00:00Z i1 uuser Tname=node%20%" + std::to_string(i) + " x" + std::to_string(i % 180) + ".1234567 y1\n";
+        }
+        REQUIRE(data.size() > 2 * 1024 * 1024);
+
+        const auto result = describe(data);
+        REQUIRE(result.size() == 100000);
+        REQUIRE(result.front() == "n1 v1 V c1 t2015-01-01T00:00:00Z i1 uuser name=node 1 x11234567 y10000000");
+        REQUIRE(result.back() == "n100000 v1 V c1 t2015-01-01T00:00:00Z i1 uuser name=node 100000 x1001234567 y10000000");
+    }
+
+    SECTION("throws on unknown object type") {
+        const std::string data = "n1\nx2\n";
+        osmium::io::Reader reader(osmium::io::File(data.data(), data.size(), "opl"));
+        REQUIRE_THROWS_AS({
+            while (reader.read()) {}
+            reader.close();
+        }, osmium::opl_error);
+    }
+
+    SECTION("throws on invalid fields") {
+        for (const char* line : { "n1 Q1", "nx", "n1 x1a", "n1 v1x", "n1 Tfoo", "n1 ta", "w1 N1", "r1 Mn1", "r1 Mz1@", "n1 u%zz%", "n1 u%41" }) {
+            const std::string data = line;
+            osmium::io::Reader reader(osmium::io::File(data.data(), data.size(), "opl"));
+            REQUIRE_THROWS_AS({
+                while (reader.read()) {}
+                reader.close();
+            }, osmium::opl_error);
+        }
+    }
+
+}
@@ -0,0 +1,167 @@
+#include "catch.hpp"
+#include "utils.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <osmium/handler.hpp>
+#include <osmium/io/gzip_compression.hpp>
+#include <osmium/io/osmbuf_input.hpp>
+#include <osmium/io/osmbuf_output.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/visitor.hpp>
+
+struct IdHandler : public osmium::handler::Handler {
+
+    std::vector<std::string> objects;
+
+    void osm_object(const osmium::OSMObject& object) {
+        std::string out = osmium::item_type_to_char(object.type()) + std::to_string(object.id()) + " u" + object.user();
+        for (const auto& tag : object.tags()) {
+            out += std::string(" ") + tag.key() + "=" + tag.value();
+        }
+        objects.push_back(out);
+    }
+
+}; // struct IdHandler
+
+template <typename... TArgs>
+static std::vector<std::string> read_ids(const osmium::io::File& file, TArgs&&... args) {
+    osmium::io::Reader reader(file, std::forward<TArgs>(args)...);
+    IdHandler handler;
+    osmium::apply(reader, handler);
+    reader.close();
+    return handler.objects;
+}
+
+static void write_osmbuf(const std::string& filename) {
+    osmium::io::Reader reader(with_data_dir("t/io/data-nwr.osm"));
+    osmium::io::Header header = reader.header();
+    header.set("generator", "test_reader_osmbuf");
+    header.add_box(osmium::Box(1.0, 2.0, 3.0, 4.0));
+    osmium::io::Writer writer(filename, header, osmium::io::overwrite::allow);
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        writer(std::move(buffer));
+    }
+    writer.close();
+    reader.close();
+}
+
+TEST_CASE("Reading OSMBUF files") {
+
+    const auto expected = read_ids(osmium::io::File(with_data_dir("t/io/data-nwr.osm")));
+    REQUIRE(expected.size() == 6);
+
+    write_osmbuf("test_reader_osmbuf.osmbuf");
+
+    SECTION("from memory mapped file") {
+        REQUIRE(read_ids(osmium::io::File("test_reader_osmbuf.osmbuf")) == expected);
+    }
+
+    SECTION("through input queue") {
+        REQUIRE(read_ids(osmium::io::File("test_reader_osmbuf.osmbuf", "osmbuf,mmap=false")) == expected);
+    }
+
+    SECTION("from compressed file") {
+        write_osmbuf("test_reader_osmbuf.osmbuf.gz");
+        REQUIRE(read_ids(osmium::io::File("test_reader_osmbuf.osmbuf.gz")) == expected);
+    }
+
+    SECTION("header") {
+        osmium::io::Reader reader("test_reader_osmbuf.osmbuf", osmium::osm_entity_bits::nothing);
+        const osmium::io::Header header = reader.header();
+        REQUIRE(header.get("generator") == "test_reader_osmbuf");
+        REQUIRE(header.boxes().size() == 1);
+        REQUIRE(header.box() == osmium::Box(1.0, 2.0, 3.0, 4.0));
+        REQUIRE(!header.has_multiple_object_versions());
+        REQUIRE(!reader.read());
+        reader.close();
+    }
+
+    SECTION("only some entity types") {
+        for (const char* format : { "osmbuf", "osmbuf,mmap=false" }) {
+            const auto ways = read_ids(osmium::io::File("test_reader_osmbuf.osmbuf", format), osmium::osm_entity_bits::way);
+            REQUIRE(ways.size() == 2);
+            REQUIRE(ways[0].substr(0, 4) == "w10 ");
+            REQUIRE(ways[1].substr(0, 4) == "w11 ");
+        }
+    }
+
+    SECTION("with bounding box") {
+        const auto objects = read_ids(osmium::io::File("test_reader_osmbuf.osmbuf"), osmium::Box(-3.0, 1.0, 0.0, 2.0));
+        REQUIRE(objects == read_ids(osmium::io::File(with_data_dir("t/io/data-nwr.osm")), osmium::Box(-3.0, 1.0, 0.0, 2.0)));
+        REQUIRE(objects.size() == 4);
+        REQUIRE(objects[0].substr(0, 3) == "n1 ");
+    }
+
+    SECTION("objects in mapped buffers can be changed") {
+        osmium::io::Reader reader("test_reader_osmbuf.osmbuf");
+        osmium::memory::Buffer buffer = reader.read();
+        REQUIRE(buffer);
+        auto& object = *buffer.begin<osmium::OSMObject>();
+        object.set_id(42);
+        REQUIRE(object.id() == 42);
+        reader.close();
+
+        REQUIRE(read_ids(osmium::io::File("test_reader_osmbuf.osmbuf")) == expected);
+    }
+
+    SECTION("truncated file") {
+        std::string data;
+        {
+            std::ifstream in("test_reader_osmbuf.osmbuf", std::ios::binary);
+            data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        data.resize(data.size() - 8);
+        {
+            std::ofstream out("test_reader_osmbuf_truncated.osmbuf", std::ios::binary);
+            out << data;
+        }
+        REQUIRE_THROWS_AS(read_ids(osmium::io::File("test_reader_osmbuf_truncated.osmbuf")), osmium::osmbuf_error);
+    }
+
+    SECTION("corrupted block directory") {
+        std::string data;
+        {
+            std::ifstream in("test_reader_osmbuf.osmbuf", std::ios::binary);
+            data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+
+        uint64_t directory_offset;
+        std::memcpy(&directory_offset, &data[data.size() - 16], sizeof(directory_offset));
+
+        // first directory entry: offset, size, entities
+        const size_t entry = static_cast<size_t>(directory_offset) + 16;
+        uint64_t entry_offset;
+        std::memcpy(&entry_offset, &data[entry], sizeof(entry_offset));
+
+        const auto read_corrupted = [&](size_t pos, uint64_t value) {
+            std::string corrupted = data;
+            std::memcpy(&corrupted[pos], &value, sizeof(value));
+            return read_ids(osmium::io::File(corrupted.data(), corrupted.size(), "osmbuf"));
+        };
+
+        // block would start right before the directory
+        REQUIRE_THROWS_AS(read_corrupted(entry, directory_offset - 8), osmium::osmbuf_error);
+
+        // block starts after the directory
+        REQUIRE_THROWS_AS(read_corrupted(entry, directory_offset + 64), osmium::osmbuf_error);
+
+        // block is not aligned
+        REQUIRE_THROWS_AS(read_corrupted(entry, entry_offset + 1), osmium::osmbuf_error);
+
+        // block size doesn't match block header
+        uint64_t entry_size;
+        std::memcpy(&entry_size, &data[entry + 8], sizeof(entry_size));
+        REQUIRE_THROWS_AS(read_corrupted(entry + 8, entry_size - 8), osmium::osmbuf_error);
+    }
+
+    SECTION("not an OSMBUF file") {
+        const std::string data = "<osm version=\"0.6\"></osm>\n";
+        REQUIRE_THROWS_AS(read_ids(osmium::io::File(data.data(), data.size(), "osmbuf")), osmium::osmbuf_error);
+    }
+
+}
@@ -0,0 +1,114 @@
+#include "catch.hpp"
+#include "utils.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <osmium/handler.hpp>
+#include <osmium/io/pbf_input.hpp>
+#include <osmium/visitor.hpp>
+#include <osmium/memory/buffer.hpp>
+
+struct CountHandler : public osmium::handler::Handler {
+
+    int count = 0;
+
+    void node(const osmium::Node& node) {
+        REQUIRE(node.id() == 1);
+        REQUIRE(std::string(node.user()) == "test");
+        ++count;
+    }
+
+}; // class CountHandler
+
+TEST_CASE("PBF Reader") {
+
+    SECTION("reads file through memory mapping") {
+        osmium::io::File file(with_data_dir("t/io/data.osm.pbf"));
+        osmium::io::Reader reader(file);
+        CountHandler handler;
+
+        osmium::apply(reader, handler);
+        REQUIRE(handler.count == 1);
+        REQUIRE(reader.eof());
+    }
+
+    SECTION("reads file through input queue if mmap is disabled") {
+        osmium::io::File file(with_data_dir("t/io/data.osm.pbf"), "pbf,mmap=false");
+        osmium::io::Reader reader(file);
+        CountHandler handler;
+
+        osmium::apply(reader, handler);
+        REQUIRE(handler.count == 1);
+    }
+
+    SECTION("reads file from buffer") {
+        std::ifstream in(with_data_dir("t/io/data.osm.pbf"), std::ios::binary);
+        const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        REQUIRE(data.size() > 0);
+
+        osmium::io::File file(data.data(), data.size(), "pbf");
+        osmium::io::Reader reader(file);
+        CountHandler handler;
+
+        osmium::apply(reader, handler);
+        REQUIRE(handler.count == 1);
+    }
+
+    SECTION("reads only header") {
+        osmium::io::Reader reader(with_data_dir("t/io/data.osm.pbf"), osmium::osm_entity_bits::nothing);
+
+        REQUIRE(reader.header().get("pbf_dense_nodes") == "true");
+        REQUIRE(!reader.read());
+    }
+
+    SECTION("can be closed before all data is read") {
+        osmium::io::Reader reader(with_data_dir("t/io/data.osm.pbf"));
+        reader.close();
+    }
+
+}
+
+TEST_CASE("PBF Reader with memory budget") {
+
+    SECTION("reads file and reports statistics") {
+        osmium::io::Reader reader(with_data_dir("t/io/data.osm.pbf"), osmium::io::memory_budget(1024 * 1024));
+        CountHandler handler;
+
+        osmium::apply(reader, handler);
+        REQUIRE(handler.count == 1);
+
+        const osmium::io::reader_stats stats = reader.stats();
+        REQUIRE(stats.decoded_data.limit == 768 * 1024);
+        REQUIRE(stats.decoded_data.peak > 0);
+        REQUIRE(stats.decoded_data.in_use == 0);
+    }
+
+    SECTION("reads file through input queue with tiny budget") {
+        osmium::io::Reader reader(osmium::io::File(with_data_dir("t/io/data.osm.pbf"), "pbf,mmap=false"), osmium::io::memory_budget(4));
+        CountHandler handler;
+
+        osmium::apply(reader, handler);
+        REQUIRE(handler.count == 1);
+
+        const osmium::io::reader_stats stats = reader.stats();
+        REQUIRE(stats.raw_data.limit == 1);
+        REQUIRE(stats.raw_data.peak > 0);
+    }
+
+}
+
+TEST_CASE("PBF Reader with recycled buffers") {
+
+    osmium::io::Reader reader(with_data_dir("t/io/data-nwr.osm.pbf"));
+
+    size_t count = 0;
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        count += static_cast<size_t>(std::distance(buffer.begin(), buffer.end()));
+        reader.recycle(std::move(buffer));
+    }
+
+    REQUIRE(count == 6);
+}
+
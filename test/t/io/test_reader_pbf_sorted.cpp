@@ -0,0 +1,118 @@
+#include "catch.hpp"
+#include "utils.hpp"
+
+#include <string>
+
+#include <osmium/handler.hpp>
+#include <osmium/io/pbf_input.hpp>
+#include <osmium/visitor.hpp>
+
+struct CountHandler : public osmium::handler::Handler {
+
+    int nodes = 0;
+    int ways = 0;
+    int relations = 0;
+
+    void node(const osmium::Node&) {
+        ++nodes;
+    }
+
+    void way(const osmium::Way&) {
+        ++ways;
+    }
+
+    void relation(const osmium::Relation&) {
+        ++relations;
+    }
+
+}; // class CountHandler
+
+TEST_CASE("PBF Reader with file sorted by type and ID") {
+
+    // this file has the Sort.Type_then_ID feature, one blob with nodes
+    // 1, 2, 5 and one blob with ways 10, 11 and relation 100
+    const std::string filename = with_data_dir("t/io/data-nwr-sorted.osm.pbf");
+
+    SECTION("header shows sorting") {
+        osmium::io::Reader reader(filename, osmium::osm_entity_bits::nothing);
+        REQUIRE(reader.header().get("sorting") == "Type_then_ID");
+        REQUIRE(reader.header().get("pbf_optional_feature_0") == "Sort.Type_then_ID");
+    }
+
+    SECTION("read everything") {
+        osmium::io::Reader reader(filename);
+        CountHandler handler;
+        osmium::apply(reader, handler);
+        REQUIRE(handler.nodes == 3);
+        REQUIRE(handler.ways == 2);
+        REQUIRE(handler.relations == 1);
+    }
+
+    SECTION("read only nodes") {
+        osmium::io::Reader reader(filename, osmium::osm_entity_bits::node);
+        CountHandler handler;
+        osmium::apply(reader, handler);
+        REQUIRE(handler.nodes == 3);
+        REQUIRE(handler.ways == 0);
+        REQUIRE(handler.relations == 0);
+    }
+
+    SECTION("read only ways") {
+        osmium::io::Reader reader(filename, osmium::osm_entity_bits::way);
+        CountHandler handler;
+        osmium::apply(reader, handler);
+        REQUIRE(handler.nodes == 0);
+        REQUIRE(handler.ways == 2);
+        REQUIRE(handler.relations == 0);
+    }
+
+    SECTION("read only relations") {
+        osmium::io::Reader reader(filename, osmium::osm_entity_bits::relation);
+        CountHandler handler;
+        osmium::apply(reader, handler);
+        REQUIRE(handler.nodes == 0);
+        REQUIRE(handler.ways == 0);
+        REQUIRE(handler.relations == 1);
+    }
+
+    SECTION("read only relations through input queue") {
+        osmium::io::Reader reader(osmium::io::File(filename, "pbf,mmap=false"), osmium::osm_entity_bits::relation);
+        CountHandler handler;
+        osmium::apply(reader, handler);
+        REQUIRE(handler.relations == 1);
+    }
+
+    SECTION("read nodes and relations") {
+        osmium::io::Reader reader(filename, osmium::osm_entity_bits::node | osmium::osm_entity_bits::relation);
+        CountHandler handler;
+        osmium::apply(reader, handler);
+        REQUIRE(handler.nodes == 3);
+        REQUIRE(handler.ways == 0);
+        REQUIRE(handler.relations == 1);
+    }
+
+}
+
+TEST_CASE("Peek at first entity type in PBF blob") {
+
+    std::string data;
+
+    SECTION("raw blob with dense nodes") {
+        // PrimitiveBlock: stringtable with empty string, group with dense
+        const std::string block("\x0a\x02\x0a\x00\x12\x02\x12\x00", 8);
+        data = std::string("\x0a\x08", 2) + block;
+        REQUIRE(osmium::io::detail::peek_first_item_type(data.data(), data.size()) == osmium::item_type::node);
+    }
+
+    SECTION("raw blob with relations after granularity") {
+        const std::string block("\x88\x01\x64\x0a\x00\x12\x02\x22\x00", 9);
+        data = std::string("\x0a\x09", 2) + block;
+        REQUIRE(osmium::io::detail::peek_first_item_type(data.data(), data.size()) == osmium::item_type::relation);
+    }
+
+    SECTION("raw blob without groups") {
+        data = std::string("\x0a\x02\x0a\x00", 4);
+        REQUIRE(osmium::io::detail::peek_first_item_type(data.data(), data.size()) == osmium::item_type::undefined);
+    }
+
+}
@@ -0,0 +1,66 @@
+#include "catch.hpp"
+#include "utils.hpp"
+
+#include <string>
+
+#include <osmium/handler.hpp>
+#include <osmium/io/pbf_input.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/visitor.hpp>
+
+struct CheckMetaHandler : public osmium::handler::Handler {
+
+    int objects = 0;
+    int with_meta = 0;
+
+    void osm_object(const osmium::OSMObject& object) {
+        ++objects;
+        REQUIRE(object.id() > 0);
+        REQUIRE(object.visible());
+        if (object.version() != 0 || object.timestamp() || object.uid() != 0 || object.changeset() != 0 || std::string(object.user()) != "") {
+            ++with_meta;
+        }
+    }
+
+    void node(const osmium::Node& node) {
+        if (node.id() == 1) {
+            REQUIRE(node.location() == osmium::Location(-2.25, 1.5));
+            REQUIRE(std::string(node.tags().get_value_by_key("amenity")) == "pub");
+        }
+    }
+
+    void way(const osmium::Way& way) {
+        if (way.id() == 10) {
+            REQUIRE(way.nodes().size() == 4);
+        }
+    }
+
+}; // class CheckMetaHandler
+
+static void check_read_meta(const std::string& filename) {
+
+    SECTION("metadata is read by default") {
+        osmium::io::Reader reader(filename);
+        CheckMetaHandler handler;
+        osmium::apply(reader, handler);
+        REQUIRE(handler.objects == 6);
+        REQUIRE(handler.with_meta == 6);
+    }
+
+    SECTION("metadata is not read with read_meta::no") {
+        osmium::io::Reader reader(filename, osmium::io::read_meta::no);
+        CheckMetaHandler handler;
+        osmium::apply(reader, handler);
+        REQUIRE(handler.objects == 6);
+        REQUIRE(handler.with_meta == 0);
+    }
+
+}
+
+TEST_CASE("Reader without metadata on XML file") {
+    check_read_meta(with_data_dir("t/io/data-nwr.osm"));
+}
+
+TEST_CASE("Reader without metadata on PBF file") {
+    check_read_meta(with_data_dir("t/io/data-nwr.osm.pbf"));
+}
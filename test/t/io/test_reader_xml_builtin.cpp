@@ -0,0 +1,161 @@
+#include "catch.hpp"
+#include "describe_handler.hpp"
+#include "utils.hpp"
+
+#include <string>
+#include <vector>
+
+#include <osmium/io/xml_input.hpp>
+#include <osmium/visitor.hpp>
+
+static std::vector<std::string> describe(const osmium::io::File& file) {
+    osmium::io::Reader reader(file);
+    DescribeHandler handler;
+    osmium::apply(reader, handler);
+    reader.close();
+    return handler.objects;
+}
+
+static std::vector<std::string> describe(const std::string& data, const std::string& format) {
+    return describe(osmium::io::File(data.data(), data.size(), format));
+}
+
+TEST_CASE("Builtin XML parser") {
+
+    SECTION("gives same result as Expat") {
+        const auto expected = describe(osmium::io::File(with_data_dir("t/io/data-nwr.osm")));
+        const auto result = describe(osmium::io::File(with_data_dir("t/io/data-nwr.osm"), "osm,xml_parser=builtin"));
+
+        REQUIRE(expected.size() == 6);
+        REQUIRE(result == expected);
+    }
+
+    SECTION("reads header") {
+        osmium::io::Reader reader(osmium::io::File(with_data_dir("t/io/data-nwr.osm"), "osm,xml_parser=builtin"), osmium::osm_entity_bits::nothing);
+        const osmium::io::Header header = reader.header();
+        REQUIRE(header.get("generator") == "test");
+        REQUIRE(!reader.read());
+    }
+
+    SECTION("decodes attribute values and parses numbers") {
+        const std::string data =
+            "<?xml version='1.0' encoding='UTF-8'?>\n"
+            "<!-- comment with <node> -->\n"
+            "<osm version='0.6' generator=\"test &amp; more\">\n"
+            "  <bounds minlat=\"-1.5\" minlon=\"-2.5\" maxlat=\"1.5\" maxlon=\"2.5\"/>\n"
+            "  <node id=\"-1\" version=\"3\" changeset=\"12\" uid=\"7\" user=\"&lt;x&gt; &#228;&#x4E2D;\" timestamp=\"2015-03-01T12:34:56Z\" lat=\"-89.12345675\" lon=\"179.9999999\">\n"
+            "    <tag k=\"a\tb\" v=\"line 1\r\nline 2\nx&quot;&apos;\"/>\n"
+            "    <tag k='name' v='a > b'></tag>\n"
+            "  </node>\n"
+            "  <node id=\"2\" lat=\"1\" lon=\".5\" timestamp=\"1970-01-01T00:00:00Z\"/>\n"
+            "  <node id=\"3\" lat=\"1e-3\" lon=\"-0.00000004\" timestamp=\"2000-02-29T23:59:59Z\"/>\n"
+            "  <node id=\"4\"/>\n"
+            "  <way id=\"5\" version=\"1\"><tag k=\"highway\" v=\"road\"/><nd ref=\"1\"/><nd ref=\"2\"/><!-- <nd ref=\"3\"/> --></way>\n"
+            "  <relation id=\"6\" visible=\"false\"><member type=\"way\" ref=\"5\" role=\"&amp;\"/><member type=\"node\" ref=\"1\" role=\"\"/><tag k=\"type\" v=\"x\"/></relation>\n"
+            "  <changeset id=\"7\" num_changes=\"3\" created_at=\"2015-01-01T00:00:00Z\" closed_at=\"2015-01-02T00:00:00Z\" min_lat=\"1\" min_lon=\"2\" max_lat=\"3\" max_lon=\"4\" user=\"u\" uid=\"8\"><tag k=\"comment\" v=\"c\"/></changeset>\n"
+            "</osm>\n";
+
+        const auto expected = describe(data, "osm");
+        const auto result = describe(data, "osm,xml_parser=builtin");
+
+        REQUIRE(expected.size() == 7);
+        REQUIRE(result == expected);
+
+        osmium::io::Reader reader(osmium::io::File(data.data(), data.size(), "osm,xml_parser=builtin"), osmium::osm_entity_bits::nothing);
+        const osmium::io::Header header = reader.header();
+        REQUIRE(header.get("generator") == "test & more");
+        REQUIRE(header.box() == osmium::Box(-2.5, -1.5, 2.5, 1.5));
+    }
+
+    SECTION("handles change files") {
+        const std::string data =
+            "<?xml version='1.0' encoding='UTF-8'?>\n"
+            "<osmChange version=\"0.6\" generator=\"test\">\n"
+            "<create>\n"
+            "  <node id=\"1\" version=\"1\" lat=\"1\" lon=\"2\"/>\n"
+            "</create>\n"
+            "<delete>\n"
+            "  <node id=\"3\" version=\"3\"/>\n"
+            "</delete>\n"
+            "<delete/>\n"
+            "<modify>\n"
+            "  <node id=\"5\" version=\"5\" lat=\"1\" lon=\"2\"/>\n"
+            "</modify>\n"
+            "</osmChange>\n";
+
+        const auto expected = describe(data, "osc");
+        const auto result = describe(data, "osc,xml_parser=builtin");
+
+        REQUIRE(expected.size() == 3);
+        REQUIRE(result == expected);
+        REQUIRE(result[1].substr(0, 6) == "n3 v3 ");
+        REQUIRE(result[1].find(" D ") != std::string::npos);
+    }
+
+    SECTION("works with the parallel parser") {
+        std::string data = "<?xml version='1.0' encoding='UTF-8'?>\n<osm version=\"0.6\">\n";
+        for (int i = 1; i <= 20000; ++i) {
+            data += "  <node id=\"" + std::to_string(i) + "\" version=\"1\" lat=\"1.5\" lon=\"-" + std::to_string(i % 180) + ".25\">\n";
+            data += "    <tag k=\"name\" v=\"node " + std::to_string(i) + "\"/>\n";
+            data += "  </node>\n";
+        }
+        data += "</osm>\n";
+
+        const auto expected = describe(data, "osm");
+        const auto result = describe(data, "osm,xml_parser=builtin,xml_parallel=true");
+
+        REQUIRE(result.size() == 20000);
+        REQUIRE(result == expected);
+    }
+
+    SECTION("reports errors") {
+        const std::string data =
+            "<?xml version='1.0' encoding='UTF-8'?>\n"
+            "<osm version=\"0.6\">\n"
+            "  <node id=\"1\" version=\"1\" lat=\"1x\" lon=\"2\"/>\n"
+            "</osm>\n";
+
+        osmium::io::Reader reader(osmium::io::File(data.data(), data.size(), "osm,xml_parser=builtin"));
+        REQUIRE_THROWS_AS({
+            while (reader.read()) {
+            }
+            reader.close();
+        }, osmium::xml_error);
+    }
+
+    SECTION("reports truncated files") {
+        const std::string data =
+            "<?xml version='1.0' encoding='UTF-8'?>\n"
+            "<osm version=\"0.6\">\n"
+            "  <node id=\"1\" version=\"1\">\n";
+
+        osmium::io::Reader reader(osmium::io::File(data.data(), data.size(), "osm,xml_parser=builtin"));
+        REQUIRE_THROWS_AS({
+            while (reader.read()) {
+            }
+            reader.close();
+        }, osmium::xml_error);
+    }
+
+    SECTION("reports wrong version") {
+        const std::string data =
+            "<?xml version='1.0' encoding='UTF-8'?>\n"
+            "<osm version=\"0.5\">\n"
+            "</osm>\n";
+
+        osmium::io::Reader reader(osmium::io::File(data.data(), data.size(), "osm,xml_parser=builtin"));
+        REQUIRE_THROWS_AS({
+            while (reader.read()) {
+            }
+            reader.close();
+        }, osmium::format_version_error);
+    }
+
+    SECTION("rejects unknown parser") {
+        REQUIRE_THROWS_AS({
+            osmium::io::Reader reader(osmium::io::File(with_data_dir("t/io/data-nwr.osm"), "osm,xml_parser=foo"));
+        }, std::runtime_error);
+    }
+
+}
+
@@ -0,0 +1,113 @@
+#include "catch.hpp"
+#include "describe_handler.hpp"
+#include "utils.hpp"
+
+#include <string>
+#include <vector>
+
+#include <osmium/io/xml_input.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/visitor.hpp>
+
+static std::vector<std::string> describe(const osmium::io::File& file) {
+    osmium::io::Reader reader(file);
+    DescribeHandler handler;
+    osmium::apply(reader, handler);
+    reader.close();
+    return handler.objects;
+}
+
+TEST_CASE("Parallel XML parser") {
+
+    SECTION("gives same result as normal parser") {
+        const auto expected = describe(osmium::io::File(with_data_dir("t/io/data-nwr.osm")));
+        const auto result = describe(osmium::io::File(with_data_dir("t/io/data-nwr.osm"), "osm,xml_parallel=true"));
+
+        REQUIRE(expected.size() == 6);
+        REQUIRE(result == expected);
+    }
+
+    SECTION("reads header") {
+        osmium::io::Reader reader(osmium::io::File(with_data_dir("t/io/data-nwr.osm"), "osm,xml_parallel=true"), osmium::osm_entity_bits::nothing);
+        const osmium::io::Header header = reader.header();
+        REQUIRE(header.get("generator") == "test");
+        REQUIRE(!reader.read());
+    }
+
+    SECTION("handles change files") {
+        const std::string data =
+            "<?xml version='1.0' encoding='UTF-8'?>\n"
+            "<osmChange version=\"0.6\" generator=\"test\">\n"
+            "<!-- <node id=\"99\"/> in a comment -->\n"
+            "<create>\n"
+            "  <node id=\"1\" version=\"1\" lat=\"1\" lon=\"2\"><tag k=\"a\" v=\"&lt;node&gt;\"/></node>\n"
+            "</create>\n"
+            "<modify>\n"
+            "  <way id=\"2\" version=\"2\"><nd ref=\"1\"/></way>\n"
+            "</modify>\n"
+            "<delete if-unused=\"true\">\n"
+            "  <node id=\"3\" version=\"3\"/>\n"
+            "  <relation id=\"4\" version=\"4\"/>\n"
+            "</delete>\n"
+            "<delete/>\n"
+            "<modify>\n"
+            "  <node id=\"5\" version=\"5\" lat=\"1\" lon=\"2\"/>\n"
+            "</modify>\n"
+            "</osmChange>\n";
+
+        const auto expected = describe(osmium::io::File(data.data(), data.size(), "osc"));
+        const auto result = describe(osmium::io::File(data.data(), data.size(), "osc,xml_parallel=true"));
+
+        REQUIRE(expected.size() == 5);
+        REQUIRE(result == expected);
+        REQUIRE(result[2] == "n3 v3 D c0 t i0 u x2147483647 y2147483647");
+        REQUIRE(result[4] == "n5 v5 V c0 t i0 u x20000000 y10000000");
+    }
+
+    SECTION("splits large files into chunks") {
+        std::string data = "<?xml version='1.0' encoding='UTF-8'?>\n<osm version=\"0.6\">\n";
+        for (int i = 1; i <= 30000; ++i) {
+            data += "  <node id=\"" + std::to_string(i) + "\" version=\"1\" lat=\"1\" lon=\"1\">\n";
+            data += "    <tag k=\"name\" v=\"node " + std::to_string(i) + "\"/>\n";
+            data += "  </node>\n";
+        }
+        data += "</osm>\n";
+        REQUIRE(data.size() > 2 * 1024 * 1024);
+
+        const auto expected = describe(osmium::io::File(data.data(), data.size(), "osm"));
+        const auto result = describe(osmium::io::File(data.data(), data.size(), "osm,xml_parallel=true"));
+
+        REQUIRE(result.size() == 30000);
+        REQUIRE(result == expected);
+    }
+
+    SECTION("reports errors") {
+        const std::string data =
+            "<?xml version='1.0' encoding='UTF-8'?>\n"
+            "<osm version=\"0.6\">\n"
+            "  <node id=\"1\" version=\"1\"><tag></node>\n"
+            "</osm>\n";
+
+        osmium::io::Reader reader(osmium::io::File(data.data(), data.size(), "osm,xml_parallel=true"));
+        REQUIRE_THROWS_AS({
+            while (reader.read()) {
+            }
+        }, osmium::xml_error);
+    }
+
+    SECTION("reports wrong version") {
+        const std::string data =
+            "<?xml version='1.0' encoding='UTF-8'?>\n"
+            "<osm version=\"0.5\">\n"
+            "  <node id=\"1\" version=\"1\"/>\n"
+            "</osm>\n";
+
+        osmium::io::Reader reader(osmium::io::File(data.data(), data.size(), "osm,xml_parallel=true"));
+        REQUIRE_THROWS_AS({
+            while (reader.read()) {
+            }
+        }, osmium::format_version_error);
+    }
+
+}
+
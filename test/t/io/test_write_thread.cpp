@@ -0,0 +1,39 @@
+#include "catch.hpp"
+
+#include <cstdio>
+#include <future>
+#include <string>
+
+#include <osmium/io/compression.hpp>
+#include <osmium/io/detail/output_format.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/detail/write_thread.hpp>
+
+static std::future<std::string> ready_future(const std::string& data) {
+    std::promise<std::string> promise;
+    promise.set_value(data);
+    return promise.get_future();
+}
+
+TEST_CASE("WriteThread") {
+
+    const std::string filename = "test_write_thread.out";
+    osmium::io::detail::data_queue_type queue;
+    osmium::io::NoCompressor compressor(osmium::io::detail::open_for_writing(filename, osmium::io::overwrite::allow));
+    osmium::io::detail::WriteThread write_thread(queue, &compressor);
+
+    SECTION("writes data until end of data") {
+        queue.push(ready_future("foo"));
+        queue.push(ready_future(""));
+        REQUIRE(write_thread());
+    }
+
+    SECTION("stops when the queue is shut down") {
+        queue.push(ready_future("foo"));
+        queue.shutdown();
+        REQUIRE_FALSE(write_thread());
+    }
+
+    compressor.close();
+    std::remove(filename.c_str());
+}
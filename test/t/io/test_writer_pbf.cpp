@@ -0,0 +1,269 @@
+#include "catch.hpp"
+#include "utils.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <osmium/io/opl_input.hpp>
+#include <osmium/io/pbf_input.hpp>
+#include <osmium/io/pbf_output.hpp>
+
+static void check_roundtrip(const std::string& format) {
+    const int num_nodes = 30000;
+    const int num_ways = 10000;
+    const std::string data = make_opl(num_nodes, num_ways);
+    const std::string filename = "test_writer_pbf.osm.pbf";
+
+    osmium::thread::Pool pool(3);
+    {
+        osmium::io::Reader reader(osmium::io::File(data.data(), data.size(), "opl"));
+        osmium::io::Writer writer(osmium::io::File(filename, format), reader.header(), osmium::io::overwrite::allow, pool);
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            writer(std::move(buffer));
+        }
+        writer.close();
+    }
+
+    osmium::io::Reader reader(filename);
+    int nodes = 0;
+    int ways = 0;
+    bool in_order = true;
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        for (auto it = buffer.cbegin<osmium::OSMObject>(); it != buffer.cend<osmium::OSMObject>(); ++it) {
+            if (it->type() == osmium::item_type::node) {
+                ++nodes;
+                in_order = in_order && ways == 0 && it->id() == nodes;
+            } else if (it->type() == osmium::item_type::way) {
+                ++ways;
+                in_order = in_order && it->id() == ways;
+                in_order = in_order && static_cast<const osmium::Way&>(*it).nodes().size() == 3;
+            }
+            in_order = in_order && std::string(it->tags().begin()->key()) == (ways ? "highway" : "amenity");
+        }
+    }
+
+    REQUIRE(nodes == num_nodes);
+    REQUIRE(ways == num_ways);
+    REQUIRE(in_order);
+}
+
+TEST_CASE("Write PBF file with several blocks") {
+
+    SECTION("dense nodes") {
+        check_roundtrip("pbf");
+    }
+
+    SECTION("without dense nodes") {
+        check_roundtrip("pbf,pbf_dense_nodes=false");
+    }
+
+    SECTION("uncompressed") {
+        check_roundtrip("pbf,pbf_compression=none");
+    }
+
+}
+
+TEST_CASE("Write PBF block with more than 65535 different strings") {
+    const int num_nodes = 8000;
+    const int tags_per_node = 10;
+    std::string data;
+    for (int i = 1; i <= num_nodes; ++i) {
+        data += "n" + std::to_string(i) + " v1 dV c1 t2015-01-01T00:00:00Z i1 uuser T";
+        for (int j = 0; j < tags_per_node; ++j) {
+            data += (j ? "," : "") + std::string("k") + std::to_string(j) + "=" + std::to_string(i * tags_per_node + j);
+        }
+        data += " x1.5 y2.5\n";
+    }
+    const std::string filename = "test_writer_pbf_strings.osm.pbf";
+
+    {
+        osmium::io::Reader reader(osmium::io::File(data.data(), data.size(), "opl"));
+        osmium::io::Writer writer(osmium::io::File(filename, "pbf"), reader.header(), osmium::io::overwrite::allow);
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            writer(std::move(buffer));
+        }
+        writer.close();
+    }
+
+    osmium::io::Reader reader(filename);
+    int nodes = 0;
+    bool tags_ok = true;
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        for (auto it = buffer.cbegin<osmium::Node>(); it != buffer.cend<osmium::Node>(); ++it) {
+            ++nodes;
+            int j = 0;
+            for (const auto& tag : it->tags()) {
+                tags_ok = tags_ok && std::string(tag.value()) == std::to_string(it->id() * tags_per_node + j);
+                ++j;
+            }
+            tags_ok = tags_ok && j == tags_per_node;
+        }
+    }
+
+    REQUIRE(nodes == num_nodes);
+    REQUIRE(tags_ok);
+}
+
+static std::string write_sorted_copy(const std::string& format) {
+    const std::string filename = "test_writer_pbf_sorted.osm.pbf";
+    {
+        osmium::io::Reader reader(with_data_dir("t/io/data-nwr-sorted.osm.pbf"));
+        osmium::io::Writer writer(osmium::io::File(filename, format), reader.header(), osmium::io::overwrite::allow);
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            writer(std::move(buffer));
+        }
+        writer.close();
+    }
+
+    osmium::io::Reader reader(filename);
+    const std::string sorting = reader.header().get("sorting");
+    reader.close();
+    return sorting;
+}
+
+TEST_CASE("Write PBF file with Sort.Type_then_ID feature") {
+
+    SECTION("sorting is not copied from input header") {
+        REQUIRE(write_sorted_copy("pbf") == "");
+    }
+
+    SECTION("sorting is set if requested") {
+        REQUIRE(write_sorted_copy("pbf,pbf_sort_type_then_id=true") == "Type_then_ID");
+    }
+
+}
+
+static std::string read_file_contents(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+TEST_CASE("Copy unchanged PBF blobs") {
+    const std::string data = make_opl(30000, 10000);
+    const std::string source = "test_writer_pbf_source.osm.pbf";
+    const std::string copy = "test_writer_pbf_copy.osm.pbf";
+
+    {
+        osmium::io::Reader reader(osmium::io::File(data.data(), data.size(), "opl"));
+        osmium::io::Writer writer(osmium::io::File(source, "pbf"), reader.header(), osmium::io::overwrite::allow);
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            writer(std::move(buffer));
+        }
+        writer.close();
+    }
+
+    SECTION("blobs are copied if nothing changed") {
+        osmium::io::Reader reader(source, osmium::io::keep_raw_data::yes);
+        osmium::io::Writer writer(osmium::io::File(copy, "pbf"), reader.header(), osmium::io::overwrite::allow, osmium::io::copy_raw_data::yes);
+        int buffers = 0;
+        bool all_raw = true;
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            ++buffers;
+            all_raw = all_raw && buffer.raw_data() != nullptr;
+            writer(std::move(buffer));
+        }
+        writer.close();
+
+        REQUIRE(buffers > 1);
+        REQUIRE(all_raw);
+        REQUIRE(read_file_contents(copy) == read_file_contents(source));
+    }
+
+    SECTION("blobs are copied if the file is not memory mapped") {
+        osmium::io::Reader reader(osmium::io::File(source, "pbf,mmap=false"), osmium::io::keep_raw_data::yes);
+        osmium::io::Writer writer(osmium::io::File(copy, "pbf"), reader.header(), osmium::io::overwrite::allow, osmium::io::copy_raw_data::yes);
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            REQUIRE(buffer.raw_data() != nullptr);
+            writer(std::move(buffer));
+        }
+        writer.close();
+
+        REQUIRE(read_file_contents(copy) == read_file_contents(source));
+    }
+
+    SECTION("blobs are encoded again if the compression is different") {
+        osmium::io::Reader reader(source, osmium::io::keep_raw_data::yes);
+        osmium::io::Writer writer(osmium::io::File(copy, "pbf,pbf_compression=none"), reader.header(), osmium::io::overwrite::allow, osmium::io::copy_raw_data::yes);
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            writer(std::move(buffer));
+        }
+        writer.close();
+
+        REQUIRE(read_file_contents(copy).size() > read_file_contents(source).size());
+
+        osmium::io::Reader copy_reader(copy);
+        int count = 0;
+        while (osmium::memory::Buffer buffer = copy_reader.read()) {
+            count += static_cast<int>(std::distance(buffer.cbegin(), buffer.cend()));
+        }
+        REQUIRE(count == 40000);
+    }
+
+    SECTION("blobs are encoded again if history flag is different") {
+        osmium::io::Reader reader(source, osmium::io::keep_raw_data::yes);
+        osmium::io::Writer writer(osmium::io::File(copy, "osh.pbf"), reader.header(), osmium::io::overwrite::allow, osmium::io::copy_raw_data::yes);
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            REQUIRE(buffer.raw_data_flags() == 0);
+            writer(std::move(buffer));
+        }
+        writer.close();
+
+        const std::string history_copy = "test_writer_pbf_history_copy.osh.pbf";
+        osmium::io::Reader history_reader(copy, osmium::io::keep_raw_data::yes);
+        osmium::io::Writer history_writer(osmium::io::File(history_copy, "osh.pbf"), history_reader.header(), osmium::io::overwrite::allow, osmium::io::copy_raw_data::yes);
+        while (osmium::memory::Buffer buffer = history_reader.read()) {
+            REQUIRE(buffer.raw_data_flags() == osmium::io::detail::pbf_raw_blob_history);
+            history_writer(std::move(buffer));
+        }
+        history_writer.close();
+
+        // copying between history files copies the blobs
+        REQUIRE(read_file_contents(history_copy) == read_file_contents(copy));
+
+        // the history file has visible flags in its blobs
+        REQUIRE(read_file_contents(copy).size() > read_file_contents(source).size());
+        std::remove(history_copy.c_str());
+    }
+
+    SECTION("changed objects are written without copy_raw_data option") {
+        osmium::io::Reader reader(source, osmium::io::keep_raw_data::yes);
+        osmium::io::Writer writer(osmium::io::File(copy, "pbf"), reader.header(), osmium::io::overwrite::allow);
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            REQUIRE(buffer.raw_data() != nullptr);
+            for (auto it = buffer.begin<osmium::Node>(); it != buffer.end<osmium::Node>(); ++it) {
+                it->set_location(osmium::Location(3.5, 4.5));
+            }
+            writer(std::move(buffer));
+        }
+        writer.close();
+
+        osmium::io::Reader copy_reader(copy);
+        int nodes = 0;
+        int changed = 0;
+        while (osmium::memory::Buffer buffer = copy_reader.read()) {
+            for (auto it = buffer.cbegin<osmium::Node>(); it != buffer.cend<osmium::Node>(); ++it) {
+                ++nodes;
+                changed += it->location() == osmium::Location(3.5, 4.5) ? 1 : 0;
+            }
+        }
+        REQUIRE(nodes == 30000);
+        REQUIRE(changed == 30000);
+    }
+
+    SECTION("no raw data without keep_raw_data option") {
+        osmium::io::Reader reader(source);
+        osmium::memory::Buffer buffer = reader.read();
+        REQUIRE(buffer);
+        REQUIRE(buffer.raw_data() == nullptr);
+    }
+
+    SECTION("no raw data if some objects are not read") {
+        osmium::io::Reader reader(source, osmium::osm_entity_bits::node, osmium::io::keep_raw_data::yes);
+        osmium::memory::Buffer buffer = reader.read();
+        REQUIRE(buffer);
+        REQUIRE(buffer.raw_data() == nullptr);
+    }
+
+}
@@ -0,0 +1,125 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <osmium/thread/byte_budget.hpp>
+#include <osmium/thread/queue.hpp>
+#include <osmium/thread/spsc_queue.hpp>
+
+TEST_CASE("Byte budget") {
+
+    SECTION("unlimited budget never blocks but keeps statistics") {
+        osmium::thread::ByteBudget budget;
+        budget.acquire(1000);
+        budget.acquire(2000);
+        budget.release(1000);
+
+        const auto stats = budget.stats();
+        REQUIRE(stats.limit == 0);
+        REQUIRE(stats.in_use == 2000);
+        REQUIRE(stats.peak == 3000);
+        REQUIRE(stats.stalls == 0);
+    }
+
+    SECTION("unlimited budget never locks the mutex") {
+        osmium::thread::ByteBudget budget;
+        osmium::thread::SPSCQueue<std::string> queue(10, "test", budget, [](const std::string& str) { return str.size(); });
+
+        std::thread producer([&] {
+            for (int i = 0; i < 1000; ++i) {
+                queue.push("abc");
+            }
+        });
+
+        std::string value;
+        for (int i = 0; i < 1000; ++i) {
+            queue.wait_and_pop(value);
+        }
+        producer.join();
+
+        const auto stats = budget.stats();
+        REQUIRE(stats.in_use == 0);
+        REQUIRE(stats.peak >= 3);
+        REQUIRE(stats.locks == 0);
+    }
+
+    SECTION("limited budget locks the mutex") {
+        osmium::thread::ByteBudget budget(100);
+        budget.acquire(10);
+        budget.release(10);
+        REQUIRE(budget.stats().locks == 2);
+    }
+
+    SECTION("data larger than budget is allowed if budget is empty") {
+        osmium::thread::ByteBudget budget(100);
+        budget.acquire(1000);
+        REQUIRE(budget.stats().in_use == 1000);
+        REQUIRE(budget.stats().stalls == 0);
+    }
+
+    SECTION("acquire blocks until enough is released") {
+        osmium::thread::ByteBudget budget(100);
+        budget.acquire(80);
+
+        std::atomic<bool> acquired(false);
+        std::thread producer([&] {
+            budget.acquire(50);
+            acquired = true;
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        REQUIRE_FALSE(acquired);
+
+        budget.release(80);
+        producer.join();
+
+        REQUIRE(acquired);
+        const auto stats = budget.stats();
+        REQUIRE(stats.in_use == 50);
+        REQUIRE(stats.stalls == 1);
+        REQUIRE(stats.stall_time.count() > 0);
+    }
+
+    SECTION("shutdown wakes up waiting producers") {
+        osmium::thread::ByteBudget budget(100);
+        budget.acquire(100);
+
+        std::thread producer([&] {
+            budget.acquire(100);
+        });
+
+        budget.shutdown();
+        producer.join();
+        REQUIRE(budget.stats().in_use == 200);
+    }
+
+}
+
+TEST_CASE("Queue with byte budget") {
+
+    osmium::thread::ByteBudget budget(10);
+    osmium::thread::Queue<std::string> queue(0, "test", budget, [](const std::string& str) { return str.size(); });
+
+    queue.push("abcdef");
+    REQUIRE(budget.stats().in_use == 6);
+
+    std::thread producer([&] {
+        queue.push("ghijkl");
+    });
+
+    std::string value;
+    queue.wait_and_pop(value);
+    REQUIRE(value == "abcdef");
+
+    producer.join();
+    REQUIRE(queue.size() == 1);
+    REQUIRE(budget.stats().in_use == 6);
+    REQUIRE(budget.stats().peak <= 10);
+
+    REQUIRE(queue.try_pop(value));
+    REQUIRE(value == "ghijkl");
+    REQUIRE(budget.stats().in_use == 0);
+}
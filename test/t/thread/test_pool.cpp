@@ -1,8 +1,11 @@
 #include "catch.hpp"
 
 #include <chrono>
+#include <future>
+#include <mutex>
 #include <stdexcept>
 #include <thread>
+#include <vector>
 
 #include <osmium/thread/pool.hpp>
 
@@ -65,5 +68,145 @@ TEST_CASE("thread") {
         REQUIRE_THROWS_AS(future.get(), std::runtime_error);
     }
 
-}
+    SECTION("can run many jobs") {
+        auto& pool = osmium::thread::Pool::instance();
+
+        std::vector<std::future<int>> futures;
+        for (int i = 0; i < 1000; ++i) {
+            futures.push_back(pool.submit([i] { return i; }));
+        }
+
+        int sum = 0;
+        for (auto& future : futures) {
+            sum += future.get();
+        }
+        REQUIRE(sum == 499500);
+        REQUIRE(pool.queue_empty());
+    }
+
+    SECTION("can submit jobs from inside pool threads") {
+        auto& pool = osmium::thread::Pool::instance();
+
+        auto outer = pool.submit([&pool] {
+            std::vector<std::future<int>> inner;
+            for (int i = 0; i < 100; ++i) {
+                inner.push_back(pool.submit([i] { return i; }));
+            }
+            return inner;
+        });
+
+        int sum = 0;
+        for (auto& future : outer.get()) {
+            sum += future.get();
+        }
+        REQUIRE(sum == 4950);
+    }
 
+    SECTION("can submit jobs to another pool from pool threads") {
+        osmium::thread::Pool outer(4);
+        osmium::thread::Pool inner(1);
+
+        std::vector<std::future<int>> futures;
+        for (int i = 0; i < 100; ++i) {
+            futures.push_back(outer.submit([&inner, i] {
+                return inner.submit([i] { return i; }).get();
+            }));
+        }
+
+        int sum = 0;
+        for (auto& future : futures) {
+            sum += future.get();
+        }
+        REQUIRE(sum == 4950);
+    }
+
+    SECTION("jobs with higher priority run first") {
+        osmium::thread::Pool pool(1);
+        REQUIRE(pool.num_threads() == 1);
+
+        // keep the worker busy until all jobs are queued
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+        std::atomic<bool> started{false};
+        auto blocker = pool.submit([released, &started] {
+            started = true;
+            released.wait();
+        });
+        while (!started) {
+            std::this_thread::yield();
+        }
+
+        std::mutex mutex;
+        std::vector<int> order;
+        auto job = [&mutex, &order](int n) {
+            return [&mutex, &order, n] {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(n);
+            };
+        };
+        auto f3 = pool.submit(job(3), osmium::thread::task_priority::low);
+        auto f2 = pool.submit(job(2), osmium::thread::task_priority::normal);
+        auto f1 = pool.submit(job(1), osmium::thread::task_priority::high);
+
+        release.set_value();
+        blocker.get();
+        f1.get();
+        f2.get();
+        f3.get();
+
+        REQUIRE(order == std::vector<int>({1, 2, 3}));
+    }
+
+    SECTION("rejects jobs waiting for space when the pool is destructed") {
+        std::promise<bool> rejected;
+        std::shared_future<bool> rejected_future = rejected.get_future().share();
+        std::thread submitter;
+        {
+            osmium::thread::Pool pool(1, 1);
+
+            // the worker is busy until the submitter is done and one more
+            // job fills the queue, so the submitter has to wait
+            std::atomic<bool> started{false};
+            pool.submit([rejected_future, &started] {
+                started = true;
+                rejected_future.wait();
+            });
+            while (!started) {
+                std::this_thread::yield();
+            }
+            pool.submit([] {});
+
+            submitter = std::thread([&pool, &rejected] {
+                try {
+                    pool.submit([] {});
+                    rejected.set_value(false);
+                } catch (const std::runtime_error&) {
+                    rejected.set_value(true);
+                }
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        submitter.join();
+
+        REQUIRE(rejected_future.get());
+    }
+
+    SECTION("can create own pool") {
+        std::vector<std::future<int>> futures;
+        {
+            osmium::thread::Pool pool(3, 2, {0});
+            REQUIRE(pool.num_threads() == 3);
+            for (int i = 0; i < 100; ++i) {
+                futures.push_back(pool.submit([i] { return i; }));
+            }
+        }
+
+        // all tasks ran before the pool was destructed
+        int sum = 0;
+        for (auto& future : futures) {
+            sum += future.get();
+        }
+        REQUIRE(sum == 4950);
+    }
+
+}
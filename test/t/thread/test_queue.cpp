@@ -0,0 +1,94 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <osmium/thread/queue.hpp>
+
+TEST_CASE("Queue") {
+
+    SECTION("elements come out in order") {
+        osmium::thread::Queue<int> queue(2);
+
+        std::thread producer([&] {
+            for (int i = 0; i < 1000; ++i) {
+                queue.push(i);
+            }
+        });
+
+        int value = -1;
+        for (int i = 0; i < 1000; ++i) {
+            REQUIRE(queue.wait_and_pop(value));
+            REQUIRE(value == i);
+        }
+        producer.join();
+        REQUIRE(queue.empty());
+    }
+
+    SECTION("push blocks on full queue until an element is popped") {
+        osmium::thread::Queue<int> queue(1);
+        queue.push(1);
+
+        std::atomic<bool> pushed(false);
+        std::thread producer([&] {
+            queue.push(2);
+            pushed = true;
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        REQUIRE_FALSE(pushed);
+
+        int value = 0;
+        REQUIRE(queue.try_pop(value));
+        REQUIRE(value == 1);
+        producer.join();
+
+        REQUIRE(pushed);
+        REQUIRE(queue.size() == 1);
+    }
+
+    SECTION("shutdown wakes up blocked producer") {
+        osmium::thread::Queue<int> queue(1);
+        queue.push(1);
+
+        std::thread producer([&] {
+            queue.push(2);
+            queue.push(3);
+        });
+
+        queue.shutdown();
+        producer.join();
+
+        REQUIRE(queue.size() == 3);
+    }
+
+    SECTION("shutdown wakes up waiting consumer") {
+        osmium::thread::Queue<int> queue;
+
+        std::atomic<bool> result(true);
+        std::thread consumer([&] {
+            int value = 0;
+            result = queue.wait_and_pop(value);
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        queue.shutdown();
+        consumer.join();
+
+        REQUIRE_FALSE(result);
+    }
+
+    SECTION("elements can be popped after shutdown") {
+        osmium::thread::Queue<int> queue;
+        queue.push(1);
+        queue.shutdown();
+
+        int value = 0;
+        REQUIRE(queue.wait_and_pop(value));
+        REQUIRE(value == 1);
+        REQUIRE_FALSE(queue.wait_and_pop(value));
+        REQUIRE_FALSE(queue.wait_and_pop_with_timeout(value));
+    }
+
+}
@@ -0,0 +1,108 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <osmium/thread/byte_budget.hpp>
+#include <osmium/thread/spsc_queue.hpp>
+
+TEST_CASE("SPSC queue") {
+
+    SECTION("capacity must not be 0") {
+        REQUIRE_THROWS_AS(osmium::thread::SPSCQueue<int>(0), std::invalid_argument);
+    }
+
+    SECTION("elements come out in order") {
+        osmium::thread::SPSCQueue<int> queue(3);
+
+        std::thread producer([&] {
+            for (int i = 0; i < 100000; ++i) {
+                queue.push(i);
+            }
+        });
+
+        int value = -1;
+        bool in_order = true;
+        for (int i = 0; i < 100000; ++i) {
+            REQUIRE(queue.wait_and_pop(value));
+            in_order = in_order && value == i;
+        }
+        producer.join();
+
+        REQUIRE(in_order);
+        REQUIRE(queue.empty());
+    }
+
+    SECTION("push blocks on full queue until an element is popped") {
+        osmium::thread::SPSCQueue<int> queue(1);
+        queue.push(1);
+
+        std::atomic<bool> pushed(false);
+        std::thread producer([&] {
+            queue.push(2);
+            pushed = true;
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        REQUIRE_FALSE(pushed);
+
+        int value = 0;
+        REQUIRE(queue.try_pop(value));
+        REQUIRE(value == 1);
+        producer.join();
+
+        REQUIRE(pushed);
+        REQUIRE(queue.size() == 1);
+    }
+
+    SECTION("shutdown wakes up blocked producer") {
+        osmium::thread::SPSCQueue<int> queue(1);
+        queue.push(1);
+
+        std::thread producer([&] {
+            queue.push(2);
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        queue.shutdown();
+        producer.join();
+
+        int value = 0;
+        REQUIRE(queue.wait_and_pop(value));
+        REQUIRE(value == 1);
+        REQUIRE_FALSE(queue.wait_and_pop(value));
+    }
+
+    SECTION("shutdown wakes up waiting consumer") {
+        osmium::thread::SPSCQueue<int> queue;
+
+        std::atomic<bool> result(true);
+        std::thread consumer([&] {
+            int value = 0;
+            result = queue.wait_and_pop(value);
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        queue.shutdown();
+        consumer.join();
+
+        REQUIRE_FALSE(result);
+    }
+
+    SECTION("budget is acquired and released") {
+        osmium::thread::ByteBudget budget;
+        osmium::thread::SPSCQueue<std::string> queue(10, "test", budget, [](const std::string& str) { return str.size(); });
+
+        queue.push("abc");
+        queue.push("de");
+        REQUIRE(budget.stats().in_use == 5);
+
+        std::string value;
+        REQUIRE(queue.wait_and_pop(value));
+        REQUIRE(value == "abc");
+        REQUIRE(budget.stats().in_use == 2);
+    }
+
+}